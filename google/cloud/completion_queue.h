@@ -17,6 +17,7 @@
 
 #include "google/cloud/future.h"
 #include "google/cloud/internal/async_read_stream_impl.h"
+#include "google/cloud/internal/async_read_write_stream_impl.h"
 #include "google/cloud/internal/completion_queue_impl.h"
 #include "google/cloud/status_or.h"
 #include "google/cloud/version.h"
@@ -26,14 +27,6 @@
 namespace google {
 namespace cloud {
 inline namespace GOOGLE_CLOUD_CPP_NS {
-namespace internal {
-// Type erase the callables in RunAsync()
-struct RunAsyncBase {
-  virtual ~RunAsyncBase() = default;
-  virtual void exec() = 0;
-};
-}  // namespace internal
-
 /**
  * Call the functor associated with asynchronous operations when they complete.
  */
@@ -174,6 +167,38 @@ class CompletionQueue {
     return stream;
   }
 
+  /**
+   * Make an asynchronous bidirectional streaming RPC.
+   *
+   * The returned object has not started the RPC, the caller must call
+   * `Start()` before any other member function. All the operations on the
+   * stream complete on the threads blocked on this object's Run() member
+   * function.
+   *
+   * @param async_call a callable to prepare the asynchronous RPC. This is
+   *     typically a wrapper around one of the gRPC-generated `PrepareAsync*()`
+   *     functions.
+   * @param context an initialized request context to make the call.
+   *
+   * @tparam AsyncCallType the type of @a async_call. It must be invocable with
+   *     parameters `(grpc::ClientContext*, grpc::CompletionQueue*)`, and return
+   *     a `std::unique_ptr<grpc::ClientAsyncReaderWriterInterface<Request,
+   *     Response>>`.
+   */
+  template <typename AsyncCallType,
+            typename Types =
+                internal::AsyncStreamingReadWriteRpcTypes<AsyncCallType>,
+            typename Request = typename Types::request_type,
+            typename Response = typename Types::response_type>
+  std::unique_ptr<internal::AsyncStreamingReadWriteRpc<Request, Response>>
+  MakeStreamingReadWriteRpc(AsyncCallType&& async_call,
+                            std::unique_ptr<grpc::ClientContext> context) {
+    auto stream = async_call(context.get(), &impl_->cq());
+    return absl::make_unique<
+        internal::AsyncStreamingReadWriteRpcImpl<Request, Response>>(
+        impl_, std::move(context), std::move(stream));
+  }
+
   /**
    * Asynchronously run a functor on a thread `Run()`ning the `CompletionQueue`.
    *
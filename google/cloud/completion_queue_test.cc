@@ -19,9 +19,13 @@
 #include <google/bigtable/admin/v2/bigtable_table_admin.grpc.pb.h>
 #include <google/bigtable/v2/bigtable.grpc.pb.h>
 #include <gmock/gmock.h>
+#include <atomic>
 #include <chrono>
+#include <functional>
 #include <memory>
+#include <numeric>
 #include <thread>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -441,6 +445,103 @@ TEST(CompletionQueueTest, RunAsyncThread) {
   for (auto& t : runners) t.join();
 }
 
+TEST(CompletionQueueTest, RunAsyncOrder) {
+  CompletionQueue cq;
+
+  // Post the functions before starting the thread, so they are all drained
+  // together.
+  std::vector<int> order;
+  auto constexpr kIterations = 100;
+  for (int i = 0; i != kIterations; ++i) {
+    cq.RunAsync([&order, i] { order.push_back(i); });
+  }
+  promise<void> done;
+  cq.RunAsync([&done] { done.set_value(); });
+  std::thread runner([&cq] { cq.Run(); });
+  done.get_future().get();
+
+  std::vector<int> expected(kIterations);
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT_EQ(expected, order);
+
+  cq.Shutdown();
+  runner.join();
+}
+
+TEST(CompletionQueueTest, RunAsyncManyProducers) {
+  CompletionQueue cq;
+  std::vector<std::thread> runners(2);
+  for (auto& t : runners) t = std::thread([&cq] { cq.Run(); });
+
+  // Each function posted from the callbacks wakes up the queue again.
+  auto constexpr kProducers = 8;
+  auto constexpr kIterations = 1000;
+  std::atomic<int> count{0};
+  promise<void> done;
+  auto increment = [&count, &done] {
+    if (++count == kProducers * kIterations) done.set_value();
+  };
+  std::vector<std::thread> producers(kProducers);
+  for (auto& t : producers) {
+    t = std::thread([&cq, &increment] {
+      for (int i = 0; i != kIterations; ++i) {
+        if (i % 2 == 0) {
+          cq.RunAsync(increment);
+        } else {
+          cq.RunAsync([&cq, &increment] { cq.RunAsync(increment); });
+        }
+      }
+    });
+  }
+  for (auto& t : producers) t.join();
+  done.get_future().get();
+  EXPECT_EQ(kProducers * kIterations, count.load());
+
+  cq.Shutdown();
+  for (auto& t : runners) t.join();
+}
+
+TEST(CompletionQueueTest, RunAsyncAfterShutdown) {
+  CompletionQueue cq;
+  std::thread runner([&cq] { cq.Run(); });
+  cq.Shutdown();
+  runner.join();
+
+  // Once the queue is shutdown the functions run in the calling thread.
+  std::thread::id id;
+  cq.RunAsync([&id] { id = std::this_thread::get_id(); });
+  EXPECT_EQ(std::this_thread::get_id(), id);
+}
+
+TEST(CompletionQueueTest, RunAsyncRepostDoesNotStarveTimers) {
+  CompletionQueue cq;
+  std::thread runner([&cq] { cq.Run(); });
+
+  // A function that posts itself again must not keep the only `Run()` thread
+  // away from the timer completions.
+  auto constexpr kMaxReposts = 1000000;
+  std::atomic<bool> expired{false};
+  std::atomic<int> reposts{0};
+  promise<void> done;
+  std::function<void()> repost = [&] {
+    if (expired.load() || ++reposts == kMaxReposts) {
+      done.set_value();
+      return;
+    }
+    cq.RunAsync(repost);
+  };
+  using TimerFuture = future<StatusOr<std::chrono::system_clock::time_point>>;
+  auto timer = cq.MakeRelativeTimer(std::chrono::milliseconds(1))
+                   .then([&expired](TimerFuture) { expired.store(true); });
+  cq.RunAsync(repost);
+  done.get_future().get();
+  timer.get();
+  EXPECT_LT(reposts.load(), kMaxReposts);
+
+  cq.Shutdown();
+  runner.join();
+}
+
 // Sets up a timer that reschedules itself and verifies we can shut down
 // cleanly whether we call `CancelAll()` on the queue first or not.
 namespace {
@@ -21,6 +21,7 @@
 #include "google/cloud/tracing_options.h"
 #include "google/cloud/version.h"
 #include <grpcpp/grpcpp.h>
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <set>
@@ -32,7 +33,8 @@ inline namespace GOOGLE_CLOUD_CPP_NS {
 namespace internal {
 std::set<std::string> DefaultTracingComponents();
 TracingOptions DefaultTracingOptions();
-std::unique_ptr<BackgroundThreads> DefaultBackgroundThreads();
+std::unique_ptr<BackgroundThreads> DefaultBackgroundThreads(
+    std::size_t thread_pool_size = 1);
 }  // namespace internal
 
 /**
@@ -53,7 +55,8 @@ class ConnectionOptions {
         tracing_components_(internal::DefaultTracingComponents()),
         tracing_options_(internal::DefaultTracingOptions()),
         user_agent_prefix_(ConnectionTraits::user_agent_prefix()),
-        background_threads_factory_(internal::DefaultBackgroundThreads) {}
+        background_threads_factory_(
+            [] { return internal::DefaultBackgroundThreads(); }) {}
 
   /// Change the gRPC credentials value.
   ConnectionOptions& set_credentials(
@@ -214,6 +217,23 @@ class ConnectionOptions {
     return *this;
   }
 
+  /**
+   * Run the background work of the connection on a pool of @p v threads.
+   *
+   * By default connections create a single background thread, which
+   * serializes all their asynchronous work, including any continuations
+   * attached by the application. Use this function to create more threads,
+   * all of them serving the connection's `CompletionQueue`. This replaces any
+   * previous call to `DisableBackgroundThreads()`. Values smaller than 1 are
+   * treated as 1.
+   */
+  ConnectionOptions& set_background_thread_pool_size(std::size_t v) {
+    background_threads_factory_ = [v] {
+      return internal::DefaultBackgroundThreads(v);
+    };
+    return *this;
+  }
+
   using BackgroundThreadsFactory =
       std::function<std::unique_ptr<BackgroundThreads>()>;
   BackgroundThreadsFactory background_threads_factory() const {
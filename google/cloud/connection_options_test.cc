@@ -186,6 +186,20 @@ TEST(ConnectionOptionsTest, CustomBackgroundThreads) {
   t.join();
 }
 
+TEST(ConnectionOptionsTest, BackgroundThreadPoolSize) {
+  auto options = TestConnectionOptions(grpc::InsecureChannelCredentials())
+                     .set_background_thread_pool_size(4);
+  auto background = options.background_threads_factory()();
+  auto* pool = dynamic_cast<internal::AutomaticallyCreatedBackgroundThreads*>(
+      background.get());
+  ASSERT_NE(nullptr, pool);
+  EXPECT_EQ(4U, pool->pool_size());
+
+  promise<std::thread::id> p;
+  background->cq().RunAsync([&p] { p.set_value(std::this_thread::get_id()); });
+  EXPECT_NE(std::this_thread::get_id(), p.get_future().get());
+}
+
 TEST(ConnectionOptionsTest, DefaultTracingComponentsNoEnvironment) {
   testing_util::ScopedEnvironment env("GOOGLE_CLOUD_CPP_ENABLE_TRACING", {});
   auto const actual = internal::DefaultTracingComponents();
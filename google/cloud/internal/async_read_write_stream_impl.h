@@ -0,0 +1,241 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_ASYNC_READ_WRITE_STREAM_IMPL_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_ASYNC_READ_WRITE_STREAM_IMPL_H
+
+#include "google/cloud/internal/completion_queue_impl.h"
+#include "google/cloud/future.h"
+#include "google/cloud/status.h"
+#include "google/cloud/version.h"
+#include "absl/types/optional.h"
+#include <grpcpp/support/async_stream.h>
+#include <memory>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+
+/**
+ * A bidirectional streaming RPC driven by a `CompletionQueue`.
+ *
+ * Each member function starts one operation and returns a future that is
+ * satisfied when the operation completes. gRPC allows at most one outstanding
+ * `Read()`, and at most one outstanding `Write()` or `WritesDone()`, the caller
+ * is responsible for respecting these limits.
+ *
+ * The caller must keep the object alive until the future returned by
+ * `Finish()` is satisfied.
+ *
+ * @tparam Request the type of the requests sent by the client.
+ * @tparam Response the type of the responses sent by the server.
+ */
+template <typename Request, typename Response>
+class AsyncStreamingReadWriteRpc {
+ public:
+  virtual ~AsyncStreamingReadWriteRpc() = default;
+
+  /// Sends a (best-effort) request to cancel the streaming RPC.
+  virtual void Cancel() = 0;
+
+  /// Starts the streaming RPC, the future is satisfied with `false` on errors.
+  virtual future<bool> Start() = 0;
+
+  /**
+   * Reads one response.
+   *
+   * The future is satisfied with an empty optional once the stream is closed,
+   * at that point the application should call `Finish()`.
+   */
+  virtual future<absl::optional<Response>> Read() = 0;
+
+  /// Writes one request, the future is satisfied with `false` on errors.
+  virtual future<bool> Write(Request const& request,
+                             grpc::WriteOptions options) = 0;
+
+  /// Half-closes the stream, the server receives no more requests.
+  virtual future<bool> WritesDone() = 0;
+
+  /// Returns the final status of the streaming RPC.
+  virtual future<Status> Finish() = 0;
+};
+
+/**
+ * Implements `AsyncStreamingReadWriteRpc` on top of a `CompletionQueueImpl`.
+ *
+ * Each operation is wrapped in a short-lived `AsyncGrpcOperation`, which owns
+ * any buffers required by gRPC, and satisfies the future when the completion
+ * queue reports the result.
+ */
+template <typename Request, typename Response>
+class AsyncStreamingReadWriteRpcImpl
+    : public AsyncStreamingReadWriteRpc<Request, Response> {
+ public:
+  using Stream = grpc::ClientAsyncReaderWriterInterface<Request, Response>;
+
+  AsyncStreamingReadWriteRpcImpl(std::shared_ptr<CompletionQueueImpl> cq,
+                                 std::unique_ptr<grpc::ClientContext> context,
+                                 std::unique_ptr<Stream> stream)
+      : cq_(std::move(cq)),
+        context_(std::move(context)),
+        stream_(std::move(stream)) {}
+
+  void Cancel() override { context_->TryCancel(); }
+
+  future<bool> Start() override {
+    auto op = std::make_shared<NotifyBool>();
+    auto f = op->result.get_future();
+    cq_->StartOperation(std::move(op),
+                        [&](void* tag) { stream_->StartCall(tag); });
+    return f;
+  }
+
+  future<absl::optional<Response>> Read() override {
+    class NotifyRead final : public AsyncGrpcOperation {
+     public:
+      Response response;
+      promise<absl::optional<Response>> result;
+
+     private:
+      void Cancel() override {}  // LCOV_EXCL_LINE
+      bool Notify(bool ok) override {
+        if (!ok) {
+          result.set_value(absl::optional<Response>{});
+          return true;
+        }
+        result.set_value(absl::make_optional(std::move(response)));
+        return true;
+      }
+    };
+
+    auto op = std::make_shared<NotifyRead>();
+    auto f = op->result.get_future();
+    auto* response = &op->response;
+    cq_->StartOperation(std::move(op),
+                        [&](void* tag) { stream_->Read(response, tag); });
+    return f;
+  }
+
+  future<bool> Write(Request const& request,
+                     grpc::WriteOptions options) override {
+    auto op = std::make_shared<NotifyBool>();
+    auto f = op->result.get_future();
+    cq_->StartOperation(std::move(op), [&](void* tag) {
+      stream_->Write(request, std::move(options), tag);
+    });
+    return f;
+  }
+
+  future<bool> WritesDone() override {
+    auto op = std::make_shared<NotifyBool>();
+    auto f = op->result.get_future();
+    cq_->StartOperation(std::move(op),
+                        [&](void* tag) { stream_->WritesDone(tag); });
+    return f;
+  }
+
+  future<Status> Finish() override {
+    class NotifyFinish final : public AsyncGrpcOperation {
+     public:
+      grpc::Status status;
+      promise<Status> result;
+
+     private:
+      void Cancel() override {}  // LCOV_EXCL_LINE
+      bool Notify(bool ok) override {
+        result.set_value(ok ? MakeStatusFromRpcError(status)
+                            : Status(StatusCode::kCancelled,
+                                     "call cancelled"));
+        return true;
+      }
+    };
+
+    auto op = std::make_shared<NotifyFinish>();
+    auto f = op->result.get_future();
+    auto* status = &op->status;
+    cq_->StartOperation(std::move(op),
+                        [&](void* tag) { stream_->Finish(status, tag); });
+    return f;
+  }
+
+ private:
+  /// An adapter for operations that only report success or failure.
+  class NotifyBool final : public AsyncGrpcOperation {
+   public:
+    promise<bool> result;
+
+   private:
+    void Cancel() override {}  // LCOV_EXCL_LINE
+    bool Notify(bool ok) override {
+      result.set_value(ok);
+      return true;
+    }
+  };
+
+  std::shared_ptr<CompletionQueueImpl> cq_;
+  std::unique_ptr<grpc::ClientContext> context_;
+  std::unique_ptr<Stream> stream_;
+};
+
+/**
+ * A meta function to extract the `Request` and `Response` types from an
+ * asynchronous bidirectional streaming RPC callable.
+ *
+ * These callables return a
+ * `std::unique_ptr<grpc::ClientAsyncReaderWriterInterface<Request, Response>>`.
+ * This is the generic version, implementing the "does not match the expected
+ * type" path.
+ */
+template <typename StreamType>
+struct AsyncStreamingReadWriteRpcUnwrap {};
+
+/**
+ * A meta function to extract the `Request` and `Response` types from an
+ * asynchronous bidirectional streaming RPC callable.
+ *
+ * This is the specialization implementing the "matched with the expected type"
+ * path.
+ */
+template <typename RequestType, typename ResponseType>
+struct AsyncStreamingReadWriteRpcUnwrap<std::unique_ptr<
+    grpc::ClientAsyncReaderWriterInterface<RequestType, ResponseType>>> {
+  using request_type = RequestType;
+  using response_type = ResponseType;
+};
+
+/**
+ * A meta function to determine the `Request` and `Response` types from an
+ * asynchronous bidirectional streaming RPC callable.
+ *
+ * These calls have the form:
+ *
+ * @code
+ *   std::unique_ptr<grpc::ClientAsyncReaderWriterInterface<Request, Response>>(
+ *      grpc::ClientContext*,
+ *      grpc::CompletionQueue*
+ *   );
+ * @endcode
+ */
+template <typename AsyncCallType>
+using AsyncStreamingReadWriteRpcTypes = AsyncStreamingReadWriteRpcUnwrap<
+    typename google::cloud::internal::invoke_result_t<
+        AsyncCallType, grpc::ClientContext*, grpc::CompletionQueue*>>;
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_ASYNC_READ_WRITE_STREAM_IMPL_H
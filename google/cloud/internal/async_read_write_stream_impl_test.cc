@@ -0,0 +1,131 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/async_read_write_stream_impl.h"
+#include "google/cloud/completion_queue.h"
+#include "google/cloud/testing_util/mock_completion_queue.h"
+#include "absl/memory/memory.h"
+#include <google/protobuf/duration.pb.h>
+#include <google/protobuf/timestamp.pb.h>
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::testing_util::MockCompletionQueue;
+using ::testing::_;
+using ::testing::StrictMock;
+
+using Request = ::google::protobuf::Duration;
+using Response = ::google::protobuf::Timestamp;
+
+class MockReaderWriter
+    : public grpc::ClientAsyncReaderWriterInterface<Request, Response> {
+ public:
+  MOCK_METHOD1(StartCall, void(void*));
+  MOCK_METHOD1(ReadInitialMetadata, void(void*));
+  MOCK_METHOD2(Finish, void(grpc::Status*, void*));
+  MOCK_METHOD2(Write, void(Request const&, void*));
+  MOCK_METHOD3(Write, void(Request const&, grpc::WriteOptions, void*));
+  MOCK_METHOD1(WritesDone, void(void*));
+  MOCK_METHOD2(Read, void(Response*, void*));
+};
+
+TEST(AsyncReadWriteStreamingRpcTest, Basic) {
+  auto mock_cq = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(mock_cq);
+
+  auto mock = absl::make_unique<MockReaderWriter>();
+  EXPECT_CALL(*mock, StartCall(_)).Times(1);
+  EXPECT_CALL(*mock, Write(_, _, _))
+      .WillOnce([](Request const& request, grpc::WriteOptions, void*) {
+        EXPECT_EQ(42, request.seconds());
+      });
+  EXPECT_CALL(*mock, Read(_, _))
+      .WillOnce([](Response* r, void*) { r->set_seconds(24); })
+      .WillOnce([](Response*, void*) {});
+  EXPECT_CALL(*mock, WritesDone(_)).Times(1);
+  EXPECT_CALL(*mock, Finish(_, _)).WillOnce([](grpc::Status* status, void*) {
+    *status = grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again");
+  });
+
+  auto stream = cq.MakeStreamingReadWriteRpc(
+      [&mock](grpc::ClientContext*, grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncReaderWriterInterface<Request, Response>>(
+            std::move(mock));
+      },
+      absl::make_unique<grpc::ClientContext>());
+
+  auto start = stream->Start();
+  mock_cq->SimulateCompletion(true);
+  EXPECT_TRUE(start.get());
+
+  Request request;
+  request.set_seconds(42);
+  auto write = stream->Write(request, grpc::WriteOptions());
+  mock_cq->SimulateCompletion(true);
+  EXPECT_TRUE(write.get());
+
+  auto read = stream->Read();
+  mock_cq->SimulateCompletion(true);
+  auto response = read.get();
+  ASSERT_TRUE(response.has_value());
+  EXPECT_EQ(24, response->seconds());
+
+  read = stream->Read();
+  mock_cq->SimulateCompletion(false);
+  EXPECT_FALSE(read.get().has_value());
+
+  auto writes_done = stream->WritesDone();
+  mock_cq->SimulateCompletion(false);
+  EXPECT_FALSE(writes_done.get());
+
+  auto finish = stream->Finish();
+  mock_cq->SimulateCompletion(true);
+  EXPECT_EQ(StatusCode::kUnavailable, finish.get().code());
+  EXPECT_TRUE(mock_cq->empty());
+}
+
+TEST(AsyncReadWriteStreamingRpcTest, AfterShutdown) {
+  auto mock_cq = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(mock_cq);
+  std::thread runner([&cq] { cq.Run(); });
+  cq.Shutdown();
+  runner.join();
+
+  // Use `StrictMock` to verify that no operations reach the stream.
+  auto stream = cq.MakeStreamingReadWriteRpc(
+      [](grpc::ClientContext*, grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncReaderWriterInterface<Request, Response>>(
+            absl::make_unique<StrictMock<MockReaderWriter>>());
+      },
+      absl::make_unique<grpc::ClientContext>());
+
+  EXPECT_FALSE(stream->Start().get());
+  EXPECT_FALSE(stream->Write(Request{}, grpc::WriteOptions()).get());
+  EXPECT_FALSE(stream->Read().get().has_value());
+  EXPECT_FALSE(stream->WritesDone().get());
+  EXPECT_EQ(StatusCode::kCancelled, stream->Finish().get().code());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -19,8 +19,13 @@ namespace cloud {
 inline namespace GOOGLE_CLOUD_CPP_NS {
 namespace internal {
 
-AutomaticallyCreatedBackgroundThreads::AutomaticallyCreatedBackgroundThreads()
-    : runner_([](CompletionQueue cq) { cq.Run(); }, cq_) {}
+AutomaticallyCreatedBackgroundThreads::AutomaticallyCreatedBackgroundThreads(
+    std::size_t thread_count)
+    : pool_(thread_count == 0 ? 1 : thread_count) {
+  for (auto& t : pool_) {
+    t = std::thread([](CompletionQueue cq) { cq.Run(); }, cq_);
+  }
+}
 
 AutomaticallyCreatedBackgroundThreads::
     ~AutomaticallyCreatedBackgroundThreads() {
@@ -29,7 +34,9 @@ AutomaticallyCreatedBackgroundThreads::
 
 void AutomaticallyCreatedBackgroundThreads::Shutdown() {
   cq_.Shutdown();
-  if (runner_.joinable()) runner_.join();
+  for (auto& t : pool_) {
+    if (t.joinable()) t.join();
+  }
 }
 
 }  // namespace internal
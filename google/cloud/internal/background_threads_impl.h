@@ -18,7 +18,9 @@
 #include "google/cloud/background_threads.h"
 #include "google/cloud/completion_queue.h"
 #include "google/cloud/version.h"
+#include <cstddef>
 #include <thread>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -38,18 +40,26 @@ class CustomerSuppliedBackgroundThreads : public BackgroundThreads {
   CompletionQueue cq_;
 };
 
-/// Create a background thread to perform background operations.
+/**
+ * Create a pool of background threads to perform background operations.
+ *
+ * All the threads block in `Run()` on the same `CompletionQueue`, gRPC hands
+ * each completed operation to one of them, so the background work (and any
+ * continuations attached to it) runs in parallel once the pool has more than
+ * one thread.
+ */
 class AutomaticallyCreatedBackgroundThreads : public BackgroundThreads {
  public:
-  AutomaticallyCreatedBackgroundThreads();
+  explicit AutomaticallyCreatedBackgroundThreads(std::size_t thread_count = 1);
   ~AutomaticallyCreatedBackgroundThreads() override;
 
   CompletionQueue cq() const override { return cq_; }
   void Shutdown();
+  std::size_t pool_size() const { return pool_.size(); }
 
  private:
   CompletionQueue cq_;
-  std::thread runner_;
+  std::vector<std::thread> pool_;
 };
 
 }  // namespace internal
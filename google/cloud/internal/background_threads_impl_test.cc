@@ -15,6 +15,10 @@
 #include "google/cloud/internal/background_threads_impl.h"
 #include "google/cloud/testing_util/scoped_thread.h"
 #include <gmock/gmock.h>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -78,6 +82,43 @@ TEST(AutomaticallyCreatedBackgroundThreads, IsActive) {
   EXPECT_NE(std::this_thread::get_id(), bg.get_future().get());
 }
 
+/// @test Verify that all the threads in the pool serve the completion queue.
+TEST(AutomaticallyCreatedBackgroundThreads, ManyThreads) {
+  std::size_t constexpr kThreadCount = 4;
+  AutomaticallyCreatedBackgroundThreads actual(kThreadCount);
+  EXPECT_EQ(kThreadCount, actual.pool_size());
+
+  // Block each callback until all of them are running, this can only succeed
+  // if each callback runs in a different thread.
+  std::mutex mu;
+  std::condition_variable cv;
+  std::size_t running = 0;
+  std::set<std::thread::id> ids;
+  std::vector<promise<void>> done(kThreadCount);
+  for (auto& p : done) {
+    actual.cq().RunAsync([&] {
+      std::unique_lock<std::mutex> lk(mu);
+      ids.insert(std::this_thread::get_id());
+      if (++running == kThreadCount) cv.notify_all();
+      cv.wait(lk, [&] { return running == kThreadCount; });
+      lk.unlock();
+      p.set_value();
+    });
+  }
+  for (auto& p : done) p.get_future().get();
+  EXPECT_EQ(kThreadCount, ids.size());
+}
+
+/// @test Verify that an empty pool still creates one thread.
+TEST(AutomaticallyCreatedBackgroundThreads, ZeroThreads) {
+  AutomaticallyCreatedBackgroundThreads actual(0);
+  EXPECT_EQ(1U, actual.pool_size());
+
+  promise<std::thread::id> bg;
+  actual.cq().RunAsync([&bg] { bg.set_value(std::this_thread::get_id()); });
+  EXPECT_NE(std::this_thread::get_id(), bg.get_future().get());
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace GOOGLE_CLOUD_CPP_NS
@@ -15,6 +15,7 @@
 #include "google/cloud/internal/completion_queue_impl.h"
 #include "google/cloud/internal/throw_delegate.h"
 #include "absl/memory/memory.h"
+#include <vector>
 
 // There is no wait to unblock the gRPC event loop, not even calling Shutdown(),
 // so we periodically wake up from the loop to check if the application has
@@ -25,6 +26,55 @@ namespace google {
 namespace cloud {
 inline namespace GOOGLE_CLOUD_CPP_NS {
 namespace internal {
+namespace {
+/**
+ * Wrap a function posted via `RunAsyncViaAlarm()` into an `AsyncOperation`.
+ *
+ * The function runs once the alarm expires, or once it is canceled.
+ */
+class AsyncFunction : public AsyncGrpcOperation {
+ public:
+  AsyncFunction(std::unique_ptr<RunAsyncBase> fun,
+                std::unique_ptr<grpc::Alarm> alarm)
+      : fun_(std::move(fun)), alarm_(std::move(alarm)) {}
+
+  void Set(grpc::CompletionQueue& cq,
+           std::chrono::system_clock::time_point deadline, void* tag) {
+    if (alarm_) {
+      alarm_->Set(&cq, deadline, tag);
+    }
+  }
+
+  void Cancel() override {
+    if (alarm_) {
+      alarm_->Cancel();
+    }
+  }
+
+ private:
+  bool Notify(bool) override {
+    fun_->exec();
+    fun_.reset();
+    return true;
+  }
+
+  std::unique_ptr<RunAsyncBase> fun_;
+  // Holds the underlying handle, it might be a nullptr in tests.
+  std::unique_ptr<grpc::Alarm> alarm_;
+};
+}  // namespace
+
+CompletionQueueImpl::~CompletionQueueImpl() {
+  // Release any functions posted after the last `Run()` thread stopped.
+  for (auto* head : {run_queue_.exchange(nullptr), ready_}) {
+    while (head != nullptr) {
+      auto* next = head->next;
+      delete head;
+      head = next;
+    }
+  }
+}
+
 void CompletionQueueImpl::Run() {
   void* tag;
   bool ok;
@@ -40,6 +90,13 @@ void CompletionQueueImpl::Run() {
       google::cloud::internal::ThrowRuntimeError(
           "unexpected status from AsyncNext()");
     }
+    if (tag == RunQueueTag()) {
+      // Clear the flag before draining the queue, so any function posted
+      // while this thread drains it wakes up another thread.
+      run_queue_alarm_pending_.store(false);
+      DrainRunQueue();
+      continue;
+    }
     auto op = FindOperation(tag);
     if (op->Notify(ok)) {
       ForgetOperation(tag);
@@ -73,6 +130,84 @@ std::unique_ptr<grpc::Alarm> CompletionQueueImpl::CreateAlarm() const {
   return absl::make_unique<grpc::Alarm>();
 }
 
+void CompletionQueueImpl::RunAsync(std::unique_ptr<RunAsyncBase> function) {
+  auto* node = function.release();
+  node->next = run_queue_.load();
+  while (!run_queue_.compare_exchange_weak(node->next, node)) {
+  }
+  // Only the thread that finds the alarm idle sets it, any other thread knows
+  // that a `Run()` thread will drain the queue, including its function.
+  if (run_queue_alarm_pending_.exchange(true)) return;
+  WakeUpRunQueue();
+}
+
+void CompletionQueueImpl::RunAsyncViaAlarm(
+    std::unique_ptr<RunAsyncBase> function) {
+  auto deadline = std::chrono::system_clock::now();
+  auto op = std::make_shared<AsyncFunction>(std::move(function), CreateAlarm());
+  StartOperation(op, [&](void* tag) { op->Set(cq_, deadline, tag); });
+}
+
+void CompletionQueueImpl::WakeUpRunQueue() {
+  for (;;) {
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      if (!shutdown_) {
+        run_queue_alarm_.Set(&cq_, std::chrono::system_clock::now(),
+                             RunQueueTag());
+        return;
+      }
+    }
+    // No thread will drain the queue, run the functions in this thread. The
+    // flag remains set while we drain, so the functions posted meanwhile do
+    // not recurse into this function, but we need to check for them after
+    // clearing it.
+    DrainRunQueue();
+    run_queue_alarm_pending_.store(false);
+    if (run_queue_.load() == nullptr) return;
+    if (run_queue_alarm_pending_.exchange(true)) return;
+  }
+}
+
+void CompletionQueueImpl::DrainRunQueue() {
+  // Take the functions from `run_queue_` at most once. Functions posted while
+  // draining, such as a function that posts itself again, wait for the next
+  // wake up, behind any completions already in `cq_`.
+  auto take_posted = true;
+  for (;;) {
+    std::unique_ptr<RunAsyncBase> function;
+    bool more;
+    {
+      std::lock_guard<std::mutex> lk(ready_mu_);
+      if (ready_ == nullptr && take_posted) {
+        take_posted = false;
+        // Reverse the stack, so the functions run in the order they were
+        // posted.
+        for (auto* head = run_queue_.exchange(nullptr); head != nullptr;) {
+          auto* next = head->next;
+          head->next = ready_;
+          ready_ = head;
+          head = next;
+        }
+      }
+      if (ready_ == nullptr) break;
+      function.reset(ready_);
+      ready_ = ready_->next;
+      more = ready_ != nullptr;
+    }
+    // Share the remaining functions with another `Run()` thread, they may
+    // block or take a long time.
+    if (more && !run_queue_alarm_pending_.exchange(true)) WakeUpRunQueue();
+    function->exec();
+  }
+  // Usually `RunAsync()` already set the alarm for any functions left, but
+  // it may have found the flag set just before a `Run()` thread cleared it.
+  if (run_queue_.load() != nullptr &&
+      !run_queue_alarm_pending_.exchange(true)) {
+    WakeUpRunQueue();
+  }
+}
+
 std::shared_ptr<AsyncGrpcOperation> CompletionQueueImpl::FindOperation(
     void* tag) {
   std::lock_guard<std::mutex> lk(mu_);
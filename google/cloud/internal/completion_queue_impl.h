@@ -25,6 +25,9 @@
 #include <grpcpp/alarm.h>
 #include <grpcpp/support/async_stream.h>
 #include <grpcpp/support/async_unary_call.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 
@@ -35,6 +38,15 @@ class CompletionQueue;
 namespace internal {
 class CompletionQueueImpl;
 
+// Type erase the callables in RunAsync()
+struct RunAsyncBase {
+  virtual ~RunAsyncBase() = default;
+  virtual void exec() = 0;
+
+  /// The next callable in the `CompletionQueueImpl` run queue.
+  RunAsyncBase* next = nullptr;
+};
+
 /**
  * Represents an AsyncOperation which gRPC understands.
  *
@@ -230,7 +242,7 @@ using AsyncCallResponseType = AsyncCallResponseTypeUnwrap<
 class CompletionQueueImpl {
  public:
   CompletionQueueImpl() = default;
-  virtual ~CompletionQueueImpl() = default;
+  virtual ~CompletionQueueImpl();
 
   /// Run the event loop until Shutdown() is called.
   void Run();
@@ -244,6 +256,17 @@ class CompletionQueueImpl {
   /// Create a new alarm object.
   virtual std::unique_ptr<grpc::Alarm> CreateAlarm() const;
 
+  /**
+   * Run @p function on one of the threads blocked in `Run()`.
+   *
+   * The function is added to a lock-free run queue, drained by the `Run()`
+   * threads. A single alarm wakes up these threads, and it is only set if no
+   * wake up is pending, so posting a function does not need more allocations,
+   * nor to register a new operation. If the queue is shutdown the function
+   * runs in the calling thread.
+   */
+  virtual void RunAsync(std::unique_ptr<RunAsyncBase> function);
+
   /// The underlying gRPC completion queue.
   grpc::CompletionQueue& cq() { return cq_; }
 
@@ -273,6 +296,15 @@ class CompletionQueueImpl {
   }
 
  protected:
+  /**
+   * Run @p function using a new `grpc::Alarm`, registered as a pending
+   * operation.
+   *
+   * This is slower than `RunAsync()`, but the function is visible to
+   * `SimulateCompletion()`, which mocks use to control when it runs.
+   */
+  void RunAsyncViaAlarm(std::unique_ptr<RunAsyncBase> function);
+
   /// Return the asynchronous operation associated with @p tag.
   std::shared_ptr<AsyncGrpcOperation> FindOperation(void* tag);
 
@@ -297,11 +329,38 @@ class CompletionQueueImpl {
   }
 
  private:
+  /// The tag used by the run queue alarm, it never matches a pending operation.
+  void* RunQueueTag() { return &run_queue_alarm_; }
+
+  /// Wake up a `Run()` thread to drain the run queue, or drain it if shutdown.
+  void WakeUpRunQueue();
+
+  /**
+   * Run the functions posted before the call, the rest wait for a wake up.
+   *
+   * Several threads may drain the queue at the same time, each one takes a
+   * single function at a time, and wakes up another thread if more functions
+   * remain. The functions posted while draining run after the completions
+   * already queued, so functions that post more functions do not starve the
+   * timers and RPCs.
+   */
+  void DrainRunQueue();
+
   grpc::CompletionQueue cq_;
   mutable std::mutex mu_;
   bool shutdown_{false};  // GUARDED_BY(mu_)
   std::unordered_map<std::intptr_t, std::shared_ptr<AsyncGrpcOperation>>
       pending_ops_;  // GUARDED_BY(mu_)
+
+  /// The functions posted via `RunAsync()`, a stack in LIFO order.
+  std::atomic<RunAsyncBase*> run_queue_{nullptr};
+  /// Set while `run_queue_alarm_` is pending, or a thread is setting it.
+  std::atomic<bool> run_queue_alarm_pending_{false};
+  grpc::Alarm run_queue_alarm_;
+  /// Only the threads draining `run_queue_` use this mutex, never `RunAsync()`.
+  std::mutex ready_mu_;
+  /// The functions taken from `run_queue_`, in FIFO order.
+  RunAsyncBase* ready_ = nullptr;  // GUARDED_BY(ready_mu_)
 };
 
 }  // namespace internal
@@ -0,0 +1,214 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "google/cloud/pubsub/benchmarks/benchmarks_config.h"
+#include "google/cloud/internal/build_info.h"
+#include "google/cloud/internal/compiler_info.h"
+#include "google/cloud/internal/getenv.h"
+#include <functional>
+#include <sstream>
+
+namespace google {
+namespace cloud {
+namespace pubsub_benchmarks {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+namespace {
+
+std::vector<std::size_t> ParseSizes(std::string const& v) {
+  std::vector<std::size_t> sizes;
+  std::istringstream is(v);
+  for (std::string token; std::getline(is, token, ',');) {
+    if (token.empty()) continue;
+    sizes.push_back(static_cast<std::size_t>(std::stoll(token)));
+  }
+  return sizes;
+}
+
+std::ostream& operator<<(std::ostream& os,
+                         std::vector<std::size_t> const& sizes) {
+  char const* sep = "";
+  for (auto s : sizes) {
+    os << sep << s;
+    sep = ",";
+  }
+  return os;
+}
+
+}  // namespace
+
+std::ostream& operator<<(std::ostream& os, Config const& config) {
+  return os << "# Project: " << config.project_id
+            << "\n# Topic: " << config.topic_id
+            << "\n# Subscription: " << config.subscription_id
+            << "\n# Samples: " << config.samples
+            << "\n# Minimum Threads: " << config.minimum_threads
+            << "\n# Maximum Threads: " << config.maximum_threads
+            << "\n# Iteration Duration: " << config.iteration_duration.count()
+            << "s"
+            << "\n# Message Sizes: " << config.message_sizes
+            << "\n# Batch Message Counts: " << config.batch_message_counts
+            << "\n# Maximum Batch Bytes: " << config.maximum_batch_bytes
+            << "\n# Maximum Hold Time: " << config.maximum_hold_time.count()
+            << "us"
+            << "\n# Max Outstanding Messages: "
+            << config.max_outstanding_messages
+            << "\n# Use Fake Server: " << config.use_fake_server
+            << "\n# Fake Server Latency: " << config.fake_server_latency.count()
+            << "us"
+            << "\n# Fake Server Error Rate: " << config.fake_server_error_rate
+            << "\n# Compiler: " << google::cloud::internal::CompilerId() << "-"
+            << google::cloud::internal::CompilerVersion()
+            << "\n# Build Flags: " << google::cloud::internal::compiler_flags()
+            << "\n";
+}
+
+google::cloud::StatusOr<Config> ParseArgs(std::vector<std::string> args) {
+  Config config;
+
+  config.project_id =
+      google::cloud::internal::GetEnv("GOOGLE_CLOUD_PROJECT").value_or("");
+
+  struct Flag {
+    std::string flag_name;
+    std::function<void(Config&, std::string)> parser;
+  };
+
+  Flag flags[] = {
+      {"--project=",
+       [](Config& c, std::string v) { c.project_id = std::move(v); }},
+      {"--topic=", [](Config& c, std::string v) { c.topic_id = std::move(v); }},
+      {"--subscription=",
+       [](Config& c, std::string v) { c.subscription_id = std::move(v); }},
+      {"--samples=",
+       [](Config& c, std::string const& v) { c.samples = std::stoi(v); }},
+      {"--iteration-duration=",
+       [](Config& c, std::string const& v) {
+         c.iteration_duration = std::chrono::seconds(std::stoi(v));
+       }},
+      {"--minimum-threads=",
+       [](Config& c, std::string const& v) {
+         c.minimum_threads = std::stoi(v);
+       }},
+      {"--maximum-threads=",
+       [](Config& c, std::string const& v) {
+         c.maximum_threads = std::stoi(v);
+       }},
+      {"--message-sizes=",
+       [](Config& c, std::string const& v) {
+         c.message_sizes = ParseSizes(v);
+       }},
+      {"--batch-message-counts=",
+       [](Config& c, std::string const& v) {
+         c.batch_message_counts = ParseSizes(v);
+       }},
+      {"--maximum-batch-bytes=",
+       [](Config& c, std::string const& v) {
+         c.maximum_batch_bytes = static_cast<std::size_t>(std::stoll(v));
+       }},
+      {"--maximum-hold-time-us=",
+       [](Config& c, std::string const& v) {
+         c.maximum_hold_time = std::chrono::microseconds(std::stoll(v));
+       }},
+      {"--max-outstanding-messages=",
+       [](Config& c, std::string const& v) {
+         c.max_outstanding_messages = static_cast<std::size_t>(std::stoll(v));
+       }},
+      {"--fake-server-latency-us=",
+       [](Config& c, std::string const& v) {
+         c.fake_server_latency = std::chrono::microseconds(std::stoll(v));
+       }},
+      {"--fake-server-error-rate=",
+       [](Config& c, std::string const& v) {
+         c.fake_server_error_rate = std::stod(v);
+       }},
+      // Flags are matched by prefix, this must follow the `--fake-server-*`
+      // flags.
+      {"--fake-server",
+       [](Config& c, std::string const&) { c.use_fake_server = true; }},
+  };
+
+  auto invalid_argument = [](std::string msg) {
+    return google::cloud::Status(google::cloud::StatusCode::kInvalidArgument,
+                                 std::move(msg));
+  };
+
+  for (auto i = std::next(args.begin()); i != args.end(); ++i) {
+    std::string const& arg = *i;
+    bool found = false;
+    for (auto const& flag : flags) {
+      if (arg.rfind(flag.flag_name, 0) != 0) continue;
+      found = true;
+      flag.parser(config, arg.substr(flag.flag_name.size()));
+
+      break;
+    }
+    if (!found && arg.rfind("--", 0) == 0) {
+      return invalid_argument("Unexpected command-line flag " + arg);
+    }
+  }
+
+  if (config.use_fake_server) {
+    // The fake server accepts any project, topic, and subscription names.
+    if (config.project_id.empty()) config.project_id = "fake-project";
+    if (config.topic_id.empty()) config.topic_id = "fake-topic";
+    if (config.subscription_id.empty()) {
+      config.subscription_id = "fake-subscription";
+    }
+  }
+
+  if (config.project_id.empty()) {
+    return invalid_argument(
+        "The project id is not set, provide a value in the --project flag,"
+        " or set the GOOGLE_CLOUD_PROJECT environment variable");
+  }
+
+  if (config.minimum_threads <= 0) {
+    std::ostringstream os;
+    os << "The minimum number of threads (" << config.minimum_threads << ")"
+       << " must be greater than zero";
+    return invalid_argument(os.str());
+  }
+  if (config.maximum_threads < config.minimum_threads) {
+    std::ostringstream os;
+    os << "The maximum number of threads (" << config.maximum_threads << ")"
+       << " must be greater or equal than the minimum number of threads ("
+       << config.minimum_threads << ")";
+    return invalid_argument(os.str());
+  }
+
+  if (config.message_sizes.empty()) {
+    return invalid_argument("The --message-sizes list must not be empty");
+  }
+  if (config.batch_message_counts.empty()) {
+    return invalid_argument(
+        "The --batch-message-counts list must not be empty");
+  }
+
+  if (config.fake_server_error_rate < 0.0 ||
+      config.fake_server_error_rate > 1.0) {
+    std::ostringstream os;
+    os << "The fake server error rate (" << config.fake_server_error_rate
+       << ") must be in the [0.0, 1.0] range";
+    return invalid_argument(os.str());
+  }
+
+  return config;
+}
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_benchmarks
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,67 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_BENCHMARKS_BENCHMARKS_CONFIG_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_BENCHMARKS_BENCHMARKS_CONFIG_H
+
+#include "google/cloud/pubsub/version.h"
+#include "google/cloud/status_or.h"
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace pubsub_benchmarks {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+struct Config {
+  std::string project_id;
+  std::string topic_id;
+  std::string subscription_id;
+
+  int samples = 2;
+  std::chrono::seconds iteration_duration = std::chrono::seconds(5);
+
+  int minimum_threads = 1;
+  int maximum_threads = 1;
+
+  // Each sample picks one value from each of these lists.
+  std::vector<std::size_t> message_sizes = {1024};
+  std::vector<std::size_t> batch_message_counts = {100};
+
+  std::size_t maximum_batch_bytes = 1024 * 1024L;
+  std::chrono::microseconds maximum_hold_time = std::chrono::milliseconds(10);
+  std::size_t max_outstanding_messages = 10 * 1000L;
+
+  // Run against an in-process `FakePubsubServer` instead of Cloud Pub/Sub.
+  bool use_fake_server = false;
+  // The latency and the error rate injected by the fake server.
+  std::chrono::microseconds fake_server_latency = std::chrono::microseconds(0);
+  double fake_server_error_rate = 0.0;
+};
+
+std::ostream& operator<<(std::ostream& os, Config const& config);
+
+google::cloud::StatusOr<Config> ParseArgs(std::vector<std::string> args);
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_benchmarks
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_BENCHMARKS_BENCHMARKS_CONFIG_H
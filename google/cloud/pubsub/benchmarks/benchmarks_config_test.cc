@@ -0,0 +1,120 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "google/cloud/pubsub/benchmarks/benchmarks_config.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "google/cloud/testing_util/scoped_environment.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace pubsub_benchmarks {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(BenchmarkConfigTest, ParseAll) {
+  auto config = ParseArgs(
+      {"placeholder", "--project=test-project", "--topic=test-topic",
+       "--subscription=test-subscription", "--samples=50",
+       "--iteration-duration=10", "--minimum-threads=2",
+       "--maximum-threads=8", "--message-sizes=10,100,1000",
+       "--batch-message-counts=1,100", "--maximum-batch-bytes=4096",
+       "--maximum-hold-time-us=250", "--max-outstanding-messages=500",
+       "--fake-server", "--fake-server-latency-us=1500",
+       "--fake-server-error-rate=0.25"});
+  ASSERT_STATUS_OK(config);
+
+  EXPECT_EQ("test-project", config->project_id);
+  EXPECT_EQ("test-topic", config->topic_id);
+  EXPECT_EQ("test-subscription", config->subscription_id);
+  EXPECT_EQ(50, config->samples);
+  EXPECT_EQ(10, config->iteration_duration.count());
+  EXPECT_EQ(2, config->minimum_threads);
+  EXPECT_EQ(8, config->maximum_threads);
+  EXPECT_THAT(config->message_sizes, ElementsAre(10, 100, 1000));
+  EXPECT_THAT(config->batch_message_counts, ElementsAre(1, 100));
+  EXPECT_EQ(4096, config->maximum_batch_bytes);
+  EXPECT_EQ(250, config->maximum_hold_time.count());
+  EXPECT_EQ(500, config->max_outstanding_messages);
+  EXPECT_TRUE(config->use_fake_server);
+  EXPECT_EQ(1500, config->fake_server_latency.count());
+  EXPECT_EQ(0.25, config->fake_server_error_rate);
+}
+
+TEST(BenchmarkConfigTest, ParseNone) {
+  testing_util::ScopedEnvironment env("GOOGLE_CLOUD_PROJECT", "test-project");
+  auto config = ParseArgs({"placeholder"});
+  ASSERT_STATUS_OK(config);
+  EXPECT_EQ("test-project", config->project_id);
+}
+
+TEST(BenchmarkConfigTest, InvalidFlag) {
+  auto config = ParseArgs({"placeholder", "--not-a-flag=1"});
+  EXPECT_EQ(StatusCode::kInvalidArgument, config.status().code());
+}
+
+TEST(BenchmarkConfigTest, EmptyProject) {
+  auto config = ParseArgs({"placeholder", "--project="});
+  EXPECT_EQ(StatusCode::kInvalidArgument, config.status().code());
+}
+
+TEST(BenchmarkConfigTest, InvalidMinimumThreads) {
+  auto config = ParseArgs(
+      {"placeholder", "--project=test-project", "--minimum-threads=-7"});
+  EXPECT_EQ(StatusCode::kInvalidArgument, config.status().code());
+}
+
+TEST(BenchmarkConfigTest, InvalidMaximumThreads) {
+  auto config = ParseArgs({"placeholder", "--project=test-project",
+                           "--minimum-threads=100", "--maximum-threads=5"});
+  EXPECT_EQ(StatusCode::kInvalidArgument, config.status().code());
+}
+
+TEST(BenchmarkConfigTest, EmptyMessageSizes) {
+  auto config = ParseArgs(
+      {"placeholder", "--project=test-project", "--message-sizes="});
+  EXPECT_EQ(StatusCode::kInvalidArgument, config.status().code());
+}
+
+TEST(BenchmarkConfigTest, EmptyBatchMessageCounts) {
+  auto config = ParseArgs(
+      {"placeholder", "--project=test-project", "--batch-message-counts="});
+  EXPECT_EQ(StatusCode::kInvalidArgument, config.status().code());
+}
+
+TEST(BenchmarkConfigTest, InvalidErrorRate) {
+  auto config = ParseArgs({"placeholder", "--project=test-project",
+                           "--fake-server-error-rate=1.5"});
+  EXPECT_EQ(StatusCode::kInvalidArgument, config.status().code());
+}
+
+TEST(BenchmarkConfigTest, FakeServer) {
+  testing_util::ScopedEnvironment env("GOOGLE_CLOUD_PROJECT", {});
+  auto config = ParseArgs({"placeholder", "--fake-server"});
+  ASSERT_STATUS_OK(config);
+
+  EXPECT_TRUE(config->use_fake_server);
+  EXPECT_FALSE(config->project_id.empty());
+  EXPECT_FALSE(config->topic_id.empty());
+  EXPECT_FALSE(config->subscription_id.empty());
+}
+
+}  // namespace
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_benchmarks
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,262 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "google/cloud/pubsub/benchmarks/fake_pubsub_server.h"
+#include "google/cloud/internal/random.h"
+#include "absl/memory/memory.h"
+#include <google/pubsub/v1/pubsub.grpc.pb.h>
+#include <grpcpp/security/credentials.h>
+#include <grpcpp/security/server_credentials.h>
+#include <grpcpp/server_builder.h>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace pubsub_benchmarks {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+namespace internal {
+
+namespace pubsub_proto = ::google::pubsub::v1;
+
+/// The state shared by the fake publisher and subscriber services.
+class FakeServerState {
+ public:
+  explicit FakeServerState(FakePubsubServerOptions options)
+      : options_(std::move(options)),
+        generator_(google::cloud::internal::MakeDefaultPRNG()) {}
+
+  FakePubsubServerOptions const& options() const { return options_; }
+
+  /// Counts the request and assigns the message ids, unless it should fail.
+  bool Publish(pubsub_proto::PublishRequest const& request,
+               pubsub_proto::PublishResponse& response) {
+    std::lock_guard<std::mutex> lk(mu_);
+    ++stats_.publish_requests;
+    if (Fail(options_.publish_error_rate)) {
+      ++stats_.failed_publish_requests;
+      return false;
+    }
+    for (auto const& m : request.messages()) {
+      response.add_message_ids(std::to_string(++message_id_));
+      ++stats_.published_messages;
+      stats_.published_bytes += static_cast<std::int64_t>(m.data().size());
+    }
+    return true;
+  }
+
+  /// Fills the next `StreamingPull()` response, unless it should fail.
+  bool MakePullResponse(std::string const& payload,
+                        pubsub_proto::StreamingPullResponse& response) {
+    auto const sent_at = FormatSentAt(std::chrono::system_clock::now());
+    std::lock_guard<std::mutex> lk(mu_);
+    if (Fail(options_.pull_error_rate)) return false;
+    for (std::size_t i = 0; i != options_.messages_per_response; ++i) {
+      auto const id = std::to_string(++message_id_);
+      auto& received = *response.add_received_messages();
+      // The acknowledgement id carries the delivery time, see `Acknowledge()`.
+      received.set_ack_id(id + ":" + sent_at);
+      auto& message = *received.mutable_message();
+      message.set_message_id(id);
+      message.set_data(payload);
+      (*message.mutable_attributes())[kSentAtAttribute] = sent_at;
+    }
+    return true;
+  }
+
+  void OnDelivered(std::size_t count) {
+    std::lock_guard<std::mutex> lk(mu_);
+    stats_.delivered_messages += static_cast<std::int64_t>(count);
+  }
+
+  void OnAcknowledged(pubsub_proto::AcknowledgeRequest const& request) {
+    auto const now = std::chrono::system_clock::now();
+    std::lock_guard<std::mutex> lk(mu_);
+    for (auto const& ack_id : request.ack_ids()) {
+      ++stats_.acked_messages;
+      auto const pos = ack_id.find(':');
+      if (pos == std::string::npos) continue;
+      auto const sent_at = ParseSentAt(ack_id.substr(pos + 1));
+      stats_.ack_latencies.push_back(
+          std::chrono::duration_cast<std::chrono::microseconds>(now -
+                                                                sent_at));
+    }
+  }
+
+  FakePubsubServerStats TakeStats() {
+    FakePubsubServerStats stats;
+    std::lock_guard<std::mutex> lk(mu_);
+    std::swap(stats, stats_);
+    return stats;
+  }
+
+ private:
+  bool Fail(double rate) {
+    if (rate <= 0.0) return false;
+    return std::bernoulli_distribution(rate)(generator_);
+  }
+
+  FakePubsubServerOptions const options_;
+  std::mutex mu_;
+  google::cloud::internal::DefaultPRNG generator_;
+  std::int64_t message_id_ = 0;
+  FakePubsubServerStats stats_;
+};
+
+grpc::Status InjectedError() {
+  return grpc::Status(grpc::StatusCode::UNAVAILABLE, "injected error");
+}
+
+class FakePublisherService : public pubsub_proto::Publisher::Service {
+ public:
+  explicit FakePublisherService(std::shared_ptr<FakeServerState> state)
+      : state_(std::move(state)) {}
+
+  grpc::Status Publish(grpc::ServerContext*,
+                       pubsub_proto::PublishRequest const* request,
+                       pubsub_proto::PublishResponse* response) override {
+    auto const latency = state_->options().publish_latency;
+    if (latency.count() > 0) std::this_thread::sleep_for(latency);
+    if (!state_->Publish(*request, *response)) return InjectedError();
+    return grpc::Status::OK;
+  }
+
+ private:
+  std::shared_ptr<FakeServerState> state_;
+};
+
+class FakeSubscriberService : public pubsub_proto::Subscriber::Service {
+ public:
+  explicit FakeSubscriberService(std::shared_ptr<FakeServerState> state)
+      : state_(std::move(state)) {}
+
+  grpc::Status StreamingPull(
+      grpc::ServerContext* context,
+      grpc::ServerReaderWriter<pubsub_proto::StreamingPullResponse,
+                               pubsub_proto::StreamingPullRequest>* stream)
+      override {
+    // The first request names the subscription, any subscription works.
+    pubsub_proto::StreamingPullRequest request;
+    if (!stream->Read(&request)) return grpc::Status::OK;
+
+    auto const& options = state_->options();
+    std::string const payload(options.message_size, 'x');
+    // `Write()` blocks while the client is not reading, this loop ends when
+    // the client (or the server shutdown) cancels the stream.
+    while (!context->IsCancelled()) {
+      pubsub_proto::StreamingPullResponse response;
+      if (!state_->MakePullResponse(payload, response)) return InjectedError();
+      if (!stream->Write(response)) break;
+      state_->OnDelivered(response.received_messages_size());
+      if (options.pull_latency.count() > 0) {
+        std::this_thread::sleep_for(options.pull_latency);
+      }
+    }
+    return grpc::Status::OK;
+  }
+
+  grpc::Status Acknowledge(grpc::ServerContext*,
+                           pubsub_proto::AcknowledgeRequest const* request,
+                           google::protobuf::Empty*) override {
+    state_->OnAcknowledged(*request);
+    return grpc::Status::OK;
+  }
+
+  grpc::Status ModifyAckDeadline(grpc::ServerContext*,
+                                 pubsub_proto::ModifyAckDeadlineRequest const*,
+                                 google::protobuf::Empty*) override {
+    return grpc::Status::OK;
+  }
+
+  std::shared_ptr<FakeServerState> const& state() const { return state_; }
+
+ private:
+  std::shared_ptr<FakeServerState> state_;
+};
+
+}  // namespace internal
+
+StatusOr<std::unique_ptr<FakePubsubServer>> FakePubsubServer::Create(
+    FakePubsubServerOptions options) {
+  auto state = std::make_shared<internal::FakeServerState>(std::move(options));
+  auto publisher = absl::make_unique<internal::FakePublisherService>(state);
+  auto subscriber = absl::make_unique<internal::FakeSubscriberService>(state);
+  int port = 0;
+  grpc::ServerBuilder builder;
+  builder.AddListeningPort("localhost:0", grpc::InsecureServerCredentials(),
+                           &port);
+  builder.RegisterService(publisher.get());
+  builder.RegisterService(subscriber.get());
+  auto server = builder.BuildAndStart();
+  if (!server || port == 0) {
+    return Status(StatusCode::kUnavailable,
+                  "cannot start the fake Pub/Sub server");
+  }
+  return std::unique_ptr<FakePubsubServer>(new FakePubsubServer(
+      std::move(publisher), std::move(subscriber), std::move(server),
+      "localhost:" + std::to_string(port)));
+}
+
+FakePubsubServer::FakePubsubServer(
+    std::unique_ptr<internal::FakePublisherService> publisher,
+    std::unique_ptr<internal::FakeSubscriberService> subscriber,
+    std::unique_ptr<grpc::Server> server, std::string endpoint)
+    : publisher_(std::move(publisher)),
+      subscriber_(std::move(subscriber)),
+      server_(std::move(server)),
+      endpoint_(std::move(endpoint)) {}
+
+FakePubsubServer::~FakePubsubServer() {
+  // The `StreamingPull()` handlers only return once their streams are
+  // cancelled, use an expired deadline to cancel them right away.
+  server_->Shutdown(std::chrono::system_clock::now());
+  server_->Wait();
+}
+
+pubsub::ConnectionOptions FakePubsubServer::connection_options() const {
+  return pubsub::ConnectionOptions(grpc::InsecureChannelCredentials())
+      .set_endpoint(endpoint_);
+}
+
+FakePubsubServerStats FakePubsubServer::TakeStats() {
+  return subscriber_->state()->TakeStats();
+}
+
+std::string FormatSentAt(std::chrono::system_clock::time_point tp) {
+  return std::to_string(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          tp.time_since_epoch())
+          .count());
+}
+
+std::chrono::system_clock::time_point ParseSentAt(std::string const& value) {
+  char* end = nullptr;
+  auto const us = std::strtoll(value.c_str(), &end, 10);
+  if (value.empty() || end == nullptr || *end != '\0') {
+    return std::chrono::system_clock::time_point{};
+  }
+  return std::chrono::system_clock::time_point(
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(
+          std::chrono::microseconds(us)));
+}
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_benchmarks
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,147 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_BENCHMARKS_FAKE_PUBSUB_SERVER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_BENCHMARKS_FAKE_PUBSUB_SERVER_H
+
+#include "google/cloud/pubsub/connection_options.h"
+#include "google/cloud/pubsub/version.h"
+#include "google/cloud/status_or.h"
+#include <grpcpp/server.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace pubsub_benchmarks {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+/// Configuration for `FakePubsubServer`.
+struct FakePubsubServerOptions {
+  /// The delay before the server responds to each `Publish()` request.
+  std::chrono::microseconds publish_latency = std::chrono::microseconds(0);
+
+  /// The fraction of `Publish()` requests that fail with `kUnavailable`.
+  double publish_error_rate = 0.0;
+
+  /// The size of the payload in each message delivered by `StreamingPull()`.
+  std::size_t message_size = 1024;
+
+  /// The number of messages in each `StreamingPull()` response.
+  std::size_t messages_per_response = 100;
+
+  /// The delay between consecutive `StreamingPull()` responses.
+  std::chrono::microseconds pull_latency = std::chrono::microseconds(0);
+
+  /**
+   * The fraction of `StreamingPull()` responses replaced by a `kUnavailable`
+   * error, which closes the stream.
+   */
+  double pull_error_rate = 0.0;
+};
+
+/// The activity observed by a `FakePubsubServer`.
+struct FakePubsubServerStats {
+  std::int64_t publish_requests = 0;
+  std::int64_t failed_publish_requests = 0;
+  std::int64_t published_messages = 0;
+  std::int64_t published_bytes = 0;
+  std::int64_t delivered_messages = 0;
+  std::int64_t acked_messages = 0;
+  /// The time between the delivery of each message and its acknowledgement.
+  std::vector<std::chrono::microseconds> ack_latencies;
+};
+
+namespace internal {
+class FakePublisherService;   // Defined in fake_pubsub_server.cc
+class FakeSubscriberService;  // Defined in fake_pubsub_server.cc
+}  // namespace internal
+
+/**
+ * An in-process fake of the `google.pubsub.v1.Publisher` and
+ * `google.pubsub.v1.Subscriber` gRPC services.
+ *
+ * The benchmarks use this fake to measure the throughput and latency of the
+ * client library without a Cloud Pub/Sub project, and without any network
+ * noise.
+ *
+ * The fake accepts any topic and subscription name. Published messages are
+ * counted and discarded, while `StreamingPull()` delivers synthetic messages
+ * as fast as the client reads them. Each delivered message has a
+ * `sent-at-us` attribute with the delivery time, and its acknowledgement id
+ * encodes the same time, so the fake can measure the acknowledgement latency.
+ * The administrative RPCs are not implemented.
+ */
+class FakePubsubServer {
+ public:
+  /// Starts a server listening on an unused `localhost` port.
+  static StatusOr<std::unique_ptr<FakePubsubServer>> Create(
+      FakePubsubServerOptions options = {});
+
+  /// Shuts down the server, cancelling any pending requests.
+  ~FakePubsubServer();
+
+  FakePubsubServer(FakePubsubServer const&) = delete;
+  FakePubsubServer& operator=(FakePubsubServer const&) = delete;
+
+  /**
+   * The address of the server, as `host:port`.
+   *
+   * Set the `PUBSUB_EMULATOR_HOST` environment variable to this value to
+   * route the default connections to the fake.
+   */
+  std::string const& endpoint() const { return endpoint_; }
+
+  /// Options for a `pubsub::*Connection` (or stub) using this server.
+  pubsub::ConnectionOptions connection_options() const;
+
+  /// Returns the activity since the previous call, and resets the counters.
+  FakePubsubServerStats TakeStats();
+
+ private:
+  FakePubsubServer(std::unique_ptr<internal::FakePublisherService> publisher,
+                   std::unique_ptr<internal::FakeSubscriberService> subscriber,
+                   std::unique_ptr<grpc::Server> server, std::string endpoint);
+
+  std::unique_ptr<internal::FakePublisherService> publisher_;
+  std::unique_ptr<internal::FakeSubscriberService> subscriber_;
+  std::unique_ptr<grpc::Server> server_;
+  std::string endpoint_;
+};
+
+/**
+ * The attribute with the time each message was sent.
+ *
+ * Both `FakePubsubServer` and the benchmark publishers set this attribute, the
+ * subscriber benchmark uses it to compute the delivery latency.
+ */
+auto constexpr kSentAtAttribute = "sent-at-us";
+
+/// Encodes @p tp as the value for `kSentAtAttribute`.
+std::string FormatSentAt(std::chrono::system_clock::time_point tp);
+
+/// Decodes a `kSentAtAttribute` value, returns the epoch on errors.
+std::chrono::system_clock::time_point ParseSentAt(std::string const& value);
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_benchmarks
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_BENCHMARKS_FAKE_PUBSUB_SERVER_H
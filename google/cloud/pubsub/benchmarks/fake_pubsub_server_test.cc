@@ -0,0 +1,158 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "google/cloud/pubsub/benchmarks/fake_pubsub_server.h"
+#include "google/cloud/pubsub/publisher.h"
+#include "google/cloud/pubsub/subscriber.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "google/cloud/testing_util/scoped_environment.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace pubsub_benchmarks {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+namespace {
+
+using ::testing::Contains;
+using ::testing::Key;
+
+pubsub::Topic TestTopic() {
+  return pubsub::Topic("fake-project", "fake-topic");
+}
+
+std::unique_ptr<FakePubsubServer> StartServer(
+    FakePubsubServerOptions options = {}) {
+  auto server = FakePubsubServer::Create(std::move(options));
+  EXPECT_STATUS_OK(server);
+  if (!server) return nullptr;
+  return *std::move(server);
+}
+
+TEST(FakePubsubServerTest, Publish) {
+  auto server = StartServer();
+  ASSERT_NE(nullptr, server);
+  pubsub::Publisher publisher(pubsub::MakePublisherConnection(
+      TestTopic(), pubsub::PublisherOptions{}, server->connection_options()));
+
+  std::vector<future<StatusOr<std::string>>> results;
+  for (auto const* data : {"m0", "m1", "m2"}) {
+    results.push_back(
+        publisher.Publish(pubsub::MessageBuilder{}.SetData(data).Build()));
+  }
+  for (auto& r : results) {
+    auto id = r.get();
+    ASSERT_STATUS_OK(id);
+    EXPECT_FALSE(id->empty());
+  }
+
+  auto const stats = server->TakeStats();
+  EXPECT_LE(1, stats.publish_requests);
+  EXPECT_EQ(0, stats.failed_publish_requests);
+  EXPECT_EQ(3, stats.published_messages);
+  EXPECT_EQ(6, stats.published_bytes);
+  EXPECT_EQ(0, server->TakeStats().published_messages);
+}
+
+TEST(FakePubsubServerTest, PublishErrors) {
+  FakePubsubServerOptions options;
+  options.publish_error_rate = 1.0;
+  auto server = StartServer(options);
+  ASSERT_NE(nullptr, server);
+  pubsub::Publisher publisher(pubsub::MakePublisherConnection(
+      TestTopic(), pubsub::PublisherOptions{}, server->connection_options()));
+
+  auto id = publisher.Publish(pubsub::MessageBuilder{}.SetData("m0").Build())
+                .get();
+  EXPECT_EQ(StatusCode::kUnavailable, id.status().code());
+
+  auto const stats = server->TakeStats();
+  EXPECT_EQ(1, stats.failed_publish_requests);
+  EXPECT_EQ(0, stats.published_messages);
+}
+
+TEST(FakePubsubServerTest, EmulatorOverrides) {
+  auto server = StartServer();
+  ASSERT_NE(nullptr, server);
+  // The default connection options use the fake, once the emulator overrides
+  // point to it.
+  testing_util::ScopedEnvironment env("PUBSUB_EMULATOR_HOST",
+                                      server->endpoint());
+  pubsub::Publisher publisher(
+      pubsub::MakePublisherConnection(TestTopic(), pubsub::PublisherOptions{}));
+  auto id = publisher.Publish(pubsub::MessageBuilder{}.SetData("m0").Build())
+                .get();
+  ASSERT_STATUS_OK(id);
+  EXPECT_EQ(1, server->TakeStats().published_messages);
+}
+
+TEST(FakePubsubServerTest, SubscribeAndAck) {
+  FakePubsubServerOptions options;
+  options.message_size = 16;
+  options.messages_per_response = 10;
+  auto server = StartServer(options);
+  ASSERT_NE(nullptr, server);
+  pubsub::Subscriber subscriber(
+      pubsub::MakeSubscriberConnection(server->connection_options()));
+
+  auto constexpr kExpected = 50;
+  std::atomic<int> received{0};
+  promise<void> done;
+  auto handler = [&](pubsub::Message const& m, pubsub::AckHandler h) {
+    EXPECT_EQ(16, m.data().size());
+    EXPECT_THAT(m.attributes(), Contains(Key(kSentAtAttribute)));
+    std::move(h).ack();
+    if (++received == kExpected) done.set_value();
+  };
+  auto session = subscriber.Subscribe(
+      pubsub::Subscription("fake-project", "fake-subscription"), handler);
+  done.get_future().get();
+
+  // The acknowledgements are sent asynchronously, wait until some arrive.
+  FakePubsubServerStats stats;
+  for (int i = 0; i != 100 && stats.acked_messages == 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    auto s = server->TakeStats();
+    stats.delivered_messages += s.delivered_messages;
+    stats.acked_messages += s.acked_messages;
+    stats.ack_latencies.insert(stats.ack_latencies.end(),
+                               s.ack_latencies.begin(), s.ack_latencies.end());
+  }
+  session.cancel();
+  EXPECT_STATUS_OK(session.get());
+
+  EXPECT_LE(kExpected, stats.delivered_messages);
+  EXPECT_LT(0, stats.acked_messages);
+  EXPECT_EQ(stats.acked_messages,
+            static_cast<std::int64_t>(stats.ack_latencies.size()));
+}
+
+TEST(FakePubsubServerTest, SentAt) {
+  auto const tp = std::chrono::system_clock::time_point(
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(
+          std::chrono::microseconds(1234567)));
+  EXPECT_EQ("1234567", FormatSentAt(tp));
+  EXPECT_EQ(tp, ParseSentAt(FormatSentAt(tp)));
+  EXPECT_EQ(std::chrono::system_clock::time_point{}, ParseSentAt(""));
+  EXPECT_EQ(std::chrono::system_clock::time_point{}, ParseSentAt("12x"));
+}
+
+}  // namespace
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_benchmarks
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,51 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_BENCHMARKS_LATENCY_SUMMARY_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_BENCHMARKS_LATENCY_SUMMARY_H
+
+#include "google/cloud/pubsub/version.h"
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace pubsub_benchmarks {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+/// The distribution of the latencies observed during one benchmark sample.
+struct LatencySummary {
+  std::size_t count = 0;
+  std::chrono::microseconds p50 = std::chrono::microseconds(0);
+  std::chrono::microseconds p90 = std::chrono::microseconds(0);
+  std::chrono::microseconds p99 = std::chrono::microseconds(0);
+  std::chrono::microseconds max = std::chrono::microseconds(0);
+};
+
+/**
+ * Computes the percentiles of @p latencies.
+ *
+ * The percentiles use the nearest-rank method, all the values are zero if
+ * @p latencies is empty.
+ */
+LatencySummary Summarize(std::vector<std::chrono::microseconds> latencies);
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_benchmarks
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_BENCHMARKS_LATENCY_SUMMARY_H
@@ -0,0 +1,60 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "google/cloud/pubsub/benchmarks/latency_summary.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace pubsub_benchmarks {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+namespace {
+
+using us = std::chrono::microseconds;
+
+TEST(LatencySummaryTest, Empty) {
+  auto const summary = Summarize({});
+  EXPECT_EQ(0, summary.count);
+  EXPECT_EQ(us(0), summary.p50);
+  EXPECT_EQ(us(0), summary.p99);
+  EXPECT_EQ(us(0), summary.max);
+}
+
+TEST(LatencySummaryTest, Percentiles) {
+  std::vector<us> latencies;
+  // Insert the values out of order, `Summarize()` must sort them.
+  for (int i = 100; i != 0; --i) latencies.emplace_back(i);
+  auto const summary = Summarize(std::move(latencies));
+  EXPECT_EQ(100, summary.count);
+  EXPECT_EQ(us(50), summary.p50);
+  EXPECT_EQ(us(90), summary.p90);
+  EXPECT_EQ(us(99), summary.p99);
+  EXPECT_EQ(us(100), summary.max);
+}
+
+TEST(LatencySummaryTest, SingleValue) {
+  auto const summary = Summarize({us(42)});
+  EXPECT_EQ(1, summary.count);
+  EXPECT_EQ(us(42), summary.p50);
+  EXPECT_EQ(us(42), summary.p90);
+  EXPECT_EQ(us(42), summary.p99);
+  EXPECT_EQ(us(42), summary.max);
+}
+
+}  // namespace
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_benchmarks
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,215 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "google/cloud/pubsub/benchmarks/benchmarks_config.h"
+#include "google/cloud/pubsub/benchmarks/fake_pubsub_server.h"
+#include "google/cloud/pubsub/benchmarks/latency_summary.h"
+#include "google/cloud/pubsub/publisher.h"
+#include "google/cloud/internal/random.h"
+#include "google/cloud/internal/setenv.h"
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace {
+
+namespace pubsub = ::google::cloud::pubsub;
+namespace pubsub_benchmarks = ::google::cloud::pubsub_benchmarks;
+using ::google::cloud::future;
+using ::google::cloud::StatusOr;
+using ::google::cloud::pubsub_benchmarks::Config;
+using ::google::cloud::pubsub_benchmarks::FakePubsubServer;
+using ::google::cloud::pubsub_benchmarks::FakePubsubServerOptions;
+using ::google::cloud::pubsub_benchmarks::LatencySummary;
+
+struct PublisherSample {
+  int thread_count;
+  std::size_t message_size;
+  std::size_t batch_message_count;
+  std::int64_t messages;
+  std::int64_t errors;
+  std::chrono::microseconds elapsed;
+  LatencySummary latency;
+};
+
+/// Collects the results of the `Publish()` calls in one sample.
+class PublishResults {
+ public:
+  void OnPublish() {
+    std::lock_guard<std::mutex> lk(mu_);
+    ++pending_;
+  }
+
+  void OnResult(bool ok, std::chrono::microseconds latency) {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (ok) {
+      latencies_.push_back(latency);
+    } else {
+      ++errors_;
+    }
+    if (--pending_ == 0) cv_.notify_all();
+  }
+
+  /// Waits for all the pending results, and returns the successful latencies.
+  std::vector<std::chrono::microseconds> WaitAll(std::int64_t& errors) {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait(lk, [this] { return pending_ == 0; });
+    errors = errors_;
+    return std::move(latencies_);
+  }
+
+ private:
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::int64_t pending_ = 0;
+  std::int64_t errors_ = 0;
+  std::vector<std::chrono::microseconds> latencies_;
+};
+
+PublisherSample RunSample(Config const& config, pubsub::Topic const& topic,
+                          int thread_count, std::size_t message_size,
+                          std::size_t batch_message_count) {
+  auto const options =
+      pubsub::PublisherOptions{}
+          .set_batching_config(
+              pubsub::BatchingConfig{}
+                  .set_maximum_message_count(batch_message_count)
+                  .set_maximum_batch_bytes(config.maximum_batch_bytes)
+                  .set_maximum_hold_time(config.maximum_hold_time))
+          .set_max_outstanding_messages(config.max_outstanding_messages)
+          .set_full_publisher_action(pubsub::FullPublisherAction::kBlock);
+  // With --fake-server the emulator overrides route this connection to the
+  // fake, see `main()`.
+  pubsub::Publisher publisher(pubsub::MakePublisherConnection(topic, options));
+
+  std::string const data(message_size, 'x');
+  auto results = std::make_shared<PublishResults>();
+  auto const start = std::chrono::steady_clock::now();
+  auto const deadline = start + config.iteration_duration;
+  auto worker = [&] {
+    while (std::chrono::steady_clock::now() < deadline) {
+      auto const sent = std::chrono::steady_clock::now();
+      results->OnPublish();
+      publisher
+          .Publish(pubsub::MessageBuilder{}
+                       .SetData(data)
+                       .SetAttributes({{pubsub_benchmarks::kSentAtAttribute,
+                                        pubsub_benchmarks::FormatSentAt(
+                                            std::chrono::system_clock::now())}})
+                       .Build())
+          .then([results, sent](future<StatusOr<std::string>> f) {
+            results->OnResult(
+                f.get().ok(),
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - sent));
+          });
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 0; i != thread_count; ++i) threads.emplace_back(worker);
+  for (auto& t : threads) t.join();
+
+  PublisherSample sample;
+  sample.thread_count = thread_count;
+  sample.message_size = message_size;
+  sample.batch_message_count = batch_message_count;
+  auto latencies = results->WaitAll(sample.errors);
+  sample.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  sample.messages = static_cast<std::int64_t>(latencies.size());
+  sample.latency = pubsub_benchmarks::Summarize(std::move(latencies));
+  return sample;
+}
+
+void PrintHeader() {
+  std::cout << "ThreadCount,MessageSize,BatchMessageCount,Messages,Errors"
+            << ",ElapsedUs,MessagesPerSecond,BytesPerSecond"
+            << ",LatencyP50Us,LatencyP90Us,LatencyP99Us,LatencyMaxUs\n";
+}
+
+void PrintSample(PublisherSample const& s) {
+  auto const seconds = static_cast<double>(s.elapsed.count()) / 1.0E6;
+  auto const rate = static_cast<double>(s.messages) / seconds;
+  std::cout << s.thread_count << ',' << s.message_size << ','
+            << s.batch_message_count << ',' << s.messages << ',' << s.errors
+            << ',' << s.elapsed.count() << ',' << rate << ','
+            << rate * static_cast<double>(s.message_size) << ','
+            << s.latency.p50.count() << ',' << s.latency.p90.count() << ','
+            << s.latency.p99.count() << ',' << s.latency.max.count() << '\n'
+            << std::flush;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Config config;
+  {
+    std::vector<std::string> args{argv, argv + argc};
+    auto c = google::cloud::pubsub_benchmarks::ParseArgs(args);
+    if (!c) {
+      std::cerr << "Error parsing command-line arguments: " << c.status()
+                << "\n";
+      return 1;
+    }
+    config = *std::move(c);
+  }
+  if (config.topic_id.empty()) {
+    std::cerr << "The topic id is not set, provide a value in the --topic"
+              << " flag\n";
+    return 1;
+  }
+
+  // With --fake-server the benchmark runs against an in-process fake. The
+  // fake is reached through the emulator overrides, as the Cloud Pub/Sub
+  // emulator would be.
+  std::unique_ptr<FakePubsubServer> fake_server;
+  if (config.use_fake_server) {
+    FakePubsubServerOptions options;
+    options.publish_latency = config.fake_server_latency;
+    options.publish_error_rate = config.fake_server_error_rate;
+    auto server = FakePubsubServer::Create(options);
+    if (!server) {
+      std::cerr << "Error starting the fake server: " << server.status()
+                << "\n";
+      return 1;
+    }
+    fake_server = *std::move(server);
+    google::cloud::internal::SetEnv("PUBSUB_EMULATOR_HOST",
+                                    fake_server->endpoint().c_str());
+  }
+
+  std::cout << config << std::flush;
+  PrintHeader();
+
+  pubsub::Topic const topic(config.project_id, config.topic_id);
+  auto generator = google::cloud::internal::MakeDefaultPRNG();
+  auto pick = [&generator](std::vector<std::size_t> const& values) {
+    return values[std::uniform_int_distribution<std::size_t>(
+        0, values.size() - 1)(generator)];
+  };
+  std::uniform_int_distribution<int> thread_count_gen(config.minimum_threads,
+                                                      config.maximum_threads);
+  for (int i = 0; i != config.samples; ++i) {
+    auto const thread_count = thread_count_gen(generator);
+    auto const message_size = pick(config.message_sizes);
+    auto const batch_message_count = pick(config.batch_message_counts);
+    PrintSample(RunSample(config, topic, thread_count, message_size,
+                          batch_message_count));
+  }
+
+  return 0;
+}
@@ -0,0 +1,224 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "google/cloud/pubsub/benchmarks/benchmarks_config.h"
+#include "google/cloud/pubsub/benchmarks/fake_pubsub_server.h"
+#include "google/cloud/pubsub/benchmarks/latency_summary.h"
+#include "google/cloud/pubsub/publisher.h"
+#include "google/cloud/pubsub/subscriber.h"
+#include "google/cloud/internal/random.h"
+#include "google/cloud/internal/setenv.h"
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace {
+
+namespace pubsub = ::google::cloud::pubsub;
+namespace pubsub_benchmarks = ::google::cloud::pubsub_benchmarks;
+using ::google::cloud::pubsub_benchmarks::Config;
+using ::google::cloud::pubsub_benchmarks::FakePubsubServer;
+using ::google::cloud::pubsub_benchmarks::FakePubsubServerOptions;
+using ::google::cloud::pubsub_benchmarks::LatencySummary;
+
+struct SubscriberSample {
+  int thread_count;
+  std::size_t message_size;
+  std::int64_t messages;
+  std::int64_t bytes;
+  std::chrono::microseconds elapsed;
+  LatencySummary delivery_latency;
+  LatencySummary ack_latency;
+};
+
+/**
+ * Publishes messages to @p topic until @p done is set.
+ *
+ * Only used against Cloud Pub/Sub (or its emulator), the fake server generates
+ * its own messages.
+ */
+void FeedTopic(Config const& config, pubsub::Topic const& topic,
+               std::size_t message_size, std::atomic<bool> const& done) {
+  pubsub::Publisher publisher(pubsub::MakePublisherConnection(
+      topic,
+      pubsub::PublisherOptions{}
+          .set_max_outstanding_messages(config.max_outstanding_messages)
+          .set_full_publisher_action(pubsub::FullPublisherAction::kBlock)));
+  std::string const data(message_size, 'x');
+  while (!done.load()) {
+    auto sent_at =
+        pubsub_benchmarks::FormatSentAt(std::chrono::system_clock::now());
+    publisher.Publish(
+        pubsub::MessageBuilder{}
+            .SetData(data)
+            .SetAttributes(
+                {{pubsub_benchmarks::kSentAtAttribute, std::move(sent_at)}})
+            .Build());
+  }
+}
+
+SubscriberSample RunSample(Config const& config, int thread_count,
+                           std::size_t message_size) {
+  // With --fake-server each sample uses a new fake, configured to generate
+  // messages of the right size. The emulator overrides route the connections
+  // to it.
+  std::unique_ptr<FakePubsubServer> fake_server;
+  if (config.use_fake_server) {
+    FakePubsubServerOptions options;
+    options.message_size = message_size;
+    options.pull_latency = config.fake_server_latency;
+    options.pull_error_rate = config.fake_server_error_rate;
+    auto server = FakePubsubServer::Create(options);
+    if (!server) {
+      std::cerr << "Error starting the fake server: " << server.status()
+                << "\n";
+      std::exit(1);
+    }
+    fake_server = *std::move(server);
+    google::cloud::internal::SetEnv("PUBSUB_EMULATOR_HOST",
+                                    fake_server->endpoint().c_str());
+  }
+
+  std::atomic<bool> feeder_done{false};
+  std::thread feeder;
+  if (!fake_server) {
+    feeder = std::thread(FeedTopic, std::cref(config),
+                         pubsub::Topic(config.project_id, config.topic_id),
+                         message_size, std::cref(feeder_done));
+  }
+
+  std::mutex mu;
+  std::int64_t messages = 0;
+  std::int64_t bytes = 0;
+  std::vector<std::chrono::microseconds> delivery_latencies;
+  auto handler = [&](pubsub::Message const& m, pubsub::AckHandler h) {
+    auto const now = std::chrono::system_clock::now();
+    std::move(h).ack();
+    auto attributes = m.attributes();
+    auto const sent_at = attributes.find(pubsub_benchmarks::kSentAtAttribute);
+    std::lock_guard<std::mutex> lk(mu);
+    ++messages;
+    bytes += static_cast<std::int64_t>(m.data().size());
+    if (sent_at == attributes.end()) return;
+    delivery_latencies.push_back(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            now - pubsub_benchmarks::ParseSentAt(sent_at->second)));
+  };
+
+  auto const start = std::chrono::steady_clock::now();
+  {
+    pubsub::Subscriber subscriber(pubsub::MakeSubscriberConnection(
+        pubsub::ConnectionOptions{}.set_background_thread_pool_size(
+            static_cast<std::size_t>(thread_count)),
+        pubsub::SubscriberOptions{}
+            .set_max_outstanding_messages(config.max_outstanding_messages)
+            .set_max_concurrency(static_cast<std::size_t>(thread_count))));
+    auto session = subscriber.Subscribe(
+        pubsub::Subscription(config.project_id, config.subscription_id),
+        handler);
+    std::this_thread::sleep_for(config.iteration_duration);
+    session.cancel();
+    auto status = session.get();
+    if (!status.ok()) std::cerr << "# Subscription error: " << status << "\n";
+  }
+  auto const elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+
+  feeder_done.store(true);
+  if (feeder.joinable()) feeder.join();
+
+  SubscriberSample sample;
+  sample.thread_count = thread_count;
+  sample.message_size = message_size;
+  sample.elapsed = elapsed;
+  {
+    std::lock_guard<std::mutex> lk(mu);
+    sample.messages = messages;
+    sample.bytes = bytes;
+    sample.delivery_latency =
+        pubsub_benchmarks::Summarize(std::move(delivery_latencies));
+  }
+  // Only the fake server can measure the acknowledgement latency.
+  if (fake_server) {
+    sample.ack_latency =
+        pubsub_benchmarks::Summarize(fake_server->TakeStats().ack_latencies);
+  }
+  return sample;
+}
+
+void PrintHeader() {
+  std::cout << "ThreadCount,MessageSize,Messages,Bytes,ElapsedUs"
+            << ",MessagesPerSecond,BytesPerSecond"
+            << ",DeliveryP50Us,DeliveryP90Us,DeliveryP99Us"
+            << ",AckCount,AckP50Us,AckP90Us,AckP99Us\n";
+}
+
+void PrintSample(SubscriberSample const& s) {
+  auto const seconds = static_cast<double>(s.elapsed.count()) / 1.0E6;
+  std::cout << s.thread_count << ',' << s.message_size << ',' << s.messages
+            << ',' << s.bytes << ',' << s.elapsed.count() << ','
+            << static_cast<double>(s.messages) / seconds << ','
+            << static_cast<double>(s.bytes) / seconds << ','
+            << s.delivery_latency.p50.count() << ','
+            << s.delivery_latency.p90.count() << ','
+            << s.delivery_latency.p99.count() << ',' << s.ack_latency.count
+            << ',' << s.ack_latency.p50.count() << ','
+            << s.ack_latency.p90.count() << ',' << s.ack_latency.p99.count()
+            << '\n'
+            << std::flush;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Config config;
+  {
+    std::vector<std::string> args{argv, argv + argc};
+    auto c = google::cloud::pubsub_benchmarks::ParseArgs(args);
+    if (!c) {
+      std::cerr << "Error parsing command-line arguments: " << c.status()
+                << "\n";
+      return 1;
+    }
+    config = *std::move(c);
+  }
+  // Against Cloud Pub/Sub the benchmark publishes its own messages, the
+  // subscription must be attached to the topic.
+  if (config.subscription_id.empty() || config.topic_id.empty()) {
+    std::cerr << "The subscription or topic ids are not set, provide values"
+              << " in the --subscription and --topic flags\n";
+    return 1;
+  }
+
+  std::cout << config << std::flush;
+  PrintHeader();
+
+  auto generator = google::cloud::internal::MakeDefaultPRNG();
+  std::uniform_int_distribution<std::size_t> message_size_index(
+      0, config.message_sizes.size() - 1);
+  std::uniform_int_distribution<int> thread_count_gen(config.minimum_threads,
+                                                      config.maximum_threads);
+  for (int i = 0; i != config.samples; ++i) {
+    auto const thread_count = thread_count_gen(generator);
+    auto const message_size =
+        config.message_sizes[message_size_index(generator)];
+    PrintSample(RunSample(config, thread_count, message_size));
+  }
+
+  return 0;
+}
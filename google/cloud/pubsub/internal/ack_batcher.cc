@@ -0,0 +1,273 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/pubsub/internal/ack_batcher.h"
+#include "google/cloud/internal/backoff_policy.h"
+#include "absl/memory/memory.h"
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+namespace {
+
+bool IsTransient(Status const& status) {
+  switch (status.code()) {
+    case StatusCode::kAborted:
+    case StatusCode::kDeadlineExceeded:
+    case StatusCode::kInternal:
+    case StatusCode::kResourceExhausted:
+    case StatusCode::kUnavailable:
+      return true;
+    default:
+      return false;
+  }
+}
+
+future<Status> AsyncSend(SubscriberStub& stub,
+                         google::cloud::CompletionQueue& cq,
+                         google::pubsub::v1::AcknowledgeRequest const& r) {
+  return stub.AsyncAcknowledge(cq, absl::make_unique<grpc::ClientContext>(),
+                               r);
+}
+
+future<Status> AsyncSend(
+    SubscriberStub& stub, google::cloud::CompletionQueue& cq,
+    google::pubsub::v1::ModifyAckDeadlineRequest const& r) {
+  return stub.AsyncModifyAckDeadline(
+      cq, absl::make_unique<grpc::ClientContext>(), r);
+}
+
+}  // namespace
+
+template <typename Request>
+class AckBatcher::Batch : public std::enable_shared_from_this<Batch<Request>> {
+ public:
+  Batch(google::cloud::CompletionQueue cq,
+        std::shared_ptr<SubscriberStub> stub, Request request,
+        std::shared_ptr<AckBatcherCounters> counters, int maximum_attempts)
+      : cq_(std::move(cq)),
+        stub_(std::move(stub)),
+        request_(std::move(request)),
+        counters_(std::move(counters)),
+        attempts_left_(maximum_attempts),
+        backoff_(google::cloud::internal::ExponentialBackoffPolicy(
+                     std::chrono::milliseconds(100), std::chrono::seconds(2),
+                     2.0)
+                     .clone()) {}
+
+  void Start() {
+    --attempts_left_;
+    auto self = this->shared_from_this();
+    AsyncSend(*stub_, cq_, request_).then([self](future<Status> f) {
+      self->OnCompletion(f.get());
+    });
+  }
+
+ private:
+  void OnCompletion(Status const& status) {
+    if (status.ok()) return;
+    if (attempts_left_ <= 0 || !IsTransient(status)) {
+      Failed();
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lk(counters_->mu);
+      ++counters_->metrics.retries;
+    }
+    auto self = this->shared_from_this();
+    cq_.MakeRelativeTimer(backoff_->OnCompletion())
+        .then([self](future<StatusOr<std::chrono::system_clock::time_point>>
+                         f) {
+          // The timer fails only if the completion queue is shutting down.
+          if (!f.get()) {
+            self->Failed();
+            return;
+          }
+          self->Start();
+        });
+  }
+
+  void Failed() {
+    std::lock_guard<std::mutex> lk(counters_->mu);
+    ++counters_->metrics.failed_batches;
+  }
+
+  google::cloud::CompletionQueue cq_;
+  std::shared_ptr<SubscriberStub> stub_;
+  Request const request_;
+  std::shared_ptr<AckBatcherCounters> counters_;
+  int attempts_left_;
+  std::unique_ptr<google::cloud::internal::BackoffPolicy> backoff_;
+};
+
+AckBatcher::AckBatcher(std::vector<std::shared_ptr<SubscriberStub>> stubs,
+                       google::cloud::CompletionQueue cq,
+                       std::string subscription, AckBatchingConfig config,
+                       std::shared_ptr<AckBatcherCounters> counters)
+    : stubs_(std::move(stubs)),
+      cq_(std::move(cq)),
+      subscription_(std::move(subscription)),
+      config_(std::move(config)),
+      counters_(std::move(counters)) {}
+
+// Only `Flush()` runs here, it does not need `shared_from_this()`, and the
+// batches keep their own references to the stubs and completion queue.
+AckBatcher::~AckBatcher() { Flush(); }
+
+void AckBatcher::Ack(std::string ack_id) {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (Add(acks_, std::move(ack_id))) {
+    auto batch = MakeAckBatch();
+    lk.unlock();
+    batch->Start();
+    return;
+  }
+  MaybeStartTimer(std::move(lk));
+}
+
+void AckBatcher::Nack(std::string ack_id) {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (Add(nacks_, std::move(ack_id))) {
+    auto batch = MakeNackBatch();
+    lk.unlock();
+    batch->Start();
+    return;
+  }
+  MaybeStartTimer(std::move(lk));
+}
+
+void AckBatcher::ExtendLeases(std::vector<std::string> ack_ids,
+                              std::chrono::seconds deadline) {
+  if (ack_ids.empty()) return;
+  auto const id_count = ack_ids.size();
+  std::vector<google::pubsub::v1::ModifyAckDeadlineRequest> requests;
+  std::size_t bytes = 0;
+  for (auto& id : ack_ids) {
+    if (requests.empty() ||
+        static_cast<std::size_t>(requests.back().ack_ids_size()) >=
+            config_.maximum_count ||
+        bytes >= config_.maximum_bytes) {
+      requests.emplace_back();
+      requests.back().set_subscription(subscription_);
+      requests.back().set_ack_deadline_seconds(
+          static_cast<std::int32_t>(deadline.count()));
+      bytes = 0;
+    }
+    bytes += id.size();
+    requests.back().add_ack_ids(std::move(id));
+  }
+  {
+    std::lock_guard<std::mutex> lk(counters_->mu);
+    counters_->metrics.extension_batches += requests.size();
+    counters_->metrics.extension_ids += id_count;
+  }
+
+  std::vector<std::shared_ptr<ModifyBatch>> batches;
+  std::unique_lock<std::mutex> lk(mu_);
+  for (auto& r : requests) {
+    batches.push_back(std::make_shared<ModifyBatch>(
+        cq_, NextStub(), std::move(r), counters_, config_.maximum_attempts));
+  }
+  lk.unlock();
+  for (auto& b : batches) b->Start();
+}
+
+void AckBatcher::Flush() {
+  std::unique_lock<std::mutex> lk(mu_);
+  auto acks = MakeAckBatch();
+  auto nacks = MakeNackBatch();
+  lk.unlock();
+  if (acks) acks->Start();
+  if (nacks) nacks->Start();
+}
+
+AckBatcherMetrics AckBatcher::metrics() const {
+  return counters_->Snapshot();
+}
+
+bool AckBatcher::Add(Pending& pending, std::string ack_id) {
+  pending.bytes += ack_id.size();
+  pending.ids.push_back(std::move(ack_id));
+  return pending.ids.size() >= config_.maximum_count ||
+         pending.bytes >= config_.maximum_bytes;
+}
+
+void AckBatcher::MaybeStartTimer(std::unique_lock<std::mutex> lk) {
+  // Only the first pending id starts a timer, any other id is sent with it.
+  if (acks_.ids.size() + nacks_.ids.size() != 1) return;
+  flush_deadline_ =
+      std::chrono::system_clock::now() + config_.maximum_hold_time;
+  auto const deadline = flush_deadline_;
+  lk.unlock();
+  // The completion queue may outlive this object, use a weak_ptr<> to avoid
+  // extending its lifetime.
+  auto weak = std::weak_ptr<AckBatcher>(shared_from_this());
+  cq_.MakeDeadlineTimer(deadline).then(
+      [weak](future<StatusOr<std::chrono::system_clock::time_point>>) {
+        if (auto self = weak.lock()) self->OnTimer();
+      });
+}
+
+void AckBatcher::OnTimer() {
+  std::unique_lock<std::mutex> lk(mu_);
+  // Timers for batches that were already sent because they were full can
+  // still fire, ignore them.
+  if (std::chrono::system_clock::now() < flush_deadline_) return;
+  lk.unlock();
+  Flush();
+}
+
+std::shared_ptr<AckBatcher::AckBatch> AckBatcher::MakeAckBatch() {
+  if (acks_.ids.empty()) return nullptr;
+  google::pubsub::v1::AcknowledgeRequest request;
+  request.set_subscription(subscription_);
+  for (auto& id : acks_.ids) request.add_ack_ids(std::move(id));
+  {
+    std::lock_guard<std::mutex> lk(counters_->mu);
+    ++counters_->metrics.ack_batches;
+    counters_->metrics.ack_ids += acks_.ids.size();
+  }
+  acks_ = Pending{};
+  return std::make_shared<AckBatch>(cq_, NextStub(), std::move(request),
+                                    counters_, config_.maximum_attempts);
+}
+
+std::shared_ptr<AckBatcher::ModifyBatch> AckBatcher::MakeNackBatch() {
+  if (nacks_.ids.empty()) return nullptr;
+  google::pubsub::v1::ModifyAckDeadlineRequest request;
+  request.set_subscription(subscription_);
+  request.set_ack_deadline_seconds(0);
+  for (auto& id : nacks_.ids) request.add_ack_ids(std::move(id));
+  {
+    std::lock_guard<std::mutex> lk(counters_->mu);
+    ++counters_->metrics.nack_batches;
+    counters_->metrics.nack_ids += nacks_.ids.size();
+  }
+  nacks_ = Pending{};
+  return std::make_shared<ModifyBatch>(cq_, NextStub(), std::move(request),
+                                       counters_, config_.maximum_attempts);
+}
+
+std::shared_ptr<SubscriberStub> AckBatcher::NextStub() {
+  auto stub = stubs_[next_stub_];
+  next_stub_ = (next_stub_ + 1) % stubs_.size();
+  return stub;
+}
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,167 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_ACK_BATCHER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_ACK_BATCHER_H
+
+#include "google/cloud/pubsub/internal/subscriber_stub.h"
+#include "google/cloud/pubsub/subscriber_metrics.h"
+#include "google/cloud/pubsub/version.h"
+#include "google/cloud/completion_queue.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+/// Configure how an `AckBatcher` groups the ids into requests.
+struct AckBatchingConfig {
+  /// Send a request once this many ids are pending.
+  std::size_t maximum_count = 2500;
+
+  /// Send a request once the pending ids reach this many bytes.
+  std::size_t maximum_bytes = 512 * 1024;
+
+  /// Send the pending ids, regardless of their number, after this time.
+  std::chrono::milliseconds maximum_hold_time = std::chrono::milliseconds(100);
+
+  /// The number of times a request is sent, including the first attempt.
+  int maximum_attempts = 5;
+};
+
+/// Counters reported by `AckBatcher`, the values are cumulative.
+using AckBatcherMetrics = pubsub::SubscriberAckMetrics;
+
+/// The counters behind `AckBatcherMetrics`, may be shared by many batchers.
+struct AckBatcherCounters {
+  AckBatcherMetrics Snapshot() {
+    std::lock_guard<std::mutex> lk(mu);
+    return metrics;
+  }
+
+  std::mutex mu;
+  AckBatcherMetrics metrics;  // GUARDED_BY(mu)
+};
+
+/**
+ * Groups the acks and nacks for a subscription into batches.
+ *
+ * Sending one `Acknowledge` or `ModifyAckDeadline` request per message is as
+ * expensive as receiving the message. This class collects the ids from all
+ * the handlers in a subscription, and sends them in asynchronous requests,
+ * each bounded by the limits in `AckBatchingConfig`. Requests that fail with
+ * transient errors are retried with backoff.
+ *
+ * Acks and nacks are best-effort operations in Cloud Pub/Sub, the service
+ * re-delivers any message that is not acknowledged before its deadline, so
+ * failures are only reported via `metrics()`.
+ *
+ * The requests are spread across the stubs in a round-robin fashion. Any ids
+ * still pending when the object is destroyed are sent immediately.
+ */
+class AckBatcher : public std::enable_shared_from_this<AckBatcher> {
+ public:
+  static std::shared_ptr<AckBatcher> Create(
+      std::vector<std::shared_ptr<SubscriberStub>> stubs,
+      google::cloud::CompletionQueue cq, std::string subscription,
+      AckBatchingConfig config = AckBatchingConfig{},
+      std::shared_ptr<AckBatcherCounters> counters = {}) {
+    if (!counters) counters = std::make_shared<AckBatcherCounters>();
+    return std::shared_ptr<AckBatcher>(new AckBatcher(
+        std::move(stubs), std::move(cq), std::move(subscription),
+        std::move(config), std::move(counters)));
+  }
+
+  ~AckBatcher();
+
+  /// Acknowledge the message with @p ack_id.
+  void Ack(std::string ack_id);
+
+  /// Reject the message with @p ack_id, the service re-delivers it.
+  void Nack(std::string ack_id);
+
+  /**
+   * Extend the ack deadline of the messages in @p ack_ids to @p deadline.
+   *
+   * The ids are sent immediately, split into as many requests as needed to
+   * respect the limits in `AckBatchingConfig`.
+   */
+  void ExtendLeases(std::vector<std::string> ack_ids,
+                    std::chrono::seconds deadline);
+
+  /// Send any pending ids immediately.
+  void Flush();
+
+  /**
+   * Returns a snapshot of the counters.
+   *
+   * The values include the requests of any other batcher sharing the same
+   * `AckBatcherCounters`.
+   */
+  AckBatcherMetrics metrics() const;
+
+ private:
+  AckBatcher(std::vector<std::shared_ptr<SubscriberStub>> stubs,
+             google::cloud::CompletionQueue cq, std::string subscription,
+             AckBatchingConfig config,
+             std::shared_ptr<AckBatcherCounters> counters);
+
+  /// The ids waiting to be sent in a single request.
+  struct Pending {
+    std::vector<std::string> ids;
+    std::size_t bytes = 0;
+  };
+
+  /// A request in flight, possibly waiting to be retried.
+  template <typename Request>
+  class Batch;
+  using AckBatch = Batch<google::pubsub::v1::AcknowledgeRequest>;
+  using ModifyBatch = Batch<google::pubsub::v1::ModifyAckDeadlineRequest>;
+
+  /// Adds @p ack_id to @p pending, returns true if the batch is full.
+  bool Add(Pending& pending, std::string ack_id);
+  void MaybeStartTimer(std::unique_lock<std::mutex> lk);
+  void OnTimer();
+  // These functions require `mu_` to be held, they return nullptr if there
+  // are no pending ids.
+  std::shared_ptr<AckBatch> MakeAckBatch();
+  std::shared_ptr<ModifyBatch> MakeNackBatch();
+  std::shared_ptr<SubscriberStub> NextStub();
+
+  std::vector<std::shared_ptr<SubscriberStub>> const stubs_;
+  google::cloud::CompletionQueue cq_;
+  std::string const subscription_;
+  AckBatchingConfig const config_;
+  std::shared_ptr<AckBatcherCounters> const counters_;
+
+  std::mutex mu_;
+  Pending acks_;                                          // GUARDED_BY(mu_)
+  Pending nacks_;                                         // GUARDED_BY(mu_)
+  std::size_t next_stub_ = 0;                             // GUARDED_BY(mu_)
+  std::chrono::system_clock::time_point flush_deadline_;  // GUARDED_BY(mu_)
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_ACK_BATCHER_H
@@ -0,0 +1,309 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/pubsub/internal/ack_batcher.h"
+#include "google/cloud/pubsub/testing/mock_subscriber_stub.h"
+#include "google/cloud/internal/background_threads_impl.h"
+#include <gmock/gmock.h>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+namespace {
+
+using ::testing::_;
+using ::testing::ElementsAre;
+
+/**
+ * A configuration where only the tests trigger the flushes.
+ *
+ * The tests must cancel the pending timer before shutting down the completion
+ * queue, otherwise the shutdown waits for the timer.
+ */
+AckBatchingConfig TestConfig() {
+  AckBatchingConfig config;
+  config.maximum_hold_time = std::chrono::hours(1);
+  return config;
+}
+
+TEST(AckBatcherTest, FlushOnCount) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  EXPECT_CALL(*mock, AsyncAcknowledge(_, _, _))
+      .WillOnce([](google::cloud::CompletionQueue&,
+                   std::unique_ptr<grpc::ClientContext>,
+                   google::pubsub::v1::AcknowledgeRequest const& request) {
+        EXPECT_EQ("test-sub", request.subscription());
+        EXPECT_THAT(request.ack_ids(), ElementsAre("a0", "a1", "a2"));
+        return make_ready_future(Status{});
+      });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto config = TestConfig();
+  config.maximum_count = 3;
+  auto batcher = AckBatcher::Create({mock}, bg.cq(), "test-sub", config);
+  batcher->Ack("a0");
+  batcher->Ack("a1");
+  auto metrics = batcher->metrics();
+  EXPECT_EQ(0, metrics.ack_batches);
+  batcher->Ack("a2");
+
+  metrics = batcher->metrics();
+  EXPECT_EQ(1, metrics.ack_batches);
+  EXPECT_EQ(3, metrics.ack_ids);
+  EXPECT_EQ(0, metrics.nack_batches);
+  bg.cq().CancelAll();
+}
+
+TEST(AckBatcherTest, FlushOnBytes) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  EXPECT_CALL(*mock, AsyncModifyAckDeadline(_, _, _))
+      .WillOnce(
+          [](google::cloud::CompletionQueue&,
+             std::unique_ptr<grpc::ClientContext>,
+             google::pubsub::v1::ModifyAckDeadlineRequest const& request) {
+            EXPECT_EQ("test-sub", request.subscription());
+            EXPECT_EQ(0, request.ack_deadline_seconds());
+            EXPECT_THAT(request.ack_ids(), ElementsAre("01234", "56789"));
+            return make_ready_future(Status{});
+          });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto config = TestConfig();
+  config.maximum_bytes = 10;
+  auto batcher = AckBatcher::Create({mock}, bg.cq(), "test-sub", config);
+  batcher->Nack("01234");
+  batcher->Nack("56789");
+
+  auto metrics = batcher->metrics();
+  EXPECT_EQ(1, metrics.nack_batches);
+  EXPECT_EQ(2, metrics.nack_ids);
+  bg.cq().CancelAll();
+}
+
+TEST(AckBatcherTest, FlushOnTimer) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  promise<void> acked;
+  EXPECT_CALL(*mock, AsyncAcknowledge(_, _, _))
+      .WillOnce([&](google::cloud::CompletionQueue&,
+                    std::unique_ptr<grpc::ClientContext>,
+                    google::pubsub::v1::AcknowledgeRequest const& request) {
+        EXPECT_THAT(request.ack_ids(), ElementsAre("a0", "a1"));
+        acked.set_value();
+        return make_ready_future(Status{});
+      });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  AckBatchingConfig config;
+  config.maximum_hold_time = std::chrono::milliseconds(10);
+  auto batcher = AckBatcher::Create({mock}, bg.cq(), "test-sub", config);
+  batcher->Ack("a0");
+  batcher->Ack("a1");
+  acked.get_future().get();
+}
+
+TEST(AckBatcherTest, FlushAndDestructor) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  EXPECT_CALL(*mock, AsyncAcknowledge(_, _, _))
+      .WillOnce([](google::cloud::CompletionQueue&,
+                   std::unique_ptr<grpc::ClientContext>,
+                   google::pubsub::v1::AcknowledgeRequest const& request) {
+        EXPECT_THAT(request.ack_ids(), ElementsAre("a0"));
+        return make_ready_future(Status{});
+      })
+      .WillOnce([](google::cloud::CompletionQueue&,
+                   std::unique_ptr<grpc::ClientContext>,
+                   google::pubsub::v1::AcknowledgeRequest const& request) {
+        EXPECT_THAT(request.ack_ids(), ElementsAre("a1"));
+        return make_ready_future(Status{});
+      });
+  EXPECT_CALL(*mock, AsyncModifyAckDeadline(_, _, _))
+      .WillOnce(
+          [](google::cloud::CompletionQueue&,
+             std::unique_ptr<grpc::ClientContext>,
+             google::pubsub::v1::ModifyAckDeadlineRequest const& request) {
+            EXPECT_THAT(request.ack_ids(), ElementsAre("n0"));
+            return make_ready_future(Status{});
+          });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto batcher = AckBatcher::Create({mock}, bg.cq(), "test-sub", TestConfig());
+  batcher->Ack("a0");
+  batcher->Nack("n0");
+  batcher->Flush();
+  // A second flush has nothing to send.
+  batcher->Flush();
+
+  // Any pending ids are sent when the batcher is destroyed.
+  batcher->Ack("a1");
+  batcher.reset();
+  bg.cq().CancelAll();
+}
+
+TEST(AckBatcherTest, ExtendLeases) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  std::vector<std::vector<std::string>> requests;
+  EXPECT_CALL(*mock, AsyncModifyAckDeadline(_, _, _))
+      .Times(3)
+      .WillRepeatedly(
+          [&](google::cloud::CompletionQueue&,
+              std::unique_ptr<grpc::ClientContext>,
+              google::pubsub::v1::ModifyAckDeadlineRequest const& request) {
+            EXPECT_EQ("test-sub", request.subscription());
+            EXPECT_EQ(42, request.ack_deadline_seconds());
+            requests.emplace_back(request.ack_ids().begin(),
+                                  request.ack_ids().end());
+            return make_ready_future(Status{});
+          });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto config = TestConfig();
+  config.maximum_count = 2;
+  auto batcher = AckBatcher::Create({mock}, bg.cq(), "test-sub", config);
+  // The extensions are sent immediately, split to respect the limits.
+  batcher->ExtendLeases({"a0", "a1", "a2", "a3", "a4"},
+                        std::chrono::seconds(42));
+  EXPECT_THAT(requests, ElementsAre(ElementsAre("a0", "a1"),
+                                    ElementsAre("a2", "a3"),
+                                    ElementsAre("a4")));
+
+  auto metrics = batcher->metrics();
+  EXPECT_EQ(3, metrics.extension_batches);
+  EXPECT_EQ(5, metrics.extension_ids);
+  EXPECT_EQ(0, metrics.nack_batches);
+}
+
+TEST(AckBatcherTest, RetryTransientErrors) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  promise<void> done;
+  EXPECT_CALL(*mock, AsyncAcknowledge(_, _, _))
+      .WillOnce([] {
+        return make_ready_future(Status(StatusCode::kUnavailable, "try-again"));
+      })
+      .WillOnce([&](google::cloud::CompletionQueue&,
+                    std::unique_ptr<grpc::ClientContext>,
+                    google::pubsub::v1::AcknowledgeRequest const& request) {
+        EXPECT_THAT(request.ack_ids(), ElementsAre("a0"));
+        done.set_value();
+        return make_ready_future(Status{});
+      });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto batcher = AckBatcher::Create({mock}, bg.cq(), "test-sub", TestConfig());
+  batcher->Ack("a0");
+  batcher->Flush();
+  done.get_future().get();
+
+  auto metrics = batcher->metrics();
+  EXPECT_EQ(1, metrics.ack_batches);
+  EXPECT_EQ(1, metrics.retries);
+  EXPECT_EQ(0, metrics.failed_batches);
+  bg.cq().CancelAll();
+}
+
+TEST(AckBatcherTest, PermanentError) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  EXPECT_CALL(*mock, AsyncModifyAckDeadline(_, _, _)).WillOnce([] {
+    return make_ready_future(Status(StatusCode::kPermissionDenied, "uh-oh"));
+  });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto batcher = AckBatcher::Create({mock}, bg.cq(), "test-sub", TestConfig());
+  batcher->Nack("n0");
+  batcher->Flush();
+
+  auto metrics = batcher->metrics();
+  EXPECT_EQ(1, metrics.nack_batches);
+  EXPECT_EQ(0, metrics.retries);
+  EXPECT_EQ(1, metrics.failed_batches);
+  bg.cq().CancelAll();
+}
+
+TEST(AckBatcherTest, TooManyTransientErrors) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  EXPECT_CALL(*mock, AsyncAcknowledge(_, _, _))
+      .Times(2)
+      .WillRepeatedly([] {
+        return make_ready_future(Status(StatusCode::kUnavailable, "try-again"));
+      });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto config = TestConfig();
+  config.maximum_attempts = 2;
+  auto batcher = AckBatcher::Create({mock}, bg.cq(), "test-sub", config);
+  batcher->Ack("a0");
+  batcher->Flush();
+
+  // The retry runs in the background, wait until it is done.
+  for (int i = 0; i != 100 && batcher->metrics().failed_batches == 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  auto metrics = batcher->metrics();
+  EXPECT_EQ(1, metrics.retries);
+  EXPECT_EQ(1, metrics.failed_batches);
+  bg.cq().CancelAll();
+}
+
+TEST(AckBatcherTest, RoundRobin) {
+  std::vector<std::shared_ptr<SubscriberStub>> stubs;
+  for (int i = 0; i != 2; ++i) {
+    auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+    EXPECT_CALL(*mock, AsyncAcknowledge(_, _, _))
+        .Times(2)
+        .WillRepeatedly([] { return make_ready_future(Status{}); });
+    stubs.push_back(std::move(mock));
+  }
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto config = TestConfig();
+  config.maximum_count = 1;
+  auto batcher = AckBatcher::Create(stubs, bg.cq(), "test-sub", config);
+  for (auto const* id : {"a0", "a1", "a2", "a3"}) batcher->Ack(id);
+  EXPECT_EQ(4, batcher->metrics().ack_batches);
+  bg.cq().CancelAll();
+}
+
+TEST(AckBatcherTest, SharedCounters) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  EXPECT_CALL(*mock, AsyncAcknowledge(_, _, _))
+      .Times(2)
+      .WillRepeatedly([] { return make_ready_future(Status{}); });
+  EXPECT_CALL(*mock, AsyncModifyAckDeadline(_, _, _))
+      .WillOnce([] { return make_ready_future(Status{}); });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto config = TestConfig();
+  config.maximum_count = 1;
+  auto counters = std::make_shared<AckBatcherCounters>();
+  auto b0 = AckBatcher::Create({mock}, bg.cq(), "test-sub", config, counters);
+  auto b1 = AckBatcher::Create({mock}, bg.cq(), "test-sub", config, counters);
+  b0->Ack("a0");
+  b1->Ack("a1");
+  b1->Nack("n0");
+
+  auto metrics = counters->Snapshot();
+  EXPECT_EQ(2, metrics.ack_batches);
+  EXPECT_EQ(2, metrics.ack_ids);
+  EXPECT_EQ(1, metrics.nack_batches);
+  EXPECT_EQ(1, metrics.nack_ids);
+  EXPECT_EQ(2, b0->metrics().ack_batches);
+  bg.cq().CancelAll();
+}
+
+}  // namespace
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
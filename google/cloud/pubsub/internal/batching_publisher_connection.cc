@@ -13,7 +13,8 @@
 // limitations under the License.
 
 #include "google/cloud/pubsub/internal/batching_publisher_connection.h"
-#include <numeric>
+#include <algorithm>
+#include <iterator>
 
 namespace google {
 namespace cloud {
@@ -27,17 +28,22 @@ struct Batch {
   // well name it as one.
   google::cloud::CompletionQueue executor;
   std::vector<promise<StatusOr<std::string>>> waiters;
+  // Release the flow control budget of these messages once they complete.
+  std::weak_ptr<BatchingPublisherConnection> publisher;
+  std::size_t bytes = 0;
 
   void operator()(future<StatusOr<google::pubsub::v1::PublishResponse>> f) {
     auto response = f.get();
-    if (!response) {
-      SatisfyAllWaiters(response.status());
-      return;
+    auto status = response.status();
+    if (status.ok() && static_cast<std::size_t>(response->message_ids_size()) !=
+                           waiters.size()) {
+      status = Status(StatusCode::kUnknown, "mismatched message id count");
+    }
+    if (auto self = publisher.lock()) {
+      self->OnBatchCompleted(waiters.size(), bytes, status);
     }
-    if (static_cast<std::size_t>(response->message_ids_size()) !=
-        waiters.size()) {
-      SatisfyAllWaiters(
-          Status(StatusCode::kUnknown, "mismatched message id count"));
+    if (!status.ok()) {
+      SatisfyAllWaiters(status);
       return;
     }
     struct SetValue {
@@ -63,25 +69,264 @@ struct Batch {
   }
 };
 
+bool PublisherFlowControl::TryAcquire(std::size_t bytes) {
+  std::lock_guard<std::mutex> lk(mu_);
+  auto& m = metrics_;
+  // Always accept a message when nothing is outstanding, otherwise a message
+  // larger than the limit would block (or be rejected) forever.
+  if (m.outstanding_messages != 0 &&
+      (m.outstanding_messages >= max_messages_ ||
+       m.outstanding_bytes > max_bytes_ ||
+       bytes > max_bytes_ - m.outstanding_bytes)) {
+    return false;
+  }
+  ++m.outstanding_messages;
+  m.outstanding_bytes += bytes;
+  return true;
+}
+
+void PublisherFlowControl::Release(std::size_t messages, std::size_t bytes) {
+  std::unique_lock<std::mutex> lk(mu_);
+  metrics_.outstanding_messages -= messages;
+  metrics_.outstanding_bytes -= bytes;
+  ++generation_;
+  lk.unlock();
+  cv_.notify_all();
+}
+
+void PublisherFlowControl::Drop(std::size_t bytes) {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    ++metrics_.dropped_messages;
+  }
+  Release(1, bytes);
+}
+
+void PublisherFlowControl::Reject() {
+  std::lock_guard<std::mutex> lk(mu_);
+  ++metrics_.rejected_messages;
+}
+
+void PublisherFlowControl::BlockStarted() {
+  std::lock_guard<std::mutex> lk(mu_);
+  ++metrics_.blocked_publishers;
+}
+
+void PublisherFlowControl::BlockFinished(
+    std::chrono::steady_clock::duration elapsed) {
+  std::lock_guard<std::mutex> lk(mu_);
+  --metrics_.blocked_publishers;
+  metrics_.blocked_time +=
+      std::chrono::duration_cast<std::chrono::microseconds>(elapsed);
+}
+
+std::uint64_t PublisherFlowControl::generation() {
+  std::lock_guard<std::mutex> lk(mu_);
+  return generation_;
+}
+
+void PublisherFlowControl::WaitForRelease(std::uint64_t generation) {
+  std::unique_lock<std::mutex> lk(mu_);
+  cv_.wait(lk, [&] { return generation_ != generation; });
+}
+
+PublisherFlowControlMetrics PublisherFlowControl::metrics() {
+  std::lock_guard<std::mutex> lk(mu_);
+  return metrics_;
+}
+
+bool PublisherCompressionBudget::TryCompress() {
+  auto constexpr kInterval = std::chrono::seconds(1);
+  std::lock_guard<std::mutex> lk(mu_);
+  auto const now = std::chrono::steady_clock::now();
+  if (now - interval_start_ >= kInterval) {
+    interval_start_ = now;
+    interval_time_ = std::chrono::steady_clock::duration(0);
+  }
+  auto const budget =
+      std::chrono::duration<double>(kInterval).count() * cpu_budget_;
+  if (std::chrono::duration<double>(interval_time_).count() > budget) {
+    ++metrics_.over_budget_batches;
+    return false;
+  }
+  return true;
+}
+
+void PublisherCompressionBudget::OnCompressed(
+    std::size_t bytes, std::chrono::steady_clock::duration elapsed) {
+  std::lock_guard<std::mutex> lk(mu_);
+  ++metrics_.compressed_batches;
+  metrics_.compressed_bytes += bytes;
+  metrics_.compression_time +=
+      std::chrono::duration_cast<std::chrono::microseconds>(elapsed);
+  interval_time_ += elapsed;
+}
+
+PublisherCompressionMetrics PublisherCompressionBudget::metrics() {
+  std::lock_guard<std::mutex> lk(mu_);
+  return metrics_;
+}
+
 future<StatusOr<std::string>> BatchingPublisherConnection::Publish(
     PublishParams p) {
+  // Use the serialized size, which includes the attributes and ordering key,
+  // and is what counts towards the service limits for each request.
+  auto const bytes = ToProto(p.message).ByteSizeLong();
+  std::vector<Item> dropped;
+  std::unique_lock<std::mutex> lk(mu_);
+  if (!paused_status_.ok()) {
+    return make_ready_future(StatusOr<std::string>(paused_status_));
+  }
+  if (!flow_control_->TryAcquire(bytes) && !MakeCapacity(lk, bytes, dropped)) {
+    flow_control_->Reject();
+    lk.unlock();
+    FailItems(std::move(dropped), DroppedStatus());
+    return make_ready_future(StatusOr<std::string>(
+        Status(StatusCode::kResourceExhausted,
+               "publisher flow control limits reached")));
+  }
+  if (!paused_status_.ok()) {
+    // Publishing was paused while this call was blocked.
+    auto paused = paused_status_;
+    lk.unlock();
+    flow_control_->Release(1, bytes);
+    FailItems(std::move(dropped), DroppedStatus());
+    return make_ready_future(StatusOr<std::string>(std::move(paused)));
+  }
   promise<StatusOr<std::string>> promise;
   auto f = promise.get_future();
-  std::unique_lock<std::mutex> lk(mu_);
-  pending_.push_back(Item{std::move(promise), std::move(p.message)});
+  pending_.push_back(Item{std::move(promise), bytes});
+  // Swap the message into the request, so the (potentially large) payload is
+  // never copied before gRPC serializes the request.
+  auto&& message = ToProto(std::move(p.message));
+  pending_request_.add_messages()->Swap(&message);
+  pending_bytes_ += bytes;
   MaybeFlush(std::move(lk));
+  FailItems(std::move(dropped), DroppedStatus());
   return f;
 }
 
-void BatchingPublisherConnection::MaybeFlush(std::unique_lock<std::mutex> lk) {
-  if (pending_.size() >= batching_config_.maximum_message_count()) {
+void BatchingPublisherConnection::ResumePublish(ResumePublishParams) {
+  std::lock_guard<std::mutex> lk(mu_);
+  paused_status_ = Status{};
+}
+
+PublisherFlowControlMetrics
+BatchingPublisherConnection::GetFlowControlMetrics() {
+  return flow_control_->metrics();
+}
+
+PublisherCompressionMetrics
+BatchingPublisherConnection::GetCompressionMetrics() {
+  return compression_->metrics();
+}
+
+bool BatchingPublisherConnection::MakeCapacity(
+    std::unique_lock<std::mutex>& lk, std::size_t bytes,
+    std::vector<Item>& dropped) {
+  switch (options_.full_publisher_action()) {
+    case pubsub::FullPublisherAction::kReject:
+      return false;
+
+    case pubsub::FullPublisherAction::kDropOldest: {
+      // Only the messages pending in this connection can be dropped, the
+      // messages pending in other connections may still use the budget.
+      auto acquired = false;
+      auto i = pending_.begin();
+      for (; !acquired && i != pending_.end(); ++i) {
+        pending_bytes_ -= i->bytes;
+        flow_control_->Drop(i->bytes);
+        dropped.push_back(std::move(*i));
+        acquired = flow_control_->TryAcquire(bytes);
+      }
+      auto const count = std::distance(pending_.begin(), i);
+      pending_.erase(pending_.begin(), i);
+      pending_request_.mutable_messages()->DeleteSubrange(
+          0, static_cast<int>(count));
+      return acquired;
+    }
+
+    case pubsub::FullPublisherAction::kBlock:
+      break;
+  }
+
+  auto const start = std::chrono::steady_clock::now();
+  flow_control_->BlockStarted();
+  for (;;) {
+    // Read the generation first, so a release after `TryAcquire()` fails is
+    // not missed.
+    auto const generation = flow_control_->generation();
+    if (flow_control_->TryAcquire(bytes)) break;
+    // Do not wait for the maximum hold time, the pending messages cannot
+    // complete until they are sent.
+    if (!pending_.empty() && !batch_in_flight_) {
+      Flush(std::move(lk));
+      lk = std::unique_lock<std::mutex>(mu_);
+      continue;
+    }
+    lk.unlock();
+    flow_control_->WaitForRelease(generation);
+    lk.lock();
+  }
+  flow_control_->BlockFinished(std::chrono::steady_clock::now() - start);
+  return true;
+}
+
+void BatchingPublisherConnection::OnBatchCompleted(std::size_t messages,
+                                                   std::size_t bytes,
+                                                   Status const& status) {
+  std::unique_lock<std::mutex> lk(mu_);
+  flow_control_->Release(messages, bytes);
+  batch_in_flight_ = false;
+  if (!options_.message_ordering()) return;
+  if (status.ok()) {
+    // Send any messages that queued up behind the completed batch.
     Flush(std::move(lk));
     return;
   }
-  auto const bytes = std::accumulate(
-      pending_.begin(), pending_.end(), std::size_t{0},
-      [](std::size_t a, Item const& b) { return a + b.message.data().size(); });
-  if (bytes >= batching_config_.maximum_batch_bytes()) {
+  // Sending the pending (or any new) messages would break the ordering
+  // guarantees, reject them until the application calls `ResumePublish()`.
+  paused_status_ = Status(
+      StatusCode::kFailedPrecondition,
+      "publishing paused for ordering key after a previous error (" +
+          status.message() + "), call ResumePublish() to continue");
+  std::vector<Item> rejected;
+  rejected.swap(pending_);
+  pending_request_.clear_messages();
+  pending_bytes_ = 0;
+  std::size_t rejected_bytes = 0;
+  for (auto const& i : rejected) rejected_bytes += i.bytes;
+  flow_control_->Release(rejected.size(), rejected_bytes);
+  auto paused = paused_status_;
+  lk.unlock();
+  FailItems(std::move(rejected), paused);
+}
+
+Status BatchingPublisherConnection::DroppedStatus() {
+  return Status(StatusCode::kResourceExhausted,
+                "message dropped by publisher flow control");
+}
+
+void BatchingPublisherConnection::FailItems(std::vector<Item> items,
+                                            Status const& status) {
+  struct SetStatus {
+    promise<StatusOr<std::string>> waiter;
+    Status status;
+    void operator()() { waiter.set_value(std::move(status)); }
+  };
+  for (auto& i : items) cq_.RunAsync(SetStatus{std::move(i.response), status});
+}
+
+bool BatchingPublisherConnection::ShouldCompress(std::size_t bytes) {
+  if (!options_.compression() || bytes < options_.compression_threshold()) {
+    return false;
+  }
+  return compression_->TryCompress();
+}
+
+void BatchingPublisherConnection::MaybeFlush(std::unique_lock<std::mutex> lk) {
+  if (pending_.size() >= batching_config_.maximum_message_count() ||
+      pending_bytes_ >= batching_config_.maximum_batch_bytes()) {
     Flush(std::move(lk));
     return;
   }
@@ -120,24 +365,64 @@ void BatchingPublisherConnection::OnTimer() {
 
 void BatchingPublisherConnection::Flush(std::unique_lock<std::mutex> lk) {
   if (pending_.empty()) return;
+  // With message ordering only one batch may be in flight, the next batch is
+  // sent once the current one completes.
+  if (batch_in_flight_) return;
+  batch_in_flight_ = options_.message_ordering();
+  // The pending messages can exceed the batch limits while waiting for the
+  // batch in flight. Like `MaybeFlush()`, close the batch once it reaches
+  // either limit.
+  auto const max_count =
+      (std::max<std::size_t>)(batching_config_.maximum_message_count(), 1);
+  auto const max_bytes = batching_config_.maximum_batch_bytes();
+  std::size_t count = 0;
+  std::size_t batch_bytes = 0;
+  while (count != pending_.size() && count != max_count &&
+         (count == 0 || batch_bytes < max_bytes)) {
+    batch_bytes += pending_[count++].bytes;
+  }
 
   auto context = absl::make_unique<grpc::ClientContext>();
 
   Batch batch;
   batch.executor = cq_;
-  batch.waiters.reserve(pending_.size());
-  google::pubsub::v1::PublishRequest request;
-  request.set_topic(topic_full_name_);
-  request.mutable_messages()->Reserve(static_cast<int>(pending_.size()));
+  batch.publisher = shared_from_this();
+  batch.waiters.reserve(count);
+  auto const end = pending_.begin() + count;
+  for (auto i = pending_.begin(); i != end; ++i) {
+    batch.waiters.push_back(std::move(i->response));
+    batch.bytes += i->bytes;
+  }
+  pending_.erase(pending_.begin(), end);
+  pending_bytes_ -= batch.bytes;
 
-  for (auto& i : pending_) {
-    batch.waiters.push_back(std::move(i.response));
-    *request.add_messages() = pubsub_internal::ToProto(std::move(i.message));
+  // The messages are added to `pending_request_` as they are published, in
+  // the common case the whole request is sent without copying any messages.
+  google::pubsub::v1::PublishRequest request;
+  if (pending_.empty()) {
+    request.Swap(&pending_request_);
+  } else {
+    auto& messages = *pending_request_.mutable_messages();
+    for (int i = 0; i != static_cast<int>(count); ++i) {
+      request.add_messages()->Swap(messages.Mutable(i));
+    }
+    messages.DeleteSubrange(0, static_cast<int>(count));
   }
-  pending_.clear();
+  request.set_topic(topic_full_name_);
+  auto const bytes = batch.bytes;
+  auto const compress = ShouldCompress(bytes);
   lk.unlock();
 
-  stub_->AsyncPublish(cq_, std::move(context), request).then(std::move(batch));
+  if (!compress) {
+    stub_->AsyncPublish(cq_, std::move(context), request)
+        .then(std::move(batch));
+    return;
+  }
+  context->set_compression_algorithm(options_.compression_algorithm());
+  auto const start = std::chrono::steady_clock::now();
+  auto f = stub_->AsyncPublish(cq_, std::move(context), request);
+  compression_->OnCompressed(bytes, std::chrono::steady_clock::now() - start);
+  f.then(std::move(batch));
 }
 
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
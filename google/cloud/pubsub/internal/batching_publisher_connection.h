@@ -17,6 +17,10 @@
 
 #include "google/cloud/pubsub/publisher_connection.h"
 #include "google/cloud/pubsub/version.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 
 namespace google {
@@ -24,32 +28,185 @@ namespace cloud {
 namespace pubsub_internal {
 inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
 
+/// The flow control counters for a `PublisherFlowControl`.
+using PublisherFlowControlMetrics = pubsub::PublisherFlowControlMetrics;
+
+/// The compression counters for a `PublisherCompressionBudget`.
+using PublisherCompressionMetrics = pubsub::PublisherCompressionMetrics;
+
+/**
+ * The flow control budget for one or more `BatchingPublisherConnection`.
+ *
+ * A publisher may use several batching connections, one for each channel and
+ * one for each ordering key. They share a single budget, so the limits in
+ * `PublisherOptions` apply to the publisher as a whole.
+ */
+class PublisherFlowControl {
+ public:
+  PublisherFlowControl(std::size_t max_messages, std::size_t max_bytes)
+      : max_messages_(max_messages), max_bytes_(max_bytes) {}
+
+  /// Reserves the budget for a message of @p bytes, if there is capacity.
+  bool TryAcquire(std::size_t bytes);
+
+  /// Returns the budget of messages that completed or failed.
+  void Release(std::size_t messages, std::size_t bytes);
+
+  /// Returns the budget of a pending message dropped to make room.
+  void Drop(std::size_t bytes);
+
+  /// Counts a message rejected because there was no capacity.
+  void Reject();
+
+  /// Called when a caller starts waiting for capacity.
+  void BlockStarted();
+
+  /// Called when a caller, blocked for @p elapsed, obtains the capacity.
+  void BlockFinished(std::chrono::steady_clock::duration elapsed);
+
+  /// Incremented on each `Release()`.
+  std::uint64_t generation();
+
+  /// Blocks until `generation()` is different from @p generation.
+  void WaitForRelease(std::uint64_t generation);
+
+  /// Returns a snapshot of the counters.
+  PublisherFlowControlMetrics metrics();
+
+ private:
+  std::size_t const max_messages_;
+  std::size_t const max_bytes_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  PublisherFlowControlMetrics metrics_;
+  std::uint64_t generation_ = 0;
+};
+
+/**
+ * The compression CPU budget for one or more `BatchingPublisherConnection`.
+ *
+ * Like `PublisherFlowControl`, the batching connections of a publisher share
+ * a single budget, so `PublisherOptions::compression_cpu_budget()` applies to
+ * the publisher as a whole.
+ */
+class PublisherCompressionBudget {
+ public:
+  explicit PublisherCompressionBudget(double cpu_budget)
+      : cpu_budget_(cpu_budget) {}
+
+  /// Returns true if the budget allows compressing one more batch.
+  bool TryCompress();
+
+  /// Charges the budget for a batch of @p bytes compressed in @p elapsed.
+  void OnCompressed(std::size_t bytes,
+                    std::chrono::steady_clock::duration elapsed);
+
+  /// Returns a snapshot of the counters.
+  PublisherCompressionMetrics metrics();
+
+ private:
+  double const cpu_budget_;
+  std::mutex mu_;
+  PublisherCompressionMetrics metrics_;
+  // The time spent compressing batches in the current one second interval.
+  std::chrono::steady_clock::time_point interval_start_;
+  std::chrono::steady_clock::duration interval_time_{0};
+};
+
+struct Batch;
+
+/**
+ * Publishes messages in batches, using a single `PublisherStub`.
+ *
+ * With `PublisherOptions::message_ordering()` enabled all the messages must
+ * share an ordering key. The connection then sends at most one batch at a
+ * time, and stops publishing after the first error, until the application
+ * calls `ResumePublish()`.
+ */
 class BatchingPublisherConnection
     : public pubsub::PublisherConnection,
       public std::enable_shared_from_this<BatchingPublisherConnection> {
  public:
   static std::shared_ptr<BatchingPublisherConnection> Create(
-      pubsub::Topic topic, pubsub::BatchingConfig batching_config,
+      pubsub::Topic topic, pubsub::PublisherOptions options,
       std::shared_ptr<pubsub_internal::PublisherStub> stub,
       google::cloud::CompletionQueue cq) {
+    auto flow_control = std::make_shared<PublisherFlowControl>(
+        options.max_outstanding_messages(), options.max_outstanding_bytes());
+    return Create(std::move(topic), std::move(options), std::move(stub),
+                  std::move(cq), std::move(flow_control));
+  }
+
+  /**
+   * Creates a connection that shares @p flow_control with other connections.
+   *
+   * The connection also shares @p compression, if provided, otherwise it uses
+   * its own compression budget.
+   */
+  static std::shared_ptr<BatchingPublisherConnection> Create(
+      pubsub::Topic topic, pubsub::PublisherOptions options,
+      std::shared_ptr<pubsub_internal::PublisherStub> stub,
+      google::cloud::CompletionQueue cq,
+      std::shared_ptr<PublisherFlowControl> flow_control,
+      std::shared_ptr<PublisherCompressionBudget> compression = {}) {
+    if (!compression) {
+      compression = std::make_shared<PublisherCompressionBudget>(
+          options.compression_cpu_budget());
+    }
     return std::shared_ptr<BatchingPublisherConnection>(
-        new BatchingPublisherConnection(std::move(topic),
-                                        std::move(batching_config),
-                                        std::move(stub), std::move(cq)));
+        new BatchingPublisherConnection(
+            std::move(topic), std::move(options), std::move(stub),
+            std::move(cq), std::move(flow_control), std::move(compression)));
+  }
+
+  static std::shared_ptr<BatchingPublisherConnection> Create(
+      pubsub::Topic topic, pubsub::BatchingConfig batching_config,
+      std::shared_ptr<pubsub_internal::PublisherStub> stub,
+      google::cloud::CompletionQueue cq) {
+    return Create(
+        std::move(topic),
+        pubsub::PublisherOptions{}.set_batching_config(
+            std::move(batching_config)),
+        std::move(stub), std::move(cq));
   }
 
   future<StatusOr<std::string>> Publish(PublishParams p) override;
+  void ResumePublish(ResumePublishParams p) override;
+
+  /// Returns the counters of the budgets shared with any other connections.
+  PublisherFlowControlMetrics GetFlowControlMetrics() override;
+  PublisherCompressionMetrics GetCompressionMetrics() override;
 
  private:
+  friend struct Batch;
+
   explicit BatchingPublisherConnection(
-      pubsub::Topic topic, pubsub::BatchingConfig batching_config,
+      pubsub::Topic topic, pubsub::PublisherOptions options,
       std::shared_ptr<pubsub_internal::PublisherStub> stub,
-      google::cloud::CompletionQueue cq)
+      google::cloud::CompletionQueue cq,
+      std::shared_ptr<PublisherFlowControl> flow_control,
+      std::shared_ptr<PublisherCompressionBudget> compression)
       : topic_(std::move(topic)),
         topic_full_name_(topic_.FullName()),
-        batching_config_(std::move(batching_config)),
+        options_(std::move(options)),
+        batching_config_(options_.batching_config()),
         stub_(std::move(stub)),
-        cq_(std::move(cq)) {}
+        cq_(std::move(cq)),
+        flow_control_(std::move(flow_control)),
+        compression_(std::move(compression)) {}
+
+  struct Item {
+    promise<StatusOr<std::string>> response;
+    std::size_t bytes;
+  };
+
+  bool MakeCapacity(std::unique_lock<std::mutex>& lk, std::size_t bytes,
+                    std::vector<Item>& dropped);
+  void OnBatchCompleted(std::size_t messages, std::size_t bytes,
+                        Status const& status);
+  static Status DroppedStatus();
+  void FailItems(std::vector<Item> items, Status const& status);
+  bool ShouldCompress(std::size_t bytes);
 
   void OnTimer();
   void MaybeFlush(std::unique_lock<std::mutex> lk);
@@ -57,17 +214,24 @@ class BatchingPublisherConnection
 
   pubsub::Topic topic_;
   std::string topic_full_name_;
+  pubsub::PublisherOptions options_;
   pubsub::BatchingConfig batching_config_;
   std::shared_ptr<pubsub_internal::PublisherStub> stub_;
   google::cloud::CompletionQueue cq_;
+  std::shared_ptr<PublisherFlowControl> flow_control_;
+  std::shared_ptr<PublisherCompressionBudget> compression_;
 
   std::mutex mu_;
-  struct Item {
-    promise<StatusOr<std::string>> response;
-    pubsub::Message message;
-  };
   std::vector<Item> pending_;
+  // The pending messages, in the same order as `pending_`, and their total
+  // serialized size.
+  google::pubsub::v1::PublishRequest pending_request_;
+  std::size_t pending_bytes_ = 0;
   std::chrono::system_clock::time_point batch_expiration_;
+  // Only used with message ordering, where at most one batch is in flight and
+  // any failure pauses publishing until `ResumePublish()` is called.
+  bool batch_in_flight_ = false;
+  Status paused_status_;
 };
 
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
@@ -26,6 +26,7 @@ inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
 namespace {
 
 using ::testing::_;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 
 TEST(BatchingPublisherConnectionTest, DefaultMakesProgress) {
@@ -183,6 +184,48 @@ TEST(BatchingPublisherConnectionTest, BatchByMessageSize) {
   t.join();
 }
 
+TEST(BatchingPublisherConnectionTest, BatchSizeIncludesAttributes) {
+  auto mock = std::make_shared<pubsub_testing::MockPublisherStub>();
+  pubsub::Topic const topic("test-project", "test-topic");
+
+  EXPECT_CALL(*mock, AsyncPublish(_, _, _))
+      .WillOnce([&](google::cloud::CompletionQueue&,
+                    std::unique_ptr<grpc::ClientContext>,
+                    google::pubsub::v1::PublishRequest const& request) {
+        EXPECT_EQ(topic.FullName(), request.topic());
+        EXPECT_EQ(1, request.messages_size());
+        EXPECT_EQ("test-data-0", request.messages(0).data());
+        google::pubsub::v1::PublishResponse response;
+        response.add_message_ids("test-message-id-0");
+        return make_ready_future(make_status_or(response));
+      });
+
+  // The data is small, but the attributes push the message over the limit, so
+  // the batch is sent right away, without waiting for the maximum hold time.
+  google::cloud::CompletionQueue cq;
+  auto publisher = BatchingPublisherConnection::Create(
+      topic,
+      pubsub::BatchingConfig{}
+          .set_maximum_hold_time(std::chrono::hours(1))
+          .set_maximum_message_count(4)
+          .set_maximum_batch_bytes(64),
+      mock, cq);
+  auto r0 = publisher->Publish(
+      {pubsub::MessageBuilder{}
+           .SetData("test-data-0")
+           .SetAttributes({{"test-key", std::string(64, 'v')}})
+           .Build()});
+  ASSERT_TRUE(::testing::Mock::VerifyAndClearExpectations(mock.get()));
+
+  std::thread t([&cq] { cq.Run(); });
+  auto id = r0.get();
+  ASSERT_STATUS_OK(id);
+  EXPECT_EQ("test-message-id-0", *id);
+
+  cq.Shutdown();
+  t.join();
+}
+
 TEST(BatchingPublisherConnectionTest, BatchByMaximumHoldTime) {
   auto mock = std::make_shared<pubsub_testing::MockPublisherStub>();
   pubsub::Topic const topic("test-project", "test-topic");
@@ -304,6 +347,657 @@ TEST(BatchingPublisherConnectionTest, HandleInvalidResponse) {
   r1.get();
 }
 
+/// A helper to keep publish requests in flight until the test completes them.
+class PendingPublishes {
+ public:
+  future<StatusOr<google::pubsub::v1::PublishResponse>> Push(
+      google::pubsub::v1::PublishRequest const& request) {
+    std::lock_guard<std::mutex> lk(mu_);
+    promise<StatusOr<google::pubsub::v1::PublishResponse>> p;
+    auto f = p.get_future();
+    pending_.push_back(Pending{std::move(p), request});
+    return f;
+  }
+
+  /// Completes the oldest request, setting a message id for each message.
+  void CompleteOldest() {
+    std::unique_lock<std::mutex> lk(mu_);
+    auto p = std::move(pending_.front());
+    pending_.erase(pending_.begin());
+    lk.unlock();
+    google::pubsub::v1::PublishResponse response;
+    for (auto const& m : p.request.messages()) {
+      response.add_message_ids("id-" + m.data());
+    }
+    p.response.set_value(std::move(response));
+  }
+
+  /// Fails the oldest request with @p status.
+  void FailOldest(Status status) {
+    std::unique_lock<std::mutex> lk(mu_);
+    auto p = std::move(pending_.front());
+    pending_.erase(pending_.begin());
+    lk.unlock();
+    p.response.set_value(std::move(status));
+  }
+
+  /// Returns the data of each message in the oldest request.
+  std::vector<std::string> OldestData() {
+    std::lock_guard<std::mutex> lk(mu_);
+    std::vector<std::string> data;
+    for (auto const& m : pending_.front().request.messages()) {
+      data.push_back(m.data());
+    }
+    return data;
+  }
+
+  std::size_t size() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return pending_.size();
+  }
+
+ private:
+  struct Pending {
+    promise<StatusOr<google::pubsub::v1::PublishResponse>> response;
+    google::pubsub::v1::PublishRequest request;
+  };
+  std::mutex mu_;
+  std::vector<Pending> pending_;
+};
+
+TEST(BatchingPublisherConnectionTest, FlowControlReject) {
+  auto mock = std::make_shared<pubsub_testing::MockPublisherStub>();
+  pubsub::Topic const topic("test-project", "test-topic");
+
+  PendingPublishes pending;
+  EXPECT_CALL(*mock, AsyncPublish(_, _, _))
+      .WillRepeatedly([&](google::cloud::CompletionQueue&,
+                          std::unique_ptr<grpc::ClientContext>,
+                          google::pubsub::v1::PublishRequest const& request) {
+        return pending.Push(request);
+      });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto publisher = BatchingPublisherConnection::Create(
+      topic,
+      pubsub::PublisherOptions{}
+          .set_batching_config(
+              pubsub::BatchingConfig{}.set_maximum_message_count(1))
+          .set_max_outstanding_messages(2)
+          .set_full_publisher_action(pubsub::FullPublisherAction::kReject),
+      mock, bg.cq());
+
+  auto r0 = publisher->Publish(
+      {pubsub::MessageBuilder{}.SetData("test-data-0").Build()});
+  auto r1 = publisher->Publish(
+      {pubsub::MessageBuilder{}.SetData("test-data-1").Build()});
+  auto r2 = publisher->Publish(
+      {pubsub::MessageBuilder{}.SetData("test-data-2").Build()});
+  EXPECT_EQ(StatusCode::kResourceExhausted, r2.get().status().code());
+
+  auto metrics = publisher->GetFlowControlMetrics();
+  EXPECT_EQ(2, metrics.outstanding_messages);
+  auto const message_size =
+      ToProto(pubsub::MessageBuilder{}.SetData("test-data-N").Build())
+          .ByteSizeLong();
+  EXPECT_EQ(2 * message_size, metrics.outstanding_bytes);
+  EXPECT_EQ(1, metrics.rejected_messages);
+
+  ASSERT_EQ(2, pending.size());
+  pending.CompleteOldest();
+  auto id = r0.get();
+  ASSERT_STATUS_OK(id);
+  EXPECT_EQ("id-test-data-0", *id);
+
+  // With the first message completed there is room for another message.
+  auto r3 = publisher->Publish(
+      {pubsub::MessageBuilder{}.SetData("test-data-3").Build()});
+  pending.CompleteOldest();
+  pending.CompleteOldest();
+  id = r1.get();
+  ASSERT_STATUS_OK(id);
+  EXPECT_EQ("id-test-data-1", *id);
+  id = r3.get();
+  ASSERT_STATUS_OK(id);
+  EXPECT_EQ("id-test-data-3", *id);
+
+  metrics = publisher->GetFlowControlMetrics();
+  EXPECT_EQ(0, metrics.outstanding_messages);
+  EXPECT_EQ(0, metrics.outstanding_bytes);
+  EXPECT_EQ(1, metrics.rejected_messages);
+}
+
+TEST(BatchingPublisherConnectionTest, FlowControlRejectLargeMessage) {
+  auto mock = std::make_shared<pubsub_testing::MockPublisherStub>();
+  pubsub::Topic const topic("test-project", "test-topic");
+
+  PendingPublishes pending;
+  EXPECT_CALL(*mock, AsyncPublish(_, _, _))
+      .WillRepeatedly([&](google::cloud::CompletionQueue&,
+                          std::unique_ptr<grpc::ClientContext>,
+                          google::pubsub::v1::PublishRequest const& request) {
+        return pending.Push(request);
+      });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto publisher = BatchingPublisherConnection::Create(
+      topic,
+      pubsub::PublisherOptions{}
+          .set_batching_config(
+              pubsub::BatchingConfig{}.set_maximum_message_count(1))
+          .set_max_outstanding_bytes(4)
+          .set_full_publisher_action(pubsub::FullPublisherAction::kReject),
+      mock, bg.cq());
+
+  // A message larger than the limit is accepted when nothing is outstanding.
+  auto r0 = publisher->Publish(
+      {pubsub::MessageBuilder{}.SetData("test-data-0").Build()});
+  auto r1 = publisher->Publish({pubsub::MessageBuilder{}.SetData("1").Build()});
+  EXPECT_EQ(StatusCode::kResourceExhausted, r1.get().status().code());
+
+  pending.CompleteOldest();
+  ASSERT_STATUS_OK(r0.get());
+  auto r2 = publisher->Publish({pubsub::MessageBuilder{}.SetData("2").Build()});
+  pending.CompleteOldest();
+  ASSERT_STATUS_OK(r2.get());
+}
+
+TEST(BatchingPublisherConnectionTest, FlowControlDropOldest) {
+  auto mock = std::make_shared<pubsub_testing::MockPublisherStub>();
+  pubsub::Topic const topic("test-project", "test-topic");
+
+  EXPECT_CALL(*mock, AsyncPublish(_, _, _))
+      .WillOnce([&](google::cloud::CompletionQueue&,
+                    std::unique_ptr<grpc::ClientContext>,
+                    google::pubsub::v1::PublishRequest const& request) {
+        EXPECT_EQ(2, request.messages_size());
+        EXPECT_EQ("test-data-1", request.messages(0).data());
+        EXPECT_EQ("test-data-2", request.messages(1).data());
+        google::pubsub::v1::PublishResponse response;
+        response.add_message_ids("test-message-id-1");
+        response.add_message_ids("test-message-id-2");
+        return make_ready_future(make_status_or(response));
+      });
+
+  // Use our own completion queue, initially inactive, so the messages stay in
+  // the pending batch until the maximum hold time expires.
+  google::cloud::CompletionQueue cq;
+  auto publisher = BatchingPublisherConnection::Create(
+      topic,
+      pubsub::PublisherOptions{}
+          .set_batching_config(
+              pubsub::BatchingConfig{}
+                  .set_maximum_hold_time(std::chrono::milliseconds(5))
+                  .set_maximum_message_count(4))
+          .set_max_outstanding_messages(2)
+          .set_full_publisher_action(pubsub::FullPublisherAction::kDropOldest),
+      mock, cq);
+
+  auto r0 = publisher->Publish(
+      {pubsub::MessageBuilder{}.SetData("test-data-0").Build()});
+  auto r1 = publisher->Publish(
+      {pubsub::MessageBuilder{}.SetData("test-data-1").Build()});
+  auto r2 = publisher->Publish(
+      {pubsub::MessageBuilder{}.SetData("test-data-2").Build()});
+  auto metrics = publisher->GetFlowControlMetrics();
+  EXPECT_EQ(2, metrics.outstanding_messages);
+  EXPECT_EQ(1, metrics.dropped_messages);
+  EXPECT_EQ(0, metrics.rejected_messages);
+
+  std::thread t([&cq] { cq.Run(); });
+
+  EXPECT_EQ(StatusCode::kResourceExhausted, r0.get().status().code());
+  auto id = r1.get();
+  ASSERT_STATUS_OK(id);
+  EXPECT_EQ("test-message-id-1", *id);
+  id = r2.get();
+  ASSERT_STATUS_OK(id);
+  EXPECT_EQ("test-message-id-2", *id);
+  EXPECT_EQ(0, publisher->GetFlowControlMetrics().outstanding_messages);
+
+  cq.Shutdown();
+  t.join();
+}
+
+TEST(BatchingPublisherConnectionTest, FlowControlBlock) {
+  auto mock = std::make_shared<pubsub_testing::MockPublisherStub>();
+  pubsub::Topic const topic("test-project", "test-topic");
+
+  PendingPublishes pending;
+  EXPECT_CALL(*mock, AsyncPublish(_, _, _))
+      .WillRepeatedly([&](google::cloud::CompletionQueue&,
+                          std::unique_ptr<grpc::ClientContext>,
+                          google::pubsub::v1::PublishRequest const& request) {
+        return pending.Push(request);
+      });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto publisher = BatchingPublisherConnection::Create(
+      topic,
+      pubsub::PublisherOptions{}
+          .set_batching_config(
+              pubsub::BatchingConfig{}
+                  .set_maximum_hold_time(std::chrono::milliseconds(5))
+                  .set_maximum_message_count(4))
+          .set_max_outstanding_messages(1)
+          .set_full_publisher_action(pubsub::FullPublisherAction::kBlock),
+      mock, bg.cq());
+
+  auto r0 = publisher->Publish(
+      {pubsub::MessageBuilder{}.SetData("test-data-0").Build()});
+  std::thread t([&publisher] {
+    auto r1 = publisher->Publish(
+        {pubsub::MessageBuilder{}.SetData("test-data-1").Build()});
+    auto id = r1.get();
+    ASSERT_STATUS_OK(id);
+    EXPECT_EQ("id-test-data-1", *id);
+  });
+
+  for (int i = 0; i != 100; ++i) {
+    if (publisher->GetFlowControlMetrics().blocked_publishers == 1 &&
+        pending.size() == 1) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  auto metrics = publisher->GetFlowControlMetrics();
+  EXPECT_EQ(1, metrics.blocked_publishers);
+  EXPECT_EQ(1, metrics.outstanding_messages);
+  ASSERT_EQ(1, pending.size());
+
+  pending.CompleteOldest();
+  auto id = r0.get();
+  ASSERT_STATUS_OK(id);
+  EXPECT_EQ("id-test-data-0", *id);
+
+  for (int i = 0; i != 100 && pending.size() != 1; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_EQ(1, pending.size());
+  pending.CompleteOldest();
+  t.join();
+
+  metrics = publisher->GetFlowControlMetrics();
+  EXPECT_EQ(0, metrics.blocked_publishers);
+  EXPECT_EQ(0, metrics.outstanding_messages);
+  EXPECT_LT(0, metrics.blocked_time.count());
+}
+
+TEST(BatchingPublisherConnectionTest, FlowControlBlockShared) {
+  auto mock = std::make_shared<pubsub_testing::MockPublisherStub>();
+  pubsub::Topic const topic("test-project", "test-topic");
+
+  PendingPublishes pending;
+  EXPECT_CALL(*mock, AsyncPublish(_, _, _))
+      .WillRepeatedly([&](google::cloud::CompletionQueue&,
+                          std::unique_ptr<grpc::ClientContext>,
+                          google::pubsub::v1::PublishRequest const& request) {
+        return pending.Push(request);
+      });
+
+  // Both connections share the budget, so the second one blocks until the
+  // message published by the first one completes.
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto const options =
+      pubsub::PublisherOptions{}
+          .set_batching_config(
+              pubsub::BatchingConfig{}.set_maximum_message_count(1))
+          .set_max_outstanding_messages(1)
+          .set_full_publisher_action(pubsub::FullPublisherAction::kBlock);
+  auto flow_control = std::make_shared<PublisherFlowControl>(
+      options.max_outstanding_messages(), options.max_outstanding_bytes());
+  auto p0 = BatchingPublisherConnection::Create(topic, options, mock, bg.cq(),
+                                                flow_control);
+  auto p1 = BatchingPublisherConnection::Create(topic, options, mock, bg.cq(),
+                                                flow_control);
+
+  auto r0 =
+      p0->Publish({pubsub::MessageBuilder{}.SetData("test-data-0").Build()});
+  std::thread t([&p1] {
+    auto r1 =
+        p1->Publish({pubsub::MessageBuilder{}.SetData("test-data-1").Build()});
+    auto id = r1.get();
+    ASSERT_STATUS_OK(id);
+    EXPECT_EQ("id-test-data-1", *id);
+  });
+
+  for (int i = 0;
+       i != 100 && p1->GetFlowControlMetrics().blocked_publishers != 1; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(1, p1->GetFlowControlMetrics().blocked_publishers);
+  // The counters belong to the shared budget, not to each connection.
+  EXPECT_EQ(1, p0->GetFlowControlMetrics().blocked_publishers);
+  EXPECT_EQ(1, p0->GetFlowControlMetrics().outstanding_messages);
+  ASSERT_EQ(1, pending.size());
+
+  pending.CompleteOldest();
+  auto id = r0.get();
+  ASSERT_STATUS_OK(id);
+  EXPECT_EQ("id-test-data-0", *id);
+
+  for (int i = 0; i != 100 && pending.size() != 1; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_EQ(1, pending.size());
+  pending.CompleteOldest();
+  t.join();
+  EXPECT_EQ(0, p1->GetFlowControlMetrics().blocked_publishers);
+}
+
+TEST(BatchingPublisherConnectionTest, OrderingOneBatchInFlight) {
+  auto mock = std::make_shared<pubsub_testing::MockPublisherStub>();
+  pubsub::Topic const topic("test-project", "test-topic");
+
+  PendingPublishes pending;
+  EXPECT_CALL(*mock, AsyncPublish(_, _, _))
+      .WillRepeatedly([&](google::cloud::CompletionQueue&,
+                          std::unique_ptr<grpc::ClientContext>,
+                          google::pubsub::v1::PublishRequest const& request) {
+        return pending.Push(request);
+      });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto publisher = BatchingPublisherConnection::Create(
+      topic,
+      pubsub::PublisherOptions{}
+          .set_batching_config(
+              pubsub::BatchingConfig{}.set_maximum_message_count(2))
+          .enable_message_ordering(),
+      mock, bg.cq());
+
+  std::vector<future<StatusOr<std::string>>> results;
+  for (auto const* data : {"d0", "d1", "d2", "d3", "d4"}) {
+    results.push_back(publisher->Publish({pubsub::MessageBuilder{}
+                                              .SetData(data)
+                                              .SetOrderingKey("k")
+                                              .Build()}));
+  }
+
+  // Only the first batch is sent, the rest wait for it to complete, and are
+  // then sent in order, respecting the batch size limits.
+  ASSERT_EQ(1, pending.size());
+  EXPECT_THAT(pending.OldestData(), ElementsAre("d0", "d1"));
+  pending.CompleteOldest();
+  ASSERT_EQ(1, pending.size());
+  EXPECT_THAT(pending.OldestData(), ElementsAre("d2", "d3"));
+  pending.CompleteOldest();
+  ASSERT_EQ(1, pending.size());
+  EXPECT_THAT(pending.OldestData(), ElementsAre("d4"));
+  pending.CompleteOldest();
+  EXPECT_EQ(0, pending.size());
+
+  for (auto const* data : {"d0", "d1", "d2", "d3", "d4"}) {
+    auto id = results.front().get();
+    results.erase(results.begin());
+    ASSERT_STATUS_OK(id);
+    EXPECT_EQ(std::string("id-") + data, *id);
+  }
+}
+
+TEST(BatchingPublisherConnectionTest, OrderingBatchByMessageSize) {
+  auto mock = std::make_shared<pubsub_testing::MockPublisherStub>();
+  pubsub::Topic const topic("test-project", "test-topic");
+
+  PendingPublishes pending;
+  EXPECT_CALL(*mock, AsyncPublish(_, _, _))
+      .WillRepeatedly([&](google::cloud::CompletionQueue&,
+                          std::unique_ptr<grpc::ClientContext>,
+                          google::pubsub::v1::PublishRequest const& request) {
+        return pending.Push(request);
+      });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto publisher = BatchingPublisherConnection::Create(
+      topic,
+      pubsub::PublisherOptions{}
+          .set_batching_config(pubsub::BatchingConfig{}
+                                   .set_maximum_message_count(100)
+                                   .set_maximum_batch_bytes(3 * 1024))
+          .enable_message_ordering(),
+      mock, bg.cq());
+
+  // Each message is slightly larger than 1 KiB, so three of them reach the
+  // batch size limit.
+  std::vector<future<StatusOr<std::string>>> results;
+  for (char c = 'a'; c != 'k'; ++c) {
+    results.push_back(publisher->Publish({pubsub::MessageBuilder{}
+                                              .SetData(std::string(1024, c))
+                                              .SetOrderingKey("k")
+                                              .Build()}));
+  }
+
+  // The messages queued behind the batch in flight are sent in batches of the
+  // same size, not in a single batch limited only by the message count.
+  auto oldest_keys = [&pending] {
+    std::string keys;
+    for (auto const& data : pending.OldestData()) keys.push_back(data[0]);
+    return keys;
+  };
+  for (auto const* expected : {"abc", "def", "ghi", "j"}) {
+    ASSERT_EQ(1, pending.size());
+    EXPECT_EQ(expected, oldest_keys());
+    pending.CompleteOldest();
+  }
+  EXPECT_EQ(0, pending.size());
+  for (auto& r : results) EXPECT_STATUS_OK(r.get());
+}
+
+TEST(BatchingPublisherConnectionTest, OrderingPausedOnError) {
+  auto mock = std::make_shared<pubsub_testing::MockPublisherStub>();
+  pubsub::Topic const topic("test-project", "test-topic");
+
+  PendingPublishes pending;
+  EXPECT_CALL(*mock, AsyncPublish(_, _, _))
+      .WillRepeatedly([&](google::cloud::CompletionQueue&,
+                          std::unique_ptr<grpc::ClientContext>,
+                          google::pubsub::v1::PublishRequest const& request) {
+        return pending.Push(request);
+      });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto publisher = BatchingPublisherConnection::Create(
+      topic,
+      pubsub::PublisherOptions{}
+          .set_batching_config(
+              pubsub::BatchingConfig{}.set_maximum_message_count(1))
+          .enable_message_ordering(),
+      mock, bg.cq());
+  auto make_message = [](std::string data) {
+    return pubsub::MessageBuilder{}
+        .SetData(std::move(data))
+        .SetOrderingKey("k")
+        .Build();
+  };
+
+  auto r0 = publisher->Publish({make_message("d0")});
+  auto r1 = publisher->Publish({make_message("d1")});
+  ASSERT_EQ(1, pending.size());
+  pending.FailOldest(Status(StatusCode::kPermissionDenied, "uh-oh"));
+  EXPECT_EQ(StatusCode::kPermissionDenied, r0.get().status().code());
+  // The pending message is rejected, and so are any new messages.
+  auto s1 = r1.get().status();
+  EXPECT_EQ(StatusCode::kFailedPrecondition, s1.code());
+  EXPECT_THAT(s1.message(), HasSubstr("uh-oh"));
+  EXPECT_EQ(StatusCode::kFailedPrecondition,
+            publisher->Publish({make_message("d2")}).get().status().code());
+  EXPECT_EQ(0, pending.size());
+  EXPECT_EQ(0, publisher->GetFlowControlMetrics().outstanding_messages);
+
+  publisher->ResumePublish({"k"});
+  auto r3 = publisher->Publish({make_message("d3")});
+  ASSERT_EQ(1, pending.size());
+  pending.CompleteOldest();
+  auto id = r3.get();
+  ASSERT_STATUS_OK(id);
+  EXPECT_EQ("id-d3", *id);
+}
+
+TEST(BatchingPublisherConnectionTest, PayloadIsNotCopied) {
+  auto mock = std::make_shared<pubsub_testing::MockPublisherStub>();
+  pubsub::Topic const topic("test-project", "test-topic");
+
+  // Use payloads larger than any small string optimization buffer.
+  std::vector<std::string> payloads{std::string(4096, 'a'),
+                                    std::string(4096, 'b')};
+  std::vector<char const*> buffers;
+  for (auto const& p : payloads) buffers.push_back(p.data());
+
+  EXPECT_CALL(*mock, AsyncPublish(_, _, _))
+      .WillOnce([&](google::cloud::CompletionQueue&,
+                    std::unique_ptr<grpc::ClientContext>,
+                    google::pubsub::v1::PublishRequest const& request) {
+        EXPECT_EQ(2, request.messages_size());
+        for (int i = 0; i != request.messages_size(); ++i) {
+          EXPECT_EQ(buffers[i], request.messages(i).data().data());
+        }
+        google::pubsub::v1::PublishResponse response;
+        response.add_message_ids("id-0");
+        response.add_message_ids("id-1");
+        return make_ready_future(make_status_or(response));
+      });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto publisher = BatchingPublisherConnection::Create(
+      topic, pubsub::BatchingConfig{}.set_maximum_message_count(2), mock,
+      bg.cq());
+  auto r0 = publisher->Publish(
+      {pubsub::MessageBuilder{}.SetData(std::move(payloads[0])).Build()});
+  auto r1 = publisher->Publish(
+      {pubsub::MessageBuilder{}.SetData(std::move(payloads[1])).Build()});
+  ASSERT_STATUS_OK(r0.get());
+  ASSERT_STATUS_OK(r1.get());
+}
+
+TEST(BatchingPublisherConnectionTest, CompressionAboveThreshold) {
+  auto mock = std::make_shared<pubsub_testing::MockPublisherStub>();
+  pubsub::Topic const topic("test-project", "test-topic");
+
+  std::vector<grpc_compression_algorithm> algorithms;
+  EXPECT_CALL(*mock, AsyncPublish(_, _, _))
+      .WillRepeatedly([&](google::cloud::CompletionQueue&,
+                          std::unique_ptr<grpc::ClientContext> context,
+                          google::pubsub::v1::PublishRequest const& request) {
+        algorithms.push_back(context->compression_algorithm());
+        google::pubsub::v1::PublishResponse response;
+        for (auto const& m : request.messages()) {
+          response.add_message_ids("id-" + m.data());
+        }
+        return make_ready_future(make_status_or(response));
+      });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto publisher = BatchingPublisherConnection::Create(
+      topic,
+      pubsub::PublisherOptions{}
+          .set_batching_config(
+              pubsub::BatchingConfig{}.set_maximum_message_count(1))
+          .enable_compression(128),
+      mock, bg.cq());
+
+  auto const small = pubsub::MessageBuilder{}.SetData("small").Build();
+  auto const large =
+      pubsub::MessageBuilder{}.SetData(std::string(256, 'x')).Build();
+  ASSERT_STATUS_OK(publisher->Publish({small}).get());
+  ASSERT_STATUS_OK(publisher->Publish({large}).get());
+  EXPECT_THAT(algorithms, ElementsAre(GRPC_COMPRESS_NONE, GRPC_COMPRESS_GZIP));
+
+  auto const metrics = publisher->GetCompressionMetrics();
+  EXPECT_EQ(1, metrics.compressed_batches);
+  EXPECT_EQ(ToProto(large).ByteSizeLong(), metrics.compressed_bytes);
+  EXPECT_EQ(0, metrics.over_budget_batches);
+}
+
+TEST(BatchingPublisherConnectionTest, CompressionCpuBudget) {
+  auto mock = std::make_shared<pubsub_testing::MockPublisherStub>();
+  pubsub::Topic const topic("test-project", "test-topic");
+
+  std::vector<grpc_compression_algorithm> algorithms;
+  EXPECT_CALL(*mock, AsyncPublish(_, _, _))
+      .WillRepeatedly([&](google::cloud::CompletionQueue&,
+                          std::unique_ptr<grpc::ClientContext> context,
+                          google::pubsub::v1::PublishRequest const& request) {
+        algorithms.push_back(context->compression_algorithm());
+        google::pubsub::v1::PublishResponse response;
+        for (auto const& m : request.messages()) {
+          response.add_message_ids("id-" + m.data());
+        }
+        return make_ready_future(make_status_or(response));
+      });
+
+  // With a zero budget the first compressed batch exhausts the budget, and
+  // the remaining batches in the same interval are sent uncompressed.
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto publisher = BatchingPublisherConnection::Create(
+      topic,
+      pubsub::PublisherOptions{}
+          .set_batching_config(
+              pubsub::BatchingConfig{}.set_maximum_message_count(1))
+          .enable_compression(0)
+          .set_compression_cpu_budget(0.0),
+      mock, bg.cq());
+
+  for (auto const* data : {"d0", "d1", "d2"}) {
+    ASSERT_STATUS_OK(
+        publisher->Publish({pubsub::MessageBuilder{}.SetData(data).Build()})
+            .get());
+  }
+  EXPECT_THAT(algorithms, ElementsAre(GRPC_COMPRESS_GZIP, GRPC_COMPRESS_NONE,
+                                      GRPC_COMPRESS_NONE));
+
+  auto const metrics = publisher->GetCompressionMetrics();
+  EXPECT_EQ(1, metrics.compressed_batches);
+  EXPECT_EQ(2, metrics.over_budget_batches);
+}
+
+TEST(BatchingPublisherConnectionTest, CompressionBudgetIsShared) {
+  auto mock = std::make_shared<pubsub_testing::MockPublisherStub>();
+  pubsub::Topic const topic("test-project", "test-topic");
+
+  std::vector<grpc_compression_algorithm> algorithms;
+  EXPECT_CALL(*mock, AsyncPublish(_, _, _))
+      .WillRepeatedly([&](google::cloud::CompletionQueue&,
+                          std::unique_ptr<grpc::ClientContext> context,
+                          google::pubsub::v1::PublishRequest const& request) {
+        algorithms.push_back(context->compression_algorithm());
+        google::pubsub::v1::PublishResponse response;
+        for (auto const& m : request.messages()) {
+          response.add_message_ids("id-" + m.data());
+        }
+        return make_ready_future(make_status_or(response));
+      });
+
+  // The batch compressed by the first connection exhausts the budget for the
+  // second connection too.
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto const options =
+      pubsub::PublisherOptions{}
+          .set_batching_config(
+              pubsub::BatchingConfig{}.set_maximum_message_count(1))
+          .enable_compression(0)
+          .set_compression_cpu_budget(0.0);
+  auto flow_control = std::make_shared<PublisherFlowControl>(
+      options.max_outstanding_messages(), options.max_outstanding_bytes());
+  auto compression = std::make_shared<PublisherCompressionBudget>(
+      options.compression_cpu_budget());
+  auto p0 = BatchingPublisherConnection::Create(topic, options, mock, bg.cq(),
+                                                flow_control, compression);
+  auto p1 = BatchingPublisherConnection::Create(topic, options, mock, bg.cq(),
+                                                flow_control, compression);
+
+  ASSERT_STATUS_OK(
+      p0->Publish({pubsub::MessageBuilder{}.SetData("d0").Build()}).get());
+  ASSERT_STATUS_OK(
+      p1->Publish({pubsub::MessageBuilder{}.SetData("d1").Build()}).get());
+  EXPECT_THAT(algorithms, ElementsAre(GRPC_COMPRESS_GZIP, GRPC_COMPRESS_NONE));
+
+  for (auto const& p : {p0, p1}) {
+    auto const metrics = p->GetCompressionMetrics();
+    EXPECT_EQ(1, metrics.compressed_batches);
+    EXPECT_EQ(1, metrics.over_budget_batches);
+  }
+}
+
 }  // namespace
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
 }  // namespace pubsub_internal
@@ -0,0 +1,162 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/pubsub/internal/lease_manager.h"
+#include <algorithm>
+#include <map>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+namespace {
+// The range of ack deadlines supported by the service.
+auto constexpr kMinDeadline = std::chrono::seconds(10);
+auto constexpr kMaxDeadline = std::chrono::seconds(600);
+}  // namespace
+
+LeaseManager::LeaseManager(std::shared_ptr<AckBatcher> ack_batcher,
+                           google::cloud::CompletionQueue cq,
+                           LeaseConfig config)
+    : ack_batcher_(std::move(ack_batcher)),
+      cq_(std::move(cq)),
+      config_(std::move(config)),
+      histogram_(kMaxDeadline.count() + 1) {}
+
+void LeaseManager::Start() {
+  std::unique_lock<std::mutex> lk(mu_);
+  StartTimer(lk);
+}
+
+void LeaseManager::Shutdown() {
+  std::unique_lock<std::mutex> lk(mu_);
+  shutdown_ = true;
+  auto timer = std::move(timer_);
+  lk.unlock();
+  // Cancelling the timer satisfies the future immediately, without waiting
+  // for the period to expire.
+  if (timer.valid()) timer.cancel();
+}
+
+void LeaseManager::Add(std::string ack_id, Clock::time_point now) {
+  std::lock_guard<std::mutex> lk(mu_);
+  auto inserted = leases_.emplace(std::move(ack_id), Lease{});
+  auto& lease = *inserted.first;
+  // The service may re-deliver a message whose lease is still tracked.
+  if (!inserted.second) expirations_.erase(lease.second.expiration);
+  lease.second.received = now;
+  lease.second.expiration =
+      expirations_.emplace(now + config_.initial_deadline, &lease.first).first;
+}
+
+void LeaseManager::Remove(std::string const& ack_id, Clock::time_point now) {
+  std::lock_guard<std::mutex> lk(mu_);
+  auto l = leases_.find(ack_id);
+  if (l == leases_.end()) return;
+  // Round up, a deadline shorter than the processing time is useless.
+  auto const elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+                           now - l->second.received)
+                           .count() +
+                       1;
+  auto const bucket = (std::min)(
+      (std::max)(elapsed, std::chrono::seconds::rep{0}), kMaxDeadline.count());
+  ++histogram_[static_cast<std::size_t>(bucket)];
+  ++samples_;
+  expirations_.erase(l->second.expiration);
+  leases_.erase(l);
+}
+
+void LeaseManager::ExtendLeases(Clock::time_point now) {
+  std::unique_lock<std::mutex> lk(mu_);
+  auto const deadline = EstimatedDeadline(lk);
+  auto const limit = now + config_.extension_margin;
+  // Most leases get the same deadline, and therefore the same requests, only
+  // the leases close to `max_lease_duration` get shorter extensions.
+  std::map<std::chrono::seconds, std::vector<std::string>> extensions;
+  // The new expirations are inserted after the loop, as some of them may be
+  // within `limit`.
+  std::vector<std::pair<Leases::value_type*, Clock::time_point>> renewed;
+  while (!expirations_.empty() && expirations_.begin()->first <= limit) {
+    auto l = leases_.find(*expirations_.begin()->second);
+    expirations_.erase(expirations_.begin());
+    auto const remaining = std::chrono::duration_cast<std::chrono::seconds>(
+        l->second.received + config_.max_lease_duration - now);
+    if (remaining <= std::chrono::seconds(0)) {
+      // Let the service re-deliver the message once its lease expires.
+      leases_.erase(l);
+      continue;
+    }
+    auto const d = (std::min)(deadline, remaining);
+    renewed.emplace_back(&*l, now + d);
+    extensions[d].push_back(l->first);
+  }
+  for (auto const& r : renewed) {
+    r.first->second.expiration =
+        expirations_.emplace(r.second, &r.first->first).first;
+  }
+  lk.unlock();
+
+  for (auto& kv : extensions) {
+    ack_batcher_->ExtendLeases(std::move(kv.second), kv.first);
+  }
+}
+
+std::chrono::seconds LeaseManager::EstimatedDeadline() const {
+  std::unique_lock<std::mutex> lk(mu_);
+  return EstimatedDeadline(lk);
+}
+
+std::size_t LeaseManager::size() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return leases_.size();
+}
+
+void LeaseManager::StartTimer(std::unique_lock<std::mutex> const&) {
+  if (shutdown_) return;
+  auto weak = std::weak_ptr<LeaseManager>(shared_from_this());
+  timer_ = cq_.MakeRelativeTimer(config_.period)
+               .then([weak](future<StatusOr<Clock::time_point>> f) {
+                 if (auto self = weak.lock()) self->OnTimer(f.get().ok());
+               });
+}
+
+void LeaseManager::OnTimer(bool ok) {
+  // The timer fails if it is cancelled or the completion queue shuts down.
+  if (!ok) return;
+  ExtendLeases(Clock::now());
+  std::unique_lock<std::mutex> lk(mu_);
+  StartTimer(lk);
+}
+
+std::chrono::seconds LeaseManager::EstimatedDeadline(
+    std::unique_lock<std::mutex> const&) const {
+  if (samples_ == 0) return config_.initial_deadline;
+  // The 99th percentile, rounded up.
+  auto const target = (samples_ * 99 + 99) / 100;
+  std::uint64_t count = 0;
+  std::size_t bucket = 0;
+  for (; bucket != histogram_.size(); ++bucket) {
+    count += histogram_[bucket];
+    if (count >= target) break;
+  }
+  auto const estimate =
+      std::chrono::seconds(static_cast<std::chrono::seconds::rep>(bucket));
+  return (std::min)((std::max)(estimate, kMinDeadline), kMaxDeadline);
+}
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,145 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_LEASE_MANAGER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_LEASE_MANAGER_H
+
+#include "google/cloud/pubsub/internal/ack_batcher.h"
+#include "google/cloud/pubsub/version.h"
+#include "google/cloud/completion_queue.h"
+#include "google/cloud/future.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+/// Configure the lease extensions in a `LeaseManager`.
+struct LeaseConfig {
+  /// The ack deadline the service sets when it delivers a message.
+  std::chrono::seconds initial_deadline = std::chrono::seconds(60);
+
+  /// Stop extending the lease of messages older than this.
+  std::chrono::seconds max_lease_duration = std::chrono::minutes(60);
+
+  /// Extend the leases that expire within this margin.
+  std::chrono::seconds extension_margin = std::chrono::seconds(5);
+
+  /// How often the leases are checked.
+  std::chrono::milliseconds period = std::chrono::seconds(1);
+};
+
+/**
+ * Extends the ack deadline of the messages that are still being processed.
+ *
+ * The service re-delivers any message that is not acknowledged before its ack
+ * deadline. Applications that take longer than that to handle a message would
+ * process it (at least) twice. This class tracks the messages received and not
+ * yet handled, and periodically sends (batched) `ModifyAckDeadline` requests
+ * for the leases about to expire.
+ *
+ * The new deadline is the 99th percentile of the time to handle messages in
+ * this subscription, clamped to the range supported by the service, so most
+ * messages need at most one extension. The leases are not extended past
+ * `LeaseConfig::max_lease_duration` from the time the message was received.
+ *
+ * The leases are kept in a hash map, and their expiration times in an ordered
+ * set, so each check only touches the leases that are about to expire, even
+ * with many thousands of messages outstanding. Each lease holds the position
+ * of its expiration, which is erased as soon as the message is handled.
+ */
+class LeaseManager : public std::enable_shared_from_this<LeaseManager> {
+ public:
+  using Clock = std::chrono::system_clock;
+
+  static std::shared_ptr<LeaseManager> Create(
+      std::shared_ptr<AckBatcher> ack_batcher,
+      google::cloud::CompletionQueue cq, LeaseConfig config = LeaseConfig{}) {
+    return std::shared_ptr<LeaseManager>(new LeaseManager(
+        std::move(ack_batcher), std::move(cq), std::move(config)));
+  }
+
+  /// Start the periodic timer.
+  void Start();
+
+  /// Stop the periodic timer, the leases are no longer extended.
+  void Shutdown();
+
+  /// Start tracking the lease for @p ack_id.
+  void Add(std::string ack_id) { Add(std::move(ack_id), Clock::now()); }
+  void Add(std::string ack_id, Clock::time_point now);
+
+  /// Stop tracking the lease for @p ack_id, the message was handled.
+  void Remove(std::string const& ack_id) { Remove(ack_id, Clock::now()); }
+  void Remove(std::string const& ack_id, Clock::time_point now);
+
+  /// Send the extensions for the leases expiring soon after @p now.
+  void ExtendLeases(Clock::time_point now);
+
+  /// The deadline used to extend the leases.
+  std::chrono::seconds EstimatedDeadline() const;
+
+  /// The number of leases tracked.
+  std::size_t size() const;
+
+ private:
+  LeaseManager(std::shared_ptr<AckBatcher> ack_batcher,
+               google::cloud::CompletionQueue cq, LeaseConfig config);
+
+  void StartTimer(std::unique_lock<std::mutex> const&);
+  void OnTimer(bool ok);
+  std::chrono::seconds EstimatedDeadline(
+      std::unique_lock<std::mutex> const&) const;
+
+  // The expiration time of each lease, and its ack id. The ack id points to
+  // the key in `leases_`, which is stable until the lease is erased.
+  using Expirations =
+      std::set<std::pair<Clock::time_point, std::string const*>>;
+
+  struct Lease {
+    Clock::time_point received;
+    Expirations::iterator expiration;
+  };
+  using Leases = std::unordered_map<std::string, Lease>;
+
+  std::shared_ptr<AckBatcher> const ack_batcher_;
+  google::cloud::CompletionQueue cq_;
+  LeaseConfig const config_;
+
+  mutable std::mutex mu_;
+  Leases leases_;            // GUARDED_BY(mu_)
+  Expirations expirations_;  // GUARDED_BY(mu_)
+  // The time to handle each message, in seconds, one bucket per second.
+  std::vector<std::uint64_t> histogram_;  // GUARDED_BY(mu_)
+  std::uint64_t samples_ = 0;             // GUARDED_BY(mu_)
+  bool shutdown_ = false;                 // GUARDED_BY(mu_)
+  future<void> timer_;                    // GUARDED_BY(mu_)
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_LEASE_MANAGER_H
@@ -0,0 +1,244 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/pubsub/internal/lease_manager.h"
+#include "google/cloud/pubsub/testing/mock_subscriber_stub.h"
+#include "google/cloud/internal/background_threads_impl.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+namespace {
+
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::UnorderedElementsAre;
+using Clock = LeaseManager::Clock;
+
+/// An `AckBatcher` where the extensions are the only requests.
+std::shared_ptr<AckBatcher> MakeBatcher(
+    std::shared_ptr<SubscriberStub> stub,
+    google::cloud::CompletionQueue const& cq) {
+  AckBatchingConfig config;
+  config.maximum_hold_time = std::chrono::hours(1);
+  return AckBatcher::Create({std::move(stub)}, cq, "test-sub", config);
+}
+
+TEST(LeaseManagerTest, AddRemove) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto leases = LeaseManager::Create(MakeBatcher(mock, bg.cq()), bg.cq());
+  leases->Add("a0");
+  leases->Add("a1");
+  leases->Add("a2");
+  EXPECT_EQ(3, leases->size());
+  leases->Remove("a1");
+  leases->Remove("unknown");
+  EXPECT_EQ(2, leases->size());
+}
+
+TEST(LeaseManagerTest, EstimatedDeadline) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  LeaseConfig config;
+  config.initial_deadline = std::chrono::seconds(42);
+  auto leases =
+      LeaseManager::Create(MakeBatcher(mock, bg.cq()), bg.cq(), config);
+  // Without any samples the manager uses the initial deadline.
+  EXPECT_EQ(std::chrono::seconds(42), leases->EstimatedDeadline());
+
+  auto const t0 = Clock::now();
+  auto handle = [&](std::string const& id, std::chrono::seconds elapsed) {
+    leases->Add(id, t0);
+    leases->Remove(id, t0 + elapsed);
+  };
+  // Fast messages are clamped to the minimum deadline.
+  for (int i = 0; i != 10; ++i) handle("fast", std::chrono::seconds(1));
+  EXPECT_EQ(std::chrono::seconds(10), leases->EstimatedDeadline());
+
+  for (int i = 0; i != 89; ++i) handle("slow", std::chrono::seconds(30));
+  handle("slowest", std::chrono::seconds(200));
+  // With 100 samples the slowest message is above the 99th percentile.
+  EXPECT_EQ(std::chrono::seconds(31), leases->EstimatedDeadline());
+
+  handle("slowest", std::chrono::seconds(200));
+  handle("slowest", std::chrono::seconds(200));
+  EXPECT_EQ(std::chrono::seconds(201), leases->EstimatedDeadline());
+
+  // The deadline is clamped to the maximum supported by the service.
+  for (int i = 0; i != 10; ++i) handle("slowest", std::chrono::hours(1));
+  EXPECT_EQ(std::chrono::seconds(600), leases->EstimatedDeadline());
+}
+
+TEST(LeaseManagerTest, ExtendLeases) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  EXPECT_CALL(*mock, AsyncModifyAckDeadline(_, _, _))
+      .WillOnce(
+          [](google::cloud::CompletionQueue&,
+             std::unique_ptr<grpc::ClientContext>,
+             google::pubsub::v1::ModifyAckDeadlineRequest const& request) {
+            EXPECT_EQ("test-sub", request.subscription());
+            EXPECT_EQ(60, request.ack_deadline_seconds());
+            EXPECT_THAT(request.ack_ids(), UnorderedElementsAre("a0", "a1"));
+            return make_ready_future(Status{});
+          })
+      .WillOnce(
+          [](google::cloud::CompletionQueue&,
+             std::unique_ptr<grpc::ClientContext>,
+             google::pubsub::v1::ModifyAckDeadlineRequest const& request) {
+            // The estimate now reflects the time to handle "a0".
+            EXPECT_EQ(59, request.ack_deadline_seconds());
+            EXPECT_THAT(request.ack_ids(), ElementsAre("a1"));
+            return make_ready_future(Status{});
+          });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  LeaseConfig config;
+  config.initial_deadline = std::chrono::seconds(60);
+  config.extension_margin = std::chrono::seconds(5);
+  auto leases =
+      LeaseManager::Create(MakeBatcher(mock, bg.cq()), bg.cq(), config);
+  auto const t0 = Clock::now();
+  leases->Add("a0", t0);
+  leases->Add("a1", t0);
+
+  // Nothing expires soon.
+  leases->ExtendLeases(t0 + std::chrono::seconds(10));
+  // Both leases expire within the margin.
+  auto const t1 = t0 + std::chrono::seconds(56);
+  leases->ExtendLeases(t1);
+  // The extended leases do not need another extension yet.
+  leases->ExtendLeases(t1 + std::chrono::seconds(1));
+
+  leases->Remove("a0", t1 + std::chrono::seconds(2));
+  leases->ExtendLeases(t1 + std::chrono::seconds(56));
+  EXPECT_EQ(1, leases->size());
+  bg.cq().CancelAll();
+}
+
+TEST(LeaseManagerTest, RedeliveredMessage) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  EXPECT_CALL(*mock, AsyncModifyAckDeadline(_, _, _))
+      .WillOnce(
+          [](google::cloud::CompletionQueue&,
+             std::unique_ptr<grpc::ClientContext>,
+             google::pubsub::v1::ModifyAckDeadlineRequest const& request) {
+            EXPECT_THAT(request.ack_ids(), ElementsAre("a0"));
+            return make_ready_future(Status{});
+          });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  LeaseConfig config;
+  config.initial_deadline = std::chrono::seconds(60);
+  config.extension_margin = std::chrono::seconds(5);
+  auto leases =
+      LeaseManager::Create(MakeBatcher(mock, bg.cq()), bg.cq(), config);
+  auto const t0 = Clock::now();
+  leases->Add("a0", t0);
+  // The service re-delivers the message, its lease starts again.
+  leases->Add("a0", t0 + std::chrono::seconds(30));
+  EXPECT_EQ(1, leases->size());
+
+  // The expiration from the first delivery is gone.
+  leases->ExtendLeases(t0 + std::chrono::seconds(56));
+  leases->ExtendLeases(t0 + std::chrono::seconds(86));
+  EXPECT_EQ(1, leases->size());
+  bg.cq().CancelAll();
+}
+
+TEST(LeaseManagerTest, MaxLeaseDuration) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  std::vector<int> deadlines;
+  EXPECT_CALL(*mock, AsyncModifyAckDeadline(_, _, _))
+      .Times(2)
+      .WillRepeatedly(
+          [&](google::cloud::CompletionQueue&,
+              std::unique_ptr<grpc::ClientContext>,
+              google::pubsub::v1::ModifyAckDeadlineRequest const& request) {
+            deadlines.push_back(request.ack_deadline_seconds());
+            return make_ready_future(Status{});
+          });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  LeaseConfig config;
+  config.initial_deadline = std::chrono::seconds(60);
+  config.max_lease_duration = std::chrono::seconds(90);
+  config.extension_margin = std::chrono::seconds(5);
+  auto leases =
+      LeaseManager::Create(MakeBatcher(mock, bg.cq()), bg.cq(), config);
+  auto const t0 = Clock::now();
+  leases->Add("a0", t0);
+
+  // The extensions never go past the maximum lease duration.
+  leases->ExtendLeases(t0 + std::chrono::seconds(56));
+  leases->ExtendLeases(t0 + std::chrono::seconds(86));
+  EXPECT_THAT(deadlines, ElementsAre(34, 4));
+
+  // Once the lease is too old it is no longer tracked.
+  leases->ExtendLeases(t0 + std::chrono::seconds(90));
+  EXPECT_EQ(0, leases->size());
+  bg.cq().CancelAll();
+}
+
+TEST(LeaseManagerTest, TimerExtendsLeases) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  promise<void> extended;
+  EXPECT_CALL(*mock, AsyncModifyAckDeadline(_, _, _))
+      .WillOnce(
+          [&](google::cloud::CompletionQueue&,
+              std::unique_ptr<grpc::ClientContext>,
+              google::pubsub::v1::ModifyAckDeadlineRequest const& request) {
+            EXPECT_THAT(request.ack_ids(), ElementsAre("a0"));
+            extended.set_value();
+            return make_ready_future(Status{});
+          })
+      .WillRepeatedly([] { return make_ready_future(Status{}); });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  LeaseConfig config;
+  config.initial_deadline = std::chrono::seconds(1);
+  config.extension_margin = std::chrono::seconds(5);
+  config.period = std::chrono::milliseconds(10);
+  auto leases =
+      LeaseManager::Create(MakeBatcher(mock, bg.cq()), bg.cq(), config);
+  leases->Add("a0");
+  leases->Start();
+  extended.get_future().get();
+  leases->Shutdown();
+  bg.cq().CancelAll();
+}
+
+TEST(LeaseManagerTest, ShutdownCancelsTimer) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  EXPECT_CALL(*mock, AsyncModifyAckDeadline(_, _, _)).Times(0);
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  LeaseConfig config;
+  config.period = std::chrono::hours(1);
+  auto leases =
+      LeaseManager::Create(MakeBatcher(mock, bg.cq()), bg.cq(), config);
+  leases->Add("a0");
+  leases->Start();
+  // Without the cancellation the completion queue would wait for the timer
+  // when it shuts down.
+  leases->Shutdown();
+}
+
+}  // namespace
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,82 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "google/cloud/pubsub/internal/ordering_key_publisher_connection.h"
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+future<StatusOr<std::string>> OrderingKeyPublisherConnection::Publish(
+    PublishParams p) {
+  auto ordering_key = p.message.ordering_key();
+  auto child = GetChild(ordering_key);
+  std::weak_ptr<OrderingKeyPublisherConnection> weak = shared_from_this();
+  return child->Publish(std::move(p))
+      .then([weak, ordering_key](future<StatusOr<std::string>> f) {
+        auto result = f.get();
+        if (auto self = weak.lock()) {
+          self->OnPublishDone(ordering_key, result.ok());
+        }
+        return result;
+      });
+}
+
+void OrderingKeyPublisherConnection::ResumePublish(ResumePublishParams p) {
+  std::unique_lock<std::mutex> lk(mu_);
+  auto i = children_.find(p.ordering_key);
+  // The child is released once idle, and idle children are not paused.
+  if (i == children_.end()) return;
+  auto child = i->second.connection;
+  lk.unlock();
+  auto ordering_key = p.ordering_key;
+  child->ResumePublish(std::move(p));
+  lk.lock();
+  i = children_.find(ordering_key);
+  if (i == children_.end()) return;
+  i->second.paused = false;
+  if (i->second.pending == 0) children_.erase(i);
+}
+
+std::shared_ptr<pubsub::PublisherConnection>
+OrderingKeyPublisherConnection::GetChild(std::string const& ordering_key) {
+  std::lock_guard<std::mutex> lk(mu_);
+  auto& child = children_[ordering_key];
+  if (!child.connection) child.connection = factory_(ordering_key);
+  ++child.pending;
+  return child.connection;
+}
+
+void OrderingKeyPublisherConnection::OnPublishDone(
+    std::string const& ordering_key, bool ok) {
+  // Declared before the lock, so a released child is destroyed after the lock
+  // is released.
+  std::shared_ptr<pubsub::PublisherConnection> released;
+  std::lock_guard<std::mutex> lk(mu_);
+  auto i = children_.find(ordering_key);
+  if (i == children_.end()) return;
+  auto& child = i->second;
+  --child.pending;
+  if (!ok) child.paused = true;
+  if (child.pending != 0 || child.paused) return;
+  released = std::move(child.connection);
+  children_.erase(i);
+}
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
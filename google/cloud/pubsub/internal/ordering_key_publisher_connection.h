@@ -0,0 +1,91 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_ORDERING_KEY_PUBLISHER_CONNECTION_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_ORDERING_KEY_PUBLISHER_CONNECTION_H
+
+#include "google/cloud/pubsub/publisher_connection.h"
+#include "google/cloud/pubsub/version.h"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+/**
+ * Routes each message to a child connection based on its ordering key.
+ *
+ * The child connections are created on demand, the first time a message with
+ * a given ordering key is published. Messages without an ordering key use the
+ * connection created for the empty key. Each child connection is expected to
+ * preserve the order of its messages, while different children publish in
+ * parallel.
+ *
+ * A child is released once all its messages complete, so applications using
+ * many ordering keys do not accumulate idle children. After a failure the
+ * child may be paused, and it is kept until `ResumePublish()` is called for
+ * its key.
+ */
+class OrderingKeyPublisherConnection
+    : public pubsub::PublisherConnection,
+      public std::enable_shared_from_this<OrderingKeyPublisherConnection> {
+ public:
+  using ConnectionFactory =
+      std::function<std::shared_ptr<pubsub::PublisherConnection>(
+          std::string const&)>;
+
+  static std::shared_ptr<OrderingKeyPublisherConnection> Create(
+      ConnectionFactory factory) {
+    return std::shared_ptr<OrderingKeyPublisherConnection>(
+        new OrderingKeyPublisherConnection(std::move(factory)));
+  }
+
+  future<StatusOr<std::string>> Publish(PublishParams p) override;
+  void ResumePublish(ResumePublishParams p) override;
+
+ private:
+  explicit OrderingKeyPublisherConnection(ConnectionFactory factory)
+      : factory_(std::move(factory)) {}
+
+  struct Child {
+    std::shared_ptr<pubsub::PublisherConnection> connection;
+    // The number of messages published and not yet completed.
+    std::size_t pending = 0;
+    // Set when a message fails, as that may pause the child, and cleared by
+    // `ResumePublish()`.
+    bool paused = false;
+  };
+
+  std::shared_ptr<pubsub::PublisherConnection> GetChild(
+      std::string const& ordering_key);
+  void OnPublishDone(std::string const& ordering_key, bool ok);
+
+  ConnectionFactory factory_;
+  std::mutex mu_;
+  std::unordered_map<std::string, Child> children_;
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_ORDERING_KEY_PUBLISHER_CONNECTION_H
@@ -0,0 +1,144 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "google/cloud/pubsub/internal/ordering_key_publisher_connection.h"
+#include "google/cloud/pubsub/mocks/mock_publisher_connection.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <map>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+namespace {
+
+using ::testing::_;
+using ::testing::ElementsAre;
+
+pubsub::Message MakeMessage(std::string data, std::string ordering_key) {
+  return pubsub::MessageBuilder{}
+      .SetData(std::move(data))
+      .SetOrderingKey(std::move(ordering_key))
+      .Build();
+}
+
+TEST(OrderingKeyPublisherConnectionTest, RoutesByOrderingKey) {
+  std::vector<std::string> created;
+  std::map<std::string, std::vector<std::string>> published;
+  auto factory = [&](std::string const& ordering_key) {
+    created.push_back(ordering_key);
+    auto mock = std::make_shared<pubsub_mocks::MockPublisherConnection>();
+    EXPECT_CALL(*mock, Publish(_))
+        .WillRepeatedly([&, ordering_key](
+                            pubsub::PublisherConnection::PublishParams p) {
+          EXPECT_EQ(ordering_key, p.message.ordering_key());
+          published[ordering_key].push_back(p.message.data());
+          return make_ready_future(
+              StatusOr<std::string>("id-" + p.message.data()));
+        });
+    return mock;
+  };
+
+  auto publisher = OrderingKeyPublisherConnection::Create(factory);
+  for (auto const& m : {MakeMessage("d0", "k0"), MakeMessage("d1", "k1"),
+                        MakeMessage("d2", ""), MakeMessage("d3", "k0"),
+                        MakeMessage("d4", "")}) {
+    auto id = publisher->Publish({m}).get();
+    ASSERT_STATUS_OK(id);
+    EXPECT_EQ("id-" + m.data(), *id);
+  }
+
+  // Each message completes before the next is published, so the children are
+  // released and created again.
+  EXPECT_THAT(created, ElementsAre("k0", "k1", "", "k0", ""));
+  EXPECT_THAT(published["k0"], ElementsAre("d0", "d3"));
+  EXPECT_THAT(published["k1"], ElementsAre("d1"));
+  EXPECT_THAT(published[""], ElementsAre("d2", "d4"));
+}
+
+TEST(OrderingKeyPublisherConnectionTest, ResumePublish) {
+  std::vector<std::string> created;
+  auto factory = [&](std::string const& ordering_key) {
+    created.push_back(ordering_key);
+    auto mock = std::make_shared<pubsub_mocks::MockPublisherConnection>();
+    EXPECT_CALL(*mock, Publish(_))
+        .WillOnce([](pubsub::PublisherConnection::PublishParams const&) {
+          return make_ready_future(StatusOr<std::string>(
+              Status(StatusCode::kPermissionDenied, "uh-oh")));
+        })
+        .WillOnce([](pubsub::PublisherConnection::PublishParams const&) {
+          return make_ready_future(StatusOr<std::string>(
+              Status(StatusCode::kFailedPrecondition, "paused")));
+        });
+    EXPECT_CALL(*mock, ResumePublish(_))
+        .WillOnce([ordering_key](
+                      pubsub::PublisherConnection::ResumePublishParams const&
+                          p) { EXPECT_EQ(ordering_key, p.ordering_key); });
+    return mock;
+  };
+
+  auto publisher = OrderingKeyPublisherConnection::Create(factory);
+  EXPECT_FALSE(publisher->Publish({MakeMessage("d0", "k0")}).get());
+  // The child may be paused, so it is kept until the key is resumed.
+  EXPECT_FALSE(publisher->Publish({MakeMessage("d1", "k0")}).get());
+  publisher->ResumePublish({"k0"});
+  // Keys without any messages have nothing to resume.
+  publisher->ResumePublish({"k1"});
+  EXPECT_THAT(created, ElementsAre("k0"));
+}
+
+TEST(OrderingKeyPublisherConnectionTest, ReleasesIdleChildren) {
+  std::vector<std::string> created;
+  std::vector<promise<StatusOr<std::string>>> results;
+  std::vector<std::weak_ptr<pubsub::PublisherConnection>> children;
+  auto factory = [&](std::string const& ordering_key) {
+    created.push_back(ordering_key);
+    auto mock = std::make_shared<pubsub_mocks::MockPublisherConnection>();
+    EXPECT_CALL(*mock, Publish(_))
+        .WillRepeatedly([&](pubsub::PublisherConnection::PublishParams const&) {
+          results.emplace_back();
+          return results.back().get_future();
+        });
+    children.push_back(mock);
+    return mock;
+  };
+
+  auto publisher = OrderingKeyPublisherConnection::Create(factory);
+  auto r0 = publisher->Publish({MakeMessage("d0", "k0")});
+  auto r1 = publisher->Publish({MakeMessage("d1", "k0")});
+  ASSERT_EQ(2, results.size());
+  EXPECT_THAT(created, ElementsAre("k0"));
+
+  // The child is kept while any of its messages are pending.
+  results[0].set_value(StatusOr<std::string>("id-0"));
+  ASSERT_STATUS_OK(r0.get());
+  EXPECT_FALSE(children[0].expired());
+  results[1].set_value(StatusOr<std::string>("id-1"));
+  ASSERT_STATUS_OK(r1.get());
+  EXPECT_TRUE(children[0].expired());
+
+  // Publishing with the same key creates a new child.
+  auto r2 = publisher->Publish({MakeMessage("d2", "k0")});
+  EXPECT_THAT(created, ElementsAre("k0", "k0"));
+  results[2].set_value(StatusOr<std::string>("id-2"));
+  ASSERT_STATUS_OK(r2.get());
+}
+
+}  // namespace
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
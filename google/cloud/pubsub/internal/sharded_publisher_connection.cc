@@ -0,0 +1,45 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "google/cloud/pubsub/internal/sharded_publisher_connection.h"
+#include <functional>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+future<StatusOr<std::string>> ShardedPublisherConnection::Publish(
+    PublishParams p) {
+  auto const& key = p.message.ordering_key();
+  auto const index = key.empty() ? next_.fetch_add(1) % children_.size()
+                                 : ShardIndex(key, children_.size());
+  return children_[index]->Publish(std::move(p));
+}
+
+void ShardedPublisherConnection::ResumePublish(ResumePublishParams p) {
+  auto const index = ShardIndex(p.ordering_key, children_.size());
+  children_[index]->ResumePublish(std::move(p));
+}
+
+std::size_t ShardedPublisherConnection::ShardIndex(
+    std::string const& ordering_key, std::size_t shards) {
+  return std::hash<std::string>{}(ordering_key) % shards;
+}
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,71 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_SHARDED_PUBLISHER_CONNECTION_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_SHARDED_PUBLISHER_CONNECTION_H
+
+#include "google/cloud/pubsub/publisher_connection.h"
+#include "google/cloud/pubsub/version.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+/**
+ * Spreads messages over several independent child connections.
+ *
+ * Messages without an ordering key are assigned to the children in
+ * round-robin order. Messages with an ordering key always use the same child,
+ * selected by hashing the key, so the messages for a key stay in sequence.
+ *
+ * Each child has its own lock, batches, and timers, so publishing threads do
+ * not contend with each other, and (when each child uses a different channel)
+ * the requests are spread over several connections to the service.
+ */
+class ShardedPublisherConnection : public pubsub::PublisherConnection {
+ public:
+  static std::shared_ptr<ShardedPublisherConnection> Create(
+      std::vector<std::shared_ptr<pubsub::PublisherConnection>> children) {
+    return std::shared_ptr<ShardedPublisherConnection>(
+        new ShardedPublisherConnection(std::move(children)));
+  }
+
+  future<StatusOr<std::string>> Publish(PublishParams p) override;
+  void ResumePublish(ResumePublishParams p) override;
+
+  /// The index of the shard used for @p ordering_key, out of @p shards.
+  static std::size_t ShardIndex(std::string const& ordering_key,
+                                std::size_t shards);
+
+ private:
+  explicit ShardedPublisherConnection(
+      std::vector<std::shared_ptr<pubsub::PublisherConnection>> children)
+      : children_(std::move(children)) {}
+
+  std::vector<std::shared_ptr<pubsub::PublisherConnection>> children_;
+  std::atomic<std::size_t> next_{0};
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_SHARDED_PUBLISHER_CONNECTION_H
@@ -0,0 +1,105 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "google/cloud/pubsub/internal/sharded_publisher_connection.h"
+#include "google/cloud/pubsub/mocks/mock_publisher_connection.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+namespace {
+
+using ::testing::_;
+using ::testing::ElementsAre;
+
+/// Creates mock connections that record the data of each message published.
+std::vector<std::shared_ptr<pubsub::PublisherConnection>> MakeChildren(
+    std::vector<std::vector<std::string>>& published) {
+  std::vector<std::shared_ptr<pubsub::PublisherConnection>> children;
+  for (std::size_t i = 0; i != published.size(); ++i) {
+    auto mock = std::make_shared<pubsub_mocks::MockPublisherConnection>();
+    EXPECT_CALL(*mock, Publish(_))
+        .WillRepeatedly(
+            [&published, i](pubsub::PublisherConnection::PublishParams p) {
+              published[i].push_back(p.message.data());
+              return make_ready_future(
+                  StatusOr<std::string>("id-" + p.message.data()));
+            });
+    children.push_back(std::move(mock));
+  }
+  return children;
+}
+
+TEST(ShardedPublisherConnectionTest, RoundRobinWithoutOrderingKey) {
+  std::vector<std::vector<std::string>> published(3);
+  auto publisher = ShardedPublisherConnection::Create(MakeChildren(published));
+  for (auto const* data : {"d0", "d1", "d2", "d3", "d4"}) {
+    auto id =
+        publisher->Publish({pubsub::MessageBuilder{}.SetData(data).Build()})
+            .get();
+    ASSERT_STATUS_OK(id);
+    EXPECT_EQ(std::string("id-") + data, *id);
+  }
+  EXPECT_THAT(published[0], ElementsAre("d0", "d3"));
+  EXPECT_THAT(published[1], ElementsAre("d1", "d4"));
+  EXPECT_THAT(published[2], ElementsAre("d2"));
+}
+
+TEST(ShardedPublisherConnectionTest, HashOrderingKey) {
+  std::vector<std::vector<std::string>> published(4);
+  auto publisher = ShardedPublisherConnection::Create(MakeChildren(published));
+  for (auto const* key : {"k0", "k1", "k2", "k0", "k1", "k2"}) {
+    ASSERT_STATUS_OK(publisher
+                         ->Publish({pubsub::MessageBuilder{}
+                                        .SetData(key)
+                                        .SetOrderingKey(key)
+                                        .Build()})
+                         .get());
+  }
+  // All the messages for a key use the same child.
+  for (auto const* key : {"k0", "k1", "k2"}) {
+    auto const index = ShardedPublisherConnection::ShardIndex(key, 4);
+    ASSERT_LT(index, 4);
+    EXPECT_EQ(2, std::count(published[index].begin(), published[index].end(),
+                            std::string(key)));
+  }
+}
+
+TEST(ShardedPublisherConnectionTest, ResumePublish) {
+  std::vector<std::shared_ptr<pubsub_mocks::MockPublisherConnection>> mocks;
+  std::vector<std::shared_ptr<pubsub::PublisherConnection>> children;
+  for (int i = 0; i != 3; ++i) {
+    mocks.push_back(std::make_shared<pubsub_mocks::MockPublisherConnection>());
+    children.push_back(mocks.back());
+  }
+  auto const index = ShardedPublisherConnection::ShardIndex("test-key", 3);
+  EXPECT_CALL(*mocks[index], ResumePublish(_))
+      .WillOnce([](pubsub::PublisherConnection::ResumePublishParams const& p) {
+        EXPECT_EQ("test-key", p.ordering_key);
+      });
+
+  auto publisher = ShardedPublisherConnection::Create(std::move(children));
+  publisher->ResumePublish({"test-key"});
+}
+
+}  // namespace
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
@@ -89,6 +89,50 @@ class DefaultSubscriberStub : public SubscriberStub {
     return {};
   }
 
+  future<Status> AsyncAcknowledge(
+      google::cloud::CompletionQueue& cq,
+      std::unique_ptr<grpc::ClientContext> context,
+      google::pubsub::v1::AcknowledgeRequest const& request) override {
+    return cq
+        .MakeUnaryRpc(
+            [this](grpc::ClientContext* context,
+                   google::pubsub::v1::AcknowledgeRequest const& request,
+                   grpc::CompletionQueue* cq) {
+              return grpc_stub_->AsyncAcknowledge(context, request, cq);
+            },
+            request, std::move(context))
+        .then([](future<StatusOr<google::protobuf::Empty>> f) {
+          return f.get().status();
+        });
+  }
+
+  future<Status> AsyncModifyAckDeadline(
+      google::cloud::CompletionQueue& cq,
+      std::unique_ptr<grpc::ClientContext> context,
+      google::pubsub::v1::ModifyAckDeadlineRequest const& request) override {
+    return cq
+        .MakeUnaryRpc(
+            [this](grpc::ClientContext* context,
+                   google::pubsub::v1::ModifyAckDeadlineRequest const& request,
+                   grpc::CompletionQueue* cq) {
+              return grpc_stub_->AsyncModifyAckDeadline(context, request, cq);
+            },
+            request, std::move(context))
+        .then([](future<StatusOr<google::protobuf::Empty>> f) {
+          return f.get().status();
+        });
+  }
+
+  std::unique_ptr<AsyncPullStream> AsyncStreamingPull(
+      google::cloud::CompletionQueue& cq,
+      std::unique_ptr<grpc::ClientContext> context) override {
+    return cq.MakeStreamingReadWriteRpc(
+        [this](grpc::ClientContext* context, grpc::CompletionQueue* cq) {
+          return grpc_stub_->PrepareAsyncStreamingPull(context, cq);
+        },
+        std::move(context));
+  }
+
  private:
   std::unique_ptr<google::pubsub::v1::Subscriber::StubInterface> grpc_stub_;
 };
@@ -17,6 +17,7 @@
 
 #include "google/cloud/pubsub/connection_options.h"
 #include "google/cloud/pubsub/version.h"
+#include "google/cloud/completion_queue.h"
 #include "google/cloud/status_or.h"
 #include <google/pubsub/v1/pubsub.grpc.pb.h>
 
@@ -69,6 +70,32 @@ class SubscriberStub {
   virtual Status ModifyAckDeadline(
       grpc::ClientContext& context,
       google::pubsub::v1::ModifyAckDeadlineRequest const& request) = 0;
+
+  /// Acknowledge one or more messages asynchronously.
+  virtual future<Status> AsyncAcknowledge(
+      google::cloud::CompletionQueue& cq,
+      std::unique_ptr<grpc::ClientContext> context,
+      google::pubsub::v1::AcknowledgeRequest const& request) = 0;
+
+  /// Modify the ACK deadline asynchronously.
+  virtual future<Status> AsyncModifyAckDeadline(
+      google::cloud::CompletionQueue& cq,
+      std::unique_ptr<grpc::ClientContext> context,
+      google::pubsub::v1::ModifyAckDeadlineRequest const& request) = 0;
+
+  using AsyncPullStream = google::cloud::internal::AsyncStreamingReadWriteRpc<
+      google::pubsub::v1::StreamingPullRequest,
+      google::pubsub::v1::StreamingPullResponse>;
+
+  /**
+   * Create a bidirectional stream to receive messages.
+   *
+   * The stream is not started, the caller must call `Start()` and then send
+   * the initial request before reading any messages.
+   */
+  virtual std::unique_ptr<AsyncPullStream> AsyncStreamingPull(
+      google::cloud::CompletionQueue& cq,
+      std::unique_ptr<grpc::ClientContext> context) = 0;
 };
 
 /**
@@ -0,0 +1,391 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/pubsub/internal/subscription_session.h"
+#include "absl/memory/memory.h"
+#include <algorithm>
+#include <chrono>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+namespace {
+
+// The ack deadline requested for messages received via the streams.
+auto constexpr kStreamAckDeadlineSeconds = 60;
+
+// The backoff policy before re-opening a stream. The maximum delay is small
+// because a session cannot stop while it waits to re-open a stream.
+std::unique_ptr<google::cloud::internal::BackoffPolicy> StreamBackoffPolicy() {
+  return google::cloud::internal::ExponentialBackoffPolicy(
+             std::chrono::milliseconds(10), std::chrono::seconds(1), 2.0)
+      .clone();
+}
+
+bool IsRetryable(Status const& status) {
+  // Servers periodically close the streams, possibly with a successful status.
+  switch (status.code()) {
+    case StatusCode::kOk:
+    case StatusCode::kAborted:
+    case StatusCode::kDeadlineExceeded:
+    case StatusCode::kInternal:
+    case StatusCode::kResourceExhausted:
+    case StatusCode::kUnavailable:
+    case StatusCode::kUnknown:
+      return true;
+    default:
+      return false;
+  }
+}
+
+LeaseConfig MakeLeaseConfig(pubsub::SubscriberOptions const& options) {
+  LeaseConfig config;
+  config.initial_deadline = std::chrono::seconds(kStreamAckDeadlineSeconds);
+  config.max_lease_duration = options.max_lease_duration();
+  return config;
+}
+
+/**
+ * Sends the acks and nacks via the session's `AckBatcher`, and releases the
+ * lease and the flow control budget of the message once it is handled.
+ */
+class SessionAckHandlerImpl : public pubsub::AckHandler::Impl {
+ public:
+  SessionAckHandlerImpl(std::shared_ptr<SubscriptionSession> session,
+                        std::shared_ptr<AckBatcher> ack_batcher,
+                        std::shared_ptr<LeaseManager> lease_manager,
+                        std::string ack_id, std::size_t message_bytes)
+      : session_(std::move(session)),
+        ack_batcher_(std::move(ack_batcher)),
+        lease_manager_(std::move(lease_manager)),
+        ack_id_(std::move(ack_id)),
+        message_bytes_(message_bytes) {}
+
+  // Applications that drop the handler also release the message.
+  ~SessionAckHandlerImpl() override {
+    if (!handled_) lease_manager_->Remove(ack_id_);
+    session_->MessageHandled(message_bytes_);
+  }
+
+  void ack() override {
+    lease_manager_->Remove(ack_id_);
+    handled_ = true;
+    ack_batcher_->Ack(std::move(ack_id_));
+  }
+  void nack() override {
+    lease_manager_->Remove(ack_id_);
+    handled_ = true;
+    ack_batcher_->Nack(std::move(ack_id_));
+  }
+  std::string ack_id() const override { return ack_id_; }
+
+ private:
+  std::shared_ptr<SubscriptionSession> session_;
+  std::shared_ptr<AckBatcher> ack_batcher_;
+  std::shared_ptr<LeaseManager> lease_manager_;
+  std::string ack_id_;
+  std::size_t message_bytes_;
+  bool handled_ = false;
+};
+
+}  // namespace
+
+/// Runs one callback on the completion queue.
+struct SubscriptionSession::CallbackRunner {
+  std::shared_ptr<SubscriptionSession> self;
+  Item item;
+
+  void operator()() { self->RunCallback(std::move(item)); }
+};
+
+std::shared_ptr<SubscriptionSession> SubscriptionSession::Create(
+    std::vector<std::shared_ptr<SubscriberStub>> stubs,
+    google::cloud::CompletionQueue cq, pubsub::SubscriberOptions options,
+    pubsub::SubscriberConnection::SubscribeParams params,
+    std::shared_ptr<AckBatcherCounters> ack_counters) {
+  return std::shared_ptr<SubscriptionSession>(new SubscriptionSession(
+      std::move(stubs), std::move(cq), std::move(options), std::move(params),
+      std::move(ack_counters)));
+}
+
+SubscriptionSession::SubscriptionSession(
+    std::vector<std::shared_ptr<SubscriberStub>> stubs,
+    google::cloud::CompletionQueue cq, pubsub::SubscriberOptions options,
+    pubsub::SubscriberConnection::SubscribeParams params,
+    std::shared_ptr<AckBatcherCounters> ack_counters)
+    : cq_(std::move(cq)),
+      options_(std::move(options)),
+      params_(std::move(params)),
+      ack_batcher_(AckBatcher::Create(stubs, cq_,
+                                      params_.full_subscription_name,
+                                      {}, std::move(ack_counters))),
+      lease_manager_(
+          LeaseManager::Create(ack_batcher_, cq_, MakeLeaseConfig(options_))),
+      streams_(options_.concurrent_streams()) {
+  for (std::size_t i = 0; i != streams_.size(); ++i) {
+    streams_[i].stub = stubs[i % stubs.size()];
+    streams_[i].backoff = StreamBackoffPolicy();
+  }
+}
+
+future<Status> SubscriptionSession::Start() {
+  std::weak_ptr<SubscriptionSession> w(shared_from_this());
+  result_ = promise<Status>([w] {
+    if (auto self = w.lock()) self->Cancel();
+  });
+  auto f = result_.get_future();
+  std::unique_lock<std::mutex> lk(mu_);
+  active_streams_ = streams_.size();
+  lk.unlock();
+  lease_manager_->Start();
+  for (std::size_t i = 0; i != streams_.size(); ++i) OpenStream(i);
+  return f;
+}
+
+void SubscriptionSession::MessageHandled(std::size_t message_bytes) {
+  std::unique_lock<std::mutex> lk(mu_);
+  --outstanding_messages_;
+  outstanding_bytes_ -= (std::min)(message_bytes, outstanding_bytes_);
+  if (shutdown_ || !HasCapacity()) return;
+  std::vector<std::size_t> resume;
+  for (std::size_t i = 0; i != streams_.size(); ++i) {
+    if (!streams_[i].paused) continue;
+    streams_[i].paused = false;
+    resume.push_back(i);
+  }
+  lk.unlock();
+  for (auto i : resume) ReadNext(i);
+}
+
+void SubscriptionSession::Cancel() {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (shutdown_) return;
+  shutdown_ = true;
+  CancelStreams(std::move(lk));
+}
+
+void SubscriptionSession::OpenStream(std::size_t index) {
+  auto self = shared_from_this();
+  auto context = absl::make_unique<grpc::ClientContext>();
+  std::unique_lock<std::mutex> lk(mu_);
+  if (shutdown_) {
+    --active_streams_;
+    CheckDone(std::move(lk));
+    return;
+  }
+  auto& stream = streams_[index];
+  stream.rpc = stream.stub->AsyncStreamingPull(cq_, std::move(context));
+  auto* rpc = stream.rpc.get();
+  lk.unlock();
+  rpc->Start().then(
+      [self, index](future<bool> f) { self->OnStart(index, f.get()); });
+}
+
+void SubscriptionSession::OnStart(std::size_t index, bool ok) {
+  if (!ok) {
+    FinishStream(index);
+    return;
+  }
+  google::pubsub::v1::StreamingPullRequest request;
+  request.set_subscription(params_.full_subscription_name);
+  request.set_stream_ack_deadline_seconds(kStreamAckDeadlineSeconds);
+
+  auto self = shared_from_this();
+  std::unique_lock<std::mutex> lk(mu_);
+  auto* rpc = streams_[index].rpc.get();
+  lk.unlock();
+  rpc->Write(request, grpc::WriteOptions{})
+      .then([self, index](future<bool> f) {
+        if (!f.get()) {
+          self->FinishStream(index);
+          return;
+        }
+        self->ReadNext(index);
+      });
+}
+
+void SubscriptionSession::ReadNext(std::size_t index) {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (shutdown_) {
+    lk.unlock();
+    FinishStream(index);
+    return;
+  }
+  if (!HasCapacity()) {
+    streams_[index].paused = true;
+    return;
+  }
+  auto self = shared_from_this();
+  auto* rpc = streams_[index].rpc.get();
+  lk.unlock();
+  rpc->Read().then(
+      [self, index](
+          future<absl::optional<google::pubsub::v1::StreamingPullResponse>>
+              f) { self->OnRead(index, f.get()); });
+}
+
+void SubscriptionSession::OnRead(
+    std::size_t index,
+    absl::optional<google::pubsub::v1::StreamingPullResponse> r) {
+  if (!r) {
+    FinishStream(index);
+    return;
+  }
+  std::unique_lock<std::mutex> lk(mu_);
+  if (shutdown_) {
+    lk.unlock();
+    // The response arrived after `CancelStreams()`, reject the messages right
+    // away, as it does for the messages that were never delivered.
+    for (auto& m : *r->mutable_received_messages()) {
+      ack_batcher_->Nack(std::move(*m.mutable_ack_id()));
+    }
+    ack_batcher_->Flush();
+    FinishStream(index);
+    return;
+  }
+  // Add the leases while holding the lock, so `CancelStreams()` either sees
+  // these messages, or they are rejected above.
+  for (auto const& m : r->received_messages()) lease_manager_->Add(m.ack_id());
+  auto& stream = streams_[index];
+  stream.backoff = StreamBackoffPolicy();
+  for (auto& m : *r->mutable_received_messages()) {
+    ++outstanding_messages_;
+    outstanding_bytes_ += m.message().data().size();
+    messages_.push_back(Item{std::move(m)});
+  }
+  Dispatch(std::move(lk));
+  // Streams may satisfy `Read()` immediately, calling `ReadNext()` from here
+  // would recurse without bound as long as the callbacks keep up.
+  auto self = shared_from_this();
+  cq_.RunAsync([self, index] { self->ReadNext(index); });
+}
+
+void SubscriptionSession::FinishStream(std::size_t index) {
+  auto self = shared_from_this();
+  std::unique_lock<std::mutex> lk(mu_);
+  auto* rpc = streams_[index].rpc.get();
+  lk.unlock();
+  rpc->Finish().then(
+      [self, index](future<Status> f) { self->OnFinish(index, f.get()); });
+}
+
+void SubscriptionSession::OnFinish(std::size_t index, Status status) {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (!shutdown_ && IsRetryable(status)) {
+    auto const delay = streams_[index].backoff->OnCompletion();
+    lk.unlock();
+    auto self = shared_from_this();
+    cq_.MakeRelativeTimer(delay).then(
+        [self, index](future<StatusOr<std::chrono::system_clock::time_point>>) {
+          self->OpenStream(index);
+        });
+    return;
+  }
+  --active_streams_;
+  if (shutdown_) {
+    CheckDone(std::move(lk));
+    return;
+  }
+  // A permanent error in any stream terminates the session.
+  shutdown_ = true;
+  status_ = std::move(status);
+  CancelStreams(std::move(lk));
+}
+
+void SubscriptionSession::RunCallback(Item item) {
+  auto const message_bytes = item.message.message().data().size();
+  auto handler = absl::make_unique<SessionAckHandlerImpl>(
+      shared_from_this(), ack_batcher_, lease_manager_,
+      std::move(*item.message.mutable_ack_id()), message_bytes);
+  params_.callback(FromProto(std::move(*item.message.mutable_message())),
+                   pubsub::AckHandler(std::move(handler)));
+
+  std::unique_lock<std::mutex> lk(mu_);
+  --running_callbacks_;
+  if (shutdown_) {
+    CheckDone(std::move(lk));
+    return;
+  }
+  Dispatch(std::move(lk));
+}
+
+bool SubscriptionSession::HasCapacity() const {
+  return outstanding_messages_ < options_.max_outstanding_messages() &&
+         outstanding_bytes_ < options_.max_outstanding_bytes();
+}
+
+void SubscriptionSession::CancelStreams(std::unique_lock<std::mutex> lk) {
+  // Once `shutdown_` is set the streams are never replaced, so it is safe to
+  // cancel them without holding the lock.
+  std::vector<SubscriberStub::AsyncPullStream*> rpcs;
+  std::vector<std::size_t> paused;
+  for (std::size_t i = 0; i != streams_.size(); ++i) {
+    auto& stream = streams_[i];
+    if (stream.rpc) rpcs.push_back(stream.rpc.get());
+    if (!stream.paused) continue;
+    stream.paused = false;
+    paused.push_back(i);
+  }
+  // Reject the messages that were never delivered, so the service can send
+  // them to other subscribers without waiting for their ack deadline.
+  for (auto& item : messages_) {
+    --outstanding_messages_;
+    outstanding_bytes_ -= (std::min)(
+        static_cast<std::size_t>(item.message.message().data().size()),
+        outstanding_bytes_);
+    lease_manager_->Remove(item.message.ack_id());
+    ack_batcher_->Nack(std::move(*item.message.mutable_ack_id()));
+  }
+  messages_.clear();
+  lk.unlock();
+
+  for (auto* rpc : rpcs) rpc->Cancel();
+  ack_batcher_->Flush();
+  for (auto i : paused) FinishStream(i);
+  CheckDone(std::unique_lock<std::mutex>(mu_));
+}
+
+void SubscriptionSession::Dispatch(std::unique_lock<std::mutex> lk) {
+  std::vector<Item> ready;
+  while (!shutdown_ && !messages_.empty() &&
+         running_callbacks_ < options_.max_concurrency()) {
+    ready.push_back(std::move(messages_.front()));
+    messages_.pop_front();
+    ++running_callbacks_;
+  }
+  lk.unlock();
+  if (ready.empty()) return;
+  auto self = shared_from_this();
+  for (auto& item : ready) cq_.RunAsync(CallbackRunner{self, std::move(item)});
+}
+
+void SubscriptionSession::CheckDone(std::unique_lock<std::mutex> lk) {
+  if (done_ || !shutdown_ || active_streams_ != 0 || running_callbacks_ != 0) {
+    return;
+  }
+  done_ = true;
+  auto status = std::move(status_);
+  lk.unlock();
+  // Send any acks from the last callbacks without waiting for the timer.
+  lease_manager_->Shutdown();
+  ack_batcher_->Flush();
+  result_.set_value(std::move(status));
+}
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,149 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_SUBSCRIPTION_SESSION_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_SUBSCRIPTION_SESSION_H
+
+#include "google/cloud/pubsub/internal/ack_batcher.h"
+#include "google/cloud/pubsub/internal/lease_manager.h"
+#include "google/cloud/pubsub/internal/subscriber_stub.h"
+#include "google/cloud/pubsub/subscriber_connection.h"
+#include "google/cloud/pubsub/subscriber_options.h"
+#include "google/cloud/pubsub/version.h"
+#include "google/cloud/completion_queue.h"
+#include "google/cloud/future.h"
+#include "google/cloud/internal/backoff_policy.h"
+#include "google/cloud/status.h"
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+/**
+ * Receives messages from a subscription and delivers them to a callback.
+ *
+ * The session keeps `SubscriberOptions::concurrent_streams()` `StreamingPull`
+ * streams open, spread across the stubs (and therefore channels) it receives.
+ * All the stream operations run asynchronously on the `CompletionQueue`, and
+ * the callbacks are scheduled on the same completion queue, with at most
+ * `SubscriberOptions::max_concurrency()` callbacks running at a time.
+ *
+ * The session implements flow control: once the number (or total size) of
+ * messages received and not yet handled by the application reaches the
+ * limits in `SubscriberOptions` the streams stop reading, they resume as the
+ * application acknowledges or rejects messages.
+ *
+ * The acks and nacks from all the handlers are sent in batches, see
+ * `AckBatcher` for details. The session also extends the ack deadline of the
+ * messages until they are handled, see `LeaseManager`.
+ *
+ * Streams that are closed with transient errors are re-opened with an
+ * exponential backoff. The session ends when the application cancels the
+ * future returned by `Start()`, or when any stream fails with a permanent
+ * error.
+ */
+class SubscriptionSession
+    : public std::enable_shared_from_this<SubscriptionSession> {
+ public:
+  /**
+   * Create a new session.
+   *
+   * The ack and nack counters are accumulated in @p ack_counters, if provided,
+   * so the caller can report them across all its sessions.
+   */
+  static std::shared_ptr<SubscriptionSession> Create(
+      std::vector<std::shared_ptr<SubscriberStub>> stubs,
+      google::cloud::CompletionQueue cq, pubsub::SubscriberOptions options,
+      pubsub::SubscriberConnection::SubscribeParams params,
+      std::shared_ptr<AckBatcherCounters> ack_counters = {});
+
+  /**
+   * Start receiving messages.
+   *
+   * The returned future is satisfied when the session ends. Cancelling the
+   * future stops the session, it is satisfied once all the streams are closed
+   * and no callbacks are running.
+   */
+  future<Status> Start();
+
+  /// Called when the application acknowledges or rejects a message.
+  void MessageHandled(std::size_t message_bytes);
+
+ private:
+  SubscriptionSession(std::vector<std::shared_ptr<SubscriberStub>> stubs,
+                      google::cloud::CompletionQueue cq,
+                      pubsub::SubscriberOptions options,
+                      pubsub::SubscriberConnection::SubscribeParams params,
+                      std::shared_ptr<AckBatcherCounters> ack_counters);
+
+  struct Stream {
+    std::shared_ptr<SubscriberStub> stub;
+    std::unique_ptr<SubscriberStub::AsyncPullStream> rpc;
+    std::unique_ptr<google::cloud::internal::BackoffPolicy> backoff;
+    // Set when flow control stopped reading from this stream.
+    bool paused = false;
+  };
+
+  struct Item {
+    google::pubsub::v1::ReceivedMessage message;
+  };
+
+  void Cancel();
+  void OpenStream(std::size_t index);
+  void OnStart(std::size_t index, bool ok);
+  void ReadNext(std::size_t index);
+  void OnRead(std::size_t index,
+              absl::optional<google::pubsub::v1::StreamingPullResponse> r);
+  void FinishStream(std::size_t index);
+  void OnFinish(std::size_t index, Status status);
+  void RunCallback(Item item);
+
+  struct CallbackRunner;
+
+  bool HasCapacity() const;
+  void CancelStreams(std::unique_lock<std::mutex> lk);
+  void Dispatch(std::unique_lock<std::mutex> lk);
+  void CheckDone(std::unique_lock<std::mutex> lk);
+
+  google::cloud::CompletionQueue cq_;
+  pubsub::SubscriberOptions const options_;
+  pubsub::SubscriberConnection::SubscribeParams const params_;
+  std::shared_ptr<AckBatcher> const ack_batcher_;
+  std::shared_ptr<LeaseManager> const lease_manager_;
+
+  std::mutex mu_;
+  std::vector<Stream> streams_;           // GUARDED_BY(mu_)
+  std::size_t active_streams_ = 0;        // GUARDED_BY(mu_)
+  std::deque<Item> messages_;             // GUARDED_BY(mu_)
+  std::size_t outstanding_messages_ = 0;  // GUARDED_BY(mu_)
+  std::size_t outstanding_bytes_ = 0;     // GUARDED_BY(mu_)
+  std::size_t running_callbacks_ = 0;     // GUARDED_BY(mu_)
+  bool shutdown_ = false;                 // GUARDED_BY(mu_)
+  bool done_ = false;                     // GUARDED_BY(mu_)
+  Status status_;                         // GUARDED_BY(mu_)
+  promise<Status> result_;
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_SUBSCRIPTION_SESSION_H
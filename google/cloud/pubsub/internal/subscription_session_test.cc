@@ -0,0 +1,491 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/pubsub/internal/subscription_session.h"
+#include "google/cloud/pubsub/testing/mock_subscriber_stub.h"
+#include "google/cloud/internal/background_threads_impl.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+namespace {
+
+using ::google::pubsub::v1::StreamingPullRequest;
+using ::google::pubsub::v1::StreamingPullResponse;
+using ::testing::_;
+using ::testing::AtLeast;
+using ::testing::ElementsAre;
+
+/// Generates responses with @p count messages, with sequential ids.
+class ResponseGenerator {
+ public:
+  explicit ResponseGenerator(int count, std::string data = "test-data")
+      : count_(count), data_(std::move(data)) {}
+
+  StreamingPullResponse operator()() {
+    StreamingPullResponse response;
+    for (int i = 0; i != count_; ++i) {
+      auto const id = std::to_string(next_++);
+      auto& m = *response.add_received_messages();
+      m.set_ack_id("test-ack-id-" + id);
+      m.mutable_message()->set_message_id("test-message-id-" + id);
+      m.mutable_message()->set_data(data_);
+    }
+    return response;
+  }
+
+ private:
+  int count_;
+  std::string data_;
+  std::atomic<int> next_{0};
+};
+
+/**
+ * Creates a mock stream, all its operations complete immediately.
+ *
+ * The stream returns a response from @p generator on each `Read()`, until it
+ * is cancelled. @p reads counts the calls to `Read()`.
+ */
+std::unique_ptr<SubscriberStub::AsyncPullStream> MakeStream(
+    std::string const& subscription,
+    std::shared_ptr<ResponseGenerator> generator,
+    std::shared_ptr<std::atomic<int>> reads) {
+  auto stream = absl::make_unique<pubsub_testing::MockAsyncPullStream>();
+  auto cancelled = std::make_shared<std::atomic<bool>>(false);
+  EXPECT_CALL(*stream, Start()).WillOnce([] {
+    return make_ready_future(true);
+  });
+  EXPECT_CALL(*stream, Write(_, _))
+      .WillOnce([subscription](StreamingPullRequest const& request,
+                               grpc::WriteOptions const&) {
+        EXPECT_EQ(subscription, request.subscription());
+        EXPECT_LT(0, request.stream_ack_deadline_seconds());
+        return make_ready_future(true);
+      });
+  EXPECT_CALL(*stream, Read()).WillRepeatedly([cancelled, generator, reads] {
+    if (*cancelled) {
+      return make_ready_future(absl::optional<StreamingPullResponse>{});
+    }
+    ++*reads;
+    return make_ready_future(absl::make_optional((*generator)()));
+  });
+  EXPECT_CALL(*stream, Cancel()).WillRepeatedly([cancelled] {
+    *cancelled = true;
+  });
+  EXPECT_CALL(*stream, Finish()).WillOnce([] {
+    return make_ready_future(Status(StatusCode::kCancelled, "cancelled"));
+  });
+  return std::unique_ptr<SubscriberStub::AsyncPullStream>(std::move(stream));
+}
+
+pubsub::SubscriberOptions TestOptions() {
+  return pubsub::SubscriberOptions{}.set_concurrent_streams(1);
+}
+
+/// Collect the handlers so the test controls when messages are handled.
+class HandlerCollector {
+ public:
+  void operator()(pubsub::Message const& m, pubsub::AckHandler h) {
+    std::lock_guard<std::mutex> lk(mu_);
+    ids_.push_back(m.message_id());
+    handlers_.push_back(std::move(h));
+    cv_.notify_all();
+  }
+
+  void WaitFor(std::size_t count) {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait(lk, [&] { return handlers_.size() >= count; });
+  }
+
+  std::vector<std::string> ids() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return ids_;
+  }
+
+  std::vector<pubsub::AckHandler> Release() {
+    std::lock_guard<std::mutex> lk(mu_);
+    std::vector<pubsub::AckHandler> tmp;
+    tmp.swap(handlers_);
+    return tmp;
+  }
+
+ private:
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::vector<std::string> ids_;
+  std::vector<pubsub::AckHandler> handlers_;
+};
+
+TEST(SubscriptionSessionTest, FlowControlMessages) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  pubsub::Subscription const subscription("test-project", "test-sub");
+  auto generator = std::make_shared<ResponseGenerator>(1);
+  auto reads = std::make_shared<std::atomic<int>>(0);
+  EXPECT_CALL(*mock, AsyncStreamingPull(_, _))
+      .WillOnce([&](google::cloud::CompletionQueue&,
+                    std::unique_ptr<grpc::ClientContext>) {
+        return MakeStream(subscription.FullName(), generator, reads);
+      });
+  EXPECT_CALL(*mock, AsyncAcknowledge(_, _, _))
+      .WillOnce([](google::cloud::CompletionQueue&,
+                   std::unique_ptr<grpc::ClientContext>,
+                   google::pubsub::v1::AcknowledgeRequest const& request) {
+        EXPECT_THAT(request.ack_ids(), ElementsAre("test-ack-id-0"));
+        return make_ready_future(Status{});
+      });
+  EXPECT_CALL(*mock, AsyncModifyAckDeadline(_, _, _)).Times(0);
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto collector = std::make_shared<HandlerCollector>();
+  auto session = SubscriptionSession::Create(
+      {mock}, bg.cq(), TestOptions().set_max_outstanding_messages(2),
+      {subscription.FullName(),
+       [collector](pubsub::Message const& m, pubsub::AckHandler h) {
+         (*collector)(m, std::move(h));
+       }});
+  auto result = session->Start();
+
+  // The stream stops reading once two messages are outstanding.
+  collector->WaitFor(2);
+  EXPECT_EQ(2, reads->load());
+  auto handlers = collector->Release();
+  ASSERT_EQ(2, handlers.size());
+
+  // Handling a message resumes the stream, which reads exactly one more. The
+  // stream may not be paused yet, the read scheduled after the second message
+  // can still be pending, so wait for the new message.
+  std::move(handlers[0]).ack();
+  collector->WaitFor(1);
+  EXPECT_EQ(3, reads->load());
+
+  result.cancel();
+  EXPECT_STATUS_OK(result.get());
+  EXPECT_THAT(collector->ids(),
+              ElementsAre("test-message-id-0", "test-message-id-1",
+                          "test-message-id-2"));
+  collector->Release();
+}
+
+TEST(SubscriptionSessionTest, FlowControlBytes) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  pubsub::Subscription const subscription("test-project", "test-sub");
+  auto generator = std::make_shared<ResponseGenerator>(1, "0123456789");
+  auto reads = std::make_shared<std::atomic<int>>(0);
+  EXPECT_CALL(*mock, AsyncStreamingPull(_, _))
+      .WillOnce([&](google::cloud::CompletionQueue&,
+                    std::unique_ptr<grpc::ClientContext>) {
+        return MakeStream(subscription.FullName(), generator, reads);
+      });
+
+  // The messages still queued when the session stops are rejected.
+  EXPECT_CALL(*mock, AsyncModifyAckDeadline(_, _, _))
+      .WillRepeatedly([] { return make_ready_future(Status{}); });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto collector = std::make_shared<HandlerCollector>();
+  auto session = SubscriptionSession::Create(
+      {mock}, bg.cq(), TestOptions().set_max_outstanding_bytes(15),
+      {subscription.FullName(),
+       [collector](pubsub::Message const& m, pubsub::AckHandler h) {
+         (*collector)(m, std::move(h));
+       }});
+  auto result = session->Start();
+
+  collector->WaitFor(2);
+  EXPECT_EQ(2, reads->load());
+
+  // Dropping the handlers also releases the flow control budget.
+  collector->Release();
+  collector->WaitFor(1);
+  EXPECT_LE(3, reads->load());
+
+  result.cancel();
+  EXPECT_STATUS_OK(result.get());
+  collector->Release();
+}
+
+TEST(SubscriptionSessionTest, ConcurrentCallbacks) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  pubsub::Subscription const subscription("test-project", "test-sub");
+  auto generator = std::make_shared<ResponseGenerator>(4);
+  auto reads = std::make_shared<std::atomic<int>>(0);
+  EXPECT_CALL(*mock, AsyncStreamingPull(_, _))
+      .WillOnce([&](google::cloud::CompletionQueue&,
+                    std::unique_ptr<grpc::ClientContext>) {
+        return MakeStream(subscription.FullName(), generator, reads);
+      });
+  EXPECT_CALL(*mock, AsyncAcknowledge(_, _, _))
+      .WillRepeatedly([] { return make_ready_future(Status{}); });
+  EXPECT_CALL(*mock, AsyncModifyAckDeadline(_, _, _))
+      .WillRepeatedly([] { return make_ready_future(Status{}); });
+
+  google::cloud::CompletionQueue cq;
+  std::vector<std::thread> threads;
+  for (int i = 0; i != 6; ++i) threads.emplace_back([&cq] { cq.Run(); });
+
+  // Block each callback until `kConcurrency` of them are running at the same
+  // time, which can only happen if they are dispatched concurrently.
+  auto constexpr kConcurrency = 3;
+  std::mutex mu;
+  std::condition_variable cv;
+  int running = 0;
+  int max_running = 0;
+  int total = 0;
+  auto handler = [&](pubsub::Message const&, pubsub::AckHandler h) {
+    std::unique_lock<std::mutex> lk(mu);
+    ++running;
+    max_running = (std::max)(max_running, running);
+    cv.notify_all();
+    cv.wait_for(lk, std::chrono::seconds(5),
+                [&] { return max_running >= kConcurrency; });
+    --running;
+    ++total;
+    cv.notify_all();
+    lk.unlock();
+    std::move(h).ack();
+  };
+
+  auto session = SubscriptionSession::Create(
+      {mock}, cq, TestOptions().set_max_concurrency(kConcurrency),
+      {subscription.FullName(), handler});
+  auto result = session->Start();
+  {
+    std::unique_lock<std::mutex> lk(mu);
+    cv.wait(lk, [&] { return total >= 20; });
+  }
+  result.cancel();
+  EXPECT_STATUS_OK(result.get());
+  EXPECT_EQ(kConcurrency, max_running);
+
+  cq.Shutdown();
+  for (auto& t : threads) t.join();
+}
+
+TEST(SubscriptionSessionTest, StreamsAcrossStubs) {
+  pubsub::Subscription const subscription("test-project", "test-sub");
+  auto generator = std::make_shared<ResponseGenerator>(1);
+  auto reads = std::make_shared<std::atomic<int>>(0);
+  auto make_stream = [&](google::cloud::CompletionQueue&,
+                         std::unique_ptr<grpc::ClientContext>) {
+    return MakeStream(subscription.FullName(), generator, reads);
+  };
+  auto mock0 = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  EXPECT_CALL(*mock0, AsyncStreamingPull(_, _))
+      .Times(2)
+      .WillRepeatedly(make_stream);
+  auto mock1 = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  EXPECT_CALL(*mock1, AsyncStreamingPull(_, _)).WillOnce(make_stream);
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto collector = std::make_shared<HandlerCollector>();
+  auto session = SubscriptionSession::Create(
+      {mock0, mock1}, bg.cq(),
+      TestOptions().set_concurrent_streams(3).set_max_outstanding_messages(3),
+      {subscription.FullName(),
+       [collector](pubsub::Message const& m, pubsub::AckHandler h) {
+         (*collector)(m, std::move(h));
+       }});
+  auto result = session->Start();
+  // Each stream checks the flow control limits before its read, so the
+  // streams may read a few more messages than the limit.
+  collector->WaitFor(3);
+  EXPECT_LE(3, reads->load());
+
+  result.cancel();
+  EXPECT_STATUS_OK(result.get());
+  collector->Release();
+}
+
+TEST(SubscriptionSessionTest, RetryTransientErrors) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  pubsub::Subscription const subscription("test-project", "test-sub");
+  auto generator = std::make_shared<ResponseGenerator>(1);
+  auto reads = std::make_shared<std::atomic<int>>(0);
+  EXPECT_CALL(*mock, AsyncStreamingPull(_, _))
+      .WillOnce([](google::cloud::CompletionQueue&,
+                   std::unique_ptr<grpc::ClientContext>) {
+        auto stream = absl::make_unique<pubsub_testing::MockAsyncPullStream>();
+        EXPECT_CALL(*stream, Start()).WillOnce([] {
+          return make_ready_future(false);
+        });
+        EXPECT_CALL(*stream, Finish()).WillOnce([] {
+          return make_ready_future(Status(StatusCode::kUnavailable, "retry"));
+        });
+        EXPECT_CALL(*stream, Cancel()).Times(AtLeast(0));
+        return std::unique_ptr<SubscriberStub::AsyncPullStream>(
+            std::move(stream));
+      })
+      .WillOnce([&](google::cloud::CompletionQueue&,
+                    std::unique_ptr<grpc::ClientContext>) {
+        return MakeStream(subscription.FullName(), generator, reads);
+      });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto collector = std::make_shared<HandlerCollector>();
+  auto session = SubscriptionSession::Create(
+      {mock}, bg.cq(), TestOptions().set_max_outstanding_messages(1),
+      {subscription.FullName(),
+       [collector](pubsub::Message const& m, pubsub::AckHandler h) {
+         (*collector)(m, std::move(h));
+       }});
+  auto result = session->Start();
+  collector->WaitFor(1);
+
+  result.cancel();
+  EXPECT_STATUS_OK(result.get());
+  collector->Release();
+}
+
+TEST(SubscriptionSessionTest, PermanentError) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  pubsub::Subscription const subscription("test-project", "test-sub");
+  auto const expected = Status(StatusCode::kPermissionDenied, "uh-oh");
+  EXPECT_CALL(*mock, AsyncStreamingPull(_, _))
+      .WillOnce([&](google::cloud::CompletionQueue&,
+                    std::unique_ptr<grpc::ClientContext>) {
+        auto stream = absl::make_unique<pubsub_testing::MockAsyncPullStream>();
+        EXPECT_CALL(*stream, Start()).WillOnce([] {
+          return make_ready_future(true);
+        });
+        EXPECT_CALL(*stream, Write(_, _)).WillOnce([] {
+          return make_ready_future(true);
+        });
+        EXPECT_CALL(*stream, Read()).WillOnce([] {
+          return make_ready_future(absl::optional<StreamingPullResponse>{});
+        });
+        EXPECT_CALL(*stream, Finish()).WillOnce([expected] {
+          return make_ready_future(expected);
+        });
+        EXPECT_CALL(*stream, Cancel()).Times(AtLeast(0));
+        return std::unique_ptr<SubscriberStub::AsyncPullStream>(
+            std::move(stream));
+      });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto session = SubscriptionSession::Create(
+      {mock}, bg.cq(), TestOptions(),
+      {subscription.FullName(), [](pubsub::Message const&, pubsub::AckHandler) {
+         ADD_FAILURE() << "unexpected callback";
+       }});
+  EXPECT_EQ(expected, session->Start().get());
+}
+
+TEST(SubscriptionSessionTest, CancelRejectsUndeliveredMessages) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  pubsub::Subscription const subscription("test-project", "test-sub");
+  auto generator = std::make_shared<ResponseGenerator>(3);
+  auto reads = std::make_shared<std::atomic<int>>(0);
+  EXPECT_CALL(*mock, AsyncStreamingPull(_, _))
+      .WillOnce([&](google::cloud::CompletionQueue&,
+                    std::unique_ptr<grpc::ClientContext>) {
+        return MakeStream(subscription.FullName(), generator, reads);
+      });
+  EXPECT_CALL(*mock, AsyncModifyAckDeadline(_, _, _))
+      .WillOnce([&](google::cloud::CompletionQueue&,
+                    std::unique_ptr<grpc::ClientContext>,
+                    google::pubsub::v1::ModifyAckDeadlineRequest const& r) {
+        EXPECT_EQ(subscription.FullName(), r.subscription());
+        EXPECT_EQ(0, r.ack_deadline_seconds());
+        EXPECT_THAT(r.ack_ids(),
+                    ElementsAre("test-ack-id-1", "test-ack-id-2"));
+        return make_ready_future(Status{});
+      });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  // Block the only callback until the session is cancelled.
+  promise<void> started;
+  promise<void> release;
+  auto release_future = release.get_future();
+  auto session = SubscriptionSession::Create(
+      {mock}, bg.cq(),
+      TestOptions().set_max_concurrency(1).set_max_outstanding_messages(3),
+      {subscription.FullName(),
+       [&](pubsub::Message const& m, pubsub::AckHandler) {
+         EXPECT_EQ("test-message-id-0", m.message_id());
+         started.set_value();
+         release_future.get();
+       }});
+  auto result = session->Start();
+  started.get_future().get();
+  result.cancel();
+  // The session waits for the running callback.
+  EXPECT_EQ(std::future_status::timeout,
+            result.wait_for(std::chrono::milliseconds(10)));
+  release.set_value();
+  EXPECT_STATUS_OK(result.get());
+}
+
+TEST(SubscriptionSessionTest, CancelRejectsLateResponses) {
+  auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+  pubsub::Subscription const subscription("test-project", "test-sub");
+  promise<absl::optional<StreamingPullResponse>> read;
+  EXPECT_CALL(*mock, AsyncStreamingPull(_, _))
+      .WillOnce([&](google::cloud::CompletionQueue&,
+                    std::unique_ptr<grpc::ClientContext>) {
+        auto stream = absl::make_unique<pubsub_testing::MockAsyncPullStream>();
+        EXPECT_CALL(*stream, Start()).WillOnce([] {
+          return make_ready_future(true);
+        });
+        EXPECT_CALL(*stream, Write(_, _)).WillOnce([] {
+          return make_ready_future(true);
+        });
+        // The read is still pending when the session is cancelled.
+        EXPECT_CALL(*stream, Read()).WillOnce([&read] {
+          return read.get_future();
+        });
+        EXPECT_CALL(*stream, Cancel()).Times(AtLeast(1));
+        EXPECT_CALL(*stream, Finish()).WillOnce([] {
+          return make_ready_future(Status(StatusCode::kCancelled, "cancelled"));
+        });
+        return std::unique_ptr<SubscriberStub::AsyncPullStream>(
+            std::move(stream));
+      });
+  EXPECT_CALL(*mock, AsyncModifyAckDeadline(_, _, _))
+      .WillOnce([](google::cloud::CompletionQueue&,
+                   std::unique_ptr<grpc::ClientContext>,
+                   google::pubsub::v1::ModifyAckDeadlineRequest const& r) {
+        EXPECT_EQ(0, r.ack_deadline_seconds());
+        EXPECT_THAT(r.ack_ids(),
+                    ElementsAre("test-ack-id-0", "test-ack-id-1"));
+        return make_ready_future(Status{});
+      });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto session = SubscriptionSession::Create(
+      {mock}, bg.cq(), TestOptions(),
+      {subscription.FullName(), [](pubsub::Message const&, pubsub::AckHandler) {
+         ADD_FAILURE() << "unexpected callback";
+       }});
+  auto result = session->Start();
+  result.cancel();
+  EXPECT_EQ(std::future_status::timeout,
+            result.wait_for(std::chrono::milliseconds(10)));
+
+  // The messages in the late response are rejected, not delivered.
+  read.set_value(ResponseGenerator(2)());
+  EXPECT_STATUS_OK(result.get());
+}
+
+}  // namespace
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
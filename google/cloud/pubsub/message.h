@@ -136,18 +136,48 @@ class MessageBuilder {
   /// Create a new message.
   Message Build() && { return Message(std::move(proto_)); }
 
-  /// Create a message with the data in @p data
-  MessageBuilder& SetData(std::string data) & {
+  /// Create a message with a copy of the data in @p data
+  MessageBuilder& SetData(std::string const& data) & {
+    proto_.set_data(data);
+    return *this;
+  }
+
+  /**
+   * Create a message with the data in @p data
+   *
+   * The message takes ownership of the buffer in @p data. The buffer is never
+   * copied as the message moves through the publisher, only gRPC reads it, to
+   * serialize the request.
+   */
+  MessageBuilder& SetData(std::string&& data) & {
     proto_.set_data(std::move(data));
     return *this;
   }
 
-  /// Create a message with the data in @p data
-  MessageBuilder&& SetData(std::string data) && {
+  /// Create a message with a copy of the data in @p data
+  MessageBuilder&& SetData(std::string const& data) && {
+    SetData(data);
+    return std::move(*this);
+  }
+
+  /// @copydoc SetData(std::string&&) &
+  MessageBuilder&& SetData(std::string&& data) && {
     SetData(std::move(data));
     return std::move(*this);
   }
 
+  /// Create a message with the ordering key in @p key
+  MessageBuilder& SetOrderingKey(std::string key) & {
+    proto_.set_ordering_key(std::move(key));
+    return *this;
+  }
+
+  /// Create a message with the ordering key in @p key
+  MessageBuilder&& SetOrderingKey(std::string key) && {
+    SetOrderingKey(std::move(key));
+    return std::move(*this);
+  }
+
   /// Create a message with the attributes from the range [@p begin, @p end)
   template <typename Iterator>
   MessageBuilder& SetAttributes(Iterator begin, Iterator end) & {
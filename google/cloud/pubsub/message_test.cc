@@ -93,6 +93,35 @@ TEST(Message, SetData) {
   EXPECT_EQ("changed", m0.data());
 }
 
+TEST(Message, SetDataMovesBuffer) {
+  // Use a payload larger than any small string optimization buffer.
+  std::string data(4096, 'x');
+  auto const* buffer = data.data();
+  auto m0 = MessageBuilder{}.SetData(std::move(data)).Build();
+  EXPECT_EQ(buffer, m0.data().data());
+  EXPECT_EQ(buffer, pubsub_internal::ToProto(std::move(m0)).data().data());
+
+  std::string const original(4096, 'y');
+  MessageBuilder builder;
+  builder.SetData(original);
+  auto const m1 = std::move(builder).Build();
+  EXPECT_EQ(original, m1.data());
+  EXPECT_NE(original.data(), m1.data().data());
+}
+
+TEST(Message, SetOrderingKey) {
+  auto const m0 =
+      MessageBuilder{}.SetData("data").SetOrderingKey("key-0").Build();
+  EXPECT_EQ("data", m0.data());
+  EXPECT_EQ("key-0", m0.ordering_key());
+
+  MessageBuilder builder;
+  builder.SetOrderingKey("key-1");
+  auto const m1 = std::move(builder).Build();
+  EXPECT_EQ("key-1", m1.ordering_key());
+  EXPECT_NE(m0, m1);
+}
+
 TEST(Message, SetAttributesIterator) {
   std::map<std::string, std::string> const attributes(
       {{"k1", "v1"}, {"k2", "v2"}});
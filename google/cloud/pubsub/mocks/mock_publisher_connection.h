@@ -27,6 +27,12 @@ class MockPublisherConnection : public pubsub::PublisherConnection {
  public:
   MOCK_METHOD(future<StatusOr<std::string>>, Publish,
               (pubsub::PublisherConnection::PublishParams), (override));
+  MOCK_METHOD(void, ResumePublish,
+              (pubsub::PublisherConnection::ResumePublishParams), (override));
+  MOCK_METHOD(pubsub::PublisherFlowControlMetrics, GetFlowControlMetrics, (),
+              (override));
+  MOCK_METHOD(pubsub::PublisherCompressionMetrics, GetCompressionMetrics, (),
+              (override));
 };
 
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
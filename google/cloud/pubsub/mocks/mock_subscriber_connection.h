@@ -27,6 +27,7 @@ class MockSubscriberConnection : public pubsub::SubscriberConnection {
  public:
   MOCK_METHOD(future<Status>, Subscribe,
               (pubsub::SubscriberConnection::SubscribeParams), (override));
+  MOCK_METHOD(pubsub::SubscriberAckMetrics, GetAckMetrics, (), (override));
 };
 
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
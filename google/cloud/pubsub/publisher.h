@@ -120,6 +120,44 @@ class Publisher {
     return connection_->Publish({std::move(m)});
   }
 
+  /**
+   * Resumes publishing messages with @p ordering_key.
+   *
+   * With message ordering enabled, an error publishing a message with an
+   * ordering key fails all the pending messages with that key, and any new
+   * messages with the same key are rejected. Once the application has handled
+   * the error it calls this function to publish messages with the key again.
+   *
+   * @see `PublisherOptions::enable_message_ordering()`
+   */
+  void ResumePublish(std::string ordering_key) {
+    connection_->ResumePublish({std::move(ordering_key)});
+  }
+
+  /**
+   * Returns a snapshot of the flow control counters.
+   *
+   * The counters cover all the messages published via this publisher's
+   * connection, the same scope as the flow control limits.
+   *
+   * @see `PublisherOptions::set_max_outstanding_messages()`
+   */
+  PublisherFlowControlMetrics GetFlowControlMetrics() {
+    return connection_->GetFlowControlMetrics();
+  }
+
+  /**
+   * Returns a snapshot of the compression counters.
+   *
+   * The counters cover all the batches sent via this publisher's connection,
+   * the same scope as the compression CPU budget.
+   *
+   * @see `PublisherOptions::set_compression_cpu_budget()`
+   */
+  PublisherCompressionMetrics GetCompressionMetrics() {
+    return connection_->GetCompressionMetrics();
+  }
+
  private:
   std::shared_ptr<PublisherConnection> connection_;
 };
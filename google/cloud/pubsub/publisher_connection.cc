@@ -14,8 +14,12 @@
 
 #include "google/cloud/pubsub/publisher_connection.h"
 #include "google/cloud/pubsub/internal/batching_publisher_connection.h"
+#include "google/cloud/pubsub/internal/ordering_key_publisher_connection.h"
 #include "google/cloud/pubsub/internal/publisher_stub.h"
+#include "google/cloud/pubsub/internal/sharded_publisher_connection.h"
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -34,6 +38,18 @@ class ContainingPublisherConnection : public PublisherConnection {
     return child_->Publish(std::move(p));
   }
 
+  void ResumePublish(ResumePublishParams p) override {
+    child_->ResumePublish(std::move(p));
+  }
+
+  PublisherFlowControlMetrics GetFlowControlMetrics() override {
+    return child_->GetFlowControlMetrics();
+  }
+
+  PublisherCompressionMetrics GetCompressionMetrics() override {
+    return child_->GetCompressionMetrics();
+  }
+
  private:
   std::shared_ptr<BackgroundThreads> background_;
   std::shared_ptr<PublisherConnection> child_;
@@ -42,17 +58,33 @@ class ContainingPublisherConnection : public PublisherConnection {
 
 PublisherConnection::~PublisherConnection() = default;
 
+void PublisherConnection::ResumePublish(ResumePublishParams) {}
+
+PublisherFlowControlMetrics PublisherConnection::GetFlowControlMetrics() {
+  return {};
+}
+
+PublisherCompressionMetrics PublisherConnection::GetCompressionMetrics() {
+  return {};
+}
+
 std::shared_ptr<PublisherConnection> MakePublisherConnection(
     Topic topic, PublisherOptions options,
     ConnectionOptions const& connection_options) {
-  auto stub = pubsub_internal::CreateDefaultPublisherStub(connection_options,
-                                                          /*channel_id=*/0);
+  auto const channels = static_cast<std::size_t>(
+      (std::max)(connection_options.num_channels(), 1));
+  std::vector<std::shared_ptr<pubsub_internal::PublisherStub>> stubs(channels);
+  int channel_id = 0;
+  std::generate(stubs.begin(), stubs.end(), [&connection_options, &channel_id] {
+    return pubsub_internal::CreateDefaultPublisherStub(connection_options,
+                                                       channel_id++);
+  });
   auto background = connection_options.background_threads_factory()();
   auto cq = background->cq();
   return std::make_shared<ContainingPublisherConnection>(
       std::move(background), pubsub_internal::MakePublisherConnection(
                                  std::move(topic), std::move(options),
-                                 std::move(stub), std::move(cq)));
+                                 std::move(stubs), std::move(cq)));
 }
 
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
@@ -60,13 +92,99 @@ std::shared_ptr<PublisherConnection> MakePublisherConnection(
 
 namespace pubsub_internal {
 inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+namespace {
+/**
+ * Reports the counters of the budgets shared by all the batchers.
+ *
+ * The batchers are spread over several sharded and ordering key connections,
+ * none of which has the complete picture.
+ */
+class MetricsPublisherConnection : public pubsub::PublisherConnection {
+ public:
+  MetricsPublisherConnection(
+      std::shared_ptr<pubsub::PublisherConnection> child,
+      std::shared_ptr<PublisherFlowControl> flow_control,
+      std::shared_ptr<PublisherCompressionBudget> compression)
+      : child_(std::move(child)),
+        flow_control_(std::move(flow_control)),
+        compression_(std::move(compression)) {}
+
+  ~MetricsPublisherConnection() override = default;
+
+  future<StatusOr<std::string>> Publish(PublishParams p) override {
+    return child_->Publish(std::move(p));
+  }
+
+  void ResumePublish(ResumePublishParams p) override {
+    child_->ResumePublish(std::move(p));
+  }
+
+  pubsub::PublisherFlowControlMetrics GetFlowControlMetrics() override {
+    return flow_control_->metrics();
+  }
+
+  pubsub::PublisherCompressionMetrics GetCompressionMetrics() override {
+    return compression_->metrics();
+  }
+
+ private:
+  std::shared_ptr<pubsub::PublisherConnection> child_;
+  std::shared_ptr<PublisherFlowControl> flow_control_;
+  std::shared_ptr<PublisherCompressionBudget> compression_;
+};
+}  // namespace
 
 std::shared_ptr<pubsub::PublisherConnection> MakePublisherConnection(
     pubsub::Topic topic, pubsub::PublisherOptions options,
     std::shared_ptr<PublisherStub> stub, google::cloud::CompletionQueue cq) {
-  return BatchingPublisherConnection::Create(std::move(topic),
-                                             options.batching_config(),
-                                             std::move(stub), std::move(cq));
+  std::vector<std::shared_ptr<PublisherStub>> stubs{std::move(stub)};
+  return MakePublisherConnection(std::move(topic), std::move(options),
+                                 std::move(stubs), std::move(cq));
+}
+
+std::shared_ptr<pubsub::PublisherConnection> MakePublisherConnection(
+    pubsub::Topic topic, pubsub::PublisherOptions options,
+    std::vector<std::shared_ptr<PublisherStub>> stubs,
+    google::cloud::CompletionQueue cq) {
+  // All the batchers share the flow control limits and the compression CPU
+  // budget, they are limits for the publisher, not for each channel or
+  // ordering key.
+  auto flow_control = std::make_shared<PublisherFlowControl>(
+      options.max_outstanding_messages(), options.max_outstanding_bytes());
+  auto compression = std::make_shared<PublisherCompressionBudget>(
+      options.compression_cpu_budget());
+
+  // Use an independent batcher for each stub, so publishers do not contend on
+  // a single lock, and the requests are spread over all the channels.
+  auto unordered_options = options;
+  unordered_options.disable_message_ordering();
+  std::vector<std::shared_ptr<pubsub::PublisherConnection>> children;
+  children.reserve(stubs.size());
+  for (auto const& s : stubs) {
+    children.push_back(BatchingPublisherConnection::Create(
+        topic, unordered_options, s, cq, flow_control, compression));
+  }
+  auto sharded = ShardedPublisherConnection::Create(std::move(children));
+  if (!options.message_ordering()) {
+    return std::make_shared<MetricsPublisherConnection>(
+        std::move(sharded), std::move(flow_control), std::move(compression));
+  }
+
+  // Each ordering key gets its own batches, so messages with different keys
+  // are sent in parallel. Messages without an ordering key do not need to be
+  // sent in sequence.
+  auto factory = [topic, options, stubs, cq, sharded, flow_control,
+                  compression](std::string const& ordering_key)
+      -> std::shared_ptr<pubsub::PublisherConnection> {
+    if (ordering_key.empty()) return sharded;
+    auto const index =
+        ShardedPublisherConnection::ShardIndex(ordering_key, stubs.size());
+    return BatchingPublisherConnection::Create(
+        topic, options, stubs[index], cq, flow_control, compression);
+  };
+  return std::make_shared<MetricsPublisherConnection>(
+      OrderingKeyPublisherConnection::Create(std::move(factory)),
+      std::move(flow_control), std::move(compression));
 }
 
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
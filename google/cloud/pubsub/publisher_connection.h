@@ -18,11 +18,14 @@
 #include "google/cloud/pubsub/connection_options.h"
 #include "google/cloud/pubsub/internal/publisher_stub.h"
 #include "google/cloud/pubsub/message.h"
+#include "google/cloud/pubsub/publisher_metrics.h"
 #include "google/cloud/pubsub/publisher_options.h"
 #include "google/cloud/pubsub/topic.h"
 #include "google/cloud/pubsub/version.h"
 #include "google/cloud/future.h"
 #include "google/cloud/status_or.h"
+#include <string>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -40,6 +43,31 @@ class PublisherConnection {
     Message message;
   };
   virtual future<StatusOr<std::string>> Publish(PublishParams p) = 0;
+
+  struct ResumePublishParams {
+    std::string ordering_key;
+  };
+  /**
+   * Resumes publishing for @p p.ordering_key after an error.
+   *
+   * The default implementation does nothing, as connections without message
+   * ordering never pause publishing.
+   */
+  virtual void ResumePublish(ResumePublishParams p);
+
+  /**
+   * Returns a snapshot of the flow control counters.
+   *
+   * The default implementation returns all zeros.
+   */
+  virtual PublisherFlowControlMetrics GetFlowControlMetrics();
+
+  /**
+   * Returns a snapshot of the compression counters.
+   *
+   * The default implementation returns all zeros.
+   */
+  virtual PublisherCompressionMetrics GetCompressionMetrics();
 };
 
 /**
@@ -71,6 +99,11 @@ inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
 std::shared_ptr<pubsub::PublisherConnection> MakePublisherConnection(
     pubsub::Topic topic, pubsub::PublisherOptions options,
     std::shared_ptr<PublisherStub> stub, google::cloud::CompletionQueue cq);
+
+std::shared_ptr<pubsub::PublisherConnection> MakePublisherConnection(
+    pubsub::Topic topic, pubsub::PublisherOptions options,
+    std::vector<std::shared_ptr<PublisherStub>> stubs,
+    google::cloud::CompletionQueue cq);
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
 }  // namespace pubsub_internal
 }  // namespace cloud
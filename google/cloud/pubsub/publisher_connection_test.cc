@@ -26,6 +26,7 @@ inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
 namespace {
 
 using ::testing::_;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 
 TEST(PublisherConnectionTest, Basic) {
@@ -102,6 +103,195 @@ TEST(PublisherConnectionTest, HandleError) {
   EXPECT_EQ("uh-oh", response.status().message());
 }
 
+TEST(PublisherConnectionTest, OrderingKeysInParallel) {
+  auto mock = std::make_shared<pubsub_testing::MockPublisherStub>();
+  Topic const topic("test-project", "test-topic");
+
+  // Each ordering key has its own batches, so the requests for different keys
+  // are in flight at the same time.
+  std::mutex mu;
+  std::vector<promise<StatusOr<google::pubsub::v1::PublishResponse>>> pending;
+  EXPECT_CALL(*mock, AsyncPublish(_, _, _))
+      .Times(2)
+      .WillRepeatedly([&](google::cloud::CompletionQueue&,
+                          std::unique_ptr<grpc::ClientContext>,
+                          google::pubsub::v1::PublishRequest const& request) {
+        EXPECT_EQ(1, request.messages_size());
+        std::lock_guard<std::mutex> lk(mu);
+        pending.emplace_back();
+        return pending.back().get_future();
+      });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto publisher = pubsub_internal::MakePublisherConnection(
+      topic,
+      PublisherOptions{}
+          .set_batching_config(BatchingConfig{}.set_maximum_message_count(1))
+          .enable_message_ordering(),
+      mock, bg.cq());
+  auto r0 = publisher->Publish(
+      {MessageBuilder{}.SetData("d0").SetOrderingKey("k0").Build()});
+  auto r1 = publisher->Publish(
+      {MessageBuilder{}.SetData("d1").SetOrderingKey("k1").Build()});
+
+  std::unique_lock<std::mutex> lk(mu);
+  ASSERT_EQ(2, pending.size());
+  auto p = std::move(pending);
+  lk.unlock();
+  for (auto& i : p) {
+    google::pubsub::v1::PublishResponse response;
+    response.add_message_ids("test-id");
+    i.set_value(std::move(response));
+  }
+  ASSERT_STATUS_OK(r0.get());
+  ASSERT_STATUS_OK(r1.get());
+}
+
+TEST(PublisherConnectionTest, FlowControlIsShared) {
+  auto mock = std::make_shared<pubsub_testing::MockPublisherStub>();
+  Topic const topic("test-project", "test-topic");
+
+  std::mutex mu;
+  std::vector<promise<StatusOr<google::pubsub::v1::PublishResponse>>> pending;
+  EXPECT_CALL(*mock, AsyncPublish(_, _, _))
+      .Times(3)
+      .WillRepeatedly([&](google::cloud::CompletionQueue&,
+                          std::unique_ptr<grpc::ClientContext>,
+                          google::pubsub::v1::PublishRequest const&) {
+        std::lock_guard<std::mutex> lk(mu);
+        pending.emplace_back();
+        return pending.back().get_future();
+      });
+  auto complete_pending = [&] {
+    std::unique_lock<std::mutex> lk(mu);
+    auto p = std::move(pending);
+    pending.clear();
+    lk.unlock();
+    for (auto& i : p) {
+      google::pubsub::v1::PublishResponse response;
+      response.add_message_ids("test-id");
+      i.set_value(std::move(response));
+    }
+  };
+
+  // The limits apply to all the ordering keys, and to the messages without an
+  // ordering key, together.
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto publisher = pubsub_internal::MakePublisherConnection(
+      topic,
+      PublisherOptions{}
+          .set_batching_config(BatchingConfig{}.set_maximum_message_count(1))
+          .enable_message_ordering()
+          .set_max_outstanding_messages(2)
+          .set_full_publisher_action(FullPublisherAction::kReject),
+      mock, bg.cq());
+  auto r0 = publisher->Publish({MessageBuilder{}.SetData("d0").Build()});
+  auto r1 = publisher->Publish(
+      {MessageBuilder{}.SetData("d1").SetOrderingKey("k0").Build()});
+  auto r2 = publisher->Publish(
+      {MessageBuilder{}.SetData("d2").SetOrderingKey("k1").Build()});
+  auto r3 = publisher->Publish({MessageBuilder{}.SetData("d3").Build()});
+  EXPECT_EQ(StatusCode::kResourceExhausted, r2.get().status().code());
+  EXPECT_EQ(StatusCode::kResourceExhausted, r3.get().status().code());
+  auto metrics = publisher->GetFlowControlMetrics();
+  EXPECT_EQ(2, metrics.outstanding_messages);
+  EXPECT_EQ(2, metrics.rejected_messages);
+
+  complete_pending();
+  ASSERT_STATUS_OK(r0.get());
+  ASSERT_STATUS_OK(r1.get());
+
+  // Once the messages complete their budget is available again.
+  auto r4 = publisher->Publish(
+      {MessageBuilder{}.SetData("d4").SetOrderingKey("k1").Build()});
+  complete_pending();
+  ASSERT_STATUS_OK(r4.get());
+  metrics = publisher->GetFlowControlMetrics();
+  EXPECT_EQ(0, metrics.outstanding_messages);
+  EXPECT_EQ(0, metrics.outstanding_bytes);
+  EXPECT_EQ(2, metrics.rejected_messages);
+}
+
+TEST(PublisherConnectionTest, MultipleStubs) {
+  std::vector<std::shared_ptr<pubsub_testing::MockPublisherStub>> mocks;
+  std::vector<std::shared_ptr<pubsub_internal::PublisherStub>> stubs;
+  for (int i = 0; i != 3; ++i) {
+    auto mock = std::make_shared<pubsub_testing::MockPublisherStub>();
+    // The messages without an ordering key are spread over all the stubs.
+    EXPECT_CALL(*mock, AsyncPublish(_, _, _))
+        .WillOnce([i](google::cloud::CompletionQueue&,
+                      std::unique_ptr<grpc::ClientContext>,
+                      google::pubsub::v1::PublishRequest const& request) {
+          EXPECT_EQ(1, request.messages_size());
+          google::pubsub::v1::PublishResponse response;
+          response.add_message_ids("test-id-" + std::to_string(i));
+          return make_ready_future(make_status_or(response));
+        });
+    mocks.push_back(mock);
+    stubs.push_back(std::move(mock));
+  }
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto publisher = pubsub_internal::MakePublisherConnection(
+      Topic("test-project", "test-topic"),
+      PublisherOptions{}.set_batching_config(
+          BatchingConfig{}.set_maximum_message_count(1)),
+      std::move(stubs), bg.cq());
+  std::vector<std::string> ids;
+  for (int i = 0; i != 3; ++i) {
+    auto id =
+        publisher->Publish({MessageBuilder{}.SetData("test-data").Build()})
+            .get();
+    ASSERT_STATUS_OK(id);
+    ids.push_back(*id);
+  }
+  EXPECT_THAT(ids, ElementsAre("test-id-0", "test-id-1", "test-id-2"));
+}
+
+TEST(PublisherConnectionTest, CompressionBudgetIsShared) {
+  std::mutex mu;
+  std::vector<grpc_compression_algorithm> algorithms;
+  std::vector<std::shared_ptr<pubsub_internal::PublisherStub>> stubs;
+  for (int i = 0; i != 3; ++i) {
+    auto mock = std::make_shared<pubsub_testing::MockPublisherStub>();
+    EXPECT_CALL(*mock, AsyncPublish(_, _, _))
+        .WillOnce([&](google::cloud::CompletionQueue&,
+                      std::unique_ptr<grpc::ClientContext> context,
+                      google::pubsub::v1::PublishRequest const&) {
+          {
+            std::lock_guard<std::mutex> lk(mu);
+            algorithms.push_back(context->compression_algorithm());
+          }
+          google::pubsub::v1::PublishResponse response;
+          response.add_message_ids("test-id");
+          return make_ready_future(make_status_or(response));
+        });
+    stubs.push_back(std::move(mock));
+  }
+
+  // The CPU budget applies to all the channels together, with a zero budget
+  // only the first batch is compressed.
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads bg;
+  auto publisher = pubsub_internal::MakePublisherConnection(
+      Topic("test-project", "test-topic"),
+      PublisherOptions{}
+          .set_batching_config(BatchingConfig{}.set_maximum_message_count(1))
+          .enable_compression(0)
+          .set_compression_cpu_budget(0.0),
+      std::move(stubs), bg.cq());
+  for (int i = 0; i != 3; ++i) {
+    ASSERT_STATUS_OK(
+        publisher->Publish({MessageBuilder{}.SetData("test-data").Build()})
+            .get());
+  }
+  EXPECT_THAT(algorithms, ElementsAre(GRPC_COMPRESS_GZIP, GRPC_COMPRESS_NONE,
+                                      GRPC_COMPRESS_NONE));
+
+  auto const metrics = publisher->GetCompressionMetrics();
+  EXPECT_EQ(1, metrics.compressed_batches);
+  EXPECT_EQ(2, metrics.over_budget_batches);
+}
+
 }  // namespace
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
 }  // namespace pubsub
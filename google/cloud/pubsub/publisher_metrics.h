@@ -0,0 +1,84 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_PUBLISHER_METRICS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_PUBLISHER_METRICS_H
+
+#include "google/cloud/pubsub/version.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace google {
+namespace cloud {
+namespace pubsub {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+/**
+ * The flow control counters for a publisher.
+ *
+ * The values cover all the messages published via one `PublisherConnection`,
+ * the same scope as the limits in `PublisherOptions`.
+ */
+struct PublisherFlowControlMetrics {
+  /// The number of messages published and not yet acknowledged.
+  std::size_t outstanding_messages = 0;
+
+  /// The size of the messages published and not yet acknowledged.
+  std::size_t outstanding_bytes = 0;
+
+  /// The number of callers currently blocked in `Publish()`.
+  std::size_t blocked_publishers = 0;
+
+  /// The total time callers have spent blocked in `Publish()`.
+  std::chrono::microseconds blocked_time{0};
+
+  /// The number of messages rejected because the publisher was full.
+  std::uint64_t rejected_messages = 0;
+
+  /// The number of pending messages dropped to make room for newer messages.
+  std::uint64_t dropped_messages = 0;
+};
+
+/**
+ * The compression counters for a publisher.
+ *
+ * The values cover all the batches sent via one `PublisherConnection`, the same
+ * scope as `PublisherOptions::compression_cpu_budget()`.
+ */
+struct PublisherCompressionMetrics {
+  /// The number of batches sent with gRPC compression.
+  std::uint64_t compressed_batches = 0;
+
+  /// The size of the messages sent with gRPC compression, before compression.
+  std::uint64_t compressed_bytes = 0;
+
+  /// The number of batches sent uncompressed because of the CPU budget.
+  std::uint64_t over_budget_batches = 0;
+
+  /**
+   * The total time spent starting the compressed requests.
+   *
+   * gRPC serializes and compresses each request as it starts, so this
+   * approximates the CPU cost of the compression.
+   */
+  std::chrono::microseconds compression_time{0};
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_PUBLISHER_METRICS_H
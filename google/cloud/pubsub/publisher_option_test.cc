@@ -14,6 +14,7 @@
 
 #include "google/cloud/pubsub/publisher_options.h"
 #include <gmock/gmock.h>
+#include <limits>
 
 namespace google {
 namespace cloud {
@@ -49,6 +50,51 @@ TEST(PublisherOptions, PublisherOptions) {
   EXPECT_EQ(expected, o.batching_config().maximum_hold_time());
 }
 
+TEST(PublisherOptions, FlowControl) {
+  auto const o0 = PublisherOptions{};
+  EXPECT_EQ((std::numeric_limits<std::size_t>::max)(),
+            o0.max_outstanding_messages());
+  EXPECT_EQ((std::numeric_limits<std::size_t>::max)(),
+            o0.max_outstanding_bytes());
+  EXPECT_EQ(FullPublisherAction::kBlock, o0.full_publisher_action());
+
+  auto const o = PublisherOptions{}
+                     .set_max_outstanding_messages(10)
+                     .set_max_outstanding_bytes(1024)
+                     .set_full_publisher_action(FullPublisherAction::kReject);
+  EXPECT_EQ(10, o.max_outstanding_messages());
+  EXPECT_EQ(1024, o.max_outstanding_bytes());
+  EXPECT_EQ(FullPublisherAction::kReject, o.full_publisher_action());
+
+  auto const o1 = PublisherOptions{}
+                      .set_max_outstanding_messages(0)
+                      .set_max_outstanding_bytes(0);
+  EXPECT_EQ(1, o1.max_outstanding_messages());
+  EXPECT_EQ(1, o1.max_outstanding_bytes());
+}
+
+TEST(PublisherOptions, Compression) {
+  auto const o0 = PublisherOptions{};
+  EXPECT_FALSE(o0.compression());
+  EXPECT_EQ(GRPC_COMPRESS_GZIP, o0.compression_algorithm());
+  EXPECT_EQ(std::numeric_limits<double>::infinity(),
+            o0.compression_cpu_budget());
+
+  auto const o = PublisherOptions{}
+                     .enable_compression(4096)
+                     .set_compression_algorithm(GRPC_COMPRESS_DEFLATE)
+                     .set_compression_cpu_budget(0.25);
+  EXPECT_TRUE(o.compression());
+  EXPECT_EQ(4096, o.compression_threshold());
+  EXPECT_EQ(GRPC_COMPRESS_DEFLATE, o.compression_algorithm());
+  EXPECT_EQ(0.25, o.compression_cpu_budget());
+
+  auto const o1 =
+      PublisherOptions{o}.disable_compression().set_compression_cpu_budget(-1);
+  EXPECT_FALSE(o1.compression());
+  EXPECT_EQ(0.0, o1.compression_cpu_budget());
+}
+
 }  // namespace
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
 }  // namespace pubsub
@@ -16,8 +16,11 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_PUBLISHER_OPTIONS_H
 
 #include "google/cloud/pubsub/version.h"
+#include <grpc/compression.h>
+#include <algorithm>
 #include <chrono>
 #include <cstddef>
+#include <limits>
 
 namespace google {
 namespace cloud {
@@ -58,7 +61,42 @@ class BatchingConfig {
   std::size_t maximum_batch_bytes_;
 };
 
-/// Configuration options for a `PublisherClient`
+/// The action taken by a `Publisher` once its flow control limits are reached.
+enum class FullPublisherAction {
+  /**
+   * Block the caller of `Publish()` until there is enough capacity.
+   *
+   * Calling `Publish()` from the threads of the connection's
+   * `CompletionQueue` may deadlock with this setting, as these threads are
+   * needed to complete the outstanding requests.
+   */
+  kBlock,
+  /// Return a future satisfied with a `kResourceExhausted` error.
+  kReject,
+  /**
+   * Fail the oldest messages not yet sent to the service, to make room for the
+   * new message. If all the outstanding messages are already in flight the new
+   * message is rejected.
+   */
+  kDropOldest,
+};
+
+/**
+ * Configuration options for a `PublisherClient`
+ *
+ * The flow control limits bound the messages published and not yet
+ * acknowledged by the service, this includes messages waiting in the current
+ * batch and messages in batches sent to the service. Once either limit is
+ * reached the publisher takes the action configured via
+ * `set_full_publisher_action()`. A single message larger than
+ * `max_outstanding_bytes()` is accepted once no other messages are
+ * outstanding. By default the publisher has no flow control limits.
+ *
+ * The publisher uses an independent batcher for each channel (see
+ * `ConnectionOptions::set_num_channels()`) and, with message ordering enabled,
+ * for each ordering key. The batching configuration applies to each of these
+ * batchers, while the flow control limits apply to the publisher as a whole.
+ */
 class PublisherOptions {
  public:
   PublisherOptions() = default;
@@ -79,9 +117,87 @@ class PublisherOptions {
     return *this;
   }
 
+  /// The maximum number of messages published and not yet acknowledged.
+  std::size_t max_outstanding_messages() const {
+    return max_outstanding_messages_;
+  }
+  PublisherOptions& set_max_outstanding_messages(std::size_t v) {
+    max_outstanding_messages_ = (std::max<std::size_t>)(v, 1);
+    return *this;
+  }
+
+  /// The maximum size of the messages published and not yet acknowledged.
+  std::size_t max_outstanding_bytes() const { return max_outstanding_bytes_; }
+  PublisherOptions& set_max_outstanding_bytes(std::size_t v) {
+    max_outstanding_bytes_ = (std::max<std::size_t>)(v, 1);
+    return *this;
+  }
+
+  /// The action taken once the flow control limits are reached.
+  FullPublisherAction full_publisher_action() const {
+    return full_publisher_action_;
+  }
+  PublisherOptions& set_full_publisher_action(FullPublisherAction v) {
+    full_publisher_action_ = v;
+    return *this;
+  }
+
+  /**
+   * Compress the batches of at least @p threshold_bytes.
+   *
+   * The publisher enables gRPC compression on each `Publish()` request
+   * carrying at least this many bytes of (serialized) messages. Smaller
+   * batches are sent uncompressed, as they seldom save enough bandwidth to pay
+   * for the CPU cost. Compression is disabled by default.
+   */
+  bool compression() const { return compression_; }
+  std::size_t compression_threshold() const { return compression_threshold_; }
+  PublisherOptions& enable_compression(std::size_t threshold_bytes) {
+    compression_ = true;
+    compression_threshold_ = threshold_bytes;
+    return *this;
+  }
+  PublisherOptions& disable_compression() {
+    compression_ = false;
+    return *this;
+  }
+
+  /// The algorithm used to compress large batches, the default is gzip.
+  grpc_compression_algorithm compression_algorithm() const {
+    return compression_algorithm_;
+  }
+  PublisherOptions& set_compression_algorithm(grpc_compression_algorithm v) {
+    compression_algorithm_ = v;
+    return *this;
+  }
+
+  /**
+   * The fraction of the time the publisher may spend compressing batches.
+   *
+   * The publisher measures the time to start each compressed `Publish()`
+   * request over one second intervals. Once the total exceeds this fraction of
+   * the interval the remaining batches in the interval are sent uncompressed.
+   * Use this budget to stop compressing when the publisher is CPU bound. By
+   * default there is no budget.
+   */
+  double compression_cpu_budget() const { return compression_cpu_budget_; }
+  PublisherOptions& set_compression_cpu_budget(double v) {
+    compression_cpu_budget_ = (std::max)(v, 0.0);
+    return *this;
+  }
+
  private:
   BatchingConfig batching_config_;
   bool message_ordering_ = false;
+  std::size_t max_outstanding_messages_ =
+      (std::numeric_limits<std::size_t>::max)();
+  std::size_t max_outstanding_bytes_ =
+      (std::numeric_limits<std::size_t>::max)();
+  FullPublisherAction full_publisher_action_ = FullPublisherAction::kBlock;
+  bool compression_ = false;
+  std::size_t compression_threshold_ = 0;
+  grpc_compression_algorithm compression_algorithm_ = GRPC_COMPRESS_GZIP;
+  double compression_cpu_budget_ = std::numeric_limits<double>::infinity();
 };
 
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
@@ -41,6 +41,47 @@ TEST(PublisherTest, PublishSimple) {
   EXPECT_EQ("test-id-0", *id);
 }
 
+TEST(PublisherTest, ResumePublish) {
+  auto mock = std::make_shared<pubsub_mocks::MockPublisherConnection>();
+  EXPECT_CALL(*mock, ResumePublish(_))
+      .WillOnce([&](PublisherConnection::ResumePublishParams const& p) {
+        EXPECT_EQ("test-key", p.ordering_key);
+      });
+
+  Publisher publisher(mock);
+  publisher.ResumePublish("test-key");
+}
+
+TEST(PublisherTest, GetFlowControlMetrics) {
+  auto mock = std::make_shared<pubsub_mocks::MockPublisherConnection>();
+  PublisherFlowControlMetrics expected;
+  expected.outstanding_messages = 3;
+  expected.rejected_messages = 2;
+  EXPECT_CALL(*mock, GetFlowControlMetrics()).WillOnce([&] {
+    return expected;
+  });
+
+  Publisher publisher(mock);
+  auto metrics = publisher.GetFlowControlMetrics();
+  EXPECT_EQ(3, metrics.outstanding_messages);
+  EXPECT_EQ(2, metrics.rejected_messages);
+}
+
+TEST(PublisherTest, GetCompressionMetrics) {
+  auto mock = std::make_shared<pubsub_mocks::MockPublisherConnection>();
+  PublisherCompressionMetrics expected;
+  expected.compressed_batches = 4;
+  expected.over_budget_batches = 1;
+  EXPECT_CALL(*mock, GetCompressionMetrics()).WillOnce([&] {
+    return expected;
+  });
+
+  Publisher publisher(mock);
+  auto metrics = publisher.GetCompressionMetrics();
+  EXPECT_EQ(4, metrics.compressed_batches);
+  EXPECT_EQ(1, metrics.over_budget_batches);
+}
+
 }  // namespace
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
 }  // namespace pubsub
@@ -21,18 +21,26 @@ pubsub_client_hdrs = [
     "connection_options.h",
     "create_subscription_builder.h",
     "create_topic_builder.h",
+    "internal/ack_batcher.h",
     "internal/batching_publisher_connection.h",
     "internal/default_ack_handler_impl.h",
     "internal/emulator_overrides.h",
+    "internal/lease_manager.h",
+    "internal/ordering_key_publisher_connection.h",
     "internal/publisher_stub.h",
+    "internal/sharded_publisher_connection.h",
     "internal/subscriber_stub.h",
+    "internal/subscription_session.h",
     "internal/user_agent_prefix.h",
     "message.h",
     "publisher.h",
     "publisher_connection.h",
+    "publisher_metrics.h",
     "publisher_options.h",
     "subscriber.h",
     "subscriber_connection.h",
+    "subscriber_metrics.h",
+    "subscriber_options.h",
     "subscription.h",
     "subscription_admin_client.h",
     "subscription_admin_connection.h",
@@ -46,17 +54,23 @@ pubsub_client_hdrs = [
 pubsub_client_srcs = [
     "ack_handler.cc",
     "connection_options.cc",
+    "internal/ack_batcher.cc",
     "internal/batching_publisher_connection.cc",
     "internal/default_ack_handler_impl.cc",
     "internal/emulator_overrides.cc",
+    "internal/lease_manager.cc",
+    "internal/ordering_key_publisher_connection.cc",
     "internal/publisher_stub.cc",
+    "internal/sharded_publisher_connection.cc",
     "internal/subscriber_stub.cc",
+    "internal/subscription_session.cc",
     "internal/user_agent_prefix.cc",
     "message.cc",
     "publisher.cc",
     "publisher_connection.cc",
     "publisher_options.cc",
     "subscriber_connection.cc",
+    "subscriber_options.cc",
     "subscription.cc",
     "subscription_admin_client.cc",
     "subscription_admin_connection.cc",
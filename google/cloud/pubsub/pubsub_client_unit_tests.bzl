@@ -20,15 +20,21 @@ pubsub_client_unit_tests = [
     "ack_handler_test.cc",
     "create_subscription_builder_test.cc",
     "create_topic_builder_test.cc",
+    "internal/ack_batcher_test.cc",
     "internal/batching_publisher_connection_test.cc",
     "internal/default_ack_handler_impl_test.cc",
     "internal/emulator_overrides_test.cc",
+    "internal/lease_manager_test.cc",
+    "internal/ordering_key_publisher_connection_test.cc",
+    "internal/sharded_publisher_connection_test.cc",
+    "internal/subscription_session_test.cc",
     "internal/user_agent_prefix_test.cc",
     "message_test.cc",
     "publisher_connection_test.cc",
     "publisher_option_test.cc",
     "publisher_test.cc",
     "subscriber_connection_test.cc",
+    "subscriber_options_test.cc",
     "subscriber_test.cc",
     "subscription_test.cc",
     "topic_test.cc",
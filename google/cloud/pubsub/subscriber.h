@@ -112,6 +112,15 @@ class Subscriber {
     return connection_->Subscribe({subscription.FullName(), std::move(f)});
   }
 
+  /**
+   * Returns a snapshot of the counters for the acks and nacks sent by this
+   * subscriber's connection.
+   *
+   * Failed ack and nack requests are not reported to the application, the
+   * service re-delivers the messages. Use these counters to monitor them.
+   */
+  SubscriberAckMetrics GetAckMetrics() { return connection_->GetAckMetrics(); }
+
  private:
   std::shared_ptr<SubscriberConnection> connection_;
 };
@@ -13,12 +13,9 @@
 // limitations under the License.
 
 #include "google/cloud/pubsub/subscriber_connection.h"
-#include "google/cloud/pubsub/internal/default_ack_handler_impl.h"
-#include "absl/memory/memory.h"
+#include "google/cloud/pubsub/internal/subscription_session.h"
 #include <algorithm>
-#include <deque>
 #include <memory>
-#include <mutex>
 
 namespace google {
 namespace cloud {
@@ -27,11 +24,22 @@ inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
 
 SubscriberConnection::~SubscriberConnection() = default;
 
+SubscriberAckMetrics SubscriberConnection::GetAckMetrics() { return {}; }
+
 std::shared_ptr<SubscriberConnection> MakeSubscriberConnection(
-    ConnectionOptions const& options) {
-  auto stub =
-      pubsub_internal::CreateDefaultSubscriberStub(options, /*channel_id=*/0);
-  return pubsub_internal::MakeSubscriberConnection(std::move(stub), options);
+    ConnectionOptions const& options, SubscriberOptions subscriber_options) {
+  // Each stream uses its own channel, as long as there are enough of them.
+  auto const channels =
+      static_cast<std::size_t>((std::max)(options.num_channels(), 1));
+  auto const count =
+      (std::min)(channels, subscriber_options.concurrent_streams());
+  std::vector<std::shared_ptr<pubsub_internal::SubscriberStub>> stubs(count);
+  int channel_id = 0;
+  std::generate(stubs.begin(), stubs.end(), [&options, &channel_id] {
+    return pubsub_internal::CreateDefaultSubscriberStub(options, channel_id++);
+  });
+  return pubsub_internal::MakeSubscriberConnection(
+      std::move(stubs), options, std::move(subscriber_options));
 }
 
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
@@ -40,134 +48,54 @@ std::shared_ptr<SubscriberConnection> MakeSubscriberConnection(
 namespace pubsub_internal {
 inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
 
-class SubscriptionSession
-    : public std::enable_shared_from_this<SubscriptionSession> {
- public:
-  SubscriptionSession(std::shared_ptr<pubsub_internal::SubscriberStub> s,
-                      google::cloud::CompletionQueue executor,
-                      pubsub::SubscriberConnection::SubscribeParams p)
-      : stub_(std::move(s)),
-        executor_(std::move(executor)),
-        params_(std::move(p)) {}
-
-  future<Status> Start() {
-    auto self = shared_from_this();
-    std::weak_ptr<SubscriptionSession> w(self);
-    result_ = promise<Status>{[w] {
-      auto self = w.lock();
-      if (!self) return;
-      self->Cancel();
-    }};
-    executor_.RunAsync([self] { self->PullOne(); });
-    return result_.get_future();
-  }
-
- private:
-  void Cancel() {
-    std::lock_guard<std::mutex> lk(mu_);
-    shutdown_ = true;
-  }
-
-  void PullOne() {
-    std::unique_lock<std::mutex> lk(mu_);
-    if (!messages_.empty()) {
-      HandleQueue(std::move(lk));
-      return;
-    }
-
-    if (shutdown_) {
-      result_.set_value(Status{});
-      return;
-    }
-
-    // TODO(#4554) - use the completion queue and asynchronous requests
-    auto self = shared_from_this();
-    lk.unlock();
-
-    grpc::ClientContext context;
-    context.set_deadline(std::chrono::system_clock::now() +
-                         std::chrono::milliseconds(500));
-    google::pubsub::v1::PullRequest request;
-    request.set_subscription(params_.full_subscription_name);
-    request.set_max_messages(1);
-    auto r = stub_->Pull(context, request);
-    // TODO(#4554) - for now we poll every 500ms to close the session gracefully
-    if (r.status().code() == StatusCode::kDeadlineExceeded) {
-      executor_.RunAsync([self] { self->PullOne(); });
-      return;
-    }
-    if (!r) {
-      result_.set_value(std::move(r).status());
-      return;
-    }
-
-    lk.lock();
-    std::move(r->mutable_received_messages()->begin(),
-              r->mutable_received_messages()->end(),
-              std::back_inserter(messages_));
-    lk.unlock();
-
-    executor_.RunAsync([self] { self->HandleQueue(); });
-  }
-
-  void HandleQueue() { HandleQueue(std::unique_lock<std::mutex>(mu_)); }
-
-  void HandleQueue(std::unique_lock<std::mutex> lk) {
-    auto self = shared_from_this();
-    if (messages_.empty()) {
-      executor_.RunAsync([self] { self->PullOne(); });
-      return;
-    }
-    auto m = std::move(messages_.front());
-    messages_.pop_front();
-    lk.unlock();
-
-    auto handler_impl = absl::make_unique<DefaultAckHandlerImpl>(
-        stub_, params_.full_subscription_name, std::move(*m.mutable_ack_id()));
-    params_.callback(FromProto(std::move(*m.mutable_message())),
-                     pubsub::AckHandler(std::move(handler_impl)));
-
-    // After the callback re-schedule ourselves.
-    // TODO(#4652) - support parallel scheduling of callbacks
-    executor_.RunAsync([self] { self->HandleQueue(); });
-  }
-
-  std::shared_ptr<pubsub_internal::SubscriberStub> stub_;
-  google::cloud::CompletionQueue executor_;
-  pubsub::SubscriberConnection::SubscribeParams params_;
-  std::mutex mu_;
-  bool shutdown_ = false;
-  std::deque<google::pubsub::v1::ReceivedMessage> messages_;
-  promise<Status> result_;
-};
-
 namespace {
 class SubscriberConnectionImpl : public pubsub::SubscriberConnection {
  public:
   explicit SubscriberConnectionImpl(
-      std::shared_ptr<pubsub_internal::SubscriberStub> stub,
-      pubsub::ConnectionOptions const& options)
-      : stub_(std::move(stub)),
-        background_(options.background_threads_factory()()) {}
+      std::vector<std::shared_ptr<pubsub_internal::SubscriberStub>> stubs,
+      pubsub::ConnectionOptions const& options,
+      pubsub::SubscriberOptions subscriber_options)
+      : stubs_(std::move(stubs)),
+        subscriber_options_(std::move(subscriber_options)),
+        background_(options.background_threads_factory()()),
+        ack_counters_(std::make_shared<AckBatcherCounters>()) {}
 
   ~SubscriberConnectionImpl() override = default;
 
   future<Status> Subscribe(SubscribeParams p) override {
-    auto session = std::make_shared<SubscriptionSession>(
-        stub_, background_->cq(), std::move(p));
+    auto session = SubscriptionSession::Create(
+        stubs_, background_->cq(), subscriber_options_, std::move(p),
+        ack_counters_);
     return session->Start();
   }
 
+  pubsub::SubscriberAckMetrics GetAckMetrics() override {
+    return ack_counters_->Snapshot();
+  }
+
  private:
-  std::shared_ptr<pubsub_internal::SubscriberStub> stub_;
+  std::vector<std::shared_ptr<pubsub_internal::SubscriberStub>> stubs_;
+  pubsub::SubscriberOptions subscriber_options_;
   std::shared_ptr<BackgroundThreads> background_;
+  std::shared_ptr<AckBatcherCounters> ack_counters_;
 };
 }  // namespace
 
+std::shared_ptr<pubsub::SubscriberConnection> MakeSubscriberConnection(
+    std::vector<std::shared_ptr<SubscriberStub>> stubs,
+    pubsub::ConnectionOptions const& options,
+    pubsub::SubscriberOptions subscriber_options) {
+  return std::make_shared<SubscriberConnectionImpl>(
+      std::move(stubs), options, std::move(subscriber_options));
+}
+
 std::shared_ptr<pubsub::SubscriberConnection> MakeSubscriberConnection(
     std::shared_ptr<SubscriberStub> stub,
-    pubsub::ConnectionOptions const& options) {
-  return std::make_shared<SubscriberConnectionImpl>(std::move(stub), options);
+    pubsub::ConnectionOptions const& options,
+    pubsub::SubscriberOptions subscriber_options) {
+  return MakeSubscriberConnection(
+      std::vector<std::shared_ptr<SubscriberStub>>{std::move(stub)}, options,
+      std::move(subscriber_options));
 }
 
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
@@ -19,10 +19,13 @@
 #include "google/cloud/pubsub/connection_options.h"
 #include "google/cloud/pubsub/internal/subscriber_stub.h"
 #include "google/cloud/pubsub/message.h"
+#include "google/cloud/pubsub/subscriber_metrics.h"
+#include "google/cloud/pubsub/subscriber_options.h"
 #include "google/cloud/pubsub/subscription.h"
 #include "google/cloud/pubsub/version.h"
 #include "google/cloud/status_or.h"
 #include <functional>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -44,6 +47,14 @@ class SubscriberConnection {
     CallbackType callback;
   };
   virtual future<Status> Subscribe(SubscribeParams p) = 0;
+
+  /**
+   * Returns a snapshot of the ack and nack counters.
+   *
+   * The values are cumulative over all the calls to `Subscribe()` on this
+   * connection. The default implementation returns all zeros.
+   */
+  virtual SubscriberAckMetrics GetAckMetrics();
 };
 
 /**
@@ -58,9 +69,12 @@ class SubscriberConnection {
  *
  * @param options (optional) configure the `SubscriberConnection` created by
  *     this function.
+ * @param subscriber_options (optional) configure the flow control, the
+ *     concurrency, and the number of streams used to receive messages.
  */
 std::shared_ptr<SubscriberConnection> MakeSubscriberConnection(
-    ConnectionOptions const& options = ConnectionOptions());
+    ConnectionOptions const& options = ConnectionOptions(),
+    SubscriberOptions subscriber_options = SubscriberOptions());
 
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
 }  // namespace pubsub
@@ -68,9 +82,15 @@ std::shared_ptr<SubscriberConnection> MakeSubscriberConnection(
 namespace pubsub_internal {
 inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
 
+std::shared_ptr<pubsub::SubscriberConnection> MakeSubscriberConnection(
+    std::vector<std::shared_ptr<SubscriberStub>> stubs,
+    pubsub::ConnectionOptions const& options,
+    pubsub::SubscriberOptions subscriber_options);
+
 std::shared_ptr<pubsub::SubscriberConnection> MakeSubscriberConnection(
     std::shared_ptr<SubscriberStub> stub,
-    pubsub::ConnectionOptions const& options);
+    pubsub::ConnectionOptions const& options,
+    pubsub::SubscriberOptions subscriber_options = pubsub::SubscriberOptions());
 
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
 }  // namespace pubsub_internal
@@ -15,8 +15,13 @@
 #include "google/cloud/pubsub/subscriber_connection.h"
 #include "google/cloud/pubsub/testing/mock_subscriber_stub.h"
 #include "google/cloud/testing_util/assert_ok.h"
+#include "absl/memory/memory.h"
 #include <gmock/gmock.h>
+#include <algorithm>
 #include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
 
 namespace google {
 namespace cloud {
@@ -24,38 +29,89 @@ namespace pubsub {
 inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
 namespace {
 
+using ::google::pubsub::v1::StreamingPullRequest;
+using ::google::pubsub::v1::StreamingPullResponse;
 using ::testing::_;
 using ::testing::AtLeast;
 
+using PullStream = pubsub_internal::SubscriberStub::AsyncPullStream;
+
+/**
+ * Create a mock stream returning the responses from @p generator.
+ *
+ * All the stream operations complete immediately, the stream returns a new
+ * response on each `Read()` until it is cancelled.
+ */
+std::unique_ptr<PullStream> MakeStream(
+    std::string const& subscription,
+    std::function<StreamingPullResponse()> generator) {
+  auto stream = absl::make_unique<pubsub_testing::MockAsyncPullStream>();
+  auto cancelled = std::make_shared<std::atomic<bool>>(false);
+  EXPECT_CALL(*stream, Start()).WillOnce([] {
+    return make_ready_future(true);
+  });
+  EXPECT_CALL(*stream, Write(_, _))
+      .WillOnce([subscription](StreamingPullRequest const& request,
+                               grpc::WriteOptions const&) {
+        EXPECT_EQ(subscription, request.subscription());
+        return make_ready_future(true);
+      });
+  EXPECT_CALL(*stream, Read()).WillRepeatedly([cancelled, generator] {
+    if (*cancelled) {
+      return make_ready_future(absl::optional<StreamingPullResponse>{});
+    }
+    return make_ready_future(absl::make_optional(generator()));
+  });
+  EXPECT_CALL(*stream, Cancel()).WillRepeatedly([cancelled] {
+    *cancelled = true;
+  });
+  EXPECT_CALL(*stream, Finish()).WillOnce([] {
+    return make_ready_future(Status(StatusCode::kCancelled, "cancelled"));
+  });
+  return std::unique_ptr<PullStream>(std::move(stream));
+}
+
 TEST(SubscriberConnectionTest, Basic) {
   auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
   Subscription const subscription("test-project", "test-subscription");
 
-  EXPECT_CALL(*mock, Pull(_, _))
+  EXPECT_CALL(*mock, AsyncStreamingPull(_, _))
       .Times(AtLeast(1))
-      .WillRepeatedly([&](grpc::ClientContext&,
-                          google::pubsub::v1::PullRequest const& request) {
-        EXPECT_EQ(subscription.FullName(), request.subscription());
-        google::pubsub::v1::PullResponse response;
-        auto& m = *response.add_received_messages();
-        m.set_ack_id("test-ack-id-0");
-        m.mutable_message()->set_message_id("test-message-id-0");
-        return make_status_or(response);
+      .WillRepeatedly([&](google::cloud::CompletionQueue&,
+                          std::unique_ptr<grpc::ClientContext>) {
+        return MakeStream(subscription.FullName(), [] {
+          StreamingPullResponse response;
+          auto& m = *response.add_received_messages();
+          m.set_ack_id("test-ack-id-0");
+          m.mutable_message()->set_message_id("test-message-id-0");
+          return response;
+        });
       });
-  EXPECT_CALL(*mock, Acknowledge(_, _))
+  EXPECT_CALL(*mock, AsyncAcknowledge(_, _, _))
       .Times(AtLeast(1))
       .WillRepeatedly(
-          [&](grpc::ClientContext&,
+          [&](google::cloud::CompletionQueue&,
+              std::unique_ptr<grpc::ClientContext>,
               google::pubsub::v1::AcknowledgeRequest const& request) {
             EXPECT_EQ(subscription.FullName(), request.subscription());
             EXPECT_FALSE(request.ack_ids().empty());
             for (auto& id : request.ack_ids()) {
               EXPECT_EQ("test-ack-id-0", id);
             }
-            return Status{};
+            return make_ready_future(Status{});
+          });
+  EXPECT_CALL(*mock, AsyncModifyAckDeadline(_, _, _))
+      .WillRepeatedly(
+          [&](google::cloud::CompletionQueue&,
+              std::unique_ptr<grpc::ClientContext>,
+              google::pubsub::v1::ModifyAckDeadlineRequest const& request) {
+            EXPECT_EQ(subscription.FullName(), request.subscription());
+            EXPECT_EQ(0, request.ack_deadline_seconds());
+            return make_ready_future(Status{});
           });
 
-  auto subscriber = pubsub_internal::MakeSubscriberConnection(mock, {});
+  auto subscriber = pubsub_internal::MakeSubscriberConnection(
+      mock, ConnectionOptions{grpc::InsecureChannelCredentials()});
   std::atomic_flag received_one{false};
   promise<void> waiter;
   auto handler = [&](Message const& m, AckHandler h) {
@@ -65,10 +121,16 @@ TEST(SubscriberConnectionTest, Basic) {
     if (received_one.test_and_set()) return;
     waiter.set_value();
   };
+  EXPECT_EQ(0, subscriber->GetAckMetrics().ack_ids);
   auto response = subscriber->Subscribe({subscription.FullName(), handler});
   waiter.get_future().wait();
   response.cancel();
   ASSERT_STATUS_OK(response.get());
+  // The session flushes the pending acks before it completes.
+  auto metrics = subscriber->GetAckMetrics();
+  EXPECT_LE(1, metrics.ack_batches);
+  EXPECT_LE(1, metrics.ack_ids);
+  EXPECT_EQ(0, metrics.failed_batches);
 }
 
 TEST(SubscriberConnectionTest, PullFailure) {
@@ -76,15 +138,23 @@ TEST(SubscriberConnectionTest, PullFailure) {
   Subscription const subscription("test-project", "test-subscription");
 
   auto const expected = Status(StatusCode::kPermissionDenied, "uh-oh");
-  EXPECT_CALL(*mock, Pull(_, _))
+  EXPECT_CALL(*mock, AsyncStreamingPull(_, _))
       .Times(AtLeast(1))
-      .WillRepeatedly([&](grpc::ClientContext&,
-                          google::pubsub::v1::PullRequest const& request) {
-        EXPECT_EQ(subscription.FullName(), request.subscription());
-        return StatusOr<google::pubsub::v1::PullResponse>(expected);
+      .WillRepeatedly([&](google::cloud::CompletionQueue&,
+                          std::unique_ptr<grpc::ClientContext>) {
+        auto stream = absl::make_unique<pubsub_testing::MockAsyncPullStream>();
+        EXPECT_CALL(*stream, Start()).WillOnce([] {
+          return make_ready_future(false);
+        });
+        EXPECT_CALL(*stream, Finish()).WillOnce([expected] {
+          return make_ready_future(expected);
+        });
+        EXPECT_CALL(*stream, Cancel()).Times(AtLeast(0));
+        return std::unique_ptr<PullStream>(std::move(stream));
       });
 
-  auto subscriber = pubsub_internal::MakeSubscriberConnection(mock, {});
+  auto subscriber = pubsub_internal::MakeSubscriberConnection(
+      mock, ConnectionOptions{grpc::InsecureChannelCredentials()});
   auto handler = [&](Message const&, AckHandler const&) {};
   auto response = subscriber->Subscribe({subscription.FullName(), handler});
   EXPECT_EQ(expected, response.get());
@@ -97,41 +167,49 @@ TEST(SubscriberConnectionTest, ScheduleCallbacks) {
 
   std::mutex mu;
   int count = 0;
-  EXPECT_CALL(*mock, Pull(_, _))
+  EXPECT_CALL(*mock, AsyncStreamingPull(_, _))
       .Times(AtLeast(1))
-      .WillRepeatedly([&](grpc::ClientContext&,
-                          google::pubsub::v1::PullRequest const& request) {
-        EXPECT_EQ(subscription.FullName(), request.subscription());
-        google::pubsub::v1::PullResponse response;
-        for (int i = 0; i != 2; ++i) {
-          auto& m = *response.add_received_messages();
-          std::lock_guard<std::mutex> lk(mu);
-          m.set_ack_id("test-ack-id-" + std::to_string(count));
-          m.mutable_message()->set_message_id("test-message-id-" +
-                                              std::to_string(count));
-          ++count;
-        }
-        return make_status_or(response);
+      .WillRepeatedly([&](google::cloud::CompletionQueue&,
+                          std::unique_ptr<grpc::ClientContext>) {
+        return MakeStream(subscription.FullName(), [&] {
+          StreamingPullResponse response;
+          for (int i = 0; i != 2; ++i) {
+            auto& m = *response.add_received_messages();
+            std::lock_guard<std::mutex> lk(mu);
+            m.set_ack_id("test-ack-id-" + std::to_string(count));
+            m.mutable_message()->set_message_id("test-message-id-" +
+                                                std::to_string(count));
+            ++count;
+          }
+          return response;
+        });
       });
 
   std::atomic<int> expected_ack_id{0};
-  EXPECT_CALL(*mock, Acknowledge(_, _))
+  EXPECT_CALL(*mock, AsyncAcknowledge(_, _, _))
       .Times(AtLeast(1))
       .WillRepeatedly(
-          [&](grpc::ClientContext&,
+          [&](google::cloud::CompletionQueue&,
+              std::unique_ptr<grpc::ClientContext>,
               google::pubsub::v1::AcknowledgeRequest const& request) {
             EXPECT_EQ(subscription.FullName(), request.subscription());
             for (auto const& a : request.ack_ids()) {
               EXPECT_EQ("test-ack-id-" + std::to_string(expected_ack_id), a);
               ++expected_ack_id;
             }
-            return Status{};
+            return make_ready_future(Status{});
           });
+  EXPECT_CALL(*mock, AsyncModifyAckDeadline(_, _, _))
+      .WillRepeatedly([] { return make_ready_future(Status{}); });
 
   google::cloud::CompletionQueue cq;
+  // With a single stream and a single callback at a time the messages are
+  // delivered in order.
   auto subscriber = pubsub_internal::MakeSubscriberConnection(
-      mock, ConnectionOptions{grpc::InsecureChannelCredentials()}
-                .DisableBackgroundThreads(cq));
+      mock,
+      ConnectionOptions{grpc::InsecureChannelCredentials()}
+          .DisableBackgroundThreads(cq),
+      SubscriberOptions{}.set_max_concurrency(1).set_concurrent_streams(1));
 
   std::vector<std::thread> tasks;
   std::generate_n(std::back_inserter(tasks), 4,
@@ -164,6 +242,53 @@ TEST(SubscriberConnectionTest, ScheduleCallbacks) {
   for (auto& t : tasks) t.join();
 }
 
+/// @test Verify the streams are spread across the stubs.
+TEST(SubscriberConnectionTest, MultipleStubs) {
+  Subscription const subscription("test-project", "test-subscription");
+  // Each stream blocks in `Read()` until it is cancelled.
+  auto make_stream = [&](google::cloud::CompletionQueue&,
+                         std::unique_ptr<grpc::ClientContext>) {
+    using ReadResult = absl::optional<StreamingPullResponse>;
+    auto pending = std::make_shared<promise<ReadResult>>();
+    auto stream = absl::make_unique<pubsub_testing::MockAsyncPullStream>();
+    EXPECT_CALL(*stream, Start()).WillOnce([] {
+      return make_ready_future(true);
+    });
+    EXPECT_CALL(*stream, Write(_, _)).WillOnce([] {
+      return make_ready_future(true);
+    });
+    EXPECT_CALL(*stream, Read()).WillOnce([pending] {
+      return pending->get_future();
+    });
+    EXPECT_CALL(*stream, Cancel()).WillOnce([pending] {
+      // Release the promise, its continuation holds a reference to the
+      // session, which owns this stream.
+      auto p = std::move(*pending);
+      p.set_value(ReadResult{});
+    });
+    EXPECT_CALL(*stream, Finish()).WillOnce([] {
+      return make_ready_future(Status(StatusCode::kCancelled, "cancelled"));
+    });
+    return std::unique_ptr<PullStream>(std::move(stream));
+  };
+  std::vector<std::shared_ptr<pubsub_internal::SubscriberStub>> stubs;
+  for (int i = 0; i != 2; ++i) {
+    auto mock = std::make_shared<pubsub_testing::MockSubscriberStub>();
+    EXPECT_CALL(*mock, AsyncStreamingPull(_, _))
+        .Times(2)
+        .WillRepeatedly(make_stream);
+    stubs.push_back(std::move(mock));
+  }
+
+  auto subscriber = pubsub_internal::MakeSubscriberConnection(
+      stubs, ConnectionOptions{grpc::InsecureChannelCredentials()},
+      SubscriberOptions{}.set_concurrent_streams(4));
+  auto response = subscriber->Subscribe(
+      {subscription.FullName(), [](Message const&, AckHandler const&) {}});
+  response.cancel();
+  EXPECT_STATUS_OK(response.get());
+}
+
 }  // namespace
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
 }  // namespace pubsub
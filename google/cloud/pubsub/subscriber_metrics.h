@@ -0,0 +1,65 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_SUBSCRIBER_METRICS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_SUBSCRIBER_METRICS_H
+
+#include "google/cloud/pubsub/version.h"
+#include <cstdint>
+
+namespace google {
+namespace cloud {
+namespace pubsub {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+/**
+ * Counters for the acks and nacks sent by a subscriber.
+ *
+ * The values are cumulative over all the subscriptions started by one
+ * `SubscriberConnection`. Acks and nacks are best-effort operations in Cloud
+ * Pub/Sub, the service re-delivers any message that is not acknowledged before
+ * its deadline, so failed requests are only reported via these counters.
+ */
+struct SubscriberAckMetrics {
+  /// The number of `Acknowledge` requests sent, not counting retries.
+  std::uint64_t ack_batches = 0;
+
+  /// The number of ids sent via `Acknowledge` requests.
+  std::uint64_t ack_ids = 0;
+
+  /// The number of `ModifyAckDeadline` requests sent, not counting retries.
+  std::uint64_t nack_batches = 0;
+
+  /// The number of ids sent via `ModifyAckDeadline` requests.
+  std::uint64_t nack_ids = 0;
+
+  /// The number of `ModifyAckDeadline` requests sent to extend leases.
+  std::uint64_t extension_batches = 0;
+
+  /// The number of ids whose lease was extended.
+  std::uint64_t extension_ids = 0;
+
+  /// The number of requests retried after a transient error.
+  std::uint64_t retries = 0;
+
+  /// The number of requests that failed, their ids are lost.
+  std::uint64_t failed_batches = 0;
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_SUBSCRIBER_METRICS_H
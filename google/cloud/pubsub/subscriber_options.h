@@ -0,0 +1,115 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_SUBSCRIBER_OPTIONS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_SUBSCRIBER_OPTIONS_H
+
+#include "google/cloud/pubsub/version.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+namespace google {
+namespace cloud {
+namespace pubsub {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+/**
+ * Configuration options for a `Subscriber`.
+ *
+ * The flow control limits bound the messages delivered to the application and
+ * not yet acknowledged or rejected. Once either limit is reached the
+ * subscriber stops reading from its streams until the application handles
+ * some messages. Each stream may exceed the limits by (at most) one response
+ * from the service.
+ */
+class SubscriberOptions {
+ public:
+  SubscriberOptions();
+
+  /// The maximum number of messages received and not yet handled.
+  std::size_t max_outstanding_messages() const {
+    return max_outstanding_messages_;
+  }
+  SubscriberOptions& set_max_outstanding_messages(std::size_t v) {
+    max_outstanding_messages_ = (std::max<std::size_t>)(v, 1);
+    return *this;
+  }
+
+  /// The maximum size of the messages received and not yet handled.
+  std::size_t max_outstanding_bytes() const { return max_outstanding_bytes_; }
+  SubscriberOptions& set_max_outstanding_bytes(std::size_t v) {
+    max_outstanding_bytes_ = (std::max<std::size_t>)(v, 1);
+    return *this;
+  }
+
+  /**
+   * The maximum number of callbacks running at the same time.
+   *
+   * The callbacks run on the threads of the connection's `CompletionQueue`,
+   * applications that want more than one callback at a time should create
+   * enough threads via `ConnectionOptions::set_background_thread_pool_size()`,
+   * or provide their own via `ConnectionOptions::DisableBackgroundThreads()`.
+   */
+  std::size_t max_concurrency() const { return max_concurrency_; }
+  SubscriberOptions& set_max_concurrency(std::size_t v) {
+    max_concurrency_ = (std::max<std::size_t>)(v, 1);
+    return *this;
+  }
+
+  /**
+   * The number of `StreamingPull` streams used to receive messages.
+   *
+   * The streams are spread across the channels of the connection, see
+   * `ConnectionOptions::set_num_channels()`.
+   */
+  std::size_t concurrent_streams() const { return concurrent_streams_; }
+  SubscriberOptions& set_concurrent_streams(std::size_t v) {
+    concurrent_streams_ = (std::max<std::size_t>)(v, 1);
+    return *this;
+  }
+
+  /**
+   * The maximum time the subscriber extends the ack deadline of a message.
+   *
+   * While the application handles a message the subscriber periodically
+   * extends its ack deadline, so the service does not re-deliver it. Once a
+   * message is this old the subscriber stops extending its deadline.
+   */
+  std::chrono::seconds max_lease_duration() const {
+    return max_lease_duration_;
+  }
+  template <typename Rep, typename Period>
+  SubscriberOptions& set_max_lease_duration(
+      std::chrono::duration<Rep, Period> v) {
+    max_lease_duration_ = (std::max)(
+        std::chrono::duration_cast<std::chrono::seconds>(v),
+        std::chrono::seconds(0));
+    return *this;
+  }
+
+ private:
+  std::size_t max_outstanding_messages_;
+  std::size_t max_outstanding_bytes_;
+  std::size_t max_concurrency_;
+  std::size_t concurrent_streams_;
+  std::chrono::seconds max_lease_duration_;
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_SUBSCRIBER_OPTIONS_H
@@ -0,0 +1,63 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/pubsub/subscriber_options.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace pubsub {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+namespace {
+
+TEST(SubscriberOptions, Defaults) {
+  auto const o = SubscriberOptions{};
+  EXPECT_LT(0, o.max_outstanding_messages());
+  EXPECT_LT(0, o.max_outstanding_bytes());
+  EXPECT_LT(0, o.max_concurrency());
+  EXPECT_LT(0, o.concurrent_streams());
+  EXPECT_LT(std::chrono::seconds(0), o.max_lease_duration());
+}
+
+TEST(SubscriberOptions, Setters) {
+  auto const o = SubscriberOptions{}
+                     .set_max_outstanding_messages(10)
+                     .set_max_outstanding_bytes(123)
+                     .set_max_concurrency(4)
+                     .set_concurrent_streams(2)
+                     .set_max_lease_duration(std::chrono::minutes(5));
+  EXPECT_EQ(10, o.max_outstanding_messages());
+  EXPECT_EQ(123, o.max_outstanding_bytes());
+  EXPECT_EQ(4, o.max_concurrency());
+  EXPECT_EQ(2, o.concurrent_streams());
+  EXPECT_EQ(std::chrono::seconds(300), o.max_lease_duration());
+}
+
+TEST(SubscriberOptions, ZeroIsClamped) {
+  auto const o = SubscriberOptions{}
+                     .set_max_outstanding_messages(0)
+                     .set_max_outstanding_bytes(0)
+                     .set_max_concurrency(0)
+                     .set_concurrent_streams(0);
+  EXPECT_EQ(1, o.max_outstanding_messages());
+  EXPECT_EQ(1, o.max_outstanding_bytes());
+  EXPECT_EQ(1, o.max_concurrency());
+  EXPECT_EQ(1, o.concurrent_streams());
+}
+
+}  // namespace
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub
+}  // namespace cloud
+}  // namespace google
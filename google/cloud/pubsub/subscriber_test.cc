@@ -66,6 +66,22 @@ TEST(SubscriberTest, SubscribeSimple) {
   ASSERT_STATUS_OK(status);
 }
 
+/// @test Verify Subscriber::GetAckMetrics() forwards to the connection.
+TEST(SubscriberTest, GetAckMetrics) {
+  auto mock = std::make_shared<pubsub_mocks::MockSubscriberConnection>();
+  SubscriberAckMetrics expected;
+  expected.ack_batches = 2;
+  expected.ack_ids = 7;
+  expected.failed_batches = 1;
+  EXPECT_CALL(*mock, GetAckMetrics()).WillOnce([&] { return expected; });
+
+  Subscriber subscriber(mock);
+  auto metrics = subscriber.GetAckMetrics();
+  EXPECT_EQ(2, metrics.ack_batches);
+  EXPECT_EQ(7, metrics.ack_ids);
+  EXPECT_EQ(1, metrics.failed_batches);
+}
+
 }  // namespace
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
 }  // namespace pubsub
@@ -59,6 +59,41 @@ class MockSubscriberStub : public pubsub_internal::SubscriberStub {
               (grpc::ClientContext&,
                google::pubsub::v1::ModifyAckDeadlineRequest const&),
               (override));
+
+  MOCK_METHOD(future<Status>, AsyncAcknowledge,
+              (google::cloud::CompletionQueue&,
+               std::unique_ptr<grpc::ClientContext>,
+               google::pubsub::v1::AcknowledgeRequest const&),
+              (override));
+
+  MOCK_METHOD(future<Status>, AsyncModifyAckDeadline,
+              (google::cloud::CompletionQueue&,
+               std::unique_ptr<grpc::ClientContext>,
+               google::pubsub::v1::ModifyAckDeadlineRequest const&),
+              (override));
+
+  MOCK_METHOD(std::unique_ptr<AsyncPullStream>, AsyncStreamingPull,
+              (google::cloud::CompletionQueue&,
+               std::unique_ptr<grpc::ClientContext>),
+              (override));
+};
+
+/**
+ * A class to mock the streams returned by `AsyncStreamingPull()`.
+ */
+class MockAsyncPullStream
+    : public pubsub_internal::SubscriberStub::AsyncPullStream {
+ public:
+  MOCK_METHOD(void, Cancel, (), (override));
+  MOCK_METHOD(future<bool>, Start, (), (override));
+  MOCK_METHOD(future<absl::optional<google::pubsub::v1::StreamingPullResponse>>,
+              Read, (), (override));
+  MOCK_METHOD(future<bool>, Write,
+              (google::pubsub::v1::StreamingPullRequest const&,
+               grpc::WriteOptions),
+              (override));
+  MOCK_METHOD(future<bool>, WritesDone, (), (override));
+  MOCK_METHOD(future<Status>, Finish, (), (override));
 };
 
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
@@ -42,6 +42,7 @@ std::ostream& operator<<(std::ostream& os, Config const& config) {
             << "\n# Query Size: " << config.query_size
             << "\n# Use Only Stubs: " << config.use_only_stubs
             << "\n# Use Only Clients: " << config.use_only_clients
+            << "\n# Use Fake Server: " << config.use_fake_server
             << "\n# Compiler: " << spanner::internal::CompilerId() << "-"
             << spanner::internal::CompilerVersion()
             << "\n# Build Flags: " << google::cloud::internal::compiler_flags()
@@ -121,6 +122,8 @@ google::cloud::StatusOr<Config> ParseArgs(std::vector<std::string> args) {
        [](Config& c, std::string const&) { c.use_only_stubs = true; }},
       {"--use-only-clients",
        [](Config& c, std::string const&) { c.use_only_clients = true; }},
+      {"--fake-server",
+       [](Config& c, std::string const&) { c.use_fake_server = true; }},
   };
 
   auto invalid_argument = [](std::string msg) {
@@ -147,6 +150,12 @@ google::cloud::StatusOr<Config> ParseArgs(std::vector<std::string> args) {
     return invalid_argument("Missing value for --experiment flag");
   }
 
+  if (config.use_fake_server) {
+    // The fake server accepts any project, instance, and database names.
+    if (config.project_id.empty()) config.project_id = "fake-project";
+    if (config.instance_id.empty()) config.instance_id = "fake-instance";
+  }
+
   if (config.project_id.empty()) {
     return invalid_argument(
         "The project id is not set, provide a value in the --project flag,"
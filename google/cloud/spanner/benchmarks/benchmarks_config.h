@@ -47,6 +47,11 @@ struct Config {
 
   bool use_only_clients = false;
   bool use_only_stubs = false;
+
+  // Run against an in-process `FakeSpannerServer` instead of Cloud Spanner.
+  bool use_fake_server = false;
+  // The address of the fake server, set once the server starts.
+  std::string fake_server_endpoint;
 };
 
 std::ostream& operator<<(std::ostream& os, Config const& config);
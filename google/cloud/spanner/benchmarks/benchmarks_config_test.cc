@@ -132,6 +132,16 @@ TEST(BenchmarkConfigTest, OnlyClients) {
   EXPECT_TRUE(config->use_only_clients);
 }
 
+TEST(BenchmarkConfigTest, FakeServer) {
+  testing_util::ScopedEnvironment env("GOOGLE_CLOUD_PROJECT", {});
+  auto config = ParseArgs({"placeholder", "--fake-server"});
+  ASSERT_STATUS_OK(config);
+
+  EXPECT_TRUE(config->use_fake_server);
+  EXPECT_FALSE(config->project_id.empty());
+  EXPECT_FALSE(config->instance_id.empty());
+}
+
 }  // namespace
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner_benchmarks
@@ -0,0 +1,1315 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/benchmarks/fake_spanner_server.h"
+#include "absl/memory/memory.h"
+#include "absl/types/optional.h"
+#include <google/spanner/v1/spanner.grpc.pb.h>
+#include <grpcpp/security/credentials.h>
+#include <grpcpp/security/server_credentials.h>
+#include <grpcpp/server_builder.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner_benchmarks {
+inline namespace SPANNER_CLIENT_NS {
+
+namespace internal {
+
+namespace spanner_proto = ::google::spanner::v1;
+
+using Key = std::vector<google::protobuf::Value>;
+using Row = std::vector<google::protobuf::Value>;
+
+Status InvalidArgument(std::string message) {
+  return Status(StatusCode::kInvalidArgument, std::move(message));
+}
+
+grpc::Status ToGrpcStatus(Status const& status) {
+  return grpc::Status(static_cast<grpc::StatusCode>(status.code()),
+                      status.message());
+}
+
+bool IsNull(google::protobuf::Value const& v) {
+  return v.kind_case() == google::protobuf::Value::kNullValue;
+}
+
+bool EqualsIgnoreCase(std::string const& a, std::string const& b) {
+  return a.size() == b.size() &&
+         std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+           return std::toupper(static_cast<unsigned char>(x)) ==
+                  std::toupper(static_cast<unsigned char>(y));
+         });
+}
+
+google::protobuf::Value NullValue() {
+  google::protobuf::Value v;
+  v.set_null_value(google::protobuf::NullValue::NULL_VALUE);
+  return v;
+}
+
+/// Compares two non-null values of the Spanner type @p code.
+int Compare(spanner_proto::TypeCode code, google::protobuf::Value const& a,
+            google::protobuf::Value const& b) {
+  if (IsNull(a) || IsNull(b)) return IsNull(b) - IsNull(a);
+  switch (code) {
+    case spanner_proto::INT64: {
+      auto x = std::strtoll(a.string_value().c_str(), nullptr, 10);
+      auto y = std::strtoll(b.string_value().c_str(), nullptr, 10);
+      return x < y ? -1 : (y < x ? 1 : 0);
+    }
+    case spanner_proto::FLOAT64: {
+      auto x = a.number_value();
+      auto y = b.number_value();
+      return x < y ? -1 : (y < x ? 1 : 0);
+    }
+    case spanner_proto::BOOL:
+      return static_cast<int>(a.bool_value()) -
+             static_cast<int>(b.bool_value());
+    default:
+      return a.string_value().compare(b.string_value());
+  }
+}
+
+/**
+ * Compares @p key with the (possibly shorter) @p prefix, looking only at the
+ * first `prefix.size()` columns.
+ */
+int ComparePrefix(std::vector<spanner_proto::TypeCode> const& codes,
+                  Key const& key, Key const& prefix) {
+  auto const n = std::min(key.size(), prefix.size());
+  for (std::size_t i = 0; i != n && i != codes.size(); ++i) {
+    auto c = Compare(codes[i], key[i], prefix[i]);
+    if (c != 0) return c;
+  }
+  return 0;
+}
+
+/// Orders the rows of a table, a shorter key sorts before its extensions.
+struct KeyLess {
+  std::vector<spanner_proto::TypeCode> codes;
+  bool operator()(Key const& a, Key const& b) const {
+    auto c = ComparePrefix(codes, a, b);
+    if (c != 0) return c < 0;
+    return a.size() < b.size();
+  }
+};
+
+Key ToKey(google::protobuf::ListValue const& lv) {
+  return Key(lv.values().begin(), lv.values().end());
+}
+
+struct Column {
+  std::string name;
+  spanner_proto::Type type;
+};
+
+struct Table {
+  Table(std::vector<Column> c, std::vector<std::size_t> k)
+      : columns(std::move(c)), key_columns(std::move(k)), rows(MakeLess()) {}
+
+  absl::optional<std::size_t> ColumnIndex(std::string const& name) const {
+    for (std::size_t i = 0; i != columns.size(); ++i) {
+      if (columns[i].name == name) return i;
+    }
+    return absl::nullopt;
+  }
+
+  spanner_proto::TypeCode KeyCode(std::size_t i) const {
+    return columns[key_columns[i]].type.code();
+  }
+
+  /// True if @p key is after the end of @p range.
+  bool PastEnd(Key const& key, spanner_proto::KeyRange const& range) const {
+    auto const& codes = rows.key_comp().codes;
+    if (range.has_end_closed()) {
+      return ComparePrefix(codes, key, ToKey(range.end_closed())) > 0;
+    }
+    return ComparePrefix(codes, key, ToKey(range.end_open())) >= 0;
+  }
+
+  bool InRange(Key const& key, spanner_proto::KeyRange const& range) const {
+    auto const& codes = rows.key_comp().codes;
+    if (range.has_start_closed() &&
+        ComparePrefix(codes, key, ToKey(range.start_closed())) < 0) {
+      return false;
+    }
+    if (range.has_start_open() &&
+        ComparePrefix(codes, key, ToKey(range.start_open())) <= 0) {
+      return false;
+    }
+    return !PastEnd(key, range);
+  }
+
+  /// The first row that may be in @p range.
+  std::map<Key, Row, KeyLess>::iterator RangeBegin(
+      spanner_proto::KeyRange const& range) {
+    if (range.has_start_closed()) {
+      return rows.lower_bound(ToKey(range.start_closed()));
+    }
+    return rows.lower_bound(ToKey(range.start_open()));
+  }
+
+  std::vector<Column> columns;
+  std::vector<std::size_t> key_columns;
+  std::map<Key, Row, KeyLess> rows;
+
+ private:
+  KeyLess MakeLess() const {
+    KeyLess less;
+    for (auto k : key_columns) less.codes.push_back(columns[k].type.code());
+    return less;
+  }
+};
+
+/// The result of a query, a read, or a DML statement.
+struct Result {
+  spanner_proto::StructType row_type;
+  std::vector<Row> rows;
+  bool is_dml = false;
+  std::int64_t row_count = 0;
+};
+
+//
+// A minimal tokenizer and parser for the supported SQL and DDL statements.
+//
+
+struct Token {
+  enum Kind { kEnd, kIdentifier, kNumber, kString, kParameter, kSymbol };
+  Kind kind;
+  std::string text;
+};
+
+StatusOr<std::vector<Token>> Tokenize(std::string const& sql) {
+  std::vector<Token> tokens;
+  auto const n = sql.size();
+  std::size_t i = 0;
+  auto is_digit = [](char c) {
+    return std::isdigit(static_cast<unsigned char>(c)) != 0;
+  };
+  auto is_ident = [](char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) != 0 || c == '_';
+  };
+  while (i != n) {
+    char const c = sql[i];
+    if (std::isspace(static_cast<unsigned char>(c)) != 0) {
+      ++i;
+      continue;
+    }
+    std::size_t start = i;
+    if (c == '@') {
+      ++start;
+      for (++i; i != n && is_ident(sql[i]);) ++i;
+      tokens.push_back({Token::kParameter, sql.substr(start, i - start)});
+    } else if (is_digit(c) ||
+               (c == '-' && i + 1 != n && is_digit(sql[i + 1]))) {
+      for (++i; i != n && (is_digit(sql[i]) || sql[i] == '.');) ++i;
+      tokens.push_back({Token::kNumber, sql.substr(start, i - start)});
+    } else if (is_ident(c)) {
+      for (++i; i != n && is_ident(sql[i]);) ++i;
+      tokens.push_back({Token::kIdentifier, sql.substr(start, i - start)});
+    } else if (c == '\'' || c == '"') {
+      auto end = sql.find(c, i + 1);
+      if (end == std::string::npos) {
+        return InvalidArgument("unterminated string literal in: " + sql);
+      }
+      tokens.push_back({Token::kString, sql.substr(i + 1, end - i - 1)});
+      i = end + 1;
+    } else {
+      static char const* const kTwoCharSymbols[] = {"<=", ">=", "<>", "!="};
+      std::string symbol(1, c);
+      for (auto const* s : kTwoCharSymbols) {
+        if (sql.compare(i, 2, s) == 0) symbol = s;
+      }
+      i += symbol.size();
+      tokens.push_back({Token::kSymbol, std::move(symbol)});
+    }
+  }
+  tokens.push_back({Token::kEnd, {}});
+  return tokens;
+}
+
+class Parser {
+ public:
+  explicit Parser(std::vector<Token> tokens) : tokens_(std::move(tokens)) {}
+
+  Token const& Peek() const { return tokens_[pos_]; }
+  bool AtEnd() const { return Peek().kind == Token::kEnd; }
+
+  /// Consumes the next token if it is the keyword or symbol @p word.
+  bool Accept(char const* word) {
+    auto const& t = Peek();
+    if (t.kind != Token::kIdentifier && t.kind != Token::kSymbol) return false;
+    if (!EqualsIgnoreCase(t.text, word)) return false;
+    ++pos_;
+    return true;
+  }
+
+  Status Expect(char const* word) {
+    if (Accept(word)) return {};
+    return InvalidArgument(std::string("expected '") + word + "' but found '" +
+                           Peek().text + "'");
+  }
+
+  StatusOr<std::string> Identifier() {
+    auto const& t = Peek();
+    if (t.kind != Token::kIdentifier) {
+      return InvalidArgument("expected an identifier but found '" + t.text +
+                             "'");
+    }
+    ++pos_;
+    return t.text;
+  }
+
+  Token Next() {
+    auto t = tokens_[pos_];
+    if (t.kind != Token::kEnd) ++pos_;
+    return t;
+  }
+
+  /// Accepts an optional trailing semicolon, then requires the end.
+  Status ExpectEnd() {
+    Accept(";");
+    if (AtEnd()) return {};
+    return InvalidArgument("unexpected '" + Peek().text + "'");
+  }
+
+ private:
+  std::vector<Token> tokens_;
+  std::size_t pos_ = 0;
+};
+
+StatusOr<spanner_proto::Type> ParseType(Parser& p) {
+  struct {
+    char const* name;
+    spanner_proto::TypeCode code;
+  } const kTypes[] = {
+      {"BOOL", spanner_proto::BOOL},       {"INT64", spanner_proto::INT64},
+      {"FLOAT64", spanner_proto::FLOAT64}, {"STRING", spanner_proto::STRING},
+      {"BYTES", spanner_proto::BYTES},     {"DATE", spanner_proto::DATE},
+      {"TIMESTAMP", spanner_proto::TIMESTAMP},
+      {"NUMERIC", spanner_proto::NUMERIC},
+  };
+  spanner_proto::Type type;
+  if (p.Accept("ARRAY")) {
+    auto status = p.Expect("<");
+    if (!status.ok()) return status;
+    auto element = ParseType(p);
+    if (!element) return std::move(element).status();
+    status = p.Expect(">");
+    if (!status.ok()) return status;
+    type.set_code(spanner_proto::ARRAY);
+    *type.mutable_array_element_type() = *std::move(element);
+    return type;
+  }
+  for (auto const& t : kTypes) {
+    if (!p.Accept(t.name)) continue;
+    type.set_code(t.code);
+    // Ignore the length of STRING(n) and BYTES(n) columns.
+    if (p.Accept("(")) {
+      p.Next();
+      auto status = p.Expect(")");
+      if (!status.ok()) return status;
+    }
+    return type;
+  }
+  return Status(StatusCode::kUnimplemented,
+                "unsupported column type '" + p.Peek().text + "'");
+}
+
+/// Parses `CREATE TABLE name (columns...) PRIMARY KEY (keys...)`.
+StatusOr<std::pair<std::string, Table>> ParseCreateTable(
+    std::string const& statement) {
+  auto tokens = Tokenize(statement);
+  if (!tokens) return std::move(tokens).status();
+  Parser p(*std::move(tokens));
+  if (!p.Accept("CREATE") || !p.Accept("TABLE")) {
+    return Status(StatusCode::kUnimplemented,
+                  "only CREATE TABLE is supported: " + statement);
+  }
+  auto name = p.Identifier();
+  if (!name) return std::move(name).status();
+  auto status = p.Expect("(");
+  if (!status.ok()) return status;
+  std::vector<Column> columns;
+  // The column list may end with a trailing comma.
+  while (!p.Accept(")")) {
+    auto column = p.Identifier();
+    if (!column) return std::move(column).status();
+    auto type = ParseType(p);
+    if (!type) return std::move(type).status();
+    if (p.Accept("NOT")) {
+      status = p.Expect("NULL");
+      if (!status.ok()) return status;
+    }
+    columns.push_back({*std::move(column), *std::move(type)});
+    if (!p.Accept(",")) {
+      status = p.Expect(")");
+      if (!status.ok()) return status;
+      break;
+    }
+  }
+  status = p.Expect("PRIMARY");
+  if (status.ok()) status = p.Expect("KEY");
+  if (status.ok()) status = p.Expect("(");
+  if (!status.ok()) return status;
+  std::vector<std::size_t> key_columns;
+  do {
+    auto key = p.Identifier();
+    if (!key) return std::move(key).status();
+    auto pos = std::find_if(columns.begin(), columns.end(),
+                            [&key](Column const& c) { return c.name == *key; });
+    if (pos == columns.end()) {
+      return InvalidArgument("unknown key column " + *key);
+    }
+    key_columns.push_back(pos - columns.begin());
+    if (!p.Accept("ASC")) p.Accept("DESC");
+  } while (p.Accept(","));
+  status = p.Expect(")");
+  if (status.ok()) status = p.ExpectEnd();
+  if (!status.ok()) return status;
+  return std::make_pair(*std::move(name),
+                        Table(std::move(columns), std::move(key_columns)));
+}
+
+/// A `column <op> operand` term of a `WHERE` clause.
+struct Condition {
+  std::size_t column;
+  std::string op;
+  google::protobuf::Value operand;
+};
+
+/// Parses a literal or a query parameter, as a value of type @p type.
+StatusOr<google::protobuf::Value> ParseOperand(
+    Parser& p, spanner_proto::Type const& type,
+    google::protobuf::Struct const& params) {
+  auto t = p.Next();
+  google::protobuf::Value v;
+  switch (t.kind) {
+    case Token::kParameter: {
+      auto f = params.fields().find(t.text);
+      if (f == params.fields().end()) {
+        return InvalidArgument("no value for query parameter @" + t.text);
+      }
+      return f->second;
+    }
+    case Token::kNumber:
+      if (type.code() == spanner_proto::FLOAT64) {
+        v.set_number_value(std::strtod(t.text.c_str(), nullptr));
+      } else {
+        v.set_string_value(t.text);
+      }
+      return v;
+    case Token::kString:
+      v.set_string_value(t.text);
+      return v;
+    case Token::kIdentifier:
+      if (EqualsIgnoreCase(t.text, "NULL")) return NullValue();
+      if (EqualsIgnoreCase(t.text, "TRUE") ||
+          EqualsIgnoreCase(t.text, "FALSE")) {
+        v.set_bool_value(EqualsIgnoreCase(t.text, "TRUE"));
+        return v;
+      }
+      break;
+    default:
+      break;
+  }
+  return InvalidArgument("expected a literal or parameter, found '" + t.text +
+                         "'");
+}
+
+StatusOr<std::size_t> ParseColumn(Parser& p, Table const& table) {
+  auto name = p.Identifier();
+  if (!name) return std::move(name).status();
+  auto pos = table.ColumnIndex(*name);
+  if (!pos) return Status(StatusCode::kNotFound, "column not found: " + *name);
+  return *pos;
+}
+
+/// Parses an optional `WHERE a op x AND b op y ...` clause.
+StatusOr<std::vector<Condition>> ParseWhere(
+    Parser& p, Table const& table, google::protobuf::Struct const& params) {
+  std::vector<Condition> conditions;
+  if (!p.Accept("WHERE")) return conditions;
+  do {
+    auto column = ParseColumn(p, table);
+    if (!column) return std::move(column).status();
+    auto op = p.Next();
+    static char const* const kOperators[] = {"=",  "!=", "<>", "<",
+                                             "<=", ">",  ">="};
+    if (op.kind != Token::kSymbol ||
+        std::none_of(std::begin(kOperators), std::end(kOperators),
+                     [&op](char const* o) { return op.text == o; })) {
+      return InvalidArgument("unsupported operator '" + op.text + "'");
+    }
+    auto operand = ParseOperand(p, table.columns[*column].type, params);
+    if (!operand) return std::move(operand).status();
+    conditions.push_back({*column, op.text, *std::move(operand)});
+  } while (p.Accept("AND"));
+  return conditions;
+}
+
+bool Matches(Table const& table, Row const& row,
+             std::vector<Condition> const& conditions) {
+  for (auto const& c : conditions) {
+    auto const& v = row[c.column];
+    // Comparisons with NULL are never true.
+    if (IsNull(v) || IsNull(c.operand)) return false;
+    auto cmp = Compare(table.columns[c.column].type.code(), v, c.operand);
+    bool match = c.op == "=" ? cmp == 0
+                 : c.op == "<"  ? cmp < 0
+                 : c.op == "<=" ? cmp <= 0
+                 : c.op == ">"  ? cmp > 0
+                 : c.op == ">=" ? cmp >= 0
+                                : cmp != 0;
+    if (!match) return false;
+  }
+  return true;
+}
+
+/**
+ * Calls @p f for each row of @p table matching @p conditions.
+ *
+ * The conditions on the first key column limit the range of rows examined,
+ * so the benchmark queries on key ranges do not scan the whole table.
+ */
+template <typename Functor>
+void ForEachMatch(Table& table, std::vector<Condition> const& conditions,
+                  Functor&& f) {
+  auto const key = table.key_columns.front();
+  auto begin = table.rows.begin();
+  Condition const* end = nullptr;
+  for (auto const& c : conditions) {
+    if (c.column != key || IsNull(c.operand)) continue;
+    if (c.op == "=" || c.op == ">=" || c.op == ">") {
+      begin = table.rows.lower_bound(Key{c.operand});
+    }
+    if (c.op == "=" || c.op == "<=" || c.op == "<") end = &c;
+  }
+  auto const code = table.KeyCode(0);
+  for (auto i = begin; i != table.rows.end(); ++i) {
+    if (end != nullptr) {
+      auto cmp = Compare(code, i->first.front(), end->operand);
+      if (cmp > 0 || (cmp == 0 && end->op == "<")) break;
+    }
+    if (Matches(table, i->second, conditions)) f(*i);
+  }
+}
+
+std::string NewTransactionId() {
+  static std::mutex mu;
+  static std::int64_t counter = 0;
+  std::lock_guard<std::mutex> lk(mu);
+  return "txn-" + std::to_string(++counter);
+}
+
+google::protobuf::Timestamp Now() {
+  auto const now = std::chrono::system_clock::now().time_since_epoch();
+  auto const s = std::chrono::duration_cast<std::chrono::seconds>(now);
+  google::protobuf::Timestamp ts;
+  ts.set_seconds(s.count());
+  ts.set_nanos(static_cast<std::int32_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - s).count()));
+  return ts;
+}
+
+/// The resume token for the value at @p index, starting at @p offset.
+std::string MakeResumeToken(std::size_t index, std::size_t offset) {
+  return std::to_string(index) + ":" + std::to_string(offset);
+}
+
+StatusOr<std::pair<std::size_t, std::size_t>> ParseResumeToken(
+    std::string const& token) {
+  if (token.empty()) return std::make_pair(std::size_t{0}, std::size_t{0});
+  auto colon = token.find(':');
+  if (colon == std::string::npos) {
+    return InvalidArgument("invalid resume token " + token);
+  }
+  return std::make_pair(
+      static_cast<std::size_t>(std::strtoull(token.c_str(), nullptr, 10)),
+      static_cast<std::size_t>(
+          std::strtoull(token.c_str() + colon + 1, nullptr, 10)));
+}
+
+class FakeSpannerService : public spanner_proto::Spanner::Service {
+ public:
+  explicit FakeSpannerService(FakeSpannerServerOptions options)
+      : options_(std::move(options)) {}
+
+  Status ApplyDdl(std::string const& statement) {
+    auto table = ParseCreateTable(statement);
+    if (!table) return std::move(table).status();
+    std::lock_guard<std::mutex> lk(mu_);
+    auto inserted = tables_.emplace(std::move(table->first),
+                                    std::move(table->second));
+    if (!inserted.second) {
+      return Status(StatusCode::kAlreadyExists,
+                    "table " + inserted.first->first + " already exists");
+    }
+    return {};
+  }
+
+  grpc::Status CreateSession(grpc::ServerContext*,
+                             spanner_proto::CreateSessionRequest const* request,
+                             spanner_proto::Session* response) override {
+    *response = NewSession(request->database());
+    return grpc::Status::OK;
+  }
+
+  grpc::Status BatchCreateSessions(
+      grpc::ServerContext*,
+      spanner_proto::BatchCreateSessionsRequest const* request,
+      spanner_proto::BatchCreateSessionsResponse* response) override {
+    // Like the service, return at most 100 sessions per request.
+    auto const count = std::max(1, std::min(request->session_count(), 100));
+    for (int i = 0; i != count; ++i) {
+      *response->add_session() = NewSession(request->database());
+    }
+    return grpc::Status::OK;
+  }
+
+  grpc::Status GetSession(grpc::ServerContext*,
+                          spanner_proto::GetSessionRequest const* request,
+                          spanner_proto::Session* response) override {
+    auto status = CheckSession(request->name());
+    if (!status.ok()) return ToGrpcStatus(status);
+    response->set_name(request->name());
+    return grpc::Status::OK;
+  }
+
+  grpc::Status ListSessions(grpc::ServerContext*,
+                            spanner_proto::ListSessionsRequest const* request,
+                            spanner_proto::ListSessionsResponse* response)
+      override {
+    auto const prefix = request->database() + "/sessions/";
+    std::lock_guard<std::mutex> lk(sessions_mu_);
+    for (auto const& s : sessions_) {
+      if (s.compare(0, prefix.size(), prefix) == 0) {
+        response->add_sessions()->set_name(s);
+      }
+    }
+    return grpc::Status::OK;
+  }
+
+  grpc::Status DeleteSession(grpc::ServerContext*,
+                             spanner_proto::DeleteSessionRequest const* request,
+                             google::protobuf::Empty*) override {
+    std::lock_guard<std::mutex> lk(sessions_mu_);
+    if (sessions_.erase(request->name()) == 0) {
+      return ToGrpcStatus(SessionNotFound(request->name()));
+    }
+    return grpc::Status::OK;
+  }
+
+  grpc::Status ExecuteSql(grpc::ServerContext*,
+                          spanner_proto::ExecuteSqlRequest const* request,
+                          spanner_proto::ResultSet* response) override {
+    auto result = ExecuteStatement(*request);
+    if (!result) return ToGrpcStatus(result.status());
+    *response->mutable_metadata() = Metadata(*result, request->transaction());
+    if (result->is_dml) {
+      response->mutable_stats()->set_row_count_exact(result->row_count);
+      return grpc::Status::OK;
+    }
+    for (auto& row : result->rows) {
+      auto& lv = *response->add_rows();
+      for (auto& v : row) *lv.add_values() = std::move(v);
+    }
+    return grpc::Status::OK;
+  }
+
+  grpc::Status ExecuteStreamingSql(
+      grpc::ServerContext*, spanner_proto::ExecuteSqlRequest const* request,
+      grpc::ServerWriter<spanner_proto::PartialResultSet>* writer) override {
+    auto result = ExecuteStatement(*request);
+    if (!result) return ToGrpcStatus(result.status());
+    return ToGrpcStatus(StreamResult(
+        *result, Metadata(*result, request->transaction()),
+        request->resume_token(),
+        [writer](spanner_proto::PartialResultSet const& r) {
+          return writer->Write(r);
+        }));
+  }
+
+  grpc::Status ExecuteBatchDml(
+      grpc::ServerContext*,
+      spanner_proto::ExecuteBatchDmlRequest const* request,
+      spanner_proto::ExecuteBatchDmlResponse* response) override {
+    auto status = CheckSession(request->session());
+    if (!status.ok()) return ToGrpcStatus(status);
+    for (auto const& s : request->statements()) {
+      auto result = ExecuteSqlText(s.sql(), s.params());
+      if (!result) {
+        status = std::move(result).status();
+        break;
+      }
+      if (!result->is_dml) {
+        status = InvalidArgument("not a DML statement: " + s.sql());
+        break;
+      }
+      auto& rs = *response->add_result_sets();
+      if (response->result_sets_size() == 1) {
+        *rs.mutable_metadata() = Metadata(*result, request->transaction());
+      }
+      rs.mutable_stats()->set_row_count_exact(result->row_count);
+    }
+    response->mutable_status()->set_code(static_cast<int>(status.code()));
+    response->mutable_status()->set_message(status.message());
+    return grpc::Status::OK;
+  }
+
+  grpc::Status Read(grpc::ServerContext*,
+                    spanner_proto::ReadRequest const* request,
+                    spanner_proto::ResultSet* response) override {
+    auto result = ExecuteRead(*request);
+    if (!result) return ToGrpcStatus(result.status());
+    *response->mutable_metadata() = Metadata(*result, request->transaction());
+    for (auto& row : result->rows) {
+      auto& lv = *response->add_rows();
+      for (auto& v : row) *lv.add_values() = std::move(v);
+    }
+    return grpc::Status::OK;
+  }
+
+  grpc::Status StreamingRead(
+      grpc::ServerContext*, spanner_proto::ReadRequest const* request,
+      grpc::ServerWriter<spanner_proto::PartialResultSet>* writer) override {
+    auto result = ExecuteRead(*request);
+    if (!result) return ToGrpcStatus(result.status());
+    return ToGrpcStatus(StreamResult(
+        *result, Metadata(*result, request->transaction()),
+        request->resume_token(),
+        [writer](spanner_proto::PartialResultSet const& r) {
+          return writer->Write(r);
+        }));
+  }
+
+  grpc::Status BeginTransaction(
+      grpc::ServerContext*,
+      spanner_proto::BeginTransactionRequest const* request,
+      spanner_proto::Transaction* response) override {
+    auto status = CheckSession(request->session());
+    if (!status.ok()) return ToGrpcStatus(status);
+    response->set_id(NewTransactionId());
+    if (request->options().has_read_only()) {
+      *response->mutable_read_timestamp() = Now();
+    }
+    return grpc::Status::OK;
+  }
+
+  grpc::Status Commit(grpc::ServerContext*,
+                      spanner_proto::CommitRequest const* request,
+                      spanner_proto::CommitResponse* response) override {
+    auto status = CheckSession(request->session());
+    if (status.ok()) status = ApplyMutations(request->mutations());
+    if (!status.ok()) return ToGrpcStatus(status);
+    *response->mutable_commit_timestamp() = Now();
+    return grpc::Status::OK;
+  }
+
+  grpc::Status Rollback(grpc::ServerContext*,
+                        spanner_proto::RollbackRequest const* request,
+                        google::protobuf::Empty*) override {
+    return ToGrpcStatus(CheckSession(request->session()));
+  }
+
+  grpc::Status PartitionQuery(
+      grpc::ServerContext*, spanner_proto::PartitionQueryRequest const* request,
+      spanner_proto::PartitionResponse* response) override {
+    return ToGrpcStatus(OnePartition(request->session(), response));
+  }
+
+  grpc::Status PartitionRead(
+      grpc::ServerContext*, spanner_proto::PartitionReadRequest const* request,
+      spanner_proto::PartitionResponse* response) override {
+    return ToGrpcStatus(OnePartition(request->session(), response));
+  }
+
+ private:
+  static Status SessionNotFound(std::string const& name) {
+    return Status(StatusCode::kNotFound, "Session not found: " + name);
+  }
+
+  spanner_proto::Session NewSession(std::string const& database) {
+    spanner_proto::Session session;
+    std::lock_guard<std::mutex> lk(sessions_mu_);
+    session.set_name(database + "/sessions/" +
+                     std::to_string(++session_counter_));
+    sessions_.insert(session.name());
+    return session;
+  }
+
+  Status CheckSession(std::string const& name) {
+    std::lock_guard<std::mutex> lk(sessions_mu_);
+    if (sessions_.count(name) == 0) return SessionNotFound(name);
+    return {};
+  }
+
+  /// Every request is served by a single partition.
+  Status OnePartition(std::string const& session,
+                      spanner_proto::PartitionResponse* response) {
+    auto status = CheckSession(session);
+    if (!status.ok()) return status;
+    response->add_partitions()->set_partition_token("partition-0");
+    response->mutable_transaction()->set_id(NewTransactionId());
+    return {};
+  }
+
+  static spanner_proto::ResultSetMetadata Metadata(
+      Result const& result, spanner_proto::TransactionSelector const& s) {
+    spanner_proto::ResultSetMetadata metadata;
+    *metadata.mutable_row_type() = result.row_type;
+    if (s.has_begin()) {
+      auto& txn = *metadata.mutable_transaction();
+      txn.set_id(NewTransactionId());
+      if (s.begin().has_read_only()) *txn.mutable_read_timestamp() = Now();
+    }
+    return metadata;
+  }
+
+  StatusOr<Result> ExecuteStatement(
+      spanner_proto::ExecuteSqlRequest const& request) {
+    auto status = CheckSession(request.session());
+    if (!status.ok()) return status;
+    return ExecuteSqlText(request.sql(), request.params());
+  }
+
+  StatusOr<Result> ExecuteSqlText(std::string const& sql,
+                                  google::protobuf::Struct const& params) {
+    auto tokens = Tokenize(sql);
+    if (!tokens) return std::move(tokens).status();
+    Parser p(*std::move(tokens));
+    std::lock_guard<std::mutex> lk(mu_);
+    if (p.Accept("SELECT")) return Select(p, params);
+    if (p.Accept("UPDATE")) return Update(p, params);
+    if (p.Accept("INSERT")) return Insert(p, params);
+    if (p.Accept("DELETE")) return Delete(p, params);
+    return Status(StatusCode::kUnimplemented, "unsupported statement: " + sql);
+  }
+
+  StatusOr<Table*> FindTable(std::string const& name) {
+    auto t = tables_.find(name);
+    if (t == tables_.end()) {
+      return Status(StatusCode::kNotFound, "table not found: " + name);
+    }
+    return &t->second;
+  }
+
+  StatusOr<Table*> ParseTable(Parser& p) {
+    auto name = p.Identifier();
+    if (!name) return std::move(name).status();
+    return FindTable(*name);
+  }
+
+  // `SELECT (* | column, ... | integer, ...) [FROM table [WHERE ...]]`
+  StatusOr<Result> Select(Parser& p, google::protobuf::Struct const& params) {
+    std::vector<Token> items;
+    do {
+      items.push_back(p.Next());
+    } while (p.Accept(","));
+
+    Result result;
+    if (!p.Accept("FROM")) {
+      // A query without a table, such as `SELECT 1`.
+      result.rows.emplace_back();
+      for (auto const& t : items) {
+        if (t.kind != Token::kNumber) {
+          return InvalidArgument("unexpected '" + t.text + "' in SELECT");
+        }
+        result.row_type.add_fields()->mutable_type()->set_code(
+            spanner_proto::INT64);
+        result.rows.back().emplace_back();
+        result.rows.back().back().set_string_value(t.text);
+      }
+      auto status = p.ExpectEnd();
+      if (!status.ok()) return status;
+      return result;
+    }
+
+    auto table = ParseTable(p);
+    if (!table) return std::move(table).status();
+    std::vector<std::size_t> columns;
+    for (auto const& t : items) {
+      if (t.kind == Token::kSymbol && t.text == "*") {
+        for (std::size_t i = 0; i != (*table)->columns.size(); ++i) {
+          columns.push_back(i);
+        }
+        continue;
+      }
+      auto pos = (*table)->ColumnIndex(t.text);
+      if (t.kind != Token::kIdentifier || !pos) {
+        return Status(StatusCode::kNotFound, "column not found: " + t.text);
+      }
+      columns.push_back(*pos);
+    }
+    auto conditions = ParseWhere(p, **table, params);
+    if (!conditions) return std::move(conditions).status();
+    auto status = p.ExpectEnd();
+    if (!status.ok()) return status;
+
+    SetRowType(**table, columns, result);
+    ForEachMatch(**table, *conditions, [&](std::pair<Key const, Row>& r) {
+      result.rows.push_back(Project(r.second, columns));
+    });
+    return result;
+  }
+
+  // `UPDATE table SET column = operand, ... WHERE ...`
+  StatusOr<Result> Update(Parser& p, google::protobuf::Struct const& params) {
+    auto table = ParseTable(p);
+    if (!table) return std::move(table).status();
+    auto& t = **table;
+    auto status = p.Expect("SET");
+    if (!status.ok()) return status;
+    std::vector<std::pair<std::size_t, google::protobuf::Value>> assignments;
+    do {
+      auto column = ParseColumn(p, t);
+      if (!column) return std::move(column).status();
+      if (std::find(t.key_columns.begin(), t.key_columns.end(), *column) !=
+          t.key_columns.end()) {
+        return InvalidArgument("cannot update key column " +
+                               t.columns[*column].name);
+      }
+      status = p.Expect("=");
+      if (!status.ok()) return status;
+      auto operand = ParseOperand(p, t.columns[*column].type, params);
+      if (!operand) return std::move(operand).status();
+      assignments.emplace_back(*column, *std::move(operand));
+    } while (p.Accept(","));
+    auto conditions = ParseWhere(p, t, params);
+    if (!conditions) return std::move(conditions).status();
+    status = p.ExpectEnd();
+    if (!status.ok()) return status;
+
+    Result result;
+    result.is_dml = true;
+    ForEachMatch(t, *conditions, [&](std::pair<Key const, Row>& r) {
+      for (auto const& a : assignments) r.second[a.first] = a.second;
+      ++result.row_count;
+    });
+    return result;
+  }
+
+  // `INSERT [INTO] table (column, ...) VALUES (operand, ...), ...`
+  StatusOr<Result> Insert(Parser& p, google::protobuf::Struct const& params) {
+    p.Accept("INTO");
+    auto table = ParseTable(p);
+    if (!table) return std::move(table).status();
+    auto& t = **table;
+    auto status = p.Expect("(");
+    if (!status.ok()) return status;
+    std::vector<std::size_t> columns;
+    do {
+      auto column = ParseColumn(p, t);
+      if (!column) return std::move(column).status();
+      columns.push_back(*column);
+    } while (p.Accept(","));
+    status = p.Expect(")");
+    if (status.ok()) status = p.Expect("VALUES");
+    if (!status.ok()) return status;
+
+    std::vector<Row> rows;
+    do {
+      status = p.Expect("(");
+      if (!status.ok()) return status;
+      Row row(t.columns.size(), NullValue());
+      for (std::size_t i = 0; i != columns.size(); ++i) {
+        if (i != 0 && !p.Accept(",")) return p.Expect(",");
+        auto v = ParseOperand(p, t.columns[columns[i]].type, params);
+        if (!v) return std::move(v).status();
+        row[columns[i]] = *std::move(v);
+      }
+      status = p.Expect(")");
+      if (!status.ok()) return status;
+      rows.push_back(std::move(row));
+    } while (p.Accept(","));
+    status = p.ExpectEnd();
+    if (!status.ok()) return status;
+
+    for (auto const& row : rows) {
+      if (t.rows.count(KeyOf(t, row)) != 0) {
+        return Status(StatusCode::kAlreadyExists, "row already exists");
+      }
+    }
+    Result result;
+    result.is_dml = true;
+    for (auto& row : rows) {
+      auto key = KeyOf(t, row);
+      t.rows.emplace(std::move(key), std::move(row));
+      ++result.row_count;
+    }
+    return result;
+  }
+
+  // `DELETE [FROM] table WHERE ...`
+  StatusOr<Result> Delete(Parser& p, google::protobuf::Struct const& params) {
+    p.Accept("FROM");
+    auto table = ParseTable(p);
+    if (!table) return std::move(table).status();
+    auto& t = **table;
+    auto conditions = ParseWhere(p, t, params);
+    if (!conditions) return std::move(conditions).status();
+    auto status = p.ExpectEnd();
+    if (!status.ok()) return status;
+
+    std::vector<Key> keys;
+    ForEachMatch(t, *conditions, [&keys](std::pair<Key const, Row>& r) {
+      keys.push_back(r.first);
+    });
+    for (auto const& k : keys) t.rows.erase(k);
+    Result result;
+    result.is_dml = true;
+    result.row_count = static_cast<std::int64_t>(keys.size());
+    return result;
+  }
+
+  StatusOr<Result> ExecuteRead(spanner_proto::ReadRequest const& request) {
+    auto status = CheckSession(request.session());
+    if (!status.ok()) return status;
+    if (!request.index().empty()) {
+      return Status(StatusCode::kUnimplemented, "reads using an index");
+    }
+    std::lock_guard<std::mutex> lk(mu_);
+    auto table = FindTable(request.table());
+    if (!table) return std::move(table).status();
+    auto& t = **table;
+    std::vector<std::size_t> columns;
+    for (auto const& name : request.columns()) {
+      auto pos = t.ColumnIndex(name);
+      if (!pos) {
+        return Status(StatusCode::kNotFound, "column not found: " + name);
+      }
+      columns.push_back(*pos);
+    }
+
+    Result result;
+    SetRowType(t, columns, result);
+    auto const limit = request.limit() == 0
+                           ? std::numeric_limits<std::size_t>::max()
+                           : static_cast<std::size_t>(request.limit());
+    auto add = [&](Row const& row) {
+      if (result.rows.size() < limit) {
+        result.rows.push_back(Project(row, columns));
+      }
+    };
+    auto const& key_set = request.key_set();
+    if (key_set.all()) {
+      for (auto const& r : t.rows) add(r.second);
+      return result;
+    }
+    for (auto const& k : key_set.keys()) {
+      auto r = t.rows.find(ToKey(k));
+      if (r != t.rows.end()) add(r->second);
+    }
+    for (auto const& range : key_set.ranges()) {
+      for (auto i = t.RangeBegin(range);
+           i != t.rows.end() && !t.PastEnd(i->first, range); ++i) {
+        if (t.InRange(i->first, range)) add(i->second);
+      }
+    }
+    return result;
+  }
+
+  /**
+   * Applies the mutations of a commit.
+   *
+   * The previous contents of each modified row are saved, and restored if any
+   * mutation fails, so the commit is atomic.
+   */
+  Status ApplyMutations(
+      google::protobuf::RepeatedPtrField<spanner_proto::Mutation> const& m) {
+    struct Undo {
+      Table* table;
+      Key key;
+      absl::optional<Row> previous;
+    };
+    std::vector<Undo> undo;
+    auto save = [&undo](Table& t, Key const& key) {
+      auto r = t.rows.find(key);
+      undo.push_back(Undo{&t, key,
+                          r == t.rows.end() ? absl::optional<Row>{}
+                                            : absl::optional<Row>(r->second)});
+    };
+
+    std::lock_guard<std::mutex> lk(mu_);
+    Status status;
+    for (auto const& mutation : m) {
+      if (mutation.has_delete_()) {
+        status = ApplyDelete(mutation.delete_(), save);
+      } else {
+        status = ApplyWrite(mutation, save);
+      }
+      if (!status.ok()) break;
+    }
+    if (status.ok()) return status;
+    for (auto u = undo.rbegin(); u != undo.rend(); ++u) {
+      if (u->previous) {
+        u->table->rows[u->key] = *std::move(u->previous);
+      } else {
+        u->table->rows.erase(u->key);
+      }
+    }
+    return status;
+  }
+
+  template <typename SaveRow>
+  Status ApplyWrite(spanner_proto::Mutation const& mutation, SaveRow& save) {
+    enum { kInsert, kUpdate, kInsertOrUpdate, kReplace } mode;
+    spanner_proto::Mutation::Write const* write;
+    if (mutation.has_insert()) {
+      mode = kInsert;
+      write = &mutation.insert();
+    } else if (mutation.has_update()) {
+      mode = kUpdate;
+      write = &mutation.update();
+    } else if (mutation.has_insert_or_update()) {
+      mode = kInsertOrUpdate;
+      write = &mutation.insert_or_update();
+    } else if (mutation.has_replace()) {
+      mode = kReplace;
+      write = &mutation.replace();
+    } else {
+      return InvalidArgument("empty mutation");
+    }
+    auto table = FindTable(write->table());
+    if (!table) return std::move(table).status();
+    auto& t = **table;
+    std::vector<std::size_t> columns;
+    for (auto const& name : write->columns()) {
+      auto pos = t.ColumnIndex(name);
+      if (!pos) {
+        return Status(StatusCode::kNotFound, "column not found: " + name);
+      }
+      columns.push_back(*pos);
+    }
+    for (auto k : t.key_columns) {
+      if (std::find(columns.begin(), columns.end(), k) == columns.end()) {
+        return InvalidArgument("missing key column " + t.columns[k].name);
+      }
+    }
+    for (auto const& values : write->values()) {
+      if (static_cast<std::size_t>(values.values_size()) != columns.size()) {
+        return InvalidArgument("wrong number of values in mutation row");
+      }
+      Row row(t.columns.size(), NullValue());
+      for (std::size_t i = 0; i != columns.size(); ++i) {
+        row[columns[i]] = values.values(static_cast<int>(i));
+      }
+      auto key = KeyOf(t, row);
+      auto existing = t.rows.find(key);
+      if (mode == kInsert && existing != t.rows.end()) {
+        return Status(StatusCode::kAlreadyExists, "row already exists");
+      }
+      if (mode == kUpdate && existing == t.rows.end()) {
+        return Status(StatusCode::kNotFound, "row not found");
+      }
+      save(t, key);
+      if (existing == t.rows.end() || mode == kReplace) {
+        t.rows[std::move(key)] = std::move(row);
+        continue;
+      }
+      for (auto c : columns) existing->second[c] = std::move(row[c]);
+    }
+    return {};
+  }
+
+  template <typename SaveRow>
+  Status ApplyDelete(spanner_proto::Mutation::Delete const& d, SaveRow& save) {
+    auto table = FindTable(d.table());
+    if (!table) return std::move(table).status();
+    auto& t = **table;
+    std::vector<Key> keys;
+    if (d.key_set().all()) {
+      for (auto const& r : t.rows) keys.push_back(r.first);
+    }
+    for (auto const& k : d.key_set().keys()) keys.push_back(ToKey(k));
+    for (auto const& range : d.key_set().ranges()) {
+      for (auto i = t.RangeBegin(range);
+           i != t.rows.end() && !t.PastEnd(i->first, range); ++i) {
+        if (t.InRange(i->first, range)) keys.push_back(i->first);
+      }
+    }
+    for (auto const& k : keys) {
+      if (t.rows.count(k) == 0) continue;
+      save(t, k);
+      t.rows.erase(k);
+    }
+    return {};
+  }
+
+  /**
+   * Sends @p result as a sequence of `PartialResultSet` messages, starting at
+   * the position encoded in @p resume_token.
+   */
+  Status StreamResult(
+      Result const& result, spanner_proto::ResultSetMetadata const& metadata,
+      std::string const& resume_token,
+      std::function<bool(spanner_proto::PartialResultSet const&)> const&
+          write) const {
+    auto start = ParseResumeToken(resume_token);
+    if (!start) return std::move(start).status();
+    auto const columns =
+        static_cast<std::size_t>(result.row_type.fields_size());
+    auto const n = result.rows.size() * columns;
+    auto i = start->first;
+    auto offset = start->second;
+    std::size_t responses = 0;
+    do {
+      spanner_proto::PartialResultSet response;
+      // The resumed streams continue the original one, which already sent the
+      // metadata.
+      if (resume_token.empty() && responses == 0) {
+        *response.mutable_metadata() = metadata;
+      }
+      for (std::size_t count = 0;
+           i < n && count != options_.values_per_response; ++count) {
+        auto const& v = result.rows[i / columns][i % columns];
+        auto const code = result.row_type.fields(static_cast<int>(i % columns))
+                              .type()
+                              .code();
+        auto const chunkable =
+            options_.max_chunk_size != 0 &&
+            v.kind_case() == google::protobuf::Value::kStringValue &&
+            (code == spanner_proto::STRING || code == spanner_proto::BYTES);
+        if (chunkable &&
+            v.string_value().size() - offset > options_.max_chunk_size) {
+          response.add_values()->set_string_value(
+              v.string_value().substr(offset, options_.max_chunk_size));
+          response.set_chunked_value(true);
+          offset += options_.max_chunk_size;
+          break;
+        }
+        if (offset == 0) {
+          *response.add_values() = v;
+        } else {
+          response.add_values()->set_string_value(
+              v.string_value().substr(offset));
+        }
+        ++i;
+        offset = 0;
+      }
+      if (i >= n && result.is_dml) {
+        response.mutable_stats()->set_row_count_exact(result.row_count);
+      }
+      if (options_.resume_tokens) {
+        response.set_resume_token(MakeResumeToken(i, offset));
+      }
+      if (!write(response)) {
+        return Status(StatusCode::kCancelled, "the stream was closed");
+      }
+      ++responses;
+      if (i < n && responses == options_.interrupt_after_responses) {
+        return Status(StatusCode::kUnavailable, "stream interrupted by fake");
+      }
+    } while (i < n);
+    return {};
+  }
+
+  static void SetRowType(Table const& t, std::vector<std::size_t> const& c,
+                         Result& result) {
+    for (auto i : c) {
+      auto& field = *result.row_type.add_fields();
+      field.set_name(t.columns[i].name);
+      *field.mutable_type() = t.columns[i].type;
+    }
+  }
+
+  static Row Project(Row const& row, std::vector<std::size_t> const& columns) {
+    Row projected;
+    projected.reserve(columns.size());
+    for (auto c : columns) projected.push_back(row[c]);
+    return projected;
+  }
+
+  static Key KeyOf(Table const& t, Row const& row) {
+    Key key;
+    key.reserve(t.key_columns.size());
+    for (auto k : t.key_columns) key.push_back(row[k]);
+    return key;
+  }
+
+  FakeSpannerServerOptions const options_;
+
+  std::mutex sessions_mu_;
+  std::int64_t session_counter_ = 0;  // GUARDED_BY(sessions_mu_)
+  std::set<std::string> sessions_;    // GUARDED_BY(sessions_mu_)
+
+  std::mutex mu_;
+  std::map<std::string, Table> tables_;  // GUARDED_BY(mu_)
+};
+
+}  // namespace internal
+
+StatusOr<std::unique_ptr<FakeSpannerServer>> FakeSpannerServer::Create(
+    FakeSpannerServerOptions options) {
+  auto service =
+      absl::make_unique<internal::FakeSpannerService>(std::move(options));
+  int port = 0;
+  grpc::ServerBuilder builder;
+  builder.AddListeningPort("localhost:0", grpc::InsecureServerCredentials(),
+                           &port);
+  builder.RegisterService(service.get());
+  auto server = builder.BuildAndStart();
+  if (!server || port == 0) {
+    return Status(StatusCode::kUnavailable,
+                  "cannot start the fake Spanner server");
+  }
+  return std::unique_ptr<FakeSpannerServer>(
+      new FakeSpannerServer(std::move(service), std::move(server),
+                            "localhost:" + std::to_string(port)));
+}
+
+FakeSpannerServer::FakeSpannerServer(
+    std::unique_ptr<internal::FakeSpannerService> service,
+    std::unique_ptr<grpc::Server> server, std::string endpoint)
+    : service_(std::move(service)),
+      server_(std::move(server)),
+      endpoint_(std::move(endpoint)) {}
+
+FakeSpannerServer::~FakeSpannerServer() {
+  server_->Shutdown();
+  server_->Wait();
+}
+
+spanner::ConnectionOptions FakeSpannerServer::connection_options() const {
+  return spanner::ConnectionOptions(grpc::InsecureChannelCredentials())
+      .set_endpoint(endpoint_);
+}
+
+Status FakeSpannerServer::ApplyDdl(std::string const& statement) {
+  return service_->ApplyDdl(statement);
+}
+
+spanner::ConnectionOptions MakeConnectionOptions(Config const& config) {
+  if (!config.use_fake_server) return spanner::ConnectionOptions();
+  return spanner::ConnectionOptions(grpc::InsecureChannelCredentials())
+      .set_endpoint(config.fake_server_endpoint);
+}
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner_benchmarks
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,127 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_BENCHMARKS_FAKE_SPANNER_SERVER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_BENCHMARKS_FAKE_SPANNER_SERVER_H
+
+#include "google/cloud/spanner/benchmarks/benchmarks_config.h"
+#include "google/cloud/spanner/connection_options.h"
+#include "google/cloud/spanner/version.h"
+#include "google/cloud/status.h"
+#include "google/cloud/status_or.h"
+#include <grpcpp/server.h>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace spanner_benchmarks {
+inline namespace SPANNER_CLIENT_NS {
+
+/// Configuration for `FakeSpannerServer`.
+struct FakeSpannerServerOptions {
+  /// The maximum number of values in each `PartialResultSet`.
+  std::size_t values_per_response = 1000;
+
+  /**
+   * If not zero, the `STRING` and `BYTES` values longer than this are split
+   * across several `PartialResultSet` messages, as chunked values.
+   */
+  std::size_t max_chunk_size = 0;
+
+  /// If true, every `PartialResultSet` carries a resume token.
+  bool resume_tokens = true;
+
+  /**
+   * If not zero, each stream fails with `kUnavailable` after sending this many
+   * `PartialResultSet` messages, so the client must resume it.
+   */
+  std::size_t interrupt_after_responses = 0;
+};
+
+namespace internal {
+class FakeSpannerService;  // Defined in fake_spanner_server.cc
+}  // namespace internal
+
+/**
+ * An in-process fake of the `google.spanner.v1.Spanner` gRPC service.
+ *
+ * The benchmarks use this fake to measure the CPU overhead of the client
+ * library without a Cloud Spanner instance, and without any network noise.
+ *
+ * The fake keeps its tables in memory. It supports sessions, transactions,
+ * mutations, reads (by keys, key ranges, or all the rows), and a small subset
+ * of SQL, enough for the benchmarks:
+ *
+ * - `CREATE TABLE`, through `ApplyDdl()`.
+ * - `SELECT` of columns, or of integer literals, from a single table, with a
+ *   `WHERE` clause made of column comparisons joined by `AND`.
+ * - `INSERT INTO ... VALUES`, and `UPDATE` and `DELETE` with the same kind of
+ *   `WHERE` clause.
+ *
+ * The comparison operands may be query parameters or literals.
+ *
+ * Commits are atomic, but there is no isolation between transactions, and DML
+ * statements take effect immediately, even if the transaction is rolled back.
+ */
+class FakeSpannerServer {
+ public:
+  /// Starts a server listening on an unused `localhost` port.
+  static StatusOr<std::unique_ptr<FakeSpannerServer>> Create(
+      FakeSpannerServerOptions options = {});
+
+  /// Shuts down the server, cancelling any pending requests.
+  ~FakeSpannerServer();
+
+  FakeSpannerServer(FakeSpannerServer const&) = delete;
+  FakeSpannerServer& operator=(FakeSpannerServer const&) = delete;
+
+  /// The address of the server, as `host:port`.
+  std::string const& endpoint() const { return endpoint_; }
+
+  /// Options for a `spanner::Connection` (or stub) using this server.
+  spanner::ConnectionOptions connection_options() const;
+
+  /**
+   * Runs a DDL @p statement.
+   *
+   * Only `CREATE TABLE` statements are supported.
+   */
+  Status ApplyDdl(std::string const& statement);
+
+ private:
+  FakeSpannerServer(std::unique_ptr<internal::FakeSpannerService> service,
+                    std::unique_ptr<grpc::Server> server, std::string endpoint);
+
+  std::unique_ptr<internal::FakeSpannerService> service_;
+  std::unique_ptr<grpc::Server> server_;
+  std::string endpoint_;
+};
+
+/**
+ * The options for the connections and stubs used by the benchmarks.
+ *
+ * When the benchmark uses a fake server these connect to
+ * `config.fake_server_endpoint` without credentials, otherwise they are the
+ * default options.
+ */
+spanner::ConnectionOptions MakeConnectionOptions(Config const& config);
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner_benchmarks
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_BENCHMARKS_FAKE_SPANNER_SERVER_H
@@ -0,0 +1,193 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/benchmarks/fake_spanner_server.h"
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner_benchmarks {
+inline namespace SPANNER_CLIENT_NS {
+namespace {
+
+using ::testing::ElementsAre;
+
+auto constexpr kCreateTable = R"sql(CREATE TABLE Singers (
+    SingerId INT64 NOT NULL,
+    Name STRING(MAX),
+    Score FLOAT64,
+  ) PRIMARY KEY (SingerId))sql";
+
+spanner::Database TestDatabase() {
+  return spanner::Database("fake-project", "fake-instance", "fake-database");
+}
+
+std::unique_ptr<FakeSpannerServer> StartServer(
+    FakeSpannerServerOptions options = {}) {
+  auto server = FakeSpannerServer::Create(std::move(options));
+  EXPECT_STATUS_OK(server);
+  if (!server) return nullptr;
+  EXPECT_STATUS_OK((*server)->ApplyDdl(kCreateTable));
+  return *std::move(server);
+}
+
+spanner::Client MakeClient(FakeSpannerServer const& server) {
+  return spanner::Client(
+      spanner::MakeConnection(TestDatabase(), server.connection_options()));
+}
+
+Status InsertSingers(spanner::Client& client, std::int64_t count,
+                     std::string const& name_suffix = {}) {
+  auto builder =
+      spanner::InsertMutationBuilder("Singers", {"SingerId", "Name", "Score"});
+  for (std::int64_t i = 0; i != count; ++i) {
+    builder.EmplaceRow(i, "singer-" + std::to_string(i) + name_suffix,
+                       static_cast<double>(i));
+  }
+  return client.Commit(spanner::Mutations{std::move(builder).Build()})
+      .status();
+}
+
+TEST(FakeSpannerServerTest, CommitAndRead) {
+  auto server = StartServer();
+  ASSERT_NE(nullptr, server);
+  auto client = MakeClient(*server);
+  ASSERT_STATUS_OK(InsertSingers(client, 10));
+
+  auto rows = client.Read(
+      "Singers",
+      spanner::KeySet().AddRange(spanner::MakeKeyBoundClosed(3),
+                                 spanner::MakeKeyBoundOpen(6)),
+      {"SingerId", "Name"});
+  std::vector<std::int64_t> ids;
+  for (auto& row : spanner::StreamOf<std::tuple<std::int64_t, std::string>>(
+           rows)) {
+    ASSERT_STATUS_OK(row);
+    EXPECT_EQ("singer-" + std::to_string(std::get<0>(*row)),
+              std::get<1>(*row));
+    ids.push_back(std::get<0>(*row));
+  }
+  EXPECT_THAT(ids, ElementsAre(3, 4, 5));
+
+  // Inserting an existing row fails, and the commit has no effect.
+  auto commit = client.Commit(spanner::Mutations{
+      spanner::MakeInsertMutation("Singers", {"SingerId"}, 100),
+      spanner::MakeInsertMutation("Singers", {"SingerId"}, 1)});
+  EXPECT_EQ(StatusCode::kAlreadyExists, commit.status().code());
+  rows = client.Read("Singers", spanner::KeySet::All(), {"SingerId"});
+  int count = 0;
+  for (auto& row : rows) {
+    ASSERT_STATUS_OK(row);
+    ++count;
+  }
+  EXPECT_EQ(10, count);
+}
+
+TEST(FakeSpannerServerTest, QueryAndDml) {
+  auto server = StartServer();
+  ASSERT_NE(nullptr, server);
+  auto client = MakeClient(*server);
+  ASSERT_STATUS_OK(InsertSingers(client, 100));
+
+  auto commit = client.Commit(
+      [&client](
+          spanner::Transaction const& txn) -> StatusOr<spanner::Mutations> {
+        auto result = client.ExecuteDml(
+            txn, spanner::SqlStatement(
+                     "UPDATE Singers SET Name = @name WHERE SingerId = @id",
+                     {{"name", spanner::Value("updated")},
+                      {"id", spanner::Value(42)}}));
+        if (!result) return std::move(result).status();
+        EXPECT_EQ(1, result->RowsModified());
+        return spanner::Mutations{};
+      });
+  ASSERT_STATUS_OK(commit);
+
+  auto rows = client.ExecuteQuery(spanner::SqlStatement(
+      "SELECT Name FROM Singers WHERE SingerId >= @begin AND SingerId < @end",
+      {{"begin", spanner::Value(40)}, {"end", spanner::Value(45)}}));
+  std::vector<std::string> names;
+  for (auto& row : spanner::StreamOf<std::tuple<std::string>>(rows)) {
+    ASSERT_STATUS_OK(row);
+    names.push_back(std::get<0>(*row));
+  }
+  EXPECT_THAT(names, ElementsAre("singer-40", "singer-41", "updated",
+                                 "singer-43", "singer-44"));
+}
+
+TEST(FakeSpannerServerTest, ChunkedAndResumedStreams) {
+  FakeSpannerServerOptions options;
+  options.values_per_response = 5;
+  options.max_chunk_size = 16;
+  options.interrupt_after_responses = 7;
+  auto server = StartServer(options);
+  ASSERT_NE(nullptr, server);
+  auto client = MakeClient(*server);
+  std::string const suffix(100, 'x');
+  ASSERT_STATUS_OK(InsertSingers(client, 50, suffix));
+
+  auto rows = client.ExecuteQuery(
+      spanner::SqlStatement("SELECT SingerId, Name, Score FROM Singers"));
+  std::int64_t expected = 0;
+  for (auto& row :
+       spanner::StreamOf<std::tuple<std::int64_t, std::string, double>>(
+           rows)) {
+    ASSERT_STATUS_OK(row);
+    EXPECT_EQ(expected, std::get<0>(*row));
+    EXPECT_EQ("singer-" + std::to_string(expected) + suffix,
+              std::get<1>(*row));
+    EXPECT_EQ(static_cast<double>(expected), std::get<2>(*row));
+    ++expected;
+  }
+  EXPECT_EQ(50, expected);
+}
+
+TEST(FakeSpannerServerTest, UnsupportedStatements) {
+  auto server = StartServer();
+  ASSERT_NE(nullptr, server);
+  EXPECT_EQ(StatusCode::kUnimplemented,
+            server->ApplyDdl("CREATE INDEX SingersByName ON Singers(Name)")
+                .code());
+  EXPECT_EQ(StatusCode::kAlreadyExists, server->ApplyDdl(kCreateTable).code());
+
+  auto client = MakeClient(*server);
+  auto rows = client.ExecuteQuery(
+      spanner::SqlStatement("SELECT COUNT(*) FROM Singers GROUP BY Name"));
+  auto row = rows.begin();
+  ASSERT_NE(rows.end(), row);
+  EXPECT_FALSE(row->ok());
+}
+
+TEST(FakeSpannerServerTest, MakeConnectionOptions) {
+  Config config;
+  config.use_fake_server = true;
+  config.fake_server_endpoint = "localhost:1234";
+  EXPECT_EQ("localhost:1234", MakeConnectionOptions(config).endpoint());
+
+  config.use_fake_server = false;
+  EXPECT_EQ(spanner::ConnectionOptions().endpoint(),
+            MakeConnectionOptions(config).endpoint());
+}
+
+}  // namespace
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner_benchmarks
+}  // namespace cloud
+}  // namespace google
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "google/cloud/spanner/benchmarks/benchmarks_config.h"
+#include "google/cloud/spanner/benchmarks/fake_spanner_server.h"
 #include "google/cloud/spanner/client.h"
 #include "google/cloud/spanner/database_admin_client.h"
 #include "google/cloud/spanner/internal/spanner_stub.h"
@@ -52,6 +53,8 @@ namespace {
 namespace spanner = ::google::cloud::spanner;
 using ::google::cloud::Status;
 using ::google::cloud::spanner_benchmarks::Config;
+using ::google::cloud::spanner_benchmarks::FakeSpannerServer;
+using ::google::cloud::spanner_benchmarks::MakeConnectionOptions;
 
 struct RowCpuSample {
   int client_count;
@@ -129,6 +132,20 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
+  // With --fake-server the experiments run against an in-process fake, and
+  // do not need a Cloud Spanner instance.
+  std::unique_ptr<FakeSpannerServer> fake_server;
+  if (config.use_fake_server) {
+    auto server = FakeSpannerServer::Create();
+    if (!server) {
+      std::cerr << "Error starting the fake server: " << server.status()
+                << "\n";
+      return 1;
+    }
+    fake_server = *std::move(server);
+    config.fake_server_endpoint = fake_server->endpoint();
+  }
+
   auto generator = google::cloud::internal::MakeDefaultPRNG();
   if (config.instance_id.empty()) {
     auto instance = google::cloud::spanner_testing::PickRandomInstance(
@@ -156,7 +173,6 @@ int main(int argc, char* argv[]) {
   // print everything out.
   std::cout << config << std::flush;
 
-  google::cloud::spanner::DatabaseAdminClient admin_client;
   std::vector<std::string> additional_statements = [&available, generator] {
     std::vector<std::string> statements;
     for (auto const& kv : available) {
@@ -167,19 +183,34 @@ int main(int argc, char* argv[]) {
     }
     return statements;
   }();
-  auto create_future =
-      admin_client.CreateDatabase(database, additional_statements);
-  std::cout << "# Waiting for database creation to complete " << std::flush;
-  for (;;) {
-    auto status = create_future.wait_for(std::chrono::seconds(1));
-    if (status == std::future_status::ready) break;
-    std::cout << '.' << std::flush;
+  if (fake_server) {
+    for (auto const& statement : additional_statements) {
+      auto status = fake_server->ApplyDdl(statement);
+      if (!status.ok()) {
+        std::cerr << "Error creating fake server table: " << status << "\n";
+        return 1;
+      }
+    }
+  }
+  std::unique_ptr<google::cloud::spanner::DatabaseAdminClient> admin_client;
+  google::cloud::StatusOr<google::spanner::admin::database::v1::Database> db;
+  if (!fake_server) {
+    admin_client =
+        absl::make_unique<google::cloud::spanner::DatabaseAdminClient>();
+    auto create_future =
+        admin_client->CreateDatabase(database, additional_statements);
+    std::cout << "# Waiting for database creation to complete " << std::flush;
+    for (;;) {
+      auto status = create_future.wait_for(std::chrono::seconds(1));
+      if (status == std::future_status::ready) break;
+      std::cout << '.' << std::flush;
+    }
+    std::cout << " DONE\n";
+    db = create_future.get();
   }
-  std::cout << " DONE\n";
 
   bool database_created = true;
-  auto db = create_future.get();
-  if (!db) {
+  if (!fake_server && !db) {
     if (user_specified_database &&
         db.status().code() == google::cloud::StatusCode::kAlreadyExists) {
       std::cout << "# Re-using existing database\n";
@@ -214,8 +245,8 @@ int main(int argc, char* argv[]) {
     }
   }
 
-  if (!user_specified_database) {
-    auto drop = admin_client.DropDatabase(database);
+  if (!user_specified_database && !fake_server) {
+    auto drop = admin_client->DropDatabase(database);
     if (!drop.ok()) {
       std::cerr << "# Error dropping database: " << drop << "\n";
     }
@@ -354,6 +385,41 @@ struct TimestampTraits {
   }
 };
 
+/**
+ * Consume @p rows as `RowType` tuples, returning the number of rows.
+ *
+ * If @p via_rows is true each `spanner::Row` is converted to a tuple, otherwise
+ * the rows are decoded directly using `spanner::StreamOf<RowType>()`. Comparing
+ * both shows the cost of the intermediate `spanner::Row` objects.
+ */
+template <typename RowType>
+int ConsumeRows(spanner::RowStream& rows, bool via_rows, Status& status) {
+  int row_count = 0;
+  if (via_rows) {
+    for (auto& row : rows) {
+      if (!row) {
+        status = std::move(row).status();
+        break;
+      }
+      auto tuple = std::move(*row).template get<RowType>();
+      if (!tuple) {
+        status = std::move(tuple).status();
+        break;
+      }
+      ++row_count;
+    }
+    return row_count;
+  }
+  for (auto& row : spanner::StreamOf<RowType>(rows)) {
+    if (!row) {
+      status = std::move(row).status();
+      break;
+    }
+    ++row_count;
+  }
+  return row_count;
+}
+
 template <typename Traits>
 class ExperimentImpl {
  public:
@@ -376,7 +442,8 @@ class ExperimentImpl {
   Status FillTable(Config const& config, spanner::Database const& database,
                    std::string const& table_name) {
     // We need to populate some data or all the requests to read will fail.
-    spanner::Client client(spanner::MakeConnection(database));
+    spanner::Client client(
+        spanner::MakeConnection(database, MakeConnectionOptions(config)));
     std::cout << "# Populating database " << std::flush;
     int const task_count = 16;
     std::vector<std::future<void>> tasks(task_count);
@@ -476,7 +543,7 @@ class ExperimentImpl {
     std::vector<std::shared_ptr<spanner::internal::SpannerStub>> stubs;
     std::cout << "# Creating clients and stubs " << std::flush;
     for (int i = 0; i != config.maximum_clients; ++i) {
-      auto options = spanner::ConnectionOptions().set_channel_pool_domain(
+      auto options = MakeConnectionOptions(config).set_channel_pool_domain(
           "task:" + std::to_string(i));
       clients.emplace_back(
           spanner::Client(spanner::MakeConnection(database, options)));
@@ -572,9 +639,12 @@ class ExperimentImpl {
 template <typename Traits>
 class ReadExperiment : public Experiment {
  public:
-  explicit ReadExperiment(google::cloud::internal::DefaultPRNG generator)
+  explicit ReadExperiment(google::cloud::internal::DefaultPRNG generator,
+                          bool via_rows = false)
       : impl_(generator),
-        table_name_("ReadExperiment_" + Traits::TableSuffix()) {}
+        table_name_("ReadExperiment_" + std::string(via_rows ? "row_" : "") +
+                    Traits::TableSuffix()),
+        via_rows_(via_rows) {}
 
   std::string AdditionalDdlStatement() override {
     return impl_.CreateTableStatement(table_name_);
@@ -758,15 +828,8 @@ class ReadExperiment : public Experiment {
       SimpleTimer timer;
       timer.Start();
       auto rows = client.Read(table_name_, key, column_names);
-      int row_count = 0;
       Status status;
-      for (auto& row : spanner::StreamOf<RowType>(rows)) {
-        if (!row) {
-          status = std::move(row).status();
-          break;
-        }
-        ++row_count;
-      }
+      int row_count = ConsumeRows<RowType>(rows, via_rows_, status);
       timer.Stop();
       samples.push_back(RowCpuSample{client_count, thread_count, false,
                                      row_count, timer.elapsed_time(),
@@ -777,6 +840,7 @@ class ReadExperiment : public Experiment {
 
   ExperimentImpl<Traits> impl_;
   std::string table_name_;
+  bool via_rows_;
 };
 
 /**
@@ -794,9 +858,13 @@ class ReadExperiment : public Experiment {
 template <typename Traits>
 class SelectExperiment : public Experiment {
  public:
-  explicit SelectExperiment(google::cloud::internal::DefaultPRNG generator)
+  explicit SelectExperiment(google::cloud::internal::DefaultPRNG generator,
+                            bool via_rows = false)
       : impl_(generator),
-        table_name_("SelectExperiment_" + Traits::TableSuffix()) {}
+        table_name_("SelectExperiment_" +
+                    std::string(via_rows ? "row_" : "") +
+                    Traits::TableSuffix()),
+        via_rows_(via_rows) {}
 
   std::string AdditionalDdlStatement() override {
     return impl_.CreateTableStatement(table_name_);
@@ -982,15 +1050,8 @@ class SelectExperiment : public Experiment {
       auto rows = client.ExecuteQuery(spanner::SqlStatement(
           statement, {{"begin", spanner::Value(key)},
                       {"end", spanner::Value(key + config.query_size)}}));
-      int row_count = 0;
       Status status;
-      for (auto& row : spanner::StreamOf<RowType>(rows)) {
-        if (!row) {
-          status = std::move(row).status();
-          break;
-        }
-        ++row_count;
-      }
+      int row_count = ConsumeRows<RowType>(rows, via_rows_, status);
       timer.Stop();
       samples.push_back(RowCpuSample{client_count, thread_count, false,
                                      row_count, timer.elapsed_time(),
@@ -1015,6 +1076,7 @@ class SelectExperiment : public Experiment {
 
   ExperimentImpl<Traits> impl_;
   std::string table_name_;
+  bool via_rows_;
 };
 
 /**
@@ -1589,15 +1651,19 @@ class RunAllExperiment : public Experiment {
 };
 
 template <typename Trait>
-ExperimentFactory MakeReadFactory() {
+ExperimentFactory MakeReadFactory(bool via_rows = false) {
   using G = ::google::cloud::internal::DefaultPRNG;
-  return [](G g) { return absl::make_unique<ReadExperiment<Trait>>(g); };
+  return [via_rows](G g) {
+    return absl::make_unique<ReadExperiment<Trait>>(g, via_rows);
+  };
 }
 
 template <typename Trait>
-ExperimentFactory MakeSelectFactory() {
+ExperimentFactory MakeSelectFactory(bool via_rows = false) {
   using G = ::google::cloud::internal::DefaultPRNG;
-  return [](G g) { return absl::make_unique<SelectExperiment<Trait>>(g); };
+  return [via_rows](G g) {
+    return absl::make_unique<SelectExperiment<Trait>>(g, via_rows);
+  };
 }
 
 template <typename Trait>
@@ -1626,6 +1692,13 @@ std::map<std::string, ExperimentFactory> AvailableExperiments() {
       {"read-int64", MakeReadFactory<Int64Traits>()},
       {"read-string", MakeReadFactory<StringTraits>()},
       {"read-timestamp", MakeReadFactory<TimestampTraits>()},
+      {"read-row-bool", MakeReadFactory<BoolTraits>(true)},
+      {"read-row-bytes", MakeReadFactory<BytesTraits>(true)},
+      {"read-row-date", MakeReadFactory<DateTraits>(true)},
+      {"read-row-float64", MakeReadFactory<Float64Traits>(true)},
+      {"read-row-int64", MakeReadFactory<Int64Traits>(true)},
+      {"read-row-string", MakeReadFactory<StringTraits>(true)},
+      {"read-row-timestamp", MakeReadFactory<TimestampTraits>(true)},
       {"select-bool", MakeSelectFactory<BoolTraits>()},
       {"select-bytes", MakeSelectFactory<BytesTraits>()},
       {"select-date", MakeSelectFactory<DateTraits>()},
@@ -1633,6 +1706,13 @@ std::map<std::string, ExperimentFactory> AvailableExperiments() {
       {"select-int64", MakeSelectFactory<Int64Traits>()},
       {"select-string", MakeSelectFactory<StringTraits>()},
       {"select-timestamp", MakeSelectFactory<TimestampTraits>()},
+      {"select-row-bool", MakeSelectFactory<BoolTraits>(true)},
+      {"select-row-bytes", MakeSelectFactory<BytesTraits>(true)},
+      {"select-row-date", MakeSelectFactory<DateTraits>(true)},
+      {"select-row-float64", MakeSelectFactory<Float64Traits>(true)},
+      {"select-row-int64", MakeSelectFactory<Int64Traits>(true)},
+      {"select-row-string", MakeSelectFactory<StringTraits>(true)},
+      {"select-row-timestamp", MakeSelectFactory<TimestampTraits>(true)},
       {"update-bool", MakeUpdateFactory<BoolTraits>()},
       {"update-bytes", MakeUpdateFactory<BytesTraits>()},
       {"update-date", MakeUpdateFactory<DateTraits>()},
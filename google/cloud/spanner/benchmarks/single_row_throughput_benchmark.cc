@@ -13,12 +13,14 @@
 // limitations under the License.
 
 #include "google/cloud/spanner/benchmarks/benchmarks_config.h"
+#include "google/cloud/spanner/benchmarks/fake_spanner_server.h"
 #include "google/cloud/spanner/client.h"
 #include "google/cloud/spanner/database_admin_client.h"
 #include "google/cloud/spanner/testing/pick_random_instance.h"
 #include "google/cloud/spanner/testing/random_database_name.h"
 #include "google/cloud/internal/getenv.h"
 #include "google/cloud/internal/random.h"
+#include "absl/memory/memory.h"
 #include <algorithm>
 #include <future>
 #include <random>
@@ -29,6 +31,8 @@ namespace {
 
 namespace spanner = ::google::cloud::spanner;
 using ::google::cloud::spanner_benchmarks::Config;
+using ::google::cloud::spanner_benchmarks::FakeSpannerServer;
+using ::google::cloud::spanner_benchmarks::MakeConnectionOptions;
 
 struct SingleRowThroughputSample {
   int client_count;
@@ -69,6 +73,20 @@ int main(int argc, char* argv[]) {
     config = *std::move(c);
   }
 
+  // With --fake-server the experiments run against an in-process fake, and
+  // do not need a Cloud Spanner instance.
+  std::unique_ptr<FakeSpannerServer> fake_server;
+  if (config.use_fake_server) {
+    auto server = FakeSpannerServer::Create();
+    if (!server) {
+      std::cerr << "Error starting the fake server: " << server.status()
+                << "\n";
+      return 1;
+    }
+    fake_server = *std::move(server);
+    config.fake_server_endpoint = fake_server->endpoint();
+  }
+
   auto generator = google::cloud::internal::MakeDefaultPRNG();
   if (config.instance_id.empty()) {
     auto instance = google::cloud::spanner_testing::PickRandomInstance(
@@ -98,23 +116,35 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
-  google::cloud::spanner::DatabaseAdminClient admin_client;
-  auto create_future =
-      admin_client.CreateDatabase(database, {R"sql(CREATE TABLE KeyValue (
+  auto const create_table = R"sql(CREATE TABLE KeyValue (
                                 Key   INT64 NOT NULL,
                                 Data  STRING(1024),
-                             ) PRIMARY KEY (Key))sql"});
-  std::cout << "# Waiting for database creation to complete " << std::flush;
-  for (;;) {
-    auto status = create_future.wait_for(std::chrono::seconds(1));
-    if (status == std::future_status::ready) break;
-    std::cout << '.' << std::flush;
+                             ) PRIMARY KEY (Key))sql";
+  std::unique_ptr<google::cloud::spanner::DatabaseAdminClient> admin_client;
+  google::cloud::StatusOr<google::spanner::admin::database::v1::Database> db;
+  if (fake_server) {
+    auto status = fake_server->ApplyDdl(create_table);
+    if (!status.ok()) {
+      std::cerr << "Error creating fake server table: " << status << "\n";
+      return 1;
+    }
+  } else {
+    admin_client =
+        absl::make_unique<google::cloud::spanner::DatabaseAdminClient>();
+    auto create_future =
+        admin_client->CreateDatabase(database, {create_table});
+    std::cout << "# Waiting for database creation to complete " << std::flush;
+    for (;;) {
+      auto status = create_future.wait_for(std::chrono::seconds(1));
+      if (status == std::future_status::ready) break;
+      std::cout << '.' << std::flush;
+    }
+    std::cout << " DONE\n";
+    db = create_future.get();
   }
-  std::cout << " DONE\n";
 
   bool database_created = true;
-  auto db = create_future.get();
-  if (!db) {
+  if (!fake_server && !db) {
     if (user_specified_database &&
         db.status().code() == google::cloud::StatusCode::kAlreadyExists) {
       std::cout << "# Re-using existing database\n";
@@ -146,8 +176,8 @@ int main(int argc, char* argv[]) {
   }
   experiment->Run(config, database, cout_sink);
 
-  if (!user_specified_database) {
-    auto drop = admin_client.DropDatabase(database);
+  if (!user_specified_database && !fake_server) {
+    auto drop = admin_client->DropDatabase(database);
     if (!drop.ok()) {
       std::cerr << "# Error dropping database: " << drop << "\n";
     }
@@ -208,7 +238,8 @@ void FillTableTask(Config const& config, spanner::Client client, std::mutex& mu,
 void FillTable(Config const& config, spanner::Database const& database,
                std::mutex& mu, std::string const& value) {
   // We need to populate some data or all the requests to read will fail.
-  spanner::Client client(spanner::MakeConnection(database));
+  spanner::Client client(
+      spanner::MakeConnection(database, MakeConnectionOptions(config)));
   std::cout << "# Populating database " << std::flush;
   int const task_count = 16;
   std::vector<std::future<void>> tasks(task_count);
@@ -234,7 +265,7 @@ spanner::Client MakeClient(Config const& config, int num_channels,
             << std::flush;
 
   auto connection = spanner::MakeConnection(
-      database, spanner::ConnectionOptions().set_num_channels(num_channels),
+      database, MakeConnectionOptions(config).set_num_channels(num_channels),
       // This pre-creates all the Sessions we will need (one per thread).
       spanner::SessionPoolOptions().set_min_sessions(config.maximum_threads));
   return spanner::Client(std::move(connection));
@@ -18,8 +18,10 @@
 
 spanner_client_benchmarks_hdrs = [
     "benchmarks_config.h",
+    "fake_spanner_server.h",
 ]
 
 spanner_client_benchmarks_srcs = [
     "benchmarks_config.cc",
+    "fake_spanner_server.cc",
 ]
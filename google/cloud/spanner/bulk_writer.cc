@@ -0,0 +1,329 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/bulk_writer.h"
+#include <algorithm>
+#include <sstream>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+namespace spanner_proto = ::google::spanner::v1;
+
+namespace {
+
+// Cloud Spanner doesn't accept more than this in a single commit.
+auto constexpr kSpannerMutationLimit = 20000;
+auto constexpr kDefaultMaxCommits = 4;
+auto constexpr kDefaultMaxOutstandingMutations =
+    kSpannerMutationLimit * kDefaultMaxCommits * 2;
+
+spanner_proto::Mutation::Write* MutableWrite(spanner_proto::Mutation& m) {
+  switch (m.operation_case()) {
+    case spanner_proto::Mutation::kInsert:
+      return m.mutable_insert();
+    case spanner_proto::Mutation::kUpdate:
+      return m.mutable_update();
+    case spanner_proto::Mutation::kInsertOrUpdate:
+      return m.mutable_insert_or_update();
+    case spanner_proto::Mutation::kReplace:
+      return m.mutable_replace();
+    default:
+      return nullptr;
+  }
+}
+
+/**
+ * Move the elements of @p elements into new copies of @p prototype, at most
+ * @p max_per_part at a time. `mutable_field(m)` returns the repeated field of
+ * `m` that holds the elements.
+ */
+template <typename Elements, typename MutableField>
+void SplitElements(spanner_proto::Mutation const& prototype,
+                   Elements& elements, std::size_t max_per_part,
+                   std::size_t per_element, MutableField mutable_field,
+                   std::vector<Mutation>& parts,
+                   std::vector<std::size_t>& part_sizes) {
+  auto const size = static_cast<std::size_t>(elements.size());
+  for (std::size_t begin = 0; begin < size; begin += max_per_part) {
+    auto const end = (std::min)(size, begin + max_per_part);
+    auto part = prototype;
+    auto& field = mutable_field(part);
+    field.Reserve(static_cast<int>(end - begin));
+    for (auto i = begin; i != end; ++i) {
+      field.Add()->Swap(elements.Mutable(static_cast<int>(i)));
+    }
+    parts.push_back(internal::MakeMutation(std::move(part)));
+    part_sizes.push_back((end - begin) * per_element);
+  }
+}
+
+}  // namespace
+
+BulkWriter::Options::Options()
+    : max_mutations_per_commit(kSpannerMutationLimit),
+      max_commits(kDefaultMaxCommits),
+      max_outstanding_mutations(kDefaultMaxOutstandingMutations) {}
+
+BulkWriter::BulkWriter(Client client, Options options)
+    : client_(std::move(client)), options_(std::move(options)) {
+  auto const n = (std::max)(options_.max_commits, std::size_t{1});
+  for (std::size_t i = 0; i != n; ++i) {
+    threads_.emplace_back([this] { CommitLoop(); });
+  }
+}
+
+BulkWriter::~BulkWriter() {
+  AsyncWaitForNoPendingRequests().get();
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  for (auto& t : threads_) t.join();
+}
+
+std::pair<future<void>, future<Status>> BulkWriter::Apply(Mutation mut) {
+  PendingMutation pending;
+  auto res = std::make_pair(pending.admission_promise.get_future(),
+                            pending.completion_promise.get_future());
+  auto status = Split(std::move(mut), pending);
+  if (!status.ok()) {
+    pending.completion_promise.set_value(std::move(status));
+    // No need to consider no_more_pending_promises because this operation
+    // didn't lower the number of pending operations.
+    pending.admission_promise.set_value();
+    return res;
+  }
+
+  std::unique_lock<std::mutex> lk(mu_);
+  ++num_requests_pending_;
+  if (!pending_mutations_.empty() || !CanAdmit(pending)) {
+    pending_mutations_.push(std::move(pending));
+    return res;
+  }
+  std::vector<AdmissionPromise> admission_promises_to_satisfy;
+  admission_promises_to_satisfy.emplace_back(
+      std::move(pending.admission_promise));
+  Admit(std::move(pending));
+  FlushIfPossible();
+  SatisfyPromises(std::move(admission_promises_to_satisfy), lk);
+  return res;
+}
+
+future<void> BulkWriter::AsyncWaitForNoPendingRequests() {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (num_requests_pending_ == 0) {
+    return make_ready_future();
+  }
+  no_more_pending_promises_.emplace_back();
+  return no_more_pending_promises_.back().get_future();
+}
+
+Status BulkWriter::Split(Mutation mut, PendingMutation& pending) const {
+  auto proto = std::move(mut).as_proto();
+  auto const* write = MutableWrite(proto);
+  std::size_t per_element = 1;
+  std::size_t elements = 0;
+  if (write != nullptr) {
+    pending.table = write->table();
+    per_element = static_cast<std::size_t>(write->columns_size());
+    elements = static_cast<std::size_t>(write->values_size());
+  } else if (proto.has_delete_()) {
+    pending.table = proto.delete_().table();
+    auto const& ks = proto.delete_().key_set();
+    elements = ks.all() ? 1
+                        : static_cast<std::size_t>(ks.keys_size()) +
+                              static_cast<std::size_t>(ks.ranges_size());
+  }
+  auto const index_count = options_.index_counts.find(pending.table);
+  if (index_count != options_.index_counts.end()) {
+    per_element *= 1 + index_count->second;
+  }
+  if (elements == 0 || per_element == 0) {
+    return Status(StatusCode::kInvalidArgument,
+                  "Supplied Mutation has no entries");
+  }
+  if (per_element > options_.max_mutations_per_commit) {
+    std::stringstream stream;
+    stream << "Too many (" << per_element
+           << ") mutations in a single row of a Mutation. "
+           << options_.max_mutations_per_commit << " is the limit.";
+    return Status(StatusCode::kInvalidArgument, stream.str());
+  }
+  pending.num_mutations = per_element * elements;
+
+  auto const max_per_part = options_.max_mutations_per_commit / per_element;
+  if (elements <= max_per_part) {
+    pending.parts.push_back(internal::MakeMutation(std::move(proto)));
+    pending.part_sizes.push_back(pending.num_mutations);
+    return Status();
+  }
+  if (write != nullptr) {
+    google::protobuf::RepeatedPtrField<google::protobuf::ListValue> values;
+    values.Swap(MutableWrite(proto)->mutable_values());
+    SplitElements(
+        proto, values, max_per_part, per_element,
+        [](spanner_proto::Mutation& m) -> decltype(values)& {
+          return *MutableWrite(m)->mutable_values();
+        },
+        pending.parts, pending.part_sizes);
+    return Status();
+  }
+  // Split the keys and the ranges of the delete separately.
+  auto& ks = *proto.mutable_delete_()->mutable_key_set();
+  google::protobuf::RepeatedPtrField<google::protobuf::ListValue> keys;
+  keys.Swap(ks.mutable_keys());
+  google::protobuf::RepeatedPtrField<spanner_proto::KeyRange> ranges;
+  ranges.Swap(ks.mutable_ranges());
+  SplitElements(
+      proto, keys, max_per_part, per_element,
+      [](spanner_proto::Mutation& m) -> decltype(keys)& {
+        return *m.mutable_delete_()->mutable_key_set()->mutable_keys();
+      },
+      pending.parts, pending.part_sizes);
+  SplitElements(
+      proto, ranges, max_per_part, per_element,
+      [](spanner_proto::Mutation& m) -> decltype(ranges)& {
+        return *m.mutable_delete_()->mutable_key_set()->mutable_ranges();
+      },
+      pending.parts, pending.part_sizes);
+  return Status();
+}
+
+bool BulkWriter::CanAdmit(PendingMutation const& mut) const {
+  // Always admit something if nothing is outstanding, otherwise a mutation
+  // larger than `max_outstanding_mutations` would never be admitted.
+  return outstanding_mutations_ == 0 ||
+         outstanding_mutations_ + mut.num_mutations <=
+             options_.max_outstanding_mutations;
+}
+
+void BulkWriter::Admit(PendingMutation mut) {
+  outstanding_mutations_ += mut.num_mutations;
+  auto data = std::make_shared<MutationData>();
+  data->completion_promise = std::move(mut.completion_promise);
+  data->remaining_parts = mut.parts.size();
+  for (std::size_t i = 0; i != mut.parts.size(); ++i) {
+    auto size = mut.part_sizes[i];
+    auto* batch = &cur_batches_[mut.table];
+    if (batch->num_mutations + size > options_.max_mutations_per_commit) {
+      // Do not exceed `max_commits`, the full batch waits for a commit slot.
+      full_batches_.push_back(std::move(*batch));
+      *batch = Batch{};
+    }
+    batch->num_mutations += size;
+    batch->mutations.push_back(std::move(mut.parts[i]));
+    batch->mutation_data.push_back(data);
+  }
+}
+
+void BulkWriter::FlushIfPossible() {
+  auto const max_commits = (std::max)(options_.max_commits, std::size_t{1});
+  while (num_outstanding_commits_ < max_commits) {
+    if (!full_batches_.empty()) {
+      Flush(std::move(full_batches_.front()));
+      full_batches_.pop_front();
+      continue;
+    }
+    if (cur_batches_.empty()) return;
+    auto i = cur_batches_.begin();
+    Flush(std::move(i->second));
+    cur_batches_.erase(i);
+  }
+}
+
+void BulkWriter::Flush(Batch batch) {
+  ++num_outstanding_commits_;
+  ready_batches_.push_back(std::move(batch));
+  cv_.notify_one();
+}
+
+void BulkWriter::CommitLoop() {
+  for (;;) {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait(lk, [this] { return shutdown_ || !ready_batches_.empty(); });
+    if (ready_batches_.empty()) return;
+    auto batch = std::move(ready_batches_.front());
+    ready_batches_.pop_front();
+    lk.unlock();
+
+    // The client already retries transient failures, using the policies of
+    // its connection. Retrying here would multiply the attempts, and could
+    // resend a commit that was applied but whose response was lost.
+    auto result = client_.Commit(batch.mutations);
+    auto const status = result ? Status() : std::move(result).status();
+
+    lk.lock();
+    OnCommitDone(std::move(batch), status, lk);
+  }
+}
+
+void BulkWriter::OnCommitDone(Batch batch, Status const& status,
+                              std::unique_lock<std::mutex>& lk) {
+  std::vector<std::shared_ptr<MutationData>> completed;
+  for (auto& data : batch.mutation_data) {
+    if (!status.ok() && data->status.ok()) data->status = status;
+    if (--data->remaining_parts == 0) completed.push_back(std::move(data));
+  }
+  outstanding_mutations_ -= batch.num_mutations;
+  --num_outstanding_commits_;
+  num_requests_pending_ -= completed.size();
+  // Release the memory before admitting more mutations.
+  batch = Batch{};
+
+  auto admission_promises = TryAdmit();
+  FlushIfPossible();
+  SatisfyPromises(std::move(admission_promises), lk);
+  for (auto& data : completed) {
+    data->completion_promise.set_value(std::move(data->status));
+  }
+}
+
+std::vector<BulkWriter::AdmissionPromise> BulkWriter::TryAdmit() {
+  std::vector<AdmissionPromise> admission_promises;
+  while (!pending_mutations_.empty() && CanAdmit(pending_mutations_.front())) {
+    auto& mut = pending_mutations_.front();
+    admission_promises.emplace_back(std::move(mut.admission_promise));
+    Admit(std::move(mut));
+    pending_mutations_.pop();
+  }
+  return admission_promises;
+}
+
+void BulkWriter::SatisfyPromises(
+    std::vector<AdmissionPromise> admission_promises,
+    std::unique_lock<std::mutex>& lk) {
+  std::vector<NoMorePendingPromise> no_more_pending_promises;
+  if (num_requests_pending_ == 0) {
+    no_more_pending_promises.swap(no_more_pending_promises_);
+  }
+  lk.unlock();
+
+  // Inform the user that we've admitted these mutations and there might be
+  // some space in the buffer finally.
+  for (auto& promise : admission_promises) {
+    promise.set_value();
+  }
+  for (auto& promise : no_more_pending_promises) {
+    promise.set_value();
+  }
+}
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,268 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_BULK_WRITER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_BULK_WRITER_H
+
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/spanner/mutations.h"
+#include "google/cloud/spanner/version.h"
+#include "google/cloud/future.h"
+#include "google/cloud/status.h"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+/**
+ * Objects of this class pack mutations into concurrent commits.
+ *
+ * `Client::Commit()` sends all its mutations in a single commit, which fails
+ * if the mutations exceed the [per-commit limit][spanner-limits]. Create a
+ * `BulkWriter` and use `BulkWriter::Apply()` to apply a large stream of
+ * mutations instead. Objects of this class split large mutations, group the
+ * mutations of each table into commits that stay under the limit, and run
+ * several commits concurrently.
+ *
+ * The number of mutations in a commit is counted the way the service counts
+ * them: the number of cells (columns times rows) written by each insert or
+ * update, and one per key or range of each delete, multiplied by one plus the
+ * number of secondary indexes on the table (see `Options::SetIndexCount()`).
+ *
+ * Each commit is independent, and they run concurrently, so there are no
+ * ordering or atomicity guarantees between mutations applied through a
+ * `BulkWriter`. Applications should not apply more than one mutation to the
+ * same row without waiting for the first one to complete.
+ *
+ * This class also offers an easy-to-use flow control mechanism to avoid
+ * unbounded growth in its internal buffers.
+ *
+ * The API is modeled on `bigtable::MutationBatcher`.
+ *
+ * [spanner-limits]: https://cloud.google.com/spanner/quotas#limits_for_creating_reading_updating_and_deleting_data
+ */
+class BulkWriter {
+ public:
+  /// Configuration for `BulkWriter`.
+  struct Options {
+    Options();
+
+    /// A single commit will not have more mutations than this.
+    Options& SetMaxMutationsPerCommit(
+        std::size_t max_mutations_per_commit_arg) {
+      max_mutations_per_commit = max_mutations_per_commit_arg;
+      return *this;
+    }
+
+    /// There will be no more commits outstanding than this.
+    Options& SetMaxCommits(std::size_t max_commits_arg) {
+      max_commits = max_commits_arg;
+      return *this;
+    }
+
+    /// BulkWriter will at most admit this many (uncommitted) mutations.
+    Options& SetMaxOutstandingMutations(
+        std::size_t max_outstanding_mutations_arg) {
+      max_outstanding_mutations = max_outstanding_mutations_arg;
+      return *this;
+    }
+
+    /// The number of secondary indexes on @p table, 0 if not set.
+    Options& SetIndexCount(std::string table, std::size_t index_count) {
+      index_counts[std::move(table)] = index_count;
+      return *this;
+    }
+
+    std::size_t max_mutations_per_commit;
+    std::size_t max_commits;
+    std::size_t max_outstanding_mutations;
+    std::map<std::string, std::size_t> index_counts;
+  };
+
+  explicit BulkWriter(Client client, Options options = Options());
+
+  /// Waits until all the applied mutations complete.
+  ~BulkWriter();
+
+  BulkWriter(BulkWriter const&) = delete;
+  BulkWriter& operator=(BulkWriter const&) = delete;
+
+  /**
+   * Apply a mutation.
+   *
+   * The mutation will most likely be committed together with others to
+   * optimize for throughput. A mutation with more rows (or keys) than fit in a
+   * commit is split, and its parts may be committed separately.
+   *
+   * @param mut the mutation.
+   *
+   * @return *admission* and *completion* futures
+   *
+   * The *completion* future will report the mutation's status once all its
+   * parts are committed. Each commit is retried only by the `Client`, using the
+   * retry policies of its `Connection`. The writer never resends a failed
+   * commit, as a commit whose response was lost may have been applied.
+   *
+   * The *admission* future should be used for flow control. In order to bound
+   * the memory usage used by `BulkWriter`, one should not submit more
+   * mutations before the *admission* future is satisfied. Note that while the
+   * future is often already satisfied when the function returns, applications
+   * should not assume that this is always the case.
+   *
+   * @code
+   * spanner::BulkWriter writer(client);
+   * while (HasMoreMutations()) {
+   *   auto admission_completion = writer.Apply(GenerateMutation());
+   *   admission_completion.second.then([](future<Status> f) {
+   *     // handle mutation completion asynchronously
+   *   });
+   *   admission_completion.first.get();
+   * }
+   * writer.AsyncWaitForNoPendingRequests().get();
+   * @endcode
+   */
+  std::pair<future<void>, future<Status>> Apply(Mutation mut);
+
+  /**
+   * Asynchronously wait until all applied mutations complete.
+   *
+   * @return a future which will be satisfied once all mutations applied
+   *     before calling this function finish; if there are no such operations,
+   *     the returned future is already satisfied.
+   */
+  future<void> AsyncWaitForNoPendingRequests();
+
+ private:
+  using CompletionPromise = promise<Status>;
+  using AdmissionPromise = promise<void>;
+  using NoMorePendingPromise = promise<void>;
+
+  /**
+   * The completion state of an applied mutation, shared by its parts.
+   */
+  struct MutationData {
+    CompletionPromise completion_promise;
+    std::size_t remaining_parts = 0;
+    Status status;
+  };
+
+  /**
+   * This structure represents a single mutation before it is admitted.
+   */
+  struct PendingMutation {
+    std::string table;
+    std::vector<Mutation> parts;
+    std::vector<std::size_t> part_sizes;  // in mutations, as counted above
+    std::size_t num_mutations = 0;
+    CompletionPromise completion_promise;
+    AdmissionPromise admission_promise;
+  };
+
+  /**
+   * This class represents a single group of mutations sent in one commit.
+   */
+  struct Batch {
+    std::size_t num_mutations = 0;
+    Mutations mutations;
+    std::vector<std::shared_ptr<MutationData>> mutation_data;
+  };
+
+  /// Split @p mut into parts that fit in a commit.
+  Status Split(Mutation mut, PendingMutation& pending) const;
+
+  /// Check if a pending mutation can be admitted.
+  bool CanAdmit(PendingMutation const& mut) const;
+
+  /// Append the parts of @p mut to the currently constructed batches.
+  void Admit(PendingMutation mut);
+
+  /**
+   * Send currently constructed batches if there are not too many outstanding
+   * commits already.
+   */
+  void FlushIfPossible();
+
+  /// Move @p batch to the commit queue.
+  void Flush(Batch batch);
+
+  /// Commit batches until shutdown, running on each of `threads_`.
+  void CommitLoop();
+
+  /// Handle a completed batch. Unlocks `lk`.
+  void OnCommitDone(Batch batch, Status const& status,
+                    std::unique_lock<std::mutex>& lk);
+
+  /**
+   * Try to move mutations waiting in `pending_mutations_` to the currently
+   * constructed batches.
+   *
+   * @return the admission promises of the newly admitted mutations.
+   */
+  std::vector<AdmissionPromise> TryAdmit();
+
+  /**
+   * Satisfies passed admission promises and potentially the promises of no more
+   * pending requests. Unlocks `lk`.
+   */
+  void SatisfyPromises(std::vector<AdmissionPromise>,
+                       std::unique_lock<std::mutex>& lk);
+
+  Client client_;
+  Options const options_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  bool shutdown_ = false;
+
+  /// Num batches sent (or queued to be sent) but not completed.
+  std::size_t num_outstanding_commits_ = 0;
+  /// Number of admitted but uncompleted mutations.
+  std::size_t outstanding_mutations_ = 0;
+  /// Number of uncompleted mutations (including not admitted).
+  std::size_t num_requests_pending_ = 0;
+
+  /// Currently constructed batches, by table.
+  std::map<std::string, Batch> cur_batches_;
+  /// Batches that cannot grow any more, waiting for a commit slot.
+  std::deque<Batch> full_batches_;
+  /// Batches waiting for a thread to commit them.
+  std::deque<Batch> ready_batches_;
+
+  /// The mutations which have not been admitted yet.
+  std::queue<PendingMutation> pending_mutations_;
+
+  /// Promises satisfied by `AsyncWaitForNoPendingRequests()`.
+  std::vector<NoMorePendingPromise> no_more_pending_promises_;
+
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_BULK_WRITER_H
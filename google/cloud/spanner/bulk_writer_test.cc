@@ -0,0 +1,243 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/bulk_writer.h"
+#include "google/cloud/spanner/mocks/mock_spanner_connection.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace {
+
+using ::google::cloud::spanner_mocks::MockConnection;
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::Invoke;
+using ::testing::Return;
+
+/// Records the mutations of each commit.
+class CommitRecorder {
+ public:
+  StatusOr<CommitResult> operator()(Connection::CommitParams const& p) {
+    std::lock_guard<std::mutex> lk(mu_);
+    commits_.push_back(p.mutations);
+    return CommitResult{};
+  }
+
+  std::vector<Mutations> commits() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return commits_;
+  }
+
+ private:
+  std::mutex mu_;
+  std::vector<Mutations> commits_;
+};
+
+/// The number of rows, and of keys and ranges, in each mutation of @p m.
+std::vector<int> Elements(Mutations const& m) {
+  std::vector<int> elements;
+  for (auto const& mut : m) {
+    auto p = mut.as_proto();
+    if (p.has_delete_()) {
+      elements.push_back(p.delete_().key_set().keys_size() +
+                         p.delete_().key_set().ranges_size());
+    } else {
+      elements.push_back(p.insert().values_size());
+    }
+  }
+  return elements;
+}
+
+Mutation MakeInsert(std::string table, std::int64_t first, int rows) {
+  InsertMutationBuilder builder(std::move(table), {"Id", "Name"});
+  for (int i = 0; i != rows; ++i) {
+    builder.EmplaceRow(first + i, "name-" + std::to_string(first + i));
+  }
+  return std::move(builder).Build();
+}
+
+TEST(BulkWriterTest, SplitLargeWrite) {
+  auto conn = std::make_shared<MockConnection>();
+  CommitRecorder recorder;
+  EXPECT_CALL(*conn, Commit(_)).WillRepeatedly(Invoke(std::ref(recorder)));
+
+  // Each row has 2 cells, so at most 5 rows fit in a commit.
+  BulkWriter writer(Client(conn), BulkWriter::Options()
+                                      .SetMaxMutationsPerCommit(10)
+                                      .SetMaxCommits(1));
+  auto res = writer.Apply(MakeInsert("T", 0, 12));
+  EXPECT_TRUE(res.first.is_ready());
+  EXPECT_STATUS_OK(res.second.get());
+  writer.AsyncWaitForNoPendingRequests().get();
+
+  std::vector<int> rows;
+  for (auto const& c : recorder.commits()) {
+    for (auto n : Elements(c)) rows.push_back(n);
+  }
+  EXPECT_THAT(rows, ElementsAre(5, 5, 2));
+}
+
+TEST(BulkWriterTest, IndexCount) {
+  auto conn = std::make_shared<MockConnection>();
+  CommitRecorder recorder;
+  EXPECT_CALL(*conn, Commit(_)).WillRepeatedly(Invoke(std::ref(recorder)));
+
+  // Each row has 2 cells, each written to the table and one index.
+  BulkWriter writer(Client(conn), BulkWriter::Options()
+                                      .SetMaxMutationsPerCommit(10)
+                                      .SetMaxCommits(1)
+                                      .SetIndexCount("T", 1));
+  EXPECT_STATUS_OK(writer.Apply(MakeInsert("T", 0, 5)).second.get());
+
+  std::vector<int> rows;
+  for (auto const& c : recorder.commits()) {
+    for (auto n : Elements(c)) rows.push_back(n);
+  }
+  EXPECT_THAT(rows, ElementsAre(2, 2, 1));
+}
+
+TEST(BulkWriterTest, SplitDelete) {
+  auto conn = std::make_shared<MockConnection>();
+  CommitRecorder recorder;
+  EXPECT_CALL(*conn, Commit(_)).WillRepeatedly(Invoke(std::ref(recorder)));
+
+  BulkWriter writer(Client(conn), BulkWriter::Options()
+                                      .SetMaxMutationsPerCommit(4)
+                                      .SetMaxCommits(1));
+  KeySet keys;
+  for (std::int64_t i = 0; i != 6; ++i) keys.AddKey(MakeKey(i));
+  keys.AddRange(MakeKeyBoundClosed(100), MakeKeyBoundOpen(200));
+  EXPECT_STATUS_OK(
+      writer.Apply(MakeDeleteMutation("T", std::move(keys))).second.get());
+
+  std::vector<int> elements;
+  for (auto const& c : recorder.commits()) {
+    for (auto n : Elements(c)) elements.push_back(n);
+  }
+  EXPECT_THAT(elements, ElementsAre(4, 2, 1));
+}
+
+TEST(BulkWriterTest, CommitsDoNotMixTables) {
+  auto conn = std::make_shared<MockConnection>();
+  CommitRecorder recorder;
+  EXPECT_CALL(*conn, Commit(_)).WillRepeatedly(Invoke(std::ref(recorder)));
+
+  std::vector<future<Status>> completions;
+  {
+    BulkWriter writer(Client(conn), BulkWriter::Options()
+                                        .SetMaxMutationsPerCommit(100)
+                                        .SetMaxCommits(2));
+    for (int i = 0; i != 20; ++i) {
+      auto table = i % 2 == 0 ? "A" : "B";
+      completions.push_back(writer.Apply(MakeInsert(table, i, 1)).second);
+    }
+    // The destructor waits for all the mutations.
+  }
+  for (auto& c : completions) EXPECT_STATUS_OK(c.get());
+
+  int rows = 0;
+  for (auto const& c : recorder.commits()) {
+    ASSERT_FALSE(c.empty());
+    auto const table = c.front().as_proto().insert().table();
+    for (auto const& m : c) {
+      EXPECT_EQ(table, m.as_proto().insert().table());
+      rows += m.as_proto().insert().values_size();
+    }
+  }
+  EXPECT_EQ(20, rows);
+}
+
+TEST(BulkWriterTest, FailuresAreNotResent) {
+  // The connection retries transient failures; a failure that reaches the
+  // writer is final, as resending the commit could apply it twice.
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, Commit(_))
+      .WillOnce(Return(Status(StatusCode::kUnavailable, "try-again")));
+
+  BulkWriter writer{Client(conn)};
+  auto status = writer.Apply(MakeInsert("T", 0, 1)).second.get();
+  EXPECT_EQ(StatusCode::kUnavailable, status.code());
+}
+
+TEST(BulkWriterTest, PermanentFailure) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, Commit(_))
+      .WillOnce(Return(Status(StatusCode::kPermissionDenied, "uh-oh")));
+
+  BulkWriter writer{Client(conn)};
+  auto status = writer.Apply(MakeInsert("T", 0, 1)).second.get();
+  EXPECT_EQ(StatusCode::kPermissionDenied, status.code());
+}
+
+TEST(BulkWriterTest, InvalidMutations) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, Commit(_)).Times(0);
+
+  BulkWriter writer(Client(conn),
+                    BulkWriter::Options().SetMaxMutationsPerCommit(1));
+  auto res = writer.Apply(Mutation());
+  EXPECT_TRUE(res.first.is_ready());
+  EXPECT_EQ(StatusCode::kInvalidArgument, res.second.get().code());
+
+  // A single row has 2 cells, which do not fit in a commit.
+  res = writer.Apply(MakeInsert("T", 0, 1));
+  EXPECT_EQ(StatusCode::kInvalidArgument, res.second.get().code());
+}
+
+TEST(BulkWriterTest, FlowControl) {
+  auto conn = std::make_shared<MockConnection>();
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  EXPECT_CALL(*conn, Commit(_))
+      .WillRepeatedly(Invoke([released](Connection::CommitParams const&) {
+        released.wait();
+        return StatusOr<CommitResult>(CommitResult{});
+      }));
+
+  BulkWriter writer(Client(conn), BulkWriter::Options()
+                                      .SetMaxCommits(1)
+                                      .SetMaxOutstandingMutations(4));
+  // The first mutation is committed right away (and blocks), the second is
+  // admitted, and the third must wait for the first two.
+  auto r1 = writer.Apply(MakeInsert("T", 0, 1));
+  auto r2 = writer.Apply(MakeInsert("T", 1, 1));
+  auto r3 = writer.Apply(MakeInsert("T", 2, 1));
+  EXPECT_TRUE(r1.first.is_ready());
+  EXPECT_TRUE(r2.first.is_ready());
+  EXPECT_FALSE(r3.first.is_ready());
+  EXPECT_FALSE(r1.second.is_ready());
+
+  release.set_value();
+  r3.first.get();
+  EXPECT_STATUS_OK(r1.second.get());
+  EXPECT_STATUS_OK(r2.second.get());
+  EXPECT_STATUS_OK(r3.second.get());
+  writer.AsyncWaitForNoPendingRequests().get();
+}
+
+}  // namespace
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -141,6 +141,68 @@ void Bytes::Decoder::Iterator::Fill() {
   }
 }
 
+std::string Bytes::Encode(std::string const& octets) {
+  auto const* p = reinterpret_cast<unsigned char const*>(octets.data());
+  auto const* const ep = p + octets.size();
+  std::string rep((octets.size() + 2) / 3 * 4, kPadding);
+  auto* r = &rep[0];
+  for (; ep - p >= 3; p += 3) {
+    unsigned int const v = p[0] << 16 | p[1] << 8 | p[2];
+    *r++ = kIndexToChar[v >> 18];
+    *r++ = kIndexToChar[v >> 12 & 0x3f];
+    *r++ = kIndexToChar[v >> 6 & 0x3f];
+    *r++ = kIndexToChar[v & 0x3f];
+  }
+  switch (ep - p) {
+    case 2: {
+      unsigned int const v = p[0] << 16 | p[1] << 8;
+      *r++ = kIndexToChar[v >> 18];
+      *r++ = kIndexToChar[v >> 12 & 0x3f];
+      *r++ = kIndexToChar[v >> 6 & 0x3f];
+      break;
+    }
+    case 1: {
+      unsigned int const v = p[0] << 16;
+      *r++ = kIndexToChar[v >> 18];
+      *r++ = kIndexToChar[v >> 12 & 0x3f];
+      break;
+    }
+  }
+  return rep;
+}
+
+std::string Bytes::Decode(std::string const& rep) {
+  // `rep` is valid base64, so its size is a multiple of 4, and only the last
+  // group may contain padding.
+  std::size_t size = rep.size() / 4 * 3;
+  if (!rep.empty() && rep.back() == kPadding) {
+    size -= rep[rep.size() - 2] == kPadding ? 2 : 1;
+  }
+  std::string octets(size, '\0');
+  auto const* p = reinterpret_cast<unsigned char const*>(rep.data());
+  auto* o = reinterpret_cast<unsigned char*>(&octets[0]);
+  auto* const eo = o + size;
+  for (; eo - o >= 3; p += 4) {
+    unsigned int const v = (kCharToIndexExcessOne[p[0]] - 1) << 18 |
+                           (kCharToIndexExcessOne[p[1]] - 1) << 12 |
+                           (kCharToIndexExcessOne[p[2]] - 1) << 6 |
+                           (kCharToIndexExcessOne[p[3]] - 1);
+    *o++ = static_cast<unsigned char>(v >> 16);
+    *o++ = static_cast<unsigned char>(v >> 8);
+    *o++ = static_cast<unsigned char>(v);
+  }
+  if (o != eo) {
+    unsigned int v = (kCharToIndexExcessOne[p[0]] - 1) << 18 |
+                     (kCharToIndexExcessOne[p[1]] - 1) << 12;
+    *o++ = static_cast<unsigned char>(v >> 16);
+    if (o != eo) {
+      v |= (kCharToIndexExcessOne[p[2]] - 1) << 6;
+      *o++ = static_cast<unsigned char>(v >> 8);
+    }
+  }
+  return octets;
+}
+
 namespace internal {
 
 // Construction from a base64-encoded US-ASCII `std::string`.
@@ -60,6 +60,7 @@ class Bytes {
   }
   template <typename Container>
   explicit Bytes(Container const& c) : Bytes(std::begin(c), std::end(c)) {}
+  explicit Bytes(std::string const& s) : base64_rep_(Encode(s)) {}
   ///@}
 
   /// Conversion to a sequence of octets.  The `Container` must support
@@ -90,6 +91,13 @@ class Bytes {
   friend StatusOr<Bytes> internal::BytesFromBase64(std::string input);
   friend std::string internal::BytesToBase64(Bytes b);
 
+  // Whole-buffer equivalents of `Encoder` and `Decoder`, which are used for
+  // the common `std::string` conversions. They size the output once, and then
+  // translate each group of 3 octets / 4 base64 characters with a few table
+  // lookups and shifts.
+  static std::string Encode(std::string const& octets);
+  static std::string Decode(std::string const& rep);
+
   struct Encoder {
     explicit Encoder(std::string& rep) : rep_(rep), len_(0) {}
     void Flush();
@@ -154,6 +162,12 @@ class Bytes {
   std::string base64_rep_;  // valid base64 representation
 };
 
+// A faster specialization for the most common conversion.
+template <>
+inline std::string Bytes::get<std::string>() const {
+  return Decode(base64_rep_);
+}
+
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
 }  // namespace cloud
@@ -15,6 +15,7 @@
 #include "google/cloud/spanner/bytes.h"
 #include <benchmark/benchmark.h>
 #include <string>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -81,6 +82,34 @@ void BM_BytesGet(benchmark::State& state) {
 }
 BENCHMARK(BM_BytesGet);
 
+void BM_BytesCtorVector(benchmark::State& state) {
+  std::vector<unsigned char> const octets(kText.begin(), kText.end());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Bytes(octets));
+  }
+  state.SetBytesProcessed(state.iterations() * octets.size());
+}
+BENCHMARK(BM_BytesCtorVector);
+
+void BM_BytesGetVector(benchmark::State& state) {
+  Bytes b(kText);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(b.get<std::vector<unsigned char>>());
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          internal::BytesToBase64(b).size());
+}
+BENCHMARK(BM_BytesGetVector);
+
+void BM_BytesFromBase64(benchmark::State& state) {
+  auto const encoded = internal::BytesToBase64(Bytes(kText));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(internal::BytesFromBase64(encoded));
+  }
+  state.SetBytesProcessed(state.iterations() * encoded.size());
+}
+BENCHMARK(BM_BytesFromBase64);
+
 }  // namespace
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
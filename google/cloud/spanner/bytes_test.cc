@@ -118,6 +118,21 @@ TEST(Bytes, LongerRoundTrip) {
   }
 }
 
+TEST(Bytes, StringMatchesIterators) {
+  // `std::string` conversions use a faster, whole-buffer implementation.
+  // Verify that it agrees with the iterator-based one for all tail sizes.
+  std::string data;
+  for (int i = 0; i != 64; ++i) {
+    std::vector<unsigned char> octets(data.begin(), data.end());
+    Bytes from_string(data);
+    Bytes from_octets(octets);
+    EXPECT_EQ(from_octets, from_string);
+    EXPECT_EQ(data, from_string.get<std::string>());
+    EXPECT_EQ(octets, from_string.get<std::vector<unsigned char>>());
+    data.push_back(static_cast<char>(i * 37 + 11));
+  }
+}
+
 TEST(Bytes, RFC4648TestVectors) {
   // https://tools.ietf.org/html/rfc4648#section-10
   std::vector<std::pair<std::string, std::string>> test_cases = {
@@ -15,6 +15,7 @@
 #include "google/cloud/spanner/client.h"
 #include "google/cloud/spanner/backoff_policy.h"
 #include "google/cloud/spanner/internal/connection_impl.h"
+#include "google/cloud/spanner/internal/read_cache.h"
 #include "google/cloud/spanner/internal/retry_loop.h"
 #include "google/cloud/spanner/internal/spanner_stub.h"
 #include "google/cloud/spanner/internal/status_utils.h"
@@ -30,6 +31,11 @@ namespace cloud {
 namespace spanner {
 inline namespace SPANNER_CLIENT_NS {
 
+Client::Client(std::shared_ptr<Connection> conn, ClientOptions opts)
+    : conn_(std::move(conn)),
+      opts_(std::move(opts)),
+      read_cache_(internal::MakeReadCache(opts_.read_cache_options())) {}
+
 RowStream Client::Read(std::string table, KeySet keys,
                        std::vector<std::string> columns,
                        ReadOptions read_options) {
@@ -46,13 +52,17 @@ RowStream Client::Read(Transaction::SingleUseOptions transaction_options,
                        std::string table, KeySet keys,
                        std::vector<std::string> columns,
                        ReadOptions read_options) {
-  return conn_->Read(
-      {internal::MakeSingleUseTransaction(std::move(transaction_options)),
-       std::move(table),
-       std::move(keys),
-       std::move(columns),
-       std::move(read_options),
-       {}});
+  Connection::ReadParams params{
+      internal::MakeSingleUseTransaction(std::move(transaction_options)),
+      std::move(table),
+      std::move(keys),
+      std::move(columns),
+      std::move(read_options),
+      {}};
+  if (!read_cache_) return conn_->Read(std::move(params));
+  return read_cache_->Read(std::move(params), [this](Connection::ReadParams p) {
+    return conn_->Read(std::move(p));
+  });
 }
 
 RowStream Client::Read(Transaction transaction, std::string table, KeySet keys,
@@ -70,6 +80,15 @@ RowStream Client::Read(ReadPartition const& read_partition) {
   return conn_->Read(internal::MakeReadParams(read_partition));
 }
 
+ReadCacheMetrics Client::GetReadCacheMetrics() const {
+  if (!read_cache_) return ReadCacheMetrics{};
+  return read_cache_->Metrics();
+}
+
+SessionPoolMetrics Client::GetSessionPoolMetrics() const {
+  return conn_->GetSessionPoolMetrics();
+}
+
 StatusOr<std::vector<ReadPartition>> Client::PartitionRead(
     Transaction transaction, std::string table, KeySet keys,
     std::vector<std::string> columns, ReadOptions read_options,
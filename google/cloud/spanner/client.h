@@ -31,6 +31,7 @@
 #include "google/cloud/spanner/read_partition.h"
 #include "google/cloud/spanner/results.h"
 #include "google/cloud/spanner/retry_policy.h"
+#include "google/cloud/spanner/session_pool_metrics.h"
 #include "google/cloud/spanner/session_pool_options.h"
 #include "google/cloud/spanner/sql_statement.h"
 #include "google/cloud/spanner/transaction.h"
@@ -50,6 +51,10 @@ namespace cloud {
 namespace spanner {
 inline namespace SPANNER_CLIENT_NS {
 
+namespace internal {
+class ReadCache;
+}  // namespace internal
+
 /**
  * Performs database client operations on Spanner.
  *
@@ -122,8 +127,7 @@ class Client {
    * with unit testing, callers may create fake/mock `Connection` objects that
    * are injected into the `Client`.
    */
-  explicit Client(std::shared_ptr<Connection> conn, ClientOptions opts = {})
-      : conn_(std::move(conn)), opts_(std::move(opts)) {}
+  explicit Client(std::shared_ptr<Connection> conn, ClientOptions opts = {});
 
   /// No default construction. Use `Client(std::shared_ptr<Connection>)`
   Client() = delete;
@@ -178,6 +182,10 @@ class Client {
    *
    * @param transaction_options Execute this read in a single-use transaction
    * with these options.
+   *
+   * @note If the read cache is enabled (see `ReadCacheOptions`), and
+   *     @p transaction_options has a bounded staleness, the result may come
+   *     from the cache.
    */
   RowStream Read(Transaction::SingleUseOptions transaction_options,
                  std::string table, KeySet keys,
@@ -209,6 +217,22 @@ class Client {
    */
   RowStream Read(ReadPartition const& partition);
 
+  /**
+   * Returns the counters of the read cache. All of them are zero if the cache
+   * is disabled.
+   *
+   * @see `ReadCacheOptions`
+   */
+  ReadCacheMetrics GetReadCacheMetrics() const;
+
+  /**
+   * Returns a snapshot of the state and the counters of the session pool.
+   *
+   * The pool can also report these periodically, see
+   * `SessionPoolOptions::set_metrics_callback()`.
+   */
+  SessionPoolMetrics GetSessionPoolMetrics() const;
+
   /**
    * Creates a set of partitions that can be used to execute a read
    * operation in parallel.  Each of the returned partitions can be passed
@@ -627,6 +651,8 @@ class Client {
 
   std::shared_ptr<Connection> conn_;
   ClientOptions opts_;
+  // Shared by the copies of this `Client`, null if the cache is disabled.
+  std::shared_ptr<internal::ReadCache> read_cache_;
 };
 
 /**
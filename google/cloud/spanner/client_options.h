@@ -16,6 +16,7 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_CLIENT_OPTIONS_H
 
 #include "google/cloud/spanner/query_options.h"
+#include "google/cloud/spanner/read_cache_options.h"
 #include "google/cloud/spanner/version.h"
 #include <string>
 
@@ -45,8 +46,20 @@ class ClientOptions {
     return *this;
   }
 
+  /// Returns the `ReadCacheOptions`
+  ReadCacheOptions const& read_cache_options() const {
+    return read_cache_options_;
+  }
+
+  /// Sets the `ReadCacheOptions`, see `ReadCacheOptions` for details.
+  ClientOptions& set_read_cache_options(ReadCacheOptions rco) {
+    read_cache_options_ = std::move(rco);
+    return *this;
+  }
+
   friend bool operator==(ClientOptions const& a, ClientOptions const& b) {
-    return a.query_options_ == b.query_options_;
+    return a.query_options_ == b.query_options_ &&
+           a.read_cache_options_ == b.read_cache_options_;
   }
 
   friend bool operator!=(ClientOptions const& a, ClientOptions const& b) {
@@ -55,6 +68,7 @@ class ClientOptions {
 
  private:
   QueryOptions query_options_;
+  ReadCacheOptions read_cache_options_;
 };
 
 }  // namespace SPANNER_CLIENT_NS
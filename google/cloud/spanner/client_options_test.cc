@@ -37,6 +37,19 @@ TEST(ClientOptionsTest, OptimizerVersion) {
   EXPECT_EQ(copy, default_constructed);
 }
 
+TEST(ClientOptionsTest, ReadCacheOptions) {
+  ClientOptions const default_constructed{};
+  EXPECT_EQ(0, default_constructed.read_cache_options().max_entries());
+
+  auto copy = default_constructed;
+  copy.set_read_cache_options(ReadCacheOptions{}.set_max_entries(100));
+  EXPECT_NE(copy, default_constructed);
+  EXPECT_EQ(100, copy.read_cache_options().max_entries());
+
+  copy.set_read_cache_options(ReadCacheOptions{});
+  EXPECT_EQ(copy, default_constructed);
+}
+
 }  // namespace
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
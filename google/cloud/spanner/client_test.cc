@@ -168,6 +168,71 @@ TEST(ClientTest, ReadFailure) {
   EXPECT_EQ((*iter).status().code(), StatusCode::kDeadlineExceeded);
 }
 
+TEST(ClientTest, ReadCache) {
+  auto conn = std::make_shared<MockConnection>();
+  Client client(conn, ClientOptions{}.set_read_cache_options(
+                          ReadCacheOptions{}.set_max_entries(10)));
+
+  auto make_source = [] {
+    auto source = absl::make_unique<MockResultSetSource>();
+    spanner_proto::ResultSetMetadata metadata;
+    *metadata.mutable_transaction()->mutable_read_timestamp() =
+        internal::TimestampToProto(
+            *MakeTimestamp(std::chrono::system_clock::now()));
+    EXPECT_CALL(*source, Metadata()).WillRepeatedly(Return(metadata));
+    EXPECT_CALL(*source, NextRow())
+        .WillOnce(Return(MakeTestRow("Steve", 12)))
+        .WillOnce(Return(Row()));
+    return RowStream(std::move(source));
+  };
+  // The strong read is not cached, the bounded-staleness read is sent once.
+  EXPECT_CALL(*conn, Read(_))
+      .WillOnce([&make_source](Connection::ReadParams const&) {
+        return make_source();
+      })
+      .WillOnce([&make_source](Connection::ReadParams const&) {
+        return make_source();
+      });
+
+  using RowType = std::tuple<std::string, std::int64_t>;
+  auto rows = client.Read("table", KeySet::All(), {"Name", "Id"});
+  for (auto& row : StreamOf<RowType>(rows)) EXPECT_STATUS_OK(row);
+
+  auto const opts = Transaction::SingleUseOptions(std::chrono::minutes(1));
+  for (int i = 0; i != 3; ++i) {
+    rows = client.Read(opts, "table", KeySet::All(), {"Name", "Id"});
+    std::vector<RowType> actual;
+    for (auto& row : StreamOf<RowType>(rows)) {
+      ASSERT_STATUS_OK(row);
+      actual.push_back(*row);
+    }
+    EXPECT_THAT(actual, ElementsAre(RowType("Steve", 12)));
+  }
+
+  auto metrics = client.GetReadCacheMetrics();
+  EXPECT_EQ(1, metrics.misses);
+  EXPECT_EQ(2, metrics.hits);
+  EXPECT_EQ(1, metrics.entries);
+
+  // Copies of the client share the cache.
+  auto copy = client;
+  EXPECT_EQ(2, copy.GetReadCacheMetrics().hits);
+  EXPECT_EQ(0, Client(conn).GetReadCacheMetrics().hits);
+}
+
+TEST(ClientTest, GetSessionPoolMetrics) {
+  auto conn = std::make_shared<MockConnection>();
+  SessionPoolMetrics metrics;
+  metrics.total_sessions = 3;
+  metrics.idle_sessions = 2;
+  EXPECT_CALL(*conn, GetSessionPoolMetrics()).WillOnce(Return(metrics));
+
+  Client client(conn);
+  auto actual = client.GetSessionPoolMetrics();
+  EXPECT_EQ(3, actual.total_sessions);
+  EXPECT_EQ(2, actual.idle_sessions);
+}
+
 TEST(ClientTest, ExecuteQuerySuccess) {
   auto conn = std::make_shared<MockConnection>();
   Client client(conn);
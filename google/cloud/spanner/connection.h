@@ -25,6 +25,7 @@
 #include "google/cloud/spanner/query_options.h"
 #include "google/cloud/spanner/read_options.h"
 #include "google/cloud/spanner/results.h"
+#include "google/cloud/spanner/session_pool_metrics.h"
 #include "google/cloud/spanner/sql_statement.h"
 #include "google/cloud/spanner/transaction.h"
 #include "google/cloud/spanner/version.h"
@@ -162,6 +163,9 @@ class Connection {
 
   /// Defines the interface for `Client::Rollback()`
   virtual Status Rollback(RollbackParams) = 0;
+
+  /// Defines the interface for `Client::GetSessionPoolMetrics()`
+  virtual SessionPoolMetrics GetSessionPoolMetrics() { return {}; }
 };
 
 }  // namespace SPANNER_CLIENT_NS
@@ -0,0 +1,132 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/dml_batcher.h"
+#include "google/cloud/spanner/internal/status_only_result_set_source.h"
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+DmlBatcher::DmlBatcher(Client client, Transaction transaction,
+                       std::size_t max_statements)
+    : client_(std::move(client)),
+      transaction_(std::move(transaction)),
+      max_statements_(max_statements == 0 ? 1 : max_statements) {}
+
+DmlBatcher::~DmlBatcher() {
+  for (auto& p : pending_) {
+    p.row_count.set_value(
+        Status(StatusCode::kCancelled,
+               "DmlBatcher destroyed before the statement was sent"));
+  }
+}
+
+StatusOr<std::int64_t> DmlBatcher::RowCount::get() {
+  // Any error is reported through the future.
+  if (!row_count_.is_ready()) batcher_->Flush();
+  return row_count_.get();
+}
+
+DmlBatcher::RowCount DmlBatcher::ExecuteDml(SqlStatement statement) {
+  promise<StatusOr<std::int64_t>> p;
+  auto f = p.get_future();
+  bool full;
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    pending_.push_back(PendingStatement{std::move(statement), std::move(p)});
+    full = pending_.size() >= max_statements_;
+  }
+  // Any error is reported through the futures.
+  if (full) Flush();
+  return RowCount(this, std::move(f));
+}
+
+Status DmlBatcher::Flush() {
+  std::vector<PendingStatement> batch;
+  std::vector<StatusOr<std::int64_t>> row_counts;
+  Status status;
+  {
+    std::lock_guard<std::mutex> flush_lk(flush_mu_);
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      batch.swap(pending_);
+    }
+    if (batch.empty()) return Status();
+
+    std::vector<SqlStatement> statements;
+    statements.reserve(batch.size());
+    for (auto& p : batch) statements.push_back(std::move(p.statement));
+    auto result = client_.ExecuteBatchDml(transaction_, std::move(statements));
+    row_counts.reserve(batch.size());
+    if (!result) {
+      status = std::move(result).status();
+      row_counts.assign(batch.size(), status);
+    } else {
+      status = std::move(result->status);
+      auto const& stats = result->stats;
+      for (std::size_t i = 0; i != batch.size(); ++i) {
+        if (i < stats.size()) {
+          row_counts.emplace_back(stats[i].row_count);
+        } else if (i == stats.size()) {
+          row_counts.emplace_back(status);
+        } else {
+          row_counts.emplace_back(
+              Status(StatusCode::kFailedPrecondition,
+                     "statement not executed, an earlier statement in the "
+                     "batch failed: " +
+                         status.message()));
+        }
+      }
+    }
+  }
+  // Satisfy the promises without holding any locks, as their continuations
+  // may use this object.
+  for (std::size_t i = 0; i != batch.size(); ++i) {
+    batch[i].row_count.set_value(std::move(row_counts[i]));
+  }
+  return status;
+}
+
+RowStream DmlBatcher::ExecuteQuery(SqlStatement statement,
+                                   QueryOptions const& opts) {
+  auto status = Flush();
+  if (!status.ok()) {
+    return internal::MakeStatusOnlyResult<RowStream>(std::move(status));
+  }
+  return client_.ExecuteQuery(transaction_, std::move(statement), opts);
+}
+
+RowStream DmlBatcher::Read(std::string table, KeySet keys,
+                           std::vector<std::string> columns,
+                           ReadOptions read_options) {
+  auto status = Flush();
+  if (!status.ok()) {
+    return internal::MakeStatusOnlyResult<RowStream>(std::move(status));
+  }
+  return client_.Read(transaction_, std::move(table), std::move(keys),
+                      std::move(columns), std::move(read_options));
+}
+
+StatusOr<CommitResult> DmlBatcher::Commit(Mutations mutations) {
+  auto status = Flush();
+  if (!status.ok()) return status;
+  return client_.Commit(transaction_, std::move(mutations));
+}
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
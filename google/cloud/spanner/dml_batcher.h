@@ -0,0 +1,176 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_DML_BATCHER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_DML_BATCHER_H
+
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/spanner/commit_result.h"
+#include "google/cloud/spanner/keys.h"
+#include "google/cloud/spanner/mutations.h"
+#include "google/cloud/spanner/query_options.h"
+#include "google/cloud/spanner/read_options.h"
+#include "google/cloud/spanner/results.h"
+#include "google/cloud/spanner/sql_statement.h"
+#include "google/cloud/spanner/transaction.h"
+#include "google/cloud/spanner/version.h"
+#include "google/cloud/future.h"
+#include "google/cloud/status.h"
+#include "google/cloud/status_or.h"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+/**
+ * Buffers the DML statements of a read-write transaction and sends them
+ * together, using `Client::ExecuteBatchDml()`.
+ *
+ * Each call to `Client::ExecuteDml()` is a round trip to the service. When an
+ * application runs many DML statements in a transaction, and does not need
+ * their results right away, it can use a `DmlBatcher` instead, so that the
+ * statements are sent in as few round trips as possible.
+ *
+ * `ExecuteDml()` returns a `RowCount`, holding the number of rows modified by
+ * the statement once it is sent. The buffered statements are sent when any of
+ * the following happen:
+ *
+ * - `RowCount::get()` is called on a statement that was not sent yet.
+ * - `Flush()` is called.
+ * - `ExecuteQuery()` or `Read()` is called, so that they observe the effects
+ *   of the preceding statements.
+ * - `Commit()` is called.
+ * - `max_statements` statements are buffered.
+ *
+ * Statements are always executed in the order they were given. If a statement
+ * fails, the statements that follow it in the same batch are not executed, and
+ * their futures report a `kFailedPrecondition` error.
+ *
+ * @par Example
+ * @code
+ * namespace spanner = ::google::cloud::spanner;
+ * auto commit = client.Commit([&client](spanner::Transaction txn)
+ *                                 -> StatusOr<spanner::Mutations> {
+ *   spanner::DmlBatcher batcher(client, txn);
+ *   for (auto& s : statements) batcher.ExecuteDml(std::move(s));
+ *   auto status = batcher.Flush();
+ *   if (!status.ok()) return status;
+ *   return spanner::Mutations{};
+ * });
+ * @endcode
+ */
+class DmlBatcher {
+ public:
+  /**
+   * The number of rows modified by a statement given to `ExecuteDml()`.
+   *
+   * Unlike a `future`, waiting for the value never blocks on statements that
+   * are still buffered: `get()` sends them first.
+   */
+  class RowCount {
+   public:
+    RowCount() = default;
+
+    /// Returns true if the statement was sent, or will never be sent.
+    bool is_ready() const { return row_count_.is_ready(); }
+
+    /**
+     * Returns the number of rows modified by the statement, sending the
+     * buffered statements of the `DmlBatcher` if needed.
+     *
+     * If the `DmlBatcher` was destroyed before the statement was sent, returns
+     * a `kCancelled` error.
+     */
+    StatusOr<std::int64_t> get();
+
+   private:
+    friend class DmlBatcher;
+    RowCount(DmlBatcher* batcher, future<StatusOr<std::int64_t>> row_count)
+        : batcher_(batcher), row_count_(std::move(row_count)) {}
+
+    // Only used while `row_count_` is not ready, as the `DmlBatcher` satisfies
+    // all its futures before it is destroyed.
+    DmlBatcher* batcher_ = nullptr;
+    future<StatusOr<std::int64_t>> row_count_;
+  };
+
+  /// Buffers statements to run in @p transaction, using @p client.
+  DmlBatcher(Client client, Transaction transaction,
+             std::size_t max_statements = 100);
+
+  /// The futures of any statements not yet sent report `kCancelled`.
+  ~DmlBatcher();
+
+  DmlBatcher(DmlBatcher const&) = delete;
+  DmlBatcher& operator=(DmlBatcher const&) = delete;
+
+  /**
+   * Buffers a DML @p statement.
+   *
+   * @return the number of rows modified by the statement, which is available
+   *     once the statement is sent.
+   */
+  RowCount ExecuteDml(SqlStatement statement);
+
+  /**
+   * Sends the buffered statements.
+   *
+   * @return the error of the first statement that failed, if any.
+   */
+  Status Flush();
+
+  /// Sends the buffered statements, then runs the query.
+  RowStream ExecuteQuery(SqlStatement statement, QueryOptions const& opts = {});
+
+  /// Sends the buffered statements, then reads the rows.
+  RowStream Read(std::string table, KeySet keys,
+                 std::vector<std::string> columns,
+                 ReadOptions read_options = {});
+
+  /**
+   * Sends the buffered statements, then commits the transaction with
+   * @p mutations.
+   *
+   * If a buffered statement fails, the transaction is not committed, and the
+   * error is returned.
+   */
+  StatusOr<CommitResult> Commit(Mutations mutations = {});
+
+ private:
+  struct PendingStatement {
+    SqlStatement statement;
+    promise<StatusOr<std::int64_t>> row_count;
+  };
+
+  Client client_;
+  Transaction transaction_;
+  std::size_t const max_statements_;
+  std::mutex flush_mu_;  // serializes the batches
+  std::mutex mu_;
+  std::vector<PendingStatement> pending_;  // GUARDED_BY(mu_)
+};
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_DML_BATCHER_H
@@ -0,0 +1,211 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/dml_batcher.h"
+#include "google/cloud/spanner/mocks/mock_spanner_connection.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace {
+
+using ::google::cloud::spanner_mocks::MockConnection;
+using ::google::cloud::spanner_mocks::MockResultSetSource;
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::InSequence;
+using ::testing::Invoke;
+using ::testing::Return;
+
+std::vector<std::string> Sql(std::vector<SqlStatement> const& statements) {
+  std::vector<std::string> sql;
+  for (auto const& s : statements) sql.push_back(s.sql());
+  return sql;
+}
+
+// Returns a successful result with row count `i + 1` for each statement `i`.
+StatusOr<BatchDmlResult> AllRowCounts(
+    Connection::ExecuteBatchDmlParams const& p) {
+  BatchDmlResult result;
+  for (std::size_t i = 0; i != p.statements.size(); ++i) {
+    result.stats.push_back({static_cast<std::int64_t>(i + 1)});
+  }
+  return result;
+}
+
+TEST(DmlBatcherTest, FlushSendsOneBatch) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, ExecuteBatchDml(_))
+      .WillOnce(Invoke([](Connection::ExecuteBatchDmlParams const& p) {
+        EXPECT_THAT(Sql(p.statements), ElementsAre("A", "B", "C"));
+        return AllRowCounts(p);
+      }));
+
+  DmlBatcher batcher(Client(conn), MakeReadWriteTransaction());
+  auto a = batcher.ExecuteDml(SqlStatement("A"));
+  auto b = batcher.ExecuteDml(SqlStatement("B"));
+  auto c = batcher.ExecuteDml(SqlStatement("C"));
+  EXPECT_FALSE(a.is_ready());
+  ASSERT_STATUS_OK(batcher.Flush());
+  EXPECT_EQ(1, *a.get());
+  EXPECT_EQ(2, *b.get());
+  EXPECT_EQ(3, *c.get());
+
+  // Nothing to send.
+  EXPECT_STATUS_OK(batcher.Flush());
+}
+
+TEST(DmlBatcherTest, GetSendsBufferedStatements) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, ExecuteBatchDml(_))
+      .WillOnce(Invoke([](Connection::ExecuteBatchDmlParams const& p) {
+        EXPECT_THAT(Sql(p.statements), ElementsAre("A", "B"));
+        return AllRowCounts(p);
+      }));
+
+  DmlBatcher batcher(Client(conn), MakeReadWriteTransaction());
+  auto a = batcher.ExecuteDml(SqlStatement("A"));
+  auto b = batcher.ExecuteDml(SqlStatement("B"));
+  EXPECT_FALSE(a.is_ready());
+  EXPECT_FALSE(b.is_ready());
+  // Without an explicit `Flush()`, waiting for a result sends the batch.
+  EXPECT_EQ(2, *b.get());
+  EXPECT_TRUE(a.is_ready());
+  EXPECT_EQ(1, *a.get());
+}
+
+TEST(DmlBatcherTest, FlushWhenFull) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, ExecuteBatchDml(_))
+      .Times(2)
+      .WillRepeatedly(Invoke([](Connection::ExecuteBatchDmlParams const& p) {
+        EXPECT_EQ(2, p.statements.size());
+        return AllRowCounts(p);
+      }));
+
+  DmlBatcher batcher(Client(conn), MakeReadWriteTransaction(), 2);
+  std::vector<DmlBatcher::RowCount> results;
+  for (int i = 0; i != 4; ++i) {
+    results.push_back(batcher.ExecuteDml(SqlStatement("S")));
+  }
+  for (auto& r : results) {
+    EXPECT_TRUE(r.is_ready());
+    EXPECT_STATUS_OK(r.get());
+  }
+}
+
+TEST(DmlBatcherTest, StatementFailure) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, ExecuteBatchDml(_))
+      .WillOnce(Return(BatchDmlResult{
+          {{10}}, Status(StatusCode::kInvalidArgument, "bad statement")}));
+
+  DmlBatcher batcher(Client(conn), MakeReadWriteTransaction());
+  auto a = batcher.ExecuteDml(SqlStatement("A"));
+  auto b = batcher.ExecuteDml(SqlStatement("B"));
+  auto c = batcher.ExecuteDml(SqlStatement("C"));
+  EXPECT_EQ(StatusCode::kInvalidArgument, batcher.Flush().code());
+  EXPECT_EQ(10, *a.get());
+  EXPECT_EQ(StatusCode::kInvalidArgument, b.get().status().code());
+  EXPECT_EQ(StatusCode::kFailedPrecondition, c.get().status().code());
+}
+
+TEST(DmlBatcherTest, RpcFailure) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, ExecuteBatchDml(_))
+      .WillOnce(Return(Status(StatusCode::kPermissionDenied, "uh-oh")));
+  EXPECT_CALL(*conn, ExecuteQuery(_)).Times(0);
+
+  DmlBatcher batcher(Client(conn), MakeReadWriteTransaction());
+  auto a = batcher.ExecuteDml(SqlStatement("A"));
+  auto rows = batcher.ExecuteQuery(SqlStatement("SELECT 1"));
+  auto row = rows.begin();
+  ASSERT_NE(row, rows.end());
+  EXPECT_EQ(StatusCode::kPermissionDenied, row->status().code());
+  EXPECT_EQ(StatusCode::kPermissionDenied, a.get().status().code());
+}
+
+TEST(DmlBatcherTest, ReadsAndCommitFlush) {
+  auto conn = std::make_shared<MockConnection>();
+  {
+    InSequence seq;
+    EXPECT_CALL(*conn, ExecuteBatchDml(_)).WillOnce(Invoke(AllRowCounts));
+    EXPECT_CALL(*conn, ExecuteQuery(_))
+        .WillOnce(Invoke([](Connection::SqlParams const&) {
+          auto source = absl::make_unique<MockResultSetSource>();
+          EXPECT_CALL(*source, NextRow()).WillOnce(Return(Row()));
+          return RowStream(std::move(source));
+        }));
+    EXPECT_CALL(*conn, ExecuteBatchDml(_)).WillOnce(Invoke(AllRowCounts));
+    EXPECT_CALL(*conn, Read(_))
+        .WillOnce(Invoke([](Connection::ReadParams const&) {
+          auto source = absl::make_unique<MockResultSetSource>();
+          EXPECT_CALL(*source, NextRow()).WillOnce(Return(Row()));
+          return RowStream(std::move(source));
+        }));
+    EXPECT_CALL(*conn, ExecuteBatchDml(_)).WillOnce(Invoke(AllRowCounts));
+    EXPECT_CALL(*conn, Commit(_)).WillOnce(Return(CommitResult{}));
+  }
+
+  DmlBatcher batcher(Client(conn), MakeReadWriteTransaction());
+  auto a = batcher.ExecuteDml(SqlStatement("A"));
+  auto rows = batcher.ExecuteQuery(SqlStatement("SELECT 1"));
+  EXPECT_TRUE(a.is_ready());
+  EXPECT_EQ(rows.begin(), rows.end());
+
+  auto b = batcher.ExecuteDml(SqlStatement("B"));
+  rows = batcher.Read("T", KeySet::All(), {"C"});
+  EXPECT_TRUE(b.is_ready());
+  EXPECT_EQ(rows.begin(), rows.end());
+
+  auto c = batcher.ExecuteDml(SqlStatement("C"));
+  EXPECT_STATUS_OK(batcher.Commit());
+  EXPECT_TRUE(c.is_ready());
+}
+
+TEST(DmlBatcherTest, CommitNotSentAfterFailure) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, ExecuteBatchDml(_))
+      .WillOnce(Return(
+          BatchDmlResult{{}, Status(StatusCode::kAlreadyExists, "dup")}));
+  EXPECT_CALL(*conn, Commit(_)).Times(0);
+
+  DmlBatcher batcher(Client(conn), MakeReadWriteTransaction());
+  batcher.ExecuteDml(SqlStatement("A"));
+  EXPECT_EQ(StatusCode::kAlreadyExists, batcher.Commit().status().code());
+}
+
+TEST(DmlBatcherTest, DestroyedWithPendingStatements) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, ExecuteBatchDml(_)).Times(0);
+
+  DmlBatcher::RowCount a;
+  {
+    DmlBatcher batcher(Client(conn), MakeReadWriteTransaction());
+    a = batcher.ExecuteDml(SqlStatement("A"));
+  }
+  EXPECT_EQ(StatusCode::kCancelled, a.get().status().code());
+}
+
+}  // namespace
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -15,8 +15,10 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_CHANNEL_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_CHANNEL_H
 
+#include "google/cloud/spanner/internal/channel_load.h"
 #include "google/cloud/spanner/internal/spanner_stub.h"
 #include "google/cloud/spanner/version.h"
+#include <cstddef>
 #include <memory>
 
 namespace google {
@@ -30,14 +32,20 @@ namespace internal {
  */
 struct Channel {
   /// @p stub_param must not be nullptr
-  explicit Channel(std::shared_ptr<SpannerStub> stub_param)
-      : stub(std::move(stub_param)) {}
+  explicit Channel(std::shared_ptr<SpannerStub> stub_param,
+                   std::shared_ptr<ChannelLoad> load_param =
+                       std::make_shared<ChannelLoad>())
+      : stub(std::move(stub_param)), load(std::move(load_param)) {}
 
   // This class is not copyable or movable.
   Channel(Channel const&) = delete;
   Channel& operator=(Channel const&) = delete;
 
   std::shared_ptr<SpannerStub> const stub;
+  /// The load on `stub`, must not be nullptr.
+  std::shared_ptr<ChannelLoad> const load;
+  /// The position of the channel in its `SessionPool`.
+  std::size_t index = 0;
   int session_count = 0;
 };
 
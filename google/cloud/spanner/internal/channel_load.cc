@@ -0,0 +1,132 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/channel_load.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+namespace {
+
+// The weight of each new sample in the moving averages is 1/kEwmaDivisor.
+std::int64_t constexpr kEwmaDivisor = 8;
+
+// Channels need this many completed RPCs before they can be unhealthy.
+std::uint64_t constexpr kMinRpcsForHealth = 10;
+
+// Channels with no RPCs completed in this period are considered healthy.
+auto constexpr kHealthProbeInterval = std::chrono::seconds(30);
+
+// A channel is unhealthy if its latency is this many times the best latency,
+auto constexpr kUnhealthyLatencyRatio = 3;
+// and is at least this large (to avoid flapping between fast channels).
+auto constexpr kUnhealthyLatencyFloor = std::chrono::milliseconds(10);
+
+// A channel is unhealthy if its failure rate is above this value.
+double constexpr kUnhealthyFailureRate = 0.5;
+
+void UpdateEwma(std::atomic<std::int64_t>& average, std::int64_t sample,
+                bool first) {
+  auto current = average.load(std::memory_order_relaxed);
+  for (;;) {
+    auto const updated =
+        first ? sample : current + (sample - current) / kEwmaDivisor;
+    if (average.compare_exchange_weak(current, updated,
+                                      std::memory_order_relaxed)) {
+      return;
+    }
+  }
+}
+
+bool IsTransientFailure(StatusCode code) {
+  return code == StatusCode::kUnavailable ||
+         code == StatusCode::kDeadlineExceeded ||
+         code == StatusCode::kResourceExhausted;
+}
+
+}  // namespace
+
+std::int64_t constexpr ChannelLoad::kPartsPerMillion;
+
+void ChannelLoad::RpcCompleted(RpcKind kind, Clock::duration latency,
+                               StatusCode code) {
+  auto const us =
+      std::chrono::duration_cast<std::chrono::microseconds>(latency);
+  auto const first = completed_.fetch_add(1, std::memory_order_relaxed) == 0;
+  UpdateEwma(failure_rate_ppm_,
+             IsTransientFailure(code) ? kPartsPerMillion : 0, first);
+  if (kind == RpcKind::kLightweight) {
+    auto const first_lightweight =
+        lightweight_completed_.fetch_add(1, std::memory_order_relaxed) == 0;
+    UpdateEwma(smoothed_latency_us_, us.count(), first_lightweight);
+  }
+  last_completion_.store(Clock::now().time_since_epoch().count(),
+                         std::memory_order_relaxed);
+  latency_.Record(us);
+}
+
+std::vector<bool> ClassifyChannelHealth(
+    std::vector<ChannelLoad const*> const& loads,
+    ChannelLoad::Clock::time_point now) {
+  auto is_recent = [now](ChannelLoad const& load) {
+    return now - load.last_completion() < kHealthProbeInterval;
+  };
+  auto has_evidence = [&is_recent](ChannelLoad const& load) {
+    return load.completed() >= kMinRpcsForHealth && is_recent(load);
+  };
+  auto has_latency_evidence = [&is_recent](ChannelLoad const& load) {
+    return load.lightweight_completed() >= kMinRpcsForHealth &&
+           is_recent(load);
+  };
+
+  auto best_latency = std::chrono::microseconds::max();
+  for (auto const* load : loads) {
+    if (!has_latency_evidence(*load) ||
+        load->failure_rate() > kUnhealthyFailureRate) {
+      continue;
+    }
+    best_latency = (std::min)(best_latency, load->smoothed_latency());
+  }
+
+  std::vector<bool> healthy;
+  healthy.reserve(loads.size());
+  for (auto const* load : loads) {
+    if (!has_evidence(*load)) {
+      healthy.push_back(true);
+      continue;
+    }
+    if (load->failure_rate() > kUnhealthyFailureRate) {
+      healthy.push_back(false);
+      continue;
+    }
+    if (!has_latency_evidence(*load)) {
+      healthy.push_back(true);
+      continue;
+    }
+    auto const latency = load->smoothed_latency();
+    healthy.push_back(latency < kUnhealthyLatencyFloor ||
+                      latency / kUnhealthyLatencyRatio <= best_latency);
+  }
+  return healthy;
+}
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
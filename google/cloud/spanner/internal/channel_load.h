@@ -0,0 +1,152 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_CHANNEL_LOAD_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_CHANNEL_LOAD_H
+
+#include "google/cloud/spanner/internal/latency_histogram.h"
+#include "google/cloud/spanner/session_pool_metrics.h"
+#include "google/cloud/spanner/version.h"
+#include "google/cloud/status.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+/**
+ * Tracks the load and the latency of the RPCs on a single gRPC channel.
+ *
+ * `LoadTrackingSpannerStub` updates this object as the RPCs start and finish,
+ * and the `SessionPool` uses it to prefer the least loaded channels, and to
+ * detect unhealthy ones. All the member functions are thread-safe, and do not
+ * block.
+ */
+class ChannelLoad {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /// The kinds of RPCs, which determine how their latency is used.
+  enum class RpcKind {
+    /**
+     * RPCs doing a small, fixed amount of work, such as `BeginTransaction()`.
+     * Their latency reflects the health of the channel.
+     */
+    kLightweight,
+    /**
+     * RPCs whose latency depends on the application's work, such as queries,
+     * DML, or commits. Their latency is not used to judge the channel.
+     */
+    kWorkload,
+  };
+
+  ChannelLoad() = default;
+  ChannelLoad(ChannelLoad const&) = delete;
+  ChannelLoad& operator=(ChannelLoad const&) = delete;
+
+  /// Called when an RPC starts.
+  void RpcStarted() { in_flight_.fetch_add(1, std::memory_order_relaxed); }
+
+  /**
+   * Called when an RPC finishes, or (for streaming RPCs) when it receives
+   * its first response.
+   */
+  void RpcCompleted(RpcKind kind, Clock::duration latency, StatusCode code);
+
+  /// Called when an RPC is no longer in flight.
+  void RpcFinished() { in_flight_.fetch_sub(1, std::memory_order_relaxed); }
+
+  /// The number of RPCs in flight.
+  int in_flight() const { return in_flight_.load(std::memory_order_relaxed); }
+
+  /// The number of RPCs that have completed.
+  std::uint64_t completed() const {
+    return completed_.load(std::memory_order_relaxed);
+  }
+
+  /// The number of `RpcKind::kLightweight` RPCs that have completed.
+  std::uint64_t lightweight_completed() const {
+    return lightweight_completed_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * The exponentially weighted moving average of the latencies of the
+   * `RpcKind::kLightweight` RPCs.
+   */
+  std::chrono::microseconds smoothed_latency() const {
+    return std::chrono::microseconds(
+        smoothed_latency_us_.load(std::memory_order_relaxed));
+  }
+
+  /**
+   * The exponentially weighted moving average of the rate of transient
+   * failures (such as `kUnavailable`), between 0 and 1.
+   */
+  double failure_rate() const {
+    return static_cast<double>(
+               failure_rate_ppm_.load(std::memory_order_relaxed)) /
+           kPartsPerMillion;
+  }
+
+  /// The last time an RPC completed.
+  Clock::time_point last_completion() const {
+    return Clock::time_point(
+        Clock::duration(last_completion_.load(std::memory_order_relaxed)));
+  }
+
+  /// The distribution of the latencies of all kinds of RPCs.
+  LatencyDistribution latency_distribution() const {
+    return latency_.Snapshot();
+  }
+
+ private:
+  static std::int64_t constexpr kPartsPerMillion = 1000 * 1000;
+
+  std::atomic<int> in_flight_{0};
+  std::atomic<std::uint64_t> completed_{0};
+  std::atomic<std::uint64_t> lightweight_completed_{0};
+  std::atomic<std::int64_t> smoothed_latency_us_{0};
+  std::atomic<std::int64_t> failure_rate_ppm_{0};
+  std::atomic<Clock::rep> last_completion_{0};
+  LatencyHistogram latency_;
+};
+
+/**
+ * Classifies a set of channels as healthy or unhealthy.
+ *
+ * A channel is unhealthy if most of its recent RPCs failed with transient
+ * errors, or if the smoothed latency of its lightweight RPCs is much higher
+ * than that of the fastest channel. The latency of queries, DML and commits is
+ * ignored, as a channel carrying slow queries is not slow itself. Channels with
+ * too few RPCs, or with no RPCs completed recently, are considered healthy, so
+ * they can receive new work and prove otherwise.
+ *
+ * @return a vector with one element per element in @p loads.
+ */
+std::vector<bool> ClassifyChannelHealth(
+    std::vector<ChannelLoad const*> const& loads,
+    ChannelLoad::Clock::time_point now);
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_CHANNEL_LOAD_H
@@ -0,0 +1,176 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/channel_load.h"
+#include <gmock/gmock.h>
+#include <chrono>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+using ms = std::chrono::milliseconds;
+using us = std::chrono::microseconds;
+
+using RpcKind = ChannelLoad::RpcKind;
+
+void Complete(ChannelLoad& load, int count, ChannelLoad::Clock::duration d,
+              StatusCode code = StatusCode::kOk,
+              RpcKind kind = RpcKind::kLightweight) {
+  for (int i = 0; i != count; ++i) {
+    load.RpcStarted();
+    load.RpcCompleted(kind, d, code);
+    load.RpcFinished();
+  }
+}
+
+TEST(ChannelLoad, InFlight) {
+  ChannelLoad load;
+  EXPECT_EQ(0, load.in_flight());
+  load.RpcStarted();
+  load.RpcStarted();
+  EXPECT_EQ(2, load.in_flight());
+  load.RpcFinished();
+  EXPECT_EQ(1, load.in_flight());
+  EXPECT_EQ(0, load.completed());
+}
+
+TEST(ChannelLoad, SmoothedLatency) {
+  ChannelLoad load;
+  EXPECT_EQ(us(0), load.smoothed_latency());
+
+  // The first sample initializes the average.
+  Complete(load, 1, us(800));
+  EXPECT_EQ(us(800), load.smoothed_latency());
+
+  // Later samples move the average by 1/8 of their difference.
+  Complete(load, 1, us(1600));
+  EXPECT_EQ(us(900), load.smoothed_latency());
+  Complete(load, 1, us(100));
+  EXPECT_EQ(us(800), load.smoothed_latency());
+
+  // The latency of the workload RPCs is recorded, but not smoothed.
+  Complete(load, 1, us(5000), StatusCode::kOk, RpcKind::kWorkload);
+  EXPECT_EQ(us(800), load.smoothed_latency());
+
+  EXPECT_EQ(4, load.completed());
+  EXPECT_EQ(3, load.lightweight_completed());
+  auto d = load.latency_distribution();
+  EXPECT_EQ(4, d.count);
+  EXPECT_EQ(us(5000), d.max);
+}
+
+TEST(ChannelLoad, FailureRate) {
+  ChannelLoad load;
+  EXPECT_EQ(0.0, load.failure_rate());
+
+  Complete(load, 1, us(10), StatusCode::kUnavailable);
+  EXPECT_EQ(1.0, load.failure_rate());
+
+  // Permanent errors are not counted as failures of the channel.
+  Complete(load, 1, us(10), StatusCode::kNotFound);
+  EXPECT_EQ(0.875, load.failure_rate());
+
+  Complete(load, 40, us(10));
+  EXPECT_GT(0.01, load.failure_rate());
+
+  Complete(load, 40, us(10), StatusCode::kDeadlineExceeded);
+  EXPECT_LT(0.99, load.failure_rate());
+}
+
+TEST(ClassifyChannelHealth, AllHealthy) {
+  ChannelLoad c0;
+  ChannelLoad c1;
+  Complete(c0, 20, ms(5));
+  Complete(c1, 20, ms(6));
+  EXPECT_THAT(ClassifyChannelHealth({&c0, &c1}, ChannelLoad::Clock::now()),
+              ElementsAre(true, true));
+}
+
+TEST(ClassifyChannelHealth, Slow) {
+  ChannelLoad c0;
+  ChannelLoad c1;
+  ChannelLoad c2;
+  Complete(c0, 20, ms(20));
+  Complete(c1, 20, ms(100));
+  Complete(c2, 20, ms(50));
+  EXPECT_THAT(
+      ClassifyChannelHealth({&c0, &c1, &c2}, ChannelLoad::Clock::now()),
+      ElementsAre(true, false, true));
+}
+
+TEST(ClassifyChannelHealth, SlowWorkload) {
+  ChannelLoad c0;
+  ChannelLoad c1;
+  Complete(c0, 20, ms(5));
+  Complete(c1, 20, ms(6));
+  // A channel running slow queries is not unhealthy.
+  Complete(c1, 20, std::chrono::seconds(2), StatusCode::kOk,
+           RpcKind::kWorkload);
+  EXPECT_THAT(ClassifyChannelHealth({&c0, &c1}, ChannelLoad::Clock::now()),
+              ElementsAre(true, true));
+
+  // But their failures count.
+  Complete(c1, 20, std::chrono::seconds(2), StatusCode::kUnavailable,
+           RpcKind::kWorkload);
+  EXPECT_THAT(ClassifyChannelHealth({&c0, &c1}, ChannelLoad::Clock::now()),
+              ElementsAre(true, false));
+}
+
+TEST(ClassifyChannelHealth, SlowButBelowFloor) {
+  ChannelLoad c0;
+  ChannelLoad c1;
+  Complete(c0, 20, us(100));
+  Complete(c1, 20, ms(5));
+  EXPECT_THAT(ClassifyChannelHealth({&c0, &c1}, ChannelLoad::Clock::now()),
+              ElementsAre(true, true));
+}
+
+TEST(ClassifyChannelHealth, Failing) {
+  ChannelLoad c0;
+  ChannelLoad c1;
+  Complete(c0, 20, ms(1));
+  // The failing channel is fast, but it does not set the best latency.
+  Complete(c1, 20, us(10), StatusCode::kUnavailable);
+  EXPECT_THAT(ClassifyChannelHealth({&c0, &c1}, ChannelLoad::Clock::now()),
+              ElementsAre(true, false));
+}
+
+TEST(ClassifyChannelHealth, NotEnoughEvidence) {
+  ChannelLoad c0;
+  ChannelLoad c1;
+  ChannelLoad c2;
+  Complete(c0, 20, ms(20));
+  Complete(c1, 5, ms(500), StatusCode::kUnavailable);
+  Complete(c2, 20, ms(500), StatusCode::kUnavailable);
+  auto const now = ChannelLoad::Clock::now();
+  EXPECT_THAT(ClassifyChannelHealth({&c0, &c1, &c2}, now),
+              ElementsAre(true, true, false));
+
+  // Once the channels are idle for long enough they get another chance.
+  EXPECT_THAT(ClassifyChannelHealth({&c0, &c1, &c2},
+                                    now + std::chrono::minutes(1)),
+              ElementsAre(true, true, true));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
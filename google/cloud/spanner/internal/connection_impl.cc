@@ -17,6 +17,7 @@
 #include "google/cloud/spanner/internal/partial_result_set_resume.h"
 #include "google/cloud/spanner/internal/partial_result_set_source.h"
 #include "google/cloud/spanner/internal/retry_loop.h"
+#include "google/cloud/spanner/internal/status_only_result_set_source.h"
 #include "google/cloud/spanner/internal/status_utils.h"
 #include "google/cloud/spanner/query_partition.h"
 #include "google/cloud/spanner/read_partition.h"
@@ -227,29 +228,8 @@ Status ConnectionImpl::Rollback(RollbackParams params) {
              std::int64_t) { return this->RollbackImpl(session, s); });
 }
 
-class StatusOnlyResultSetSource : public internal::ResultSourceInterface {
- public:
-  explicit StatusOnlyResultSetSource(google::cloud::Status status)
-      : status_(std::move(status)) {}
-  ~StatusOnlyResultSetSource() override = default;
-
-  StatusOr<Row> NextRow() override { return status_; }
-  absl::optional<google::spanner::v1::ResultSetMetadata> Metadata() override {
-    return {};
-  }
-  absl::optional<google::spanner::v1::ResultSetStats> Stats() const override {
-    return {};
-  }
-
- private:
-  google::cloud::Status status_;
-};
-
-// Helper function to build and wrap a `StatusOnlyResultSetSource`.
-template <typename ResultType>
-ResultType MakeStatusOnlyResult(Status status) {
-  return ResultType(
-      absl::make_unique<StatusOnlyResultSetSource>(std::move(status)));
+SessionPoolMetrics ConnectionImpl::GetSessionPoolMetrics() {
+  return session_pool_->Metrics();
 }
 
 class DmlResultSetSource : public internal::ResultSourceInterface {
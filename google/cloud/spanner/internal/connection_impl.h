@@ -22,6 +22,7 @@
 #include "google/cloud/spanner/internal/session_pool.h"
 #include "google/cloud/spanner/internal/spanner_stub.h"
 #include "google/cloud/spanner/retry_policy.h"
+#include "google/cloud/spanner/session_pool_metrics.h"
 #include "google/cloud/spanner/tracing_options.h"
 #include "google/cloud/spanner/version.h"
 #include "google/cloud/background_threads.h"
@@ -82,6 +83,7 @@ class ConnectionImpl : public Connection {
   StatusOr<BatchDmlResult> ExecuteBatchDml(ExecuteBatchDmlParams) override;
   StatusOr<CommitResult> Commit(CommitParams) override;
   Status Rollback(RollbackParams) override;
+  SessionPoolMetrics GetSessionPoolMetrics() override;
 
  private:
   // Only the factory method can construct instances of this class.
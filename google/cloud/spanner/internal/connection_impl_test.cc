@@ -174,6 +174,21 @@ class MockGrpcReader
   MOCK_METHOD0(WaitForInitialMetadata, void());
 };
 
+TEST(ConnectionImplTest, GetSessionPoolMetrics) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*mock, BatchCreateSessions(_, _))
+      .WillOnce(Return(MakeSessionsResponse({"test-session-name"})));
+
+  auto db = Database("dummy_project", "dummy_instance", "dummy_database_id");
+  auto conn = MakeConnection(
+      db, {mock}, ConnectionOptions{grpc::InsecureChannelCredentials()},
+      SessionPoolOptions{}.set_min_sessions(1));
+  auto metrics = conn->GetSessionPoolMetrics();
+  EXPECT_EQ(1, metrics.total_sessions);
+  EXPECT_EQ(1, metrics.idle_sessions);
+  EXPECT_EQ(1, metrics.sessions_created);
+}
+
 TEST(ConnectionImplTest, ReadGetSessionFailure) {
   auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
 
@@ -0,0 +1,69 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/latency_histogram.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+std::size_t constexpr LatencyHistogram::kMinBucketBits;
+std::size_t constexpr LatencyHistogram::kBucketCount;
+
+LatencyHistogram::LatencyHistogram() : count_(0), total_(0), max_(0) {
+  for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::Record(std::chrono::microseconds latency) {
+  auto const us = (std::max)(latency.count(), std::int64_t{0});
+  // Bucket `i` holds the latencies below `2^(kMinBucketBits + i)`, except the
+  // last bucket, which has no upper limit.
+  std::size_t bucket = 0;
+  for (auto v = static_cast<std::uint64_t>(us) >> kMinBucketBits;
+       v != 0 && bucket + 1 != kBucketCount; v >>= 1) {
+    ++bucket;
+  }
+  buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  total_.fetch_add(us, std::memory_order_relaxed);
+  auto max = max_.load(std::memory_order_relaxed);
+  while (us > max &&
+         !max_.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+  }
+}
+
+LatencyDistribution LatencyHistogram::Snapshot() const {
+  LatencyDistribution d;
+  d.count = count_.load(std::memory_order_relaxed);
+  d.total = std::chrono::microseconds(total_.load(std::memory_order_relaxed));
+  d.max = std::chrono::microseconds(max_.load(std::memory_order_relaxed));
+  d.bucket_limits.reserve(kBucketCount - 1);
+  d.bucket_counts.reserve(kBucketCount);
+  for (std::size_t i = 0; i != kBucketCount; ++i) {
+    if (i + 1 != kBucketCount) {
+      d.bucket_limits.emplace_back(std::int64_t{1} << (kMinBucketBits + i));
+    }
+    d.bucket_counts.push_back(buckets_[i].load(std::memory_order_relaxed));
+  }
+  return d;
+}
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,70 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_LATENCY_HISTOGRAM_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_LATENCY_HISTOGRAM_H
+
+#include "google/cloud/spanner/session_pool_metrics.h"
+#include "google/cloud/spanner/version.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+/**
+ * A lock-free histogram of latencies.
+ *
+ * The bucket limits are powers of two, from 16us to about 67s, so recording a
+ * latency is a handful of relaxed atomic operations. `Record()` may be called
+ * concurrently from any number of threads. `Snapshot()` may run concurrently
+ * with `Record()`, in which case it may miss some of the concurrent updates,
+ * or include them only in some of its fields.
+ */
+class LatencyHistogram {
+ public:
+  LatencyHistogram();
+
+  LatencyHistogram(LatencyHistogram const&) = delete;
+  LatencyHistogram& operator=(LatencyHistogram const&) = delete;
+
+  /// Records one operation with the given @p latency.
+  void Record(std::chrono::microseconds latency);
+
+  /// Returns the distribution of the latencies recorded so far.
+  LatencyDistribution Snapshot() const;
+
+ private:
+  static std::size_t constexpr kMinBucketBits = 4;
+  static std::size_t constexpr kBucketCount = 24;
+
+  std::array<std::atomic<std::uint64_t>, kBucketCount> buckets_;
+  std::atomic<std::uint64_t> count_;
+  std::atomic<std::int64_t> total_;
+  std::atomic<std::int64_t> max_;
+};
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_LATENCY_HISTOGRAM_H
@@ -0,0 +1,89 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/latency_histogram.h"
+#include <gmock/gmock.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+namespace {
+
+using us = std::chrono::microseconds;
+
+TEST(LatencyHistogram, Empty) {
+  LatencyHistogram histogram;
+  auto d = histogram.Snapshot();
+  EXPECT_EQ(0, d.count);
+  EXPECT_EQ(us(0), d.total);
+  EXPECT_EQ(us(0), d.max);
+  EXPECT_EQ(d.bucket_limits.size() + 1, d.bucket_counts.size());
+  EXPECT_EQ(us(16), d.bucket_limits.front());
+  for (auto c : d.bucket_counts) EXPECT_EQ(0, c);
+}
+
+TEST(LatencyHistogram, Buckets) {
+  LatencyHistogram histogram;
+  histogram.Record(us(0));
+  histogram.Record(us(15));
+  histogram.Record(us(16));
+  histogram.Record(us(31));
+  histogram.Record(us(1000));
+  histogram.Record(std::chrono::hours(1));
+  histogram.Record(us(-5));  // Treated as zero.
+
+  auto d = histogram.Snapshot();
+  EXPECT_EQ(7, d.count);
+  EXPECT_EQ(us(0 + 15 + 16 + 31 + 1000) + std::chrono::hours(1), d.total);
+  EXPECT_EQ(std::chrono::hours(1), d.max);
+  ASSERT_EQ(d.bucket_limits.size() + 1, d.bucket_counts.size());
+  EXPECT_EQ(3, d.bucket_counts[0]);  // [0, 16)
+  EXPECT_EQ(2, d.bucket_counts[1]);  // [16, 32)
+  EXPECT_EQ(us(32), d.bucket_limits[1]);
+  EXPECT_EQ(1, d.bucket_counts[6]);  // [512, 1024)
+  EXPECT_EQ(us(1024), d.bucket_limits[6]);
+  EXPECT_EQ(1, d.bucket_counts.back());
+}
+
+TEST(LatencyHistogram, Concurrent) {
+  LatencyHistogram histogram;
+  int const kThreads = 4;
+  int const kIterations = 1000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t != kThreads; ++t) {
+    threads.emplace_back([&histogram, t] {
+      for (int i = 0; i != kIterations; ++i) histogram.Record(us(t * 100 + i));
+    });
+  }
+  for (auto& t : threads) t.join();
+
+  auto d = histogram.Snapshot();
+  EXPECT_EQ(kThreads * kIterations, d.count);
+  EXPECT_EQ(us((kThreads - 1) * 100 + kIterations - 1), d.max);
+  std::uint64_t total = 0;
+  for (auto c : d.bucket_counts) total += c;
+  EXPECT_EQ(d.count, total);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,256 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/load_tracking_spanner_stub.h"
+#include "google/cloud/grpc_error_delegate.h"
+#include "absl/memory/memory.h"
+#include <cstdint>
+#include <functional>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+namespace spanner_proto = ::google::spanner::v1;
+
+namespace {
+
+using Clock = ChannelLoad::Clock;
+using RpcKind = ChannelLoad::RpcKind;
+
+StatusCode CodeOf(Status const& status) { return status.code(); }
+
+template <typename T>
+StatusCode CodeOf(StatusOr<T> const& result) {
+  return result.status().code();
+}
+
+/// Runs the synchronous RPC @p call, recording it in @p load.
+template <typename Functor>
+auto Track(ChannelLoad& load, RpcKind kind, Functor&& call)
+    -> decltype(call()) {
+  load.RpcStarted();
+  auto const start = Clock::now();
+  auto result = call();
+  load.RpcCompleted(kind, Clock::now() - start, CodeOf(result));
+  load.RpcFinished();
+  return result;
+}
+
+/// Tracks a streaming RPC until it finishes, or the reader is destroyed.
+class LoadTrackingReader
+    : public grpc::ClientReaderInterface<spanner_proto::PartialResultSet> {
+ public:
+  using Reader = grpc::ClientReaderInterface<spanner_proto::PartialResultSet>;
+
+  LoadTrackingReader(std::unique_ptr<Reader> child,
+                     std::shared_ptr<ChannelLoad> load, Clock::time_point start)
+      : child_(std::move(child)), load_(std::move(load)), start_(start) {}
+
+  ~LoadTrackingReader() override {
+    if (!finished_) load_->RpcFinished();
+  }
+
+  bool NextMessageSize(std::uint32_t* sz) override {
+    return child_->NextMessageSize(sz);
+  }
+
+  bool Read(spanner_proto::PartialResultSet* msg) override {
+    auto const ok = child_->Read(msg);
+    // Failures are recorded in `Finish()`, when their status is known.
+    if (ok && !completed_) Complete(StatusCode::kOk);
+    return ok;
+  }
+
+  grpc::Status Finish() override {
+    auto status = child_->Finish();
+    if (!completed_) Complete(MakeStatusFromRpcError(status).code());
+    if (!finished_) {
+      finished_ = true;
+      load_->RpcFinished();
+    }
+    return status;
+  }
+
+  void WaitForInitialMetadata() override { child_->WaitForInitialMetadata(); }
+
+ private:
+  void Complete(StatusCode code) {
+    completed_ = true;
+    // The time to the first response depends on the query, or the read.
+    load_->RpcCompleted(RpcKind::kWorkload, Clock::now() - start_, code);
+  }
+
+  std::unique_ptr<Reader> child_;
+  std::shared_ptr<ChannelLoad> load_;
+  Clock::time_point start_;
+  bool completed_ = false;
+  bool finished_ = false;
+};
+
+std::unique_ptr<LoadTrackingReader::Reader> TrackStream(
+    std::shared_ptr<ChannelLoad> const& load,
+    std::function<std::unique_ptr<LoadTrackingReader::Reader>()> const& call) {
+  load->RpcStarted();
+  auto const start = Clock::now();
+  return absl::make_unique<LoadTrackingReader>(call(), load, start);
+}
+
+}  // namespace
+
+StatusOr<spanner_proto::Session> LoadTrackingSpannerStub::CreateSession(
+    grpc::ClientContext& client_context,
+    spanner_proto::CreateSessionRequest const& request) {
+  return Track(*load_, RpcKind::kLightweight, [&] {
+    return child_->CreateSession(client_context, request);
+  });
+}
+
+StatusOr<spanner_proto::BatchCreateSessionsResponse>
+LoadTrackingSpannerStub::BatchCreateSessions(
+    grpc::ClientContext& client_context,
+    spanner_proto::BatchCreateSessionsRequest const& request) {
+  return Track(*load_, RpcKind::kLightweight, [&] {
+    return child_->BatchCreateSessions(client_context, request);
+  });
+}
+
+std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+    spanner_proto::BatchCreateSessionsResponse>>
+LoadTrackingSpannerStub::AsyncBatchCreateSessions(
+    grpc::ClientContext& client_context,
+    spanner_proto::BatchCreateSessionsRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return child_->AsyncBatchCreateSessions(client_context, request, cq);
+}
+
+StatusOr<spanner_proto::Session> LoadTrackingSpannerStub::GetSession(
+    grpc::ClientContext& client_context,
+    spanner_proto::GetSessionRequest const& request) {
+  return Track(*load_, RpcKind::kLightweight,
+               [&] { return child_->GetSession(client_context, request); });
+}
+
+StatusOr<spanner_proto::ListSessionsResponse>
+LoadTrackingSpannerStub::ListSessions(
+    grpc::ClientContext& client_context,
+    spanner_proto::ListSessionsRequest const& request) {
+  return Track(*load_, RpcKind::kLightweight,
+               [&] { return child_->ListSessions(client_context, request); });
+}
+
+Status LoadTrackingSpannerStub::DeleteSession(
+    grpc::ClientContext& client_context,
+    spanner_proto::DeleteSessionRequest const& request) {
+  return Track(*load_, RpcKind::kLightweight,
+               [&] { return child_->DeleteSession(client_context, request); });
+}
+
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<google::protobuf::Empty>>
+LoadTrackingSpannerStub::AsyncDeleteSession(
+    grpc::ClientContext& client_context,
+    spanner_proto::DeleteSessionRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return child_->AsyncDeleteSession(client_context, request, cq);
+}
+
+StatusOr<spanner_proto::ResultSet> LoadTrackingSpannerStub::ExecuteSql(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteSqlRequest const& request) {
+  return Track(*load_, RpcKind::kWorkload,
+               [&] { return child_->ExecuteSql(client_context, request); });
+}
+
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<spanner_proto::ResultSet>>
+LoadTrackingSpannerStub::AsyncExecuteSql(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteSqlRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return child_->AsyncExecuteSql(client_context, request, cq);
+}
+
+std::unique_ptr<grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>
+LoadTrackingSpannerStub::ExecuteStreamingSql(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteSqlRequest const& request) {
+  return TrackStream(load_, [&] {
+    return child_->ExecuteStreamingSql(client_context, request);
+  });
+}
+
+StatusOr<spanner_proto::ExecuteBatchDmlResponse>
+LoadTrackingSpannerStub::ExecuteBatchDml(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteBatchDmlRequest const& request) {
+  return Track(*load_, RpcKind::kWorkload, [&] {
+    return child_->ExecuteBatchDml(client_context, request);
+  });
+}
+
+std::unique_ptr<grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>
+LoadTrackingSpannerStub::StreamingRead(
+    grpc::ClientContext& client_context,
+    spanner_proto::ReadRequest const& request) {
+  return TrackStream(load_, [&] {
+    return child_->StreamingRead(client_context, request);
+  });
+}
+
+StatusOr<spanner_proto::Transaction> LoadTrackingSpannerStub::BeginTransaction(
+    grpc::ClientContext& client_context,
+    spanner_proto::BeginTransactionRequest const& request) {
+  return Track(*load_, RpcKind::kLightweight, [&] {
+    return child_->BeginTransaction(client_context, request);
+  });
+}
+
+StatusOr<spanner_proto::CommitResponse> LoadTrackingSpannerStub::Commit(
+    grpc::ClientContext& client_context,
+    spanner_proto::CommitRequest const& request) {
+  return Track(*load_, RpcKind::kWorkload,
+               [&] { return child_->Commit(client_context, request); });
+}
+
+Status LoadTrackingSpannerStub::Rollback(
+    grpc::ClientContext& client_context,
+    spanner_proto::RollbackRequest const& request) {
+  return Track(*load_, RpcKind::kLightweight,
+               [&] { return child_->Rollback(client_context, request); });
+}
+
+StatusOr<spanner_proto::PartitionResponse>
+LoadTrackingSpannerStub::PartitionQuery(
+    grpc::ClientContext& client_context,
+    spanner_proto::PartitionQueryRequest const& request) {
+  return Track(*load_, RpcKind::kWorkload,
+               [&] { return child_->PartitionQuery(client_context, request); });
+}
+
+StatusOr<spanner_proto::PartitionResponse>
+LoadTrackingSpannerStub::PartitionRead(
+    grpc::ClientContext& client_context,
+    spanner_proto::PartitionReadRequest const& request) {
+  return Track(*load_, RpcKind::kWorkload,
+               [&] { return child_->PartitionRead(client_context, request); });
+}
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,169 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/load_tracking_spanner_stub.h"
+#include "google/cloud/spanner/testing/mock_spanner_stub.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::testing::_;
+using ::testing::Return;
+namespace spanner_proto = ::google::spanner::v1;
+
+class MockGrpcReader
+    : public ::grpc::ClientReaderInterface<spanner_proto::PartialResultSet> {
+ public:
+  MOCK_METHOD1(Read, bool(spanner_proto::PartialResultSet*));
+  MOCK_METHOD1(NextMessageSize, bool(std::uint32_t*));
+  MOCK_METHOD0(Finish, grpc::Status());
+  MOCK_METHOD0(WaitForInitialMetadata, void());
+};
+
+TEST(LoadTrackingSpannerStub, Unary) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*mock, Commit(_, _))
+      .WillOnce(Return(spanner_proto::CommitResponse{}))
+      .WillOnce(Return(Status(StatusCode::kUnavailable, "try-again")));
+  auto load = std::make_shared<ChannelLoad>();
+  LoadTrackingSpannerStub stub(mock, load);
+
+  grpc::ClientContext c1;
+  EXPECT_TRUE(stub.Commit(c1, spanner_proto::CommitRequest{}).ok());
+  EXPECT_EQ(0, load->in_flight());
+  EXPECT_EQ(1, load->completed());
+  EXPECT_EQ(0.0, load->failure_rate());
+
+  grpc::ClientContext c2;
+  EXPECT_EQ(StatusCode::kUnavailable,
+            stub.Commit(c2, spanner_proto::CommitRequest{}).status().code());
+  EXPECT_EQ(0, load->in_flight());
+  EXPECT_EQ(2, load->completed());
+  EXPECT_LT(0.0, load->failure_rate());
+}
+
+TEST(LoadTrackingSpannerStub, InFlightDuringCall) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto load = std::make_shared<ChannelLoad>();
+  EXPECT_CALL(*mock, Rollback(_, _))
+      .WillOnce([&load](grpc::ClientContext&,
+                        spanner_proto::RollbackRequest const&) {
+        EXPECT_EQ(1, load->in_flight());
+        return Status();
+      });
+  LoadTrackingSpannerStub stub(mock, load);
+  grpc::ClientContext context;
+  EXPECT_TRUE(stub.Rollback(context, spanner_proto::RollbackRequest{}).ok());
+  EXPECT_EQ(0, load->in_flight());
+}
+
+TEST(LoadTrackingSpannerStub, Streaming) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*mock, ExecuteStreamingSql(_, _))
+      .WillOnce([](grpc::ClientContext&,
+                   spanner_proto::ExecuteSqlRequest const&) {
+        auto reader = absl::make_unique<MockGrpcReader>();
+        EXPECT_CALL(*reader, Read(_))
+            .WillOnce(Return(true))
+            .WillOnce(Return(true))
+            .WillOnce(Return(false));
+        EXPECT_CALL(*reader, Finish()).WillOnce(Return(grpc::Status()));
+        return std::unique_ptr<grpc::ClientReaderInterface<
+            spanner_proto::PartialResultSet>>(std::move(reader));
+      });
+  auto load = std::make_shared<ChannelLoad>();
+  LoadTrackingSpannerStub stub(mock, load);
+
+  grpc::ClientContext context;
+  auto reader =
+      stub.ExecuteStreamingSql(context, spanner_proto::ExecuteSqlRequest{});
+  EXPECT_EQ(1, load->in_flight());
+  EXPECT_EQ(0, load->completed());
+
+  spanner_proto::PartialResultSet response;
+  EXPECT_TRUE(reader->Read(&response));
+  // The latency is measured to the first response.
+  EXPECT_EQ(1, load->completed());
+  EXPECT_TRUE(reader->Read(&response));
+  EXPECT_FALSE(reader->Read(&response));
+  EXPECT_EQ(1, load->in_flight());
+  EXPECT_TRUE(reader->Finish().ok());
+  EXPECT_EQ(0, load->in_flight());
+  EXPECT_EQ(1, load->completed());
+  EXPECT_EQ(0.0, load->failure_rate());
+
+  // Destroying the reader does not change the counts.
+  reader.reset();
+  EXPECT_EQ(0, load->in_flight());
+}
+
+TEST(LoadTrackingSpannerStub, StreamingFailure) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*mock, StreamingRead(_, _))
+      .WillOnce([](grpc::ClientContext&, spanner_proto::ReadRequest const&) {
+        auto reader = absl::make_unique<MockGrpcReader>();
+        EXPECT_CALL(*reader, Read(_)).WillOnce(Return(false));
+        EXPECT_CALL(*reader, Finish())
+            .WillOnce(
+                Return(grpc::Status(grpc::StatusCode::UNAVAILABLE, "down")));
+        return std::unique_ptr<grpc::ClientReaderInterface<
+            spanner_proto::PartialResultSet>>(std::move(reader));
+      });
+  auto load = std::make_shared<ChannelLoad>();
+  LoadTrackingSpannerStub stub(mock, load);
+
+  grpc::ClientContext context;
+  auto reader = stub.StreamingRead(context, spanner_proto::ReadRequest{});
+  spanner_proto::PartialResultSet response;
+  EXPECT_FALSE(reader->Read(&response));
+  EXPECT_EQ(0, load->completed());
+  EXPECT_FALSE(reader->Finish().ok());
+  EXPECT_EQ(0, load->in_flight());
+  EXPECT_EQ(1, load->completed());
+  EXPECT_EQ(1.0, load->failure_rate());
+}
+
+TEST(LoadTrackingSpannerStub, StreamingAbandoned) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*mock, ExecuteStreamingSql(_, _))
+      .WillOnce([](grpc::ClientContext&,
+                   spanner_proto::ExecuteSqlRequest const&) {
+        return std::unique_ptr<grpc::ClientReaderInterface<
+            spanner_proto::PartialResultSet>>(
+            absl::make_unique<MockGrpcReader>());
+      });
+  auto load = std::make_shared<ChannelLoad>();
+  LoadTrackingSpannerStub stub(mock, load);
+
+  grpc::ClientContext context;
+  auto reader =
+      stub.ExecuteStreamingSql(context, spanner_proto::ExecuteSqlRequest{});
+  EXPECT_EQ(1, load->in_flight());
+  reader.reset();
+  EXPECT_EQ(0, load->in_flight());
+  EXPECT_EQ(0, load->completed());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -13,8 +13,11 @@
 // limitations under the License.
 
 #include "google/cloud/spanner/internal/partial_result_set_source.h"
+#include "google/cloud/spanner/bytes.h"
 #include "google/cloud/spanner/internal/merge_chunk.h"
 #include "google/cloud/log.h"
+#include <algorithm>
+#include <iterator>
 
 namespace google {
 namespace cloud {
@@ -46,6 +49,40 @@ StatusOr<Row> PartialResultSetSource::NextRow() {
     return Row();
   }
 
+  auto buffered = BufferRow();
+  if (!buffered) return std::move(buffered).status();
+  if (!*buffered) return Row();
+
+  auto const& fields = metadata_->row_type().fields();
+  std::vector<Value> values;
+  values.reserve(fields.size());
+  auto iter = buffer_.begin();
+  for (auto const& field : fields) {
+    values.push_back(FromProto(field.type(), std::move(*iter)));
+    ++iter;
+  }
+  buffer_.erase(buffer_.begin(), iter);
+  return internal::MakeRow(std::move(values), columns_);
+}
+
+Status PartialResultSetSource::NextRowProtos(
+    std::vector<google::protobuf::Value>& values) {
+  values.clear();
+  if (finished_) return {};
+
+  auto buffered = BufferRow();
+  if (!buffered) return std::move(buffered).status();
+  if (!*buffered) return {};
+
+  auto const end = buffer_.begin() + columns_->size();
+  std::move(buffer_.begin(), end, std::back_inserter(values));
+  buffer_.erase(buffer_.begin(), end);
+  return {};
+}
+
+// Reads from the stream until `buffer_` holds a complete row. Returns false if
+// the stream ended cleanly instead.
+StatusOr<bool> PartialResultSetSource::BufferRow() {
   while (buffer_.empty() || buffer_.size() < columns_->size()) {
     auto status = ReadFromStream();
     if (!status.ok()) {
@@ -59,25 +96,15 @@ StatusOr<Row> PartialResultSetSource::NextRow() {
       if (!buffer_.empty()) {
         return Status(StatusCode::kInternal, "incomplete row at end of stream");
       }
-      return Row();
+      return false;
     }
   }
 
-  auto const& fields = metadata_->row_type().fields();
-  if (fields.empty()) {
+  if (metadata_->row_type().fields().empty()) {
     return Status(StatusCode::kInternal,
                   "response metadata is missing row type information");
   }
-
-  std::vector<Value> values;
-  values.reserve(fields.size());
-  auto iter = buffer_.begin();
-  for (auto const& field : fields) {
-    values.push_back(FromProto(field.type(), std::move(*iter)));
-    ++iter;
-  }
-  buffer_.erase(buffer_.begin(), iter);
-  return internal::MakeRow(std::move(values), columns_);
+  return true;
 }
 
 PartialResultSetSource::~PartialResultSetSource() {
@@ -112,10 +139,11 @@ Status PartialResultSetSource::ReadFromStream() {
       metadata_ = std::move(*result_set->mutable_metadata());
       // Copies the column names into a shared_ptr that will be shared with
       // every Row object returned from NextRow().
-      columns_ = std::make_shared<std::vector<std::string>>();
+      std::vector<std::string> names;
       for (auto const& field : metadata_->row_type().fields()) {
-        columns_->push_back(field.name());
+        names.push_back(field.name());
       }
+      columns_ = std::make_shared<ColumnIndex>(std::move(names));
     }
   }
 
@@ -146,6 +174,7 @@ Status PartialResultSetSource::ReadFromStream() {
   //
   // n.b. One value can span more than two responses (the `E1E2E3` case above);
   // the code "just works" without needing to treat that as a special-case.
+  int first = 0;
   if (chunk_) {
     if (new_values.empty()) {
       return Status(StatusCode::kInternal,
@@ -153,33 +182,165 @@ Status PartialResultSetSource::ReadFromStream() {
                     "to merge with prior chunked_value");
     }
     auto& front = new_values[0];
-    auto merge_status = MergeChunk(*chunk_, std::move(front));
-    if (!merge_status.ok()) {
-      return merge_status;
+    if (chunk_->kind_case() == google::protobuf::Value::kStringValue &&
+        front.kind_case() == google::protobuf::Value::kStringValue) {
+      auto status = AppendStringChunk(std::move(*front.mutable_string_value()));
+      if (!status.ok()) return status;
+      // The value continues into the next response.
+      if (result_set->chunked_value() && new_values.size() == 1) return {};
+      status = FinishStringChunk();
+      if (!status.ok()) return status;
+      first = 1;  // `front` has been merged into `buffer_`.
+    } else {
+      auto merge_status = MergeChunk(*chunk_, std::move(front));
+      if (!merge_status.ok()) {
+        return merge_status;
+      }
+      using std::swap;
+      swap(*chunk_, front);
     }
-    using std::swap;
-    swap(*chunk_, front);
     chunk_ = {};
   }
 
+  absl::optional<google::protobuf::Value> new_chunk;
   if (result_set->chunked_value()) {
     if (new_values.empty()) {
       return Status(StatusCode::kInternal,
                     "PartialResultSet had chunked_value "
                     "set true but contained no values");
     }
-    chunk_ = std::move(new_values[new_values.size() - 1]);
+    new_chunk = std::move(new_values[new_values.size() - 1]);
     new_values.RemoveLast();
   }
 
   // Moves all the remaining in new_values to buffer_
-  for (auto& value_proto : new_values) {
-    buffer_.push_back(std::move(value_proto));
+  for (int i = first; i < new_values.size(); ++i) {
+    auto status = BufferValue(std::move(new_values[i]));
+    if (!status.ok()) return status;
+  }
+
+  if (new_chunk) {
+    chunk_ = std::move(new_chunk);
+    if (chunk_->kind_case() == google::protobuf::Value::kStringValue) {
+      return StartStringChunk();
+    }
   }
 
   return {};  // OK
 }
 
+Status PartialResultSetSource::BufferValue(google::protobuf::Value value) {
+  if (!sinks_.empty() &&
+      value.kind_case() == google::protobuf::Value::kStringValue) {
+    auto const column = buffer_.size() % sinks_.size();
+    if (sinks_[column].sink) {
+      auto status =
+          Sink(column, std::move(*value.mutable_string_value()), true);
+      if (!status.ok()) return status;
+      value.set_string_value(std::string{});
+    }
+  }
+  buffer_.push_back(std::move(value));
+  return {};
+}
+
+Status PartialResultSetSource::StartStringChunk() {
+  chunk_pieces_.clear();
+  chunk_sunk_ = false;
+  if (sinks_.empty()) return {};
+  chunk_column_ = buffer_.size() % sinks_.size();
+  if (!sinks_[chunk_column_].sink) return {};
+  chunk_sunk_ = true;
+  auto piece = std::move(*chunk_->mutable_string_value());
+  chunk_->set_string_value(std::string{});
+  return Sink(chunk_column_, std::move(piece), false);
+}
+
+Status PartialResultSetSource::AppendStringChunk(std::string piece) {
+  if (chunk_sunk_) return Sink(chunk_column_, std::move(piece), false);
+  chunk_pieces_.push_back(std::move(piece));
+  return {};
+}
+
+Status PartialResultSetSource::FinishStringChunk() {
+  if (chunk_sunk_) {
+    chunk_sunk_ = false;
+    // The value was delivered to the sink as it arrived.
+    buffer_.emplace_back();
+    buffer_.back().set_string_value(std::string{});
+    return Sink(chunk_column_, std::string{}, true);
+  }
+  auto& str = *chunk_->mutable_string_value();
+  auto size = str.size();
+  for (auto const& p : chunk_pieces_) size += p.size();
+  str.reserve(size);
+  for (auto const& p : chunk_pieces_) str += p;
+  chunk_pieces_.clear();
+  buffer_.push_back(std::move(*chunk_));
+  return {};
+}
+
+Status PartialResultSetSource::Sink(std::size_t column, std::string piece,
+                                    bool last) {
+  auto const& info = sinks_[column];
+  if (!info.is_bytes) {
+    info.sink(std::move(piece), last);
+    return {};
+  }
+  // Decode the complete groups of 4 base64 characters, and keep the rest
+  // until the next piece arrives.
+  base64_carry_ += piece;
+  auto const n = last ? base64_carry_.size() : base64_carry_.size() / 4 * 4;
+  auto bytes = BytesFromBase64(base64_carry_.substr(0, n));
+  if (!bytes) {
+    base64_carry_.clear();
+    return Status(StatusCode::kInternal,
+                  "invalid BYTES value: " + bytes.status().message());
+  }
+  base64_carry_.erase(0, n);
+  info.sink(bytes->get<std::string>(), last);
+  return {};
+}
+
+Status PartialResultSetSource::SetColumnSink(std::string const& name,
+                                             ColumnSink sink) {
+  auto const pos = columns_->Find(name);
+  if (pos == columns_->size()) {
+    return Status(StatusCode::kInvalidArgument,
+                  "column name not found: " + name);
+  }
+  auto const code = metadata_->row_type().fields(static_cast<int>(pos))
+                        .type()
+                        .code();
+  if (code != google::spanner::v1::TypeCode::STRING &&
+      code != google::spanner::v1::TypeCode::BYTES) {
+    return Status(StatusCode::kInvalidArgument,
+                  "column " + name + " is not a STRING or BYTES column");
+  }
+  sinks_.resize(columns_->size());
+  sinks_[pos] = {std::move(sink), code == google::spanner::v1::TypeCode::BYTES};
+
+  // Deliver any values that were received before the sink was set.
+  for (std::size_t i = pos; i < buffer_.size(); i += sinks_.size()) {
+    auto& value = buffer_[i];
+    if (value.kind_case() != google::protobuf::Value::kStringValue) continue;
+    auto status = Sink(pos, std::move(*value.mutable_string_value()), true);
+    if (!status.ok()) return status;
+    value.set_string_value(std::string{});
+  }
+  if (chunk_ && chunk_->kind_case() == google::protobuf::Value::kStringValue &&
+      buffer_.size() % sinks_.size() == pos) {
+    auto pieces = std::move(chunk_pieces_);
+    auto status = StartStringChunk();
+    for (auto& p : pieces) {
+      if (!status.ok()) break;
+      status = AppendStringChunk(std::move(p));
+    }
+    if (!status.ok()) return status;
+  }
+  return {};
+}
+
 }  // namespace internal
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
@@ -27,6 +27,8 @@
 #include <grpcpp/grpcpp.h>
 #include <deque>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -49,6 +51,9 @@ class PartialResultSetSource : public internal::ResultSourceInterface {
 
   StatusOr<Row> NextRow() override;
 
+  bool SupportsRowProtos() const override { return true; }
+  Status NextRowProtos(std::vector<google::protobuf::Value>& values) override;
+
   absl::optional<google::spanner::v1::ResultSetMetadata> Metadata() override {
     return metadata_;
   }
@@ -57,19 +62,45 @@ class PartialResultSetSource : public internal::ResultSourceInterface {
     return stats_;
   }
 
+  Status SetColumnSink(std::string const& name, ColumnSink sink) override;
+
  private:
   explicit PartialResultSetSource(
       std::unique_ptr<PartialResultSetReader> reader)
       : reader_(std::move(reader)) {}
 
+  StatusOr<bool> BufferRow();
   Status ReadFromStream();
 
+  // Adds a (complete) value to `buffer_`, first delivering it to any sink for
+  // its column.
+  Status BufferValue(google::protobuf::Value value);
+  // Starts, continues, and completes a chunked STRING or BYTES value.
+  Status StartStringChunk();
+  Status AppendStringChunk(std::string piece);
+  Status FinishStringChunk();
+  Status Sink(std::size_t column, std::string piece, bool last);
+
+  struct ColumnSinkInfo {
+    ColumnSink sink;  // nullptr if the column has no sink
+    bool is_bytes;
+  };
+
   std::unique_ptr<PartialResultSetReader> reader_;
   absl::optional<google::spanner::v1::ResultSetMetadata> metadata_;
   absl::optional<google::spanner::v1::ResultSetStats> stats_;
   std::deque<google::protobuf::Value> buffer_;
   absl::optional<google::protobuf::Value> chunk_;
-  std::shared_ptr<std::vector<std::string>> columns_;
+  // A chunked STRING or BYTES value is kept as a rope: `chunk_` holds the
+  // first piece and `chunk_pieces_` the rest, so each piece is copied just
+  // once, when the value is complete. If the value goes to a sink, the pieces
+  // are delivered as they arrive instead.
+  std::vector<std::string> chunk_pieces_;
+  std::size_t chunk_column_ = 0;
+  bool chunk_sunk_ = false;
+  std::vector<ColumnSinkInfo> sinks_;  // indexed by column, or empty
+  std::string base64_carry_;  // BYTES characters not yet decoded for a sink
+  std::shared_ptr<ColumnIndex const> columns_;
   bool finished_ = false;
 };
 
@@ -24,6 +24,9 @@
 #include <array>
 #include <cstdint>
 #include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -721,6 +724,334 @@ TEST(PartialResultSetSourceTest, ErrorOnIncompleteRow) {
   EXPECT_THAT(row.status().message(), HasSubstr("incomplete row"));
 }
 
+/**
+ * @test Verify a column sink receives BYTES values decoded, as their chunks
+ * arrive, including values received before the sink was set.
+ */
+TEST(PartialResultSetSourceTest, ColumnSinkBytes) {
+  auto grpc_reader = absl::make_unique<MockPartialResultSetReader>();
+  std::array<char const*, 3> text{{
+      R"pb(
+        metadata: {
+          row_type: {
+            fields: {
+              name: "Id",
+              type: { code: INT64 }
+            }
+            fields: {
+              name: "Data",
+              type: { code: BYTES }
+            }
+          }
+        }
+        values: { string_value: "1" }
+        values: { string_value: "aGVsbG8=" }
+        values: { string_value: "2" }
+        values: { string_value: "VGhlIHF1aW" }
+        chunked_value: true
+      )pb",
+      R"pb(
+        values: { string_value: "NrIGJyb3duIGZveCBqdW" }
+        chunked_value: true
+      )pb",
+      R"pb(
+        values: { string_value: "1wcyBvdmVyIHRoZSBsYXp5IGRvZw==" }
+        values: { string_value: "3" }
+        values: { null_value: NULL_VALUE }
+      )pb",
+  }};
+  std::array<spanner_proto::PartialResultSet, text.size()> response;
+  for (std::size_t i = 0; i != text.size(); ++i) {
+    SCOPED_TRACE("Converting text to proto [" + std::to_string(i) + "]");
+    ASSERT_TRUE(TextFormat::ParseFromString(text[i], &response[i]));
+  }
+  EXPECT_CALL(*grpc_reader, Read())
+      .WillOnce(Return(response[0]))
+      .WillOnce(Return(response[1]))
+      .WillOnce(Return(response[2]))
+      .WillOnce(Return(absl::optional<spanner_proto::PartialResultSet>{}));
+  EXPECT_CALL(*grpc_reader, Finish()).WillOnce(Return(Status()));
+
+  auto reader = PartialResultSetSource::Create(std::move(grpc_reader));
+  ASSERT_STATUS_OK(reader);
+
+  std::vector<std::string> values;
+  std::string current;
+  int pieces = 0;
+  auto status = (*reader)->SetColumnSink(
+      "Data", [&](std::string piece, bool last) {
+        ++pieces;
+        current += piece;
+        if (!last) return;
+        values.push_back(std::move(current));
+        current.clear();
+      });
+  ASSERT_STATUS_OK(status);
+  // The complete value, and the first piece of the chunked value, were
+  // delivered immediately.
+  EXPECT_THAT(values, ::testing::ElementsAre("hello"));
+
+  auto const empty = Value(Bytes());
+  EXPECT_THAT(
+      (*reader)->NextRow(),
+      IsValidAndEquals(MakeTestRow({{"Id", Value(1)}, {"Data", empty}})));
+  EXPECT_THAT(
+      (*reader)->NextRow(),
+      IsValidAndEquals(MakeTestRow({{"Id", Value(2)}, {"Data", empty}})));
+  EXPECT_THAT(values,
+              ::testing::ElementsAre(
+                  "hello", "The quick brown fox jumps over the lazy dog"));
+  EXPECT_LT(2, pieces);
+  EXPECT_THAT((*reader)->NextRow(),
+              IsValidAndEquals(MakeTestRow(
+                  {{"Id", Value(3)}, {"Data", MakeNullValue<Bytes>()}})));
+  EXPECT_THAT((*reader)->NextRow(), IsValidAndEquals(Row{}));
+  EXPECT_EQ(2, values.size());
+}
+
+/// @test Verify a column sink set before a chunked STRING value arrives.
+TEST(PartialResultSetSourceTest, ColumnSinkString) {
+  auto grpc_reader = absl::make_unique<MockPartialResultSetReader>();
+  std::array<char const*, 3> text{{
+      R"pb(
+        metadata: {
+          row_type: {
+            fields: {
+              name: "Prose",
+              type: { code: STRING }
+            }
+          }
+        }
+      )pb",
+      R"pb(
+        values: { string_value: "first_chunk" }
+        chunked_value: true
+      )pb",
+      R"pb(
+        values: { string_value: "second_chunk" }
+        values: { string_value: "not_chunked" }
+      )pb",
+  }};
+  std::array<spanner_proto::PartialResultSet, text.size()> response;
+  for (std::size_t i = 0; i != text.size(); ++i) {
+    SCOPED_TRACE("Converting text to proto [" + std::to_string(i) + "]");
+    ASSERT_TRUE(TextFormat::ParseFromString(text[i], &response[i]));
+  }
+  EXPECT_CALL(*grpc_reader, Read())
+      .WillOnce(Return(response[0]))
+      .WillOnce(Return(response[1]))
+      .WillOnce(Return(response[2]))
+      .WillOnce(Return(absl::optional<spanner_proto::PartialResultSet>{}));
+  EXPECT_CALL(*grpc_reader, Finish()).WillOnce(Return(Status()));
+
+  auto reader = PartialResultSetSource::Create(std::move(grpc_reader));
+  ASSERT_STATUS_OK(reader);
+
+  std::vector<std::pair<std::string, bool>> pieces;
+  ASSERT_STATUS_OK((*reader)->SetColumnSink(
+      "Prose", [&pieces](std::string piece, bool last) {
+        pieces.emplace_back(std::move(piece), last);
+      }));
+
+  auto const empty = MakeTestRow({{"Prose", Value("")}});
+  EXPECT_THAT((*reader)->NextRow(), IsValidAndEquals(empty));
+  EXPECT_THAT((*reader)->NextRow(), IsValidAndEquals(empty));
+  EXPECT_THAT((*reader)->NextRow(), IsValidAndEquals(Row{}));
+  using Piece = std::pair<std::string, bool>;
+  EXPECT_THAT(pieces, ::testing::ElementsAre(
+                          Piece{"first_chunk", false},
+                          Piece{"second_chunk", false}, Piece{"", true},
+                          Piece{"not_chunked", true}));
+}
+
+/// @test Verify column sinks are only accepted for STRING and BYTES columns.
+TEST(PartialResultSetSourceTest, ColumnSinkErrors) {
+  auto grpc_reader = absl::make_unique<MockPartialResultSetReader>();
+  spanner_proto::PartialResultSet response;
+  ASSERT_TRUE(TextFormat::ParseFromString(
+      R"pb(
+        metadata: {
+          row_type: {
+            fields: {
+              name: "Id",
+              type: { code: INT64 }
+            }
+            fields: {
+              name: "Data",
+              type: { code: BYTES }
+            }
+          }
+        }
+        values: { string_value: "1" }
+        values: { string_value: "not base64" }
+      )pb",
+      &response));
+  EXPECT_CALL(*grpc_reader, Read()).WillOnce(Return(response));
+  EXPECT_CALL(*grpc_reader, TryCancel()).Times(1);
+  EXPECT_CALL(*grpc_reader, Finish()).WillOnce(Return(Status()));
+
+  auto reader = PartialResultSetSource::Create(std::move(grpc_reader));
+  ASSERT_STATUS_OK(reader);
+
+  auto sink = [](std::string, bool) {};
+  EXPECT_EQ(StatusCode::kInvalidArgument,
+            (*reader)->SetColumnSink("Missing", sink).code());
+  EXPECT_EQ(StatusCode::kInvalidArgument,
+            (*reader)->SetColumnSink("Id", sink).code());
+  auto status = (*reader)->SetColumnSink("Data", sink);
+  EXPECT_EQ(StatusCode::kInternal, status.code());
+  EXPECT_THAT(status.message(), HasSubstr("invalid BYTES value"));
+}
+
+/**
+ * @test Verify `NextRowProtos()` returns the value protos of each row, across
+ * responses, and then an empty row at the end of the stream.
+ */
+TEST(PartialResultSetSourceTest, NextRowProtos) {
+  auto grpc_reader = absl::make_unique<MockPartialResultSetReader>();
+  std::array<spanner_proto::PartialResultSet, 2> response;
+  ASSERT_TRUE(TextFormat::ParseFromString(
+      R"pb(
+        metadata: {
+          row_type: {
+            fields: {
+              name: "UserId",
+              type: { code: INT64 }
+            }
+            fields: {
+              name: "UserName",
+              type: { code: STRING }
+            }
+          }
+        }
+        values: { string_value: "10" }
+        values: { string_value: "user10" }
+        values: { string_value: "22" }
+      )pb",
+      &response[0]));
+  ASSERT_TRUE(TextFormat::ParseFromString(
+      R"pb(
+        values: { string_value: "user22" }
+      )pb",
+      &response[1]));
+  EXPECT_CALL(*grpc_reader, Read())
+      .WillOnce(Return(response[0]))
+      .WillOnce(Return(response[1]))
+      .WillOnce(Return(absl::optional<spanner_proto::PartialResultSet>{}));
+  EXPECT_CALL(*grpc_reader, Finish()).WillOnce(Return(Status()));
+
+  auto reader = PartialResultSetSource::Create(std::move(grpc_reader));
+  ASSERT_STATUS_OK(reader);
+
+  std::vector<google::protobuf::Value> values;
+  ASSERT_STATUS_OK((*reader)->NextRowProtos(values));
+  ASSERT_EQ(2, values.size());
+  EXPECT_EQ("10", values[0].string_value());
+  EXPECT_EQ("user10", values[1].string_value());
+
+  ASSERT_STATUS_OK((*reader)->NextRowProtos(values));
+  ASSERT_EQ(2, values.size());
+  EXPECT_EQ("22", values[0].string_value());
+  EXPECT_EQ("user22", values[1].string_value());
+
+  ASSERT_STATUS_OK((*reader)->NextRowProtos(values));
+  EXPECT_TRUE(values.empty());
+}
+
+/// @test Verify `StreamOf()` decodes a `RowStream` directly into tuples.
+TEST(PartialResultSetSourceTest, StreamOfTuples) {
+  auto grpc_reader = absl::make_unique<MockPartialResultSetReader>();
+  auto constexpr kText = R"pb(
+    metadata: {
+      row_type: {
+        fields: {
+          name: "UserId",
+          type: { code: INT64 }
+        }
+        fields: {
+          name: "UserName",
+          type: { code: STRING }
+        }
+        fields: {
+          name: "Scores",
+          type: {
+            code: ARRAY
+            array_element_type: { code: INT64 }
+          }
+        }
+      }
+    }
+    values: { string_value: "10" }
+    values: { string_value: "user10" }
+    values: {
+      list_value: {
+        values: { string_value: "1" }
+        values: { string_value: "2" }
+      }
+    }
+    values: { string_value: "22" }
+    values: { null_value: NULL_VALUE }
+    values: { list_value: {} }
+  )pb";
+  spanner_proto::PartialResultSet response;
+  ASSERT_TRUE(TextFormat::ParseFromString(kText, &response));
+  EXPECT_CALL(*grpc_reader, Read())
+      .WillOnce(Return(response))
+      .WillOnce(Return(absl::optional<spanner_proto::PartialResultSet>{}));
+  EXPECT_CALL(*grpc_reader, Finish()).WillOnce(Return(Status()));
+
+  auto reader = PartialResultSetSource::Create(std::move(grpc_reader));
+  ASSERT_STATUS_OK(reader);
+  RowStream rows(*std::move(reader));
+
+  using RowType = std::tuple<std::int64_t, absl::optional<std::string>,
+                             std::vector<std::int64_t>>;
+  std::vector<RowType> actual;
+  for (auto& row : StreamOf<RowType>(rows)) {
+    ASSERT_STATUS_OK(row);
+    actual.push_back(*std::move(row));
+  }
+  std::vector<RowType> const expected = {
+      RowType{10, "user10", {1, 2}},
+      RowType{22, absl::nullopt, {}},
+  };
+  EXPECT_EQ(expected, actual);
+}
+
+/// @test Verify `StreamOf()` reports a column type mismatch once, then ends.
+TEST(PartialResultSetSourceTest, StreamOfWrongType) {
+  auto grpc_reader = absl::make_unique<MockPartialResultSetReader>();
+  auto constexpr kText = R"pb(
+    metadata: {
+      row_type: {
+        fields: {
+          name: "UserId",
+          type: { code: INT64 }
+        }
+      }
+    }
+    values: { string_value: "10" }
+    values: { string_value: "22" }
+  )pb";
+  spanner_proto::PartialResultSet response;
+  ASSERT_TRUE(TextFormat::ParseFromString(kText, &response));
+  EXPECT_CALL(*grpc_reader, Read()).WillOnce(Return(response));
+  EXPECT_CALL(*grpc_reader, TryCancel()).Times(1);
+  EXPECT_CALL(*grpc_reader, Finish()).WillOnce(Return(Status()));
+
+  auto reader = PartialResultSetSource::Create(std::move(grpc_reader));
+  ASSERT_STATUS_OK(reader);
+  RowStream rows(*std::move(reader));
+
+  int count = 0;
+  for (auto& row : StreamOf<std::tuple<std::string>>(rows)) {
+    EXPECT_FALSE(row.ok());
+    EXPECT_EQ(StatusCode::kUnknown, row.status().code());
+    ++count;
+  }
+  EXPECT_EQ(1, count);
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace SPANNER_CLIENT_NS
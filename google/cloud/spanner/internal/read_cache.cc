@@ -0,0 +1,286 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/read_cache.h"
+#include "google/cloud/spanner/keys.h"
+#include "google/cloud/spanner/transaction.h"
+#include "absl/memory/memory.h"
+#include "absl/time/time.h"
+#include <algorithm>
+#include <chrono>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+namespace spanner_proto = ::google::spanner::v1;
+
+namespace {
+
+spanner_proto::ResultSetMetadata MakeMetadata(
+    absl::optional<Timestamp> const& read_timestamp) {
+  spanner_proto::ResultSetMetadata metadata;
+  if (read_timestamp) {
+    *metadata.mutable_transaction()->mutable_read_timestamp() =
+        TimestampToProto(*read_timestamp);
+  }
+  return metadata;
+}
+
+// Returns the rows of a cached result. The rows are shared by all the readers
+// of the entry, and copied as they are returned.
+template <typename Entry>
+class CachedResultSource : public ResultSourceInterface {
+ public:
+  explicit CachedResultSource(std::shared_ptr<Entry const> entry)
+      : entry_(std::move(entry)) {}
+
+  StatusOr<Row> NextRow() override {
+    if (next_ == entry_->rows.size()) return Row();
+    return entry_->rows[next_++];
+  }
+  absl::optional<spanner_proto::ResultSetMetadata> Metadata() override {
+    return MakeMetadata(entry_->read_timestamp);
+  }
+  absl::optional<spanner_proto::ResultSetStats> Stats() const override {
+    return {};
+  }
+
+ private:
+  std::shared_ptr<Entry const> entry_;
+  std::size_t next_ = 0;
+};
+
+// Returns the rows received while trying to fill a cache entry, followed by
+// the rest of the original stream.
+class PassThroughSource : public ResultSourceInterface {
+ public:
+  PassThroughSource(std::vector<Row> rows, std::unique_ptr<RowStream> stream,
+                    RowStreamIterator next)
+      : rows_(std::move(rows)),
+        stream_(std::move(stream)),
+        next_(std::move(next)) {}
+
+  StatusOr<Row> NextRow() override {
+    if (prefix_ != rows_.size()) return std::move(rows_[prefix_++]);
+    if (next_ == stream_->end()) return Row();
+    auto row = std::move(*next_);
+    ++next_;
+    return row;
+  }
+  absl::optional<spanner_proto::ResultSetMetadata> Metadata() override {
+    return MakeMetadata(stream_->ReadTimestamp());
+  }
+  absl::optional<spanner_proto::ResultSetStats> Stats() const override {
+    return {};
+  }
+
+ private:
+  std::vector<Row> rows_;
+  std::size_t prefix_ = 0;
+  std::unique_ptr<RowStream> stream_;
+  RowStreamIterator next_;
+};
+
+Timestamp SystemClockNow() {
+  return *MakeTimestamp(std::chrono::system_clock::now());
+}
+
+}  // namespace
+
+ReadCache::ReadCache(ReadCacheOptions const& options, Clock clock)
+    : max_entries_per_shard_((std::max<std::size_t>)(
+          1, (options.max_entries() + (std::max)(options.num_shards(), 1) - 1) /
+                 (std::max)(options.num_shards(), 1))),
+      max_rows_per_entry_(options.max_rows_per_entry()),
+      clock_(clock ? std::move(clock) : Clock(SystemClockNow)) {
+  auto const num_shards = (std::max)(options.num_shards(), 1);
+  shards_.reserve(num_shards);
+  for (int i = 0; i != num_shards; ++i) {
+    shards_.push_back(absl::make_unique<Shard>());
+  }
+}
+
+RowStream ReadCache::Read(Connection::ReadParams params,
+                          ReadFunction const& read) {
+  auto key = ReadCacheKey(params, clock_());
+  if (!key) return read(std::move(params));
+  auto const& oldest = key->second;
+  auto& shard = *shards_[std::hash<std::string>{}(key->first) % shards_.size()];
+  auto cached = [](std::shared_ptr<Entry const> entry) {
+    return RowStream(
+        absl::make_unique<CachedResultSource<Entry>>(std::move(entry)));
+  };
+
+  std::shared_ptr<Pending> pending;
+  {
+    std::unique_lock<std::mutex> lk(shard.mu);
+    auto i = shard.index.find(key->first);
+    bool const found = i != shard.index.end();
+    if (found && i->second->second->read_timestamp >= oldest) {
+      shard.lru.splice(shard.lru.begin(), shard.lru, i->second);
+      ++hits_;
+      return cached(i->second->second);
+    }
+    auto p = shard.pending.find(key->first);
+    if (p != shard.pending.end()) {
+      auto waiting = p->second;
+      waiting->cv.wait(lk, [&waiting] { return waiting->done; });
+      if (waiting->entry && waiting->entry->read_timestamp >= oldest) {
+        ++coalesced_;
+        return cached(waiting->entry);
+      }
+    }
+    ++misses_;
+    if (found) ++stale_misses_;
+    if (shard.pending.find(key->first) == shard.pending.end()) {
+      pending = std::make_shared<Pending>();
+      shard.pending.emplace(key->first, pending);
+    }
+  }
+  return ReadAndFill(shard, key->first, pending, std::move(params), read);
+}
+
+RowStream ReadCache::ReadAndFill(Shard& shard, std::string const& key,
+                                 std::shared_ptr<Pending> const& pending,
+                                 Connection::ReadParams params,
+                                 ReadFunction const& read) {
+  // The stream is heap-allocated because its iterators refer to it.
+  auto stream = absl::make_unique<RowStream>(read(std::move(params)));
+  std::vector<Row> rows;
+  auto next = stream->begin();
+  bool complete = true;
+  for (; next != stream->end(); ++next) {
+    if (!*next || rows.size() == max_rows_per_entry_) {
+      complete = false;
+      break;
+    }
+    rows.push_back(*std::move(*next));
+  }
+
+  std::shared_ptr<Entry const> entry;
+  auto const read_timestamp = stream->ReadTimestamp();
+  if (complete && read_timestamp) {
+    entry = std::make_shared<Entry const>(
+        Entry{*read_timestamp, std::move(rows)});
+  } else {
+    ++uncacheable_;
+  }
+  {
+    std::lock_guard<std::mutex> lk(shard.mu);
+    if (entry) Insert(shard, key, entry);
+    if (pending) {
+      pending->entry = entry;
+      pending->done = true;
+      shard.pending.erase(key);
+      pending->cv.notify_all();
+    }
+  }
+  if (entry) {
+    return RowStream(absl::make_unique<CachedResultSource<Entry>>(entry));
+  }
+  return RowStream(absl::make_unique<PassThroughSource>(
+      std::move(rows), std::move(stream), std::move(next)));
+}
+
+void ReadCache::Insert(Shard& shard, std::string const& key,
+                       std::shared_ptr<Entry const> entry) {
+  auto i = shard.index.find(key);
+  if (i != shard.index.end()) {
+    // Keep the fresher result, if another caller raced with this one.
+    auto& current = i->second->second;
+    if (current->read_timestamp < entry->read_timestamp) {
+      current = std::move(entry);
+    }
+    shard.lru.splice(shard.lru.begin(), shard.lru, i->second);
+    return;
+  }
+  shard.lru.emplace_front(key, std::move(entry));
+  shard.index.emplace(key, shard.lru.begin());
+  while (shard.lru.size() > max_entries_per_shard_) {
+    shard.index.erase(shard.lru.back().first);
+    shard.lru.pop_back();
+    ++evictions_;
+  }
+}
+
+ReadCacheMetrics ReadCache::Metrics() const {
+  ReadCacheMetrics metrics;
+  metrics.hits = hits_.load();
+  metrics.coalesced = coalesced_.load();
+  metrics.misses = misses_.load();
+  metrics.stale_misses = stale_misses_.load();
+  metrics.uncacheable = uncacheable_.load();
+  metrics.evictions = evictions_.load();
+  for (auto const& shard : shards_) {
+    std::lock_guard<std::mutex> lk(shard->mu);
+    metrics.entries += shard->lru.size();
+  }
+  return metrics;
+}
+
+std::shared_ptr<ReadCache> MakeReadCache(ReadCacheOptions const& options) {
+  if (options.max_entries() == 0) return nullptr;
+  return std::make_shared<ReadCache>(options);
+}
+
+absl::optional<std::pair<std::string, Timestamp>> ReadCacheKey(
+    Connection::ReadParams const& params, Timestamp now) {
+  if (params.partition_token) return {};
+
+  // Only single-use transactions with a bounded staleness can be cached.
+  absl::optional<Timestamp> oldest;
+  Visit(params.transaction,
+        [&](SessionHolder&, StatusOr<spanner_proto::TransactionSelector>& s,
+            std::int64_t) {
+          if (!s || !s->has_single_use()) return 0;
+          if (!s->single_use().has_read_only()) return 0;
+          auto const& ro = s->single_use().read_only();
+          if (ro.has_max_staleness()) {
+            auto const& d = ro.max_staleness();
+            auto t = MakeTimestamp(*now.get<absl::Time>() -
+                                   absl::Seconds(d.seconds()) -
+                                   absl::Nanoseconds(d.nanos()));
+            if (t) oldest = *t;
+          } else if (ro.has_min_read_timestamp()) {
+            auto t = TimestampFromProto(ro.min_read_timestamp());
+            if (t) oldest = *t;
+          }
+          return 0;
+        });
+  if (!oldest) return {};
+
+  // The components are separated by characters that cannot appear in table,
+  // index or column names.
+  std::string key = params.table;
+  key += '\0';
+  key += params.read_options.index_name;
+  key += '\0';
+  key += std::to_string(params.read_options.limit);
+  for (auto const& column : params.columns) {
+    key += '\0';
+    key += column;
+  }
+  key += '\1';
+  ToProto(params.keys).AppendToString(&key);
+  return std::make_pair(std::move(key), *oldest);
+}
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
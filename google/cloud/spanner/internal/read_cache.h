@@ -0,0 +1,126 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_READ_CACHE_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_READ_CACHE_H
+
+#include "google/cloud/spanner/connection.h"
+#include "google/cloud/spanner/read_cache_options.h"
+#include "google/cloud/spanner/results.h"
+#include "google/cloud/spanner/row.h"
+#include "google/cloud/spanner/timestamp.h"
+#include "google/cloud/spanner/version.h"
+#include "absl/types/optional.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+/**
+ * A sharded, LRU-bounded cache for single-use, bounded-staleness reads.
+ *
+ * See `ReadCacheOptions` for the behavior. All the member functions are
+ * thread-safe.
+ */
+class ReadCache {
+ public:
+  using Clock = std::function<Timestamp()>;
+  using ReadFunction = std::function<RowStream(Connection::ReadParams)>;
+
+  explicit ReadCache(ReadCacheOptions const& options, Clock clock = {});
+
+  /**
+   * Returns the result of the read described by @p params.
+   *
+   * Cacheable reads are served from the cache when possible, otherwise (and
+   * for reads that are not cacheable) the result comes from calling @p read.
+   */
+  RowStream Read(Connection::ReadParams params, ReadFunction const& read);
+
+  ReadCacheMetrics Metrics() const;
+
+ private:
+  // A complete result, and the timestamp it was read at.
+  struct Entry {
+    Timestamp read_timestamp;
+    std::vector<Row> rows;
+  };
+
+  // An identical read in flight, other callers wait for its result.
+  struct Pending {
+    std::condition_variable cv;
+    bool done = false;
+    std::shared_ptr<Entry const> entry;
+  };
+
+  struct Shard {
+    using LruList =
+        std::list<std::pair<std::string, std::shared_ptr<Entry const>>>;
+    std::mutex mu;
+    LruList lru;  // Most recently used first.
+    std::unordered_map<std::string, LruList::iterator> index;
+    std::unordered_map<std::string, std::shared_ptr<Pending>> pending;
+  };
+
+  RowStream ReadAndFill(Shard& shard, std::string const& key,
+                        std::shared_ptr<Pending> const& pending,
+                        Connection::ReadParams params,
+                        ReadFunction const& read);
+  void Insert(Shard& shard, std::string const& key,
+              std::shared_ptr<Entry const> entry);  // EXCLUSIVE_LOCKS_REQUIRED
+
+  std::size_t const max_entries_per_shard_;
+  std::size_t const max_rows_per_entry_;
+  Clock clock_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+
+  std::atomic<std::uint64_t> hits_{0};
+  std::atomic<std::uint64_t> coalesced_{0};
+  std::atomic<std::uint64_t> misses_{0};
+  std::atomic<std::uint64_t> stale_misses_{0};
+  std::atomic<std::uint64_t> uncacheable_{0};
+  std::atomic<std::uint64_t> evictions_{0};
+};
+
+/// Returns a cache configured with @p options, or nullptr if it is disabled.
+std::shared_ptr<ReadCache> MakeReadCache(ReadCacheOptions const& options);
+
+/**
+ * Returns the key for the read described by @p params, or an empty optional
+ * if the read cannot be cached. Also returns the oldest acceptable read
+ * timestamp, computed using @p now.
+ */
+absl::optional<std::pair<std::string, Timestamp>> ReadCacheKey(
+    Connection::ReadParams const& params, Timestamp now);
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_READ_CACHE_H
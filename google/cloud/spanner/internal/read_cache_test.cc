@@ -0,0 +1,345 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/read_cache.h"
+#include "google/cloud/spanner/timestamp.h"
+#include "google/cloud/spanner/transaction.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+namespace {
+
+namespace spanner_proto = ::google::spanner::v1;
+using ::testing::ElementsAre;
+
+// A result set with the given rows, read at `read_timestamp`, optionally
+// followed by an error.
+class FakeSource : public ResultSourceInterface {
+ public:
+  FakeSource(std::vector<std::int64_t> values, Timestamp read_timestamp,
+             Status error = {})
+      : values_(std::move(values)),
+        read_timestamp_(read_timestamp),
+        error_(std::move(error)) {}
+
+  StatusOr<Row> NextRow() override {
+    if (next_ != values_.size()) return MakeTestRow(values_[next_++]);
+    if (!error_.ok()) return error_;
+    return Row();
+  }
+  absl::optional<spanner_proto::ResultSetMetadata> Metadata() override {
+    spanner_proto::ResultSetMetadata metadata;
+    *metadata.mutable_transaction()->mutable_read_timestamp() =
+        TimestampToProto(read_timestamp_);
+    return metadata;
+  }
+  absl::optional<spanner_proto::ResultSetStats> Stats() const override {
+    return {};
+  }
+
+ private:
+  std::vector<std::int64_t> values_;
+  std::size_t next_ = 0;
+  Timestamp read_timestamp_;
+  Status error_;
+};
+
+Timestamp At(std::int64_t seconds) {
+  return *MakeTimestamp(absl::FromUnixSeconds(1600000000 + seconds));
+}
+
+Connection::ReadParams MakeParams(Transaction::SingleUseOptions opts,
+                                  std::string table = "T",
+                                  KeySet keys = KeySet::All()) {
+  return {MakeSingleUseTransaction(std::move(opts)),
+          std::move(table),
+          std::move(keys),
+          {"C"},
+          ReadOptions{},
+          {}};
+}
+
+std::vector<std::int64_t> Values(RowStream& rows) {
+  std::vector<std::int64_t> values;
+  for (auto& row : StreamOf<std::tuple<std::int64_t>>(rows)) {
+    if (!row) break;
+    values.push_back(std::get<0>(*row));
+  }
+  return values;
+}
+
+class ReadCacheTest : public ::testing::Test {
+ protected:
+  ReadCacheTest() : cache_(MakeOptions(), [this] { return now_; }) {}
+
+  static ReadCacheOptions MakeOptions() {
+    return ReadCacheOptions{}.set_max_entries(2).set_num_shards(1);
+  }
+
+  // Returns a read function yielding `values`, read at `read_timestamp`.
+  ReadCache::ReadFunction Returns(std::vector<std::int64_t> values,
+                                  Timestamp read_timestamp) {
+    return [this, values, read_timestamp](Connection::ReadParams const&) {
+      ++reads_;
+      return RowStream(absl::make_unique<FakeSource>(values, read_timestamp));
+    };
+  }
+
+  Timestamp now_ = At(0);
+  ReadCache cache_;
+  int reads_ = 0;
+};
+
+TEST(ReadCacheKey, Cacheable) {
+  auto const now = At(0);
+  auto max_staleness = ReadCacheKey(
+      MakeParams(Transaction::SingleUseOptions(std::chrono::seconds(10))), now);
+  ASSERT_TRUE(max_staleness.has_value());
+  EXPECT_EQ(At(-10), max_staleness->second);
+
+  auto min_read_timestamp =
+      ReadCacheKey(MakeParams(Transaction::SingleUseOptions(At(-3))), now);
+  ASSERT_TRUE(min_read_timestamp.has_value());
+  EXPECT_EQ(At(-3), min_read_timestamp->second);
+  EXPECT_EQ(max_staleness->first, min_read_timestamp->first);
+}
+
+TEST(ReadCacheKey, NotCacheable) {
+  auto const now = At(0);
+  // Strong reads.
+  EXPECT_FALSE(ReadCacheKey(MakeParams(Transaction::ReadOnlyOptions()), now));
+  // Exact staleness.
+  EXPECT_FALSE(ReadCacheKey(
+      MakeParams(Transaction::ReadOnlyOptions(std::chrono::seconds(10))), now));
+
+  // Multi-use transactions.
+  auto params =
+      MakeParams(Transaction::SingleUseOptions(std::chrono::seconds(10)));
+  params.transaction = MakeReadOnlyTransaction();
+  EXPECT_FALSE(ReadCacheKey(params, now));
+
+  // Partitioned reads.
+  params = MakeParams(Transaction::SingleUseOptions(std::chrono::seconds(10)));
+  params.partition_token = "token";
+  EXPECT_FALSE(ReadCacheKey(params, now));
+}
+
+TEST(ReadCacheKey, Distinct) {
+  auto const now = At(0);
+  auto const opts = Transaction::SingleUseOptions(std::chrono::seconds(10));
+  auto key = [&now](Connection::ReadParams const& params) {
+    return ReadCacheKey(params, now)->first;
+  };
+  auto const base = key(MakeParams(opts));
+  EXPECT_EQ(base, key(MakeParams(opts)));
+  EXPECT_NE(base, key(MakeParams(opts, "U")));
+  EXPECT_NE(base, key(MakeParams(opts, "T", KeySet().AddKey(MakeKey(1)))));
+  auto params = MakeParams(opts);
+  params.columns.push_back("D");
+  EXPECT_NE(base, key(params));
+  params = MakeParams(opts);
+  params.read_options.index_name = "I";
+  EXPECT_NE(base, key(params));
+  params = MakeParams(opts);
+  params.read_options.limit = 5;
+  EXPECT_NE(base, key(params));
+}
+
+TEST_F(ReadCacheTest, HitWithinBound) {
+  auto const opts = Transaction::SingleUseOptions(std::chrono::seconds(10));
+  auto rows = cache_.Read(MakeParams(opts), Returns({1, 2}, At(-5)));
+  EXPECT_THAT(Values(rows), ElementsAre(1, 2));
+  EXPECT_EQ(1, reads_);
+
+  rows = cache_.Read(MakeParams(opts), Returns({3}, At(0)));
+  EXPECT_EQ(1, reads_);
+  EXPECT_EQ(At(-5), rows.ReadTimestamp());
+  EXPECT_THAT(Values(rows), ElementsAre(1, 2));
+
+  auto metrics = cache_.Metrics();
+  EXPECT_EQ(1, metrics.hits);
+  EXPECT_EQ(1, metrics.misses);
+  EXPECT_EQ(0, metrics.stale_misses);
+  EXPECT_EQ(1, metrics.entries);
+}
+
+TEST_F(ReadCacheTest, StaleMiss) {
+  auto const opts = Transaction::SingleUseOptions(std::chrono::seconds(10));
+  auto rows = cache_.Read(MakeParams(opts), Returns({1}, At(-5)));
+  EXPECT_THAT(Values(rows), ElementsAre(1));
+
+  // The cached result is now older than the bound.
+  now_ = At(10);
+  rows = cache_.Read(MakeParams(opts), Returns({2}, At(9)));
+  EXPECT_THAT(Values(rows), ElementsAre(2));
+  EXPECT_EQ(2, reads_);
+
+  // The fresher result replaced the old one.
+  rows = cache_.Read(MakeParams(opts), Returns({3}, At(10)));
+  EXPECT_THAT(Values(rows), ElementsAre(2));
+  EXPECT_EQ(2, reads_);
+
+  // A tighter bound is a miss, even if the entry is recent.
+  rows = cache_.Read(MakeParams(Transaction::SingleUseOptions(At(10))),
+                     Returns({4}, At(10)));
+  EXPECT_THAT(Values(rows), ElementsAre(4));
+  EXPECT_EQ(3, reads_);
+
+  auto metrics = cache_.Metrics();
+  EXPECT_EQ(1, metrics.hits);
+  EXPECT_EQ(3, metrics.misses);
+  EXPECT_EQ(2, metrics.stale_misses);
+}
+
+TEST_F(ReadCacheTest, NotCacheable) {
+  auto rows = cache_.Read(MakeParams(Transaction::ReadOnlyOptions()),
+                          Returns({1}, At(0)));
+  EXPECT_THAT(Values(rows), ElementsAre(1));
+  rows = cache_.Read(MakeParams(Transaction::ReadOnlyOptions()),
+                     Returns({1}, At(0)));
+  EXPECT_THAT(Values(rows), ElementsAre(1));
+  EXPECT_EQ(2, reads_);
+
+  auto metrics = cache_.Metrics();
+  EXPECT_EQ(0, metrics.hits);
+  EXPECT_EQ(0, metrics.misses);
+  EXPECT_EQ(0, metrics.entries);
+}
+
+TEST_F(ReadCacheTest, LruEviction) {
+  auto const opts = Transaction::SingleUseOptions(std::chrono::seconds(10));
+  for (auto const* table : {"A", "B", "A", "C"}) {
+    auto rows = cache_.Read(MakeParams(opts, table), Returns({1}, At(0)));
+    EXPECT_THAT(Values(rows), ElementsAre(1));
+  }
+  EXPECT_EQ(3, reads_);
+
+  // "B" was the least recently used entry.
+  auto rows = cache_.Read(MakeParams(opts, "A"), Returns({1}, At(0)));
+  EXPECT_EQ(3, reads_);
+  rows = cache_.Read(MakeParams(opts, "B"), Returns({1}, At(0)));
+  EXPECT_EQ(4, reads_);
+
+  auto metrics = cache_.Metrics();
+  EXPECT_EQ(2, metrics.evictions);
+  EXPECT_EQ(2, metrics.entries);
+}
+
+TEST(ReadCache, TooManyRows) {
+  auto const options =
+      ReadCacheOptions{}.set_max_entries(10).set_max_rows_per_entry(2);
+  ReadCache cache(options, [] { return At(0); });
+  auto const opts = Transaction::SingleUseOptions(std::chrono::seconds(10));
+  int reads = 0;
+  auto read = [&reads](Connection::ReadParams const&) {
+    ++reads;
+    return RowStream(absl::make_unique<FakeSource>(
+        std::vector<std::int64_t>{1, 2, 3}, At(0)));
+  };
+  for (int i = 0; i != 2; ++i) {
+    auto rows = cache.Read(MakeParams(opts), read);
+    EXPECT_EQ(At(0), rows.ReadTimestamp());
+    EXPECT_THAT(Values(rows), ElementsAre(1, 2, 3));
+  }
+  EXPECT_EQ(2, reads);
+  auto metrics = cache.Metrics();
+  EXPECT_EQ(2, metrics.uncacheable);
+  EXPECT_EQ(0, metrics.entries);
+}
+
+TEST(ReadCache, Error) {
+  ReadCache cache(ReadCacheOptions{}.set_max_entries(10),
+                  [] { return At(0); });
+  auto const opts = Transaction::SingleUseOptions(std::chrono::seconds(10));
+  auto rows = cache.Read(MakeParams(opts), [](Connection::ReadParams const&) {
+    return RowStream(absl::make_unique<FakeSource>(
+        std::vector<std::int64_t>{1}, At(0),
+        Status(StatusCode::kUnavailable, "try-again")));
+  });
+  std::vector<StatusOr<Row>> results;
+  for (auto& row : rows) results.push_back(std::move(row));
+  ASSERT_EQ(2, results.size());
+  EXPECT_STATUS_OK(results[0]);
+  EXPECT_EQ(StatusCode::kUnavailable, results[1].status().code());
+
+  auto metrics = cache.Metrics();
+  EXPECT_EQ(1, metrics.uncacheable);
+  EXPECT_EQ(0, metrics.entries);
+}
+
+TEST(ReadCache, CoalesceConcurrentMisses) {
+  ReadCache cache(ReadCacheOptions{}.set_max_entries(10),
+                  [] { return At(0); });
+  auto const opts = Transaction::SingleUseOptions(std::chrono::seconds(10));
+  std::atomic<int> reads{0};
+  std::promise<void> started;
+  std::promise<void> release;
+  auto release_future = release.get_future().share();
+  auto read = [&](Connection::ReadParams const&) {
+    if (++reads == 1) started.set_value();
+    release_future.wait();
+    return RowStream(absl::make_unique<FakeSource>(
+        std::vector<std::int64_t>{7}, At(0)));
+  };
+
+  std::vector<std::int64_t> leader;
+  std::thread t([&] {
+    auto rows = cache.Read(MakeParams(opts), read);
+    leader = Values(rows);
+  });
+  started.get_future().wait();
+
+  // These readers wait for the leader, or find its result in the cache.
+  std::vector<std::vector<std::int64_t>> followers(3);
+  std::vector<std::thread> threads;
+  for (auto& f : followers) {
+    threads.emplace_back([&] {
+      auto rows = cache.Read(MakeParams(opts), read);
+      f = Values(rows);
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  release.set_value();
+  t.join();
+  for (auto& thread : threads) thread.join();
+
+  EXPECT_EQ(1, reads.load());
+  EXPECT_THAT(leader, ElementsAre(7));
+  for (auto const& f : followers) EXPECT_THAT(f, ElementsAre(7));
+  auto metrics = cache.Metrics();
+  EXPECT_EQ(1, metrics.misses);
+  EXPECT_EQ(3, metrics.hits + metrics.coalesced);
+}
+
+TEST(ReadCache, MakeReadCache) {
+  EXPECT_EQ(nullptr, MakeReadCache(ReadCacheOptions{}));
+  EXPECT_NE(nullptr, MakeReadCache(ReadCacheOptions{}.set_max_entries(1)));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
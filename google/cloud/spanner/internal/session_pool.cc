@@ -14,6 +14,7 @@
 
 #include "google/cloud/spanner/internal/session_pool.h"
 #include "google/cloud/spanner/internal/connection_impl.h"
+#include "google/cloud/spanner/internal/load_tracking_spanner_stub.h"
 #include "google/cloud/spanner/internal/retry_loop.h"
 #include "google/cloud/spanner/internal/session.h"
 #include "google/cloud/completion_queue.h"
@@ -23,7 +24,8 @@
 #include "absl/memory/memory.h"
 #include <algorithm>
 #include <chrono>
-#include <random>
+#include <iterator>
+#include <limits>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -36,6 +38,36 @@ namespace internal {
 
 namespace spanner_proto = ::google::spanner::v1;
 
+namespace {
+
+// How long `ChannelHealth()` reuses its cached classification.
+auto constexpr kChannelHealthRefreshInterval = std::chrono::seconds(1);
+
+/**
+ * Records the asynchronous RPC started by @p call in @p load.
+ *
+ * The RPC completes in the `CompletionQueue`, where `LoadTrackingSpannerStub`
+ * cannot observe it. Its completion time includes any retries, so it is
+ * recorded as `kWorkload`, and only its status is used to judge the channel.
+ */
+template <typename Functor>
+auto TrackAsync(std::shared_ptr<ChannelLoad> load, Functor&& call)
+    -> decltype(call()) {
+  using ResultFuture = decltype(call());
+  load->RpcStarted();
+  auto const start = ChannelLoad::Clock::now();
+  return call().then([load, start](ResultFuture f) {
+    auto result = f.get();
+    load->RpcCompleted(ChannelLoad::RpcKind::kWorkload,
+                       ChannelLoad::Clock::now() - start,
+                       result.status().code());
+    load->RpcFinished();
+    return result;
+  });
+}
+
+}  // namespace
+
 std::shared_ptr<SessionPool> MakeSessionPool(
     Database db, std::vector<std::shared_ptr<SpannerStub>> stubs,
     SessionPoolOptions options, google::cloud::CompletionQueue cq,
@@ -64,8 +96,7 @@ SessionPool::SessionPool(Database db,
       backoff_policy_prototype_(std::move(backoff_policy)),
       clock_(std::move(clock)),
       max_pool_size_(options_.max_sessions_per_channel() *
-                     static_cast<int>(stubs.size())),
-      random_generator_(std::random_device()()) {
+                     static_cast<int>(stubs.size())) {
   if (stubs.empty()) {
     google::cloud::internal::ThrowInvalidArgument(
         "SessionPool requires a non-empty set of stubs");
@@ -73,8 +104,15 @@ SessionPool::SessionPool(Database db,
 
   channels_.reserve(stubs.size());
   for (auto& stub : stubs) {
-    channels_.push_back(std::make_shared<Channel>(std::move(stub)));
+    // Track the load on each channel, to balance the work between them.
+    auto load = std::make_shared<ChannelLoad>();
+    channels_.push_back(std::make_shared<Channel>(
+        std::make_shared<LoadTrackingSpannerStub>(std::move(stub), load),
+        std::move(load)));
+    channels_.back()->index = channels_.size() - 1;
   }
+  idle_sessions_.resize(channels_.size());
+  channel_health_.assign(channels_.size(), true);
   // `channels_` is never resized after this point.
   next_dissociated_stub_channel_ = channels_.begin();
 }
@@ -119,9 +157,26 @@ void SessionPool::ScheduleBackgroundWork(std::chrono::seconds relative_time) {
 void SessionPool::DoBackgroundWork() {
   MaintainPoolSize();
   RefreshExpiringSessions();
+  RetireUnhealthySessions();
+  ReportMetrics();
   ScheduleBackgroundWork(std::chrono::seconds(5));
 }
 
+// Report the metrics if `metrics_interval()` has elapsed since the last time.
+void SessionPool::ReportMetrics() {
+  auto const interval = options_.metrics_interval();
+  if (interval <= std::chrono::seconds(0)) return;
+  auto const now = clock_->Now();
+  if (now - last_metrics_report_ < interval) return;
+  last_metrics_report_ = now;
+  auto metrics = Metrics();
+  if (options_.metrics_callback()) {
+    options_.metrics_callback()(metrics);
+    return;
+  }
+  GCP_LOG(INFO) << "Session pool for " << db_.FullName() << ": " << metrics;
+}
+
 // Ensure the pool size conforms to what was specified in the `SessionOptions`,
 // creating or deleting sessions as necessary.
 void SessionPool::MaintainPoolSize() {
@@ -136,7 +191,7 @@ void SessionPool::MaintainPoolSize() {
 // Refresh all sessions whose last-use time is older than the keep-alive
 // interval. Issues asynchronous RPCs, so this method does not block.
 void SessionPool::RefreshExpiringSessions() {
-  std::vector<std::pair<std::shared_ptr<SpannerStub>, std::string>>
+  std::vector<std::pair<std::shared_ptr<Channel>, std::string>>
       sessions_to_refresh;
   auto now = clock_->Now();
   auto refresh_limit = now - options_.keep_alive_interval();
@@ -144,27 +199,39 @@ void SessionPool::RefreshExpiringSessions() {
     std::unique_lock<std::mutex> lk(mu_);
     if (last_use_time_lower_bound_ <= refresh_limit) {
       last_use_time_lower_bound_ = now;
-      for (auto const& session : sessions_) {
-        auto last_use_time = session->last_use_time();
-        if (last_use_time <= refresh_limit) {
-          sessions_to_refresh.emplace_back(session->channel()->stub,
-                                           session->session_name());
-          session->update_last_use_time();
-        } else if (last_use_time < last_use_time_lower_bound_) {
-          last_use_time_lower_bound_ = last_use_time;
+      for (auto const& idle : idle_sessions_) {
+        for (auto const& session : idle) {
+          auto last_use_time = session->last_use_time();
+          if (last_use_time <= refresh_limit) {
+            ++keep_alive_refreshes_;
+            sessions_to_refresh.emplace_back(session->channel(),
+                                             session->session_name());
+            session->update_last_use_time();
+          } else if (last_use_time < last_use_time_lower_bound_) {
+            last_use_time_lower_bound_ = last_use_time;
+          }
         }
       }
     }
   }
+  std::weak_ptr<SessionPool> pool = shared_from_this();
   for (auto& refresh : sessions_to_refresh) {
-    AsyncRefreshSession(cq_, refresh.first, std::move(refresh.second))
-        .then([](future<StatusOr<spanner_proto::ResultSet>> result) {
+    auto const& channel = refresh.first;
+    TrackAsync(channel->load,
+               [&] {
+                 return AsyncRefreshSession(cq_, channel->stub,
+                                            std::move(refresh.second));
+               })
+        .then([pool](future<StatusOr<spanner_proto::ResultSet>> result) {
           // We simply discard the response as handling IsSessionNotFound()
           // by removing the session from the pool is problematic (and would
           // not eliminate the possibility of IsSessionNotFound() elsewhere).
           // The last-use time has already been updated to throttle attempts.
           // TODO(#1430): Re-evaluate these decisions.
-          (void)result.get();
+          if (result.get().ok()) return;
+          if (auto shared_pool = pool.lock()) {
+            ++shared_pool->keep_alive_failures_;
+          }
         });
   }
 }
@@ -210,8 +277,24 @@ SessionPool::ComputeCreateCounts(int sessions_to_create) {
   int target_total_sessions =
       (std::min)(total_sessions_ + sessions_to_create, max_pool_size_);
 
+  // Do not create sessions on unhealthy channels, unless all of them are. The
+  // sessions already on the unhealthy channels stay there.
+  std::vector<std::shared_ptr<Channel>> channels_by_count;
+  auto const& healthy = ChannelHealth();
+  for (std::size_t i = 0; i != channels_.size(); ++i) {
+    if (healthy[i]) {
+      channels_by_count.push_back(channels_[i]);
+    } else {
+      target_total_sessions -= channels_[i]->session_count;
+    }
+  }
+  if (channels_by_count.empty()) {
+    channels_by_count = channels_;
+    target_total_sessions =
+        (std::min)(total_sessions_ + sessions_to_create, max_pool_size_);
+  }
+
   // Sort the channels in *descending* order of session count.
-  std::vector<std::shared_ptr<Channel>> channels_by_count = channels_;
   std::sort(channels_by_count.begin(), channels_by_count.end(),
             [](std::shared_ptr<Channel> const& lhs,
                std::shared_ptr<Channel> const& rhs) {
@@ -221,12 +304,14 @@ SessionPool::ComputeCreateCounts(int sessions_to_create) {
 
   // Compute the number of new Sessions to create on each channel.
   int sessions_remaining = target_total_sessions;
-  int channels_remaining = static_cast<int>(channels_.size());
+  int channels_remaining = static_cast<int>(channels_by_count.size());
   std::vector<CreateCount> create_counts;
   for (auto& channel : channels_by_count) {
-    // The target number of sessions for this channel, rounded up.
-    int target =
-        (sessions_remaining + channels_remaining - 1) / channels_remaining;
+    // The target number of sessions for this channel, rounded up, and within
+    // the per-channel limit.
+    int target = (std::min)(
+        (sessions_remaining + channels_remaining - 1) / channels_remaining,
+        options_.max_sessions_per_channel());
     --channels_remaining;
     if (channel->session_count < target) {
       int sessions_to_create = target - channel->session_count;
@@ -266,18 +351,27 @@ Status SessionPool::CreateSessions(
 }
 
 StatusOr<SessionHolder> SessionPool::Allocate(bool dissociate_from_pool) {
+  auto const start = MetricsClock::now();
+  ++allocations_;
+  auto session = AllocateImpl(dissociate_from_pool);
+  allocation_latency_.Record(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          MetricsClock::now() - start));
+  if (!session && session.status().code() == StatusCode::kResourceExhausted) {
+    ++exhausted_allocations_;
+  }
+  return session;
+}
+
+StatusOr<SessionHolder> SessionPool::AllocateImpl(bool dissociate_from_pool) {
   std::unique_lock<std::mutex> lk(mu_);
+  if (num_idle_sessions_ == 0) ++allocations_without_idle_session_;
   for (;;) {
-    if (!sessions_.empty()) {
-      // return the most recently used session.
-      auto session = std::move(sessions_.back());
-      sessions_.pop_back();
+    if (num_idle_sessions_ > 0) {
+      auto session = TakeIdleSession();
       if (dissociate_from_pool) {
         --total_sessions_;
-        auto const& channel = session->channel();
-        if (channel) {
-          --channel->session_count;
-        }
+        --session->channel()->session_count;
       }
       return {MakeSessionHolder(std::move(session), dissociate_from_pool)};
     }
@@ -289,7 +383,7 @@ StatusOr<SessionHolder> SessionPool::Allocate(bool dissociate_from_pool) {
         return Status(StatusCode::kResourceExhausted, "session pool exhausted");
       }
       Wait(lk, [this] {
-        return !sessions_.empty() || total_sessions_ < max_pool_size_;
+        return num_idle_sessions_ > 0 || total_sessions_ < max_pool_size_;
       });
       continue;
     }
@@ -302,7 +396,7 @@ StatusOr<SessionHolder> SessionPool::Allocate(bool dissociate_from_pool) {
     // number of waiters in the `sessions_to_create` calculation below.
     if (create_calls_in_progress_ > 0) {
       Wait(lk, [this] {
-        return !sessions_.empty() || create_calls_in_progress_ == 0;
+        return num_idle_sessions_ > 0 || create_calls_in_progress_ == 0;
       });
       continue;
     }
@@ -324,14 +418,152 @@ std::shared_ptr<SpannerStub> SessionPool::GetStub(Session const& session) {
   }
 
   // Sessions that were created for partitioned Reads/Queries do not have
-  // their own channel/stub; return a stub to use by round-robining between
-  // the channels.
+  // their own channel/stub; return the stub of the channel with the fewest
+  // RPCs in flight, round-robining between the channels to break ties.
   std::unique_lock<std::mutex> lk(mu_);
-  auto stub = (*next_dissociated_stub_channel_)->stub;
-  if (++next_dissociated_stub_channel_ == channels_.end()) {
+  auto best = next_dissociated_stub_channel_;
+  auto it = best;
+  for (std::size_t i = 0; i != channels_.size(); ++i) {
+    if ((*it)->load->in_flight() < (*best)->load->in_flight()) best = it;
+    if (++it == channels_.end()) it = channels_.begin();
+  }
+  next_dissociated_stub_channel_ = std::next(best);
+  if (next_dissociated_stub_channel_ == channels_.end()) {
     next_dissociated_stub_channel_ = channels_.begin();
   }
-  return stub;
+  return (*best)->stub;
+}
+
+std::vector<bool> const& SessionPool::ChannelHealth() {
+  if (clock_->Now() - channel_health_time_ >= kChannelHealthRefreshInterval) {
+    RefreshChannelHealth();
+  }
+  return channel_health_;
+}
+
+void SessionPool::RefreshChannelHealth() {
+  std::vector<ChannelLoad const*> loads;
+  loads.reserve(channels_.size());
+  for (auto const& channel : channels_) loads.push_back(channel->load.get());
+  channel_health_ = ClassifyChannelHealth(loads, ChannelLoad::Clock::now());
+  channel_health_time_ = clock_->Now();
+}
+
+std::unique_ptr<Session> SessionPool::TakeIdleSession() {
+  // Prefer the channels with the fewest RPCs in flight, and healthy channels
+  // over unhealthy ones. Break ties in favor of the most recently used
+  // session, so the pool stays LIFO.
+  std::size_t best = 0;
+  if (channels_.size() != 1) {
+    auto constexpr kUnhealthyPenalty = 1 << 20;
+    auto const& healthy = ChannelHealth();
+    auto best_score = (std::numeric_limits<int>::max)();
+    Session::Clock::time_point best_last_use;
+    for (std::size_t i = 0; i != channels_.size(); ++i) {
+      auto const& idle = idle_sessions_[i];
+      if (idle.empty()) continue;
+      auto const score = channels_[i]->load->in_flight() +
+                         (healthy[i] ? 0 : kUnhealthyPenalty);
+      auto const last_use = idle.back()->last_use_time();
+      if (score < best_score ||
+          (score == best_score && last_use > best_last_use)) {
+        best = i;
+        best_score = score;
+        best_last_use = last_use;
+      }
+    }
+  }
+  auto& idle = idle_sessions_[best];
+  auto session = std::move(idle.back());
+  idle.pop_back();
+  --num_idle_sessions_;
+  return session;
+}
+
+// Move the idle sessions away from unhealthy channels, deleting some of them
+// on each call, and creating their replacements on the healthy channels.
+void SessionPool::RetireUnhealthySessions() {
+  std::vector<std::pair<std::shared_ptr<Channel>, std::string>> retired;
+  {
+    std::unique_lock<std::mutex> lk(mu_);
+    if (channels_.size() < 2) return;
+    RefreshChannelHealth();
+    auto const& healthy = channel_health_;
+    if (std::find(healthy.begin(), healthy.end(), true) == healthy.end()) {
+      return;  // Nowhere to move the sessions.
+    }
+    // Retire the least recently used half of the idle sessions (rounded up)
+    // on each unhealthy channel, so the pool adapts quickly without churning
+    // all at once.
+    for (std::size_t i = 0; i != channels_.size(); ++i) {
+      if (healthy[i]) continue;
+      auto& idle = idle_sessions_[i];
+      auto const count = static_cast<int>((idle.size() + 1) / 2);
+      auto const end = idle.begin() + count;
+      auto const& channel = channels_[i];
+      for (auto s = idle.begin(); s != end; ++s) {
+        retired.emplace_back(channel, (*s)->session_name());
+      }
+      idle.erase(idle.begin(), end);
+      channel->session_count -= count;
+      num_idle_sessions_ -= count;
+      total_sessions_ -= count;
+    }
+    if (retired.empty()) return;
+    sessions_retired_ += retired.size();
+    if (create_calls_in_progress_ == 0) {
+      (void)Grow(lk, static_cast<int>(retired.size()),
+                 WaitForSessionAllocation::kNoWait);
+    }
+  }
+  for (auto& r : retired) {
+    auto const& channel = r.first;
+    TrackAsync(channel->load,
+               [&] {
+                 return AsyncDeleteSession(cq_, channel->stub,
+                                           std::move(r.second));
+               })
+        .then([](future<StatusOr<google::protobuf::Empty>> result) {
+          // Failing to delete a session is harmless, the service will garbage
+          // collect it eventually.
+          (void)result.get();
+        });
+  }
+}
+
+SessionPoolMetrics SessionPool::Metrics() {
+  SessionPoolMetrics metrics;
+  {
+    std::unique_lock<std::mutex> lk(mu_);
+    auto const& healthy = ChannelHealth();
+    metrics.channels.resize(channels_.size());
+    for (std::size_t i = 0; i != channels_.size(); ++i) {
+      auto& c = metrics.channels[i];
+      c.sessions = channels_[i]->session_count;
+      c.idle_sessions = static_cast<int>(idle_sessions_[i].size());
+      c.in_flight_rpcs = channels_[i]->load->in_flight();
+      c.healthy = healthy[i];
+      c.rpc_latency = channels_[i]->load->latency_distribution();
+    }
+    metrics.total_sessions = total_sessions_;
+    metrics.idle_sessions = num_idle_sessions_;
+    metrics.waiting_for_session = num_waiting_for_session_;
+  }
+  metrics.max_sessions = max_pool_size_;
+  metrics.allocations = allocations_.load();
+  metrics.allocations_without_idle_session =
+      allocations_without_idle_session_.load();
+  metrics.exhausted_allocations = exhausted_allocations_.load();
+  metrics.allocation_latency = allocation_latency_.Snapshot();
+  metrics.batch_create_calls = batch_create_calls_.load();
+  metrics.batch_create_failures = batch_create_failures_.load();
+  metrics.sessions_created = sessions_created_.load();
+  metrics.batch_create_latency = batch_create_latency_.Snapshot();
+  metrics.keep_alive_refreshes = keep_alive_refreshes_.load();
+  metrics.keep_alive_failures = keep_alive_failures_.load();
+  metrics.sessions_not_found = sessions_not_found_.load();
+  metrics.sessions_retired = sessions_retired_.load();
+  return metrics;
 }
 
 void SessionPool::Release(std::unique_ptr<Session> session) {
@@ -339,6 +571,7 @@ void SessionPool::Release(std::unique_ptr<Session> session) {
   if (session->is_bad()) {
     // Once we have support for background processing, we may want to signal
     // that to replenish this bad session.
+    ++sessions_not_found_;
     --total_sessions_;
     auto const& channel = session->channel();
     if (channel) {
@@ -347,7 +580,9 @@ void SessionPool::Release(std::unique_ptr<Session> session) {
     return;
   }
   session->update_last_use_time();
-  sessions_.push_back(std::move(session));
+  auto const index = session->channel()->index;
+  idle_sessions_[index].push_back(std::move(session));
+  ++num_idle_sessions_;
   if (num_waiting_for_session_ > 0) {
     lk.unlock();
     cond_.notify_one();
@@ -364,6 +599,7 @@ Status SessionPool::CreateSessionsSync(
                                                                labels.end());
   request.set_session_count(std::int32_t{num_sessions});
   auto const& stub = channel->stub;
+  auto const start = MetricsClock::now();
   auto response = RetryLoop(
       retry_policy_prototype_->clone(), backoff_policy_prototype_->clone(),
       true,
@@ -372,20 +608,25 @@ Status SessionPool::CreateSessionsSync(
         return stub->BatchCreateSessions(context, request);
       },
       request, __func__);
-  return HandleBatchCreateSessionsDone(channel, std::move(response));
+  return HandleBatchCreateSessionsDone(channel, std::move(response), start);
 }
 
 void SessionPool::CreateSessionsAsync(
     std::shared_ptr<Channel> const& channel,
     std::map<std::string, std::string> const& labels, int num_sessions) {
   std::weak_ptr<SessionPool> pool = shared_from_this();
-  AsyncBatchCreateSessions(cq_, channel->stub, labels, num_sessions)
-      .then([pool, channel](
+  auto const start = MetricsClock::now();
+  TrackAsync(channel->load,
+             [&] {
+               return AsyncBatchCreateSessions(cq_, channel->stub, labels,
+                                               num_sessions);
+             })
+      .then([pool, channel, start](
                 future<StatusOr<spanner_proto::BatchCreateSessionsResponse>>
                     result) {
         if (auto shared_pool = pool.lock()) {
-          shared_pool->HandleBatchCreateSessionsDone(channel,
-                                                     std::move(result).get());
+          shared_pool->HandleBatchCreateSessionsDone(
+              channel, std::move(result).get(), start);
         }
       });
 }
@@ -465,23 +706,30 @@ future<StatusOr<spanner_proto::ResultSet>> SessionPool::AsyncRefreshSession(
 
 Status SessionPool::HandleBatchCreateSessionsDone(
     std::shared_ptr<Channel> const& channel,
-    StatusOr<spanner_proto::BatchCreateSessionsResponse> response) {
+    StatusOr<spanner_proto::BatchCreateSessionsResponse> response,
+    MetricsClock::time_point start) {
+  ++batch_create_calls_;
+  batch_create_latency_.Record(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          MetricsClock::now() - start));
   std::unique_lock<std::mutex> lk(mu_);
   --create_calls_in_progress_;
   if (!response.ok()) {
+    ++batch_create_failures_;
     return response.status();
   }
   // Add sessions to the pool and update counters for `channel` and the pool.
   auto const sessions_created = response->session_size();
+  sessions_created_ += sessions_created;
   channel->session_count += sessions_created;
+  num_idle_sessions_ += sessions_created;
   total_sessions_ += sessions_created;
-  sessions_.reserve(sessions_.size() + sessions_created);
+  auto& idle = idle_sessions_[channel->index];
+  idle.reserve(idle.size() + sessions_created);
   for (auto& session : *response->mutable_session()) {
-    sessions_.push_back(absl::make_unique<Session>(
+    idle.push_back(absl::make_unique<Session>(
         std::move(*session.mutable_name()), channel, clock_));
   }
-  // Shuffle the pool so we distribute returned sessions across channels.
-  std::shuffle(sessions_.begin(), sessions_.end(), random_generator_);
 
   // Wake up anyone who was waiting for a `Session`.
   lk.unlock();
@@ -18,22 +18,25 @@
 #include "google/cloud/spanner/backoff_policy.h"
 #include "google/cloud/spanner/database.h"
 #include "google/cloud/spanner/internal/channel.h"
+#include "google/cloud/spanner/internal/latency_histogram.h"
 #include "google/cloud/spanner/internal/session.h"
 #include "google/cloud/spanner/internal/spanner_stub.h"
 #include "google/cloud/spanner/retry_policy.h"
+#include "google/cloud/spanner/session_pool_metrics.h"
 #include "google/cloud/spanner/session_pool_options.h"
 #include "google/cloud/spanner/version.h"
 #include "google/cloud/completion_queue.h"
 #include "google/cloud/future.h"
 #include "google/cloud/status_or.h"
 #include <google/spanner/v1/spanner.pb.h>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstddef>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <mutex>
-#include <random>
 #include <string>
 #include <utility>
 #include <vector>
@@ -56,7 +59,9 @@ struct SessionPoolFriendForTest;
  *
  * Allocation from the pool is LIFO to take advantage of the fact the Spanner
  * backends maintain a cache of sessions which is valid for 30 seconds, so
- * re-using Sessions as quickly as possible has performance advantages.
+ * re-using Sessions as quickly as possible has performance advantages. The
+ * idle sessions are kept separately for each channel, so the pool can prefer
+ * the least loaded channel, and is LIFO within each channel.
  */
 class SessionPool : public std::enable_shared_from_this<SessionPool> {
  public:
@@ -99,6 +104,9 @@ class SessionPool : public std::enable_shared_from_this<SessionPool> {
    */
   std::shared_ptr<SpannerStub> GetStub(Session const& session);
 
+  /// Return a snapshot of the pool's state and its cumulative metrics.
+  SessionPoolMetrics Metrics();
+
  private:
   // Represents a request to create `session_count` sessions on `channel`
   // See `ComputeCreateCounts` and `CreateSessions`.
@@ -107,6 +115,18 @@ class SessionPool : public std::enable_shared_from_this<SessionPool> {
     int session_count;
   };
   enum class WaitForSessionAllocation { kWait, kNoWait };
+  using MetricsClock = std::chrono::steady_clock;
+
+  StatusOr<SessionHolder> AllocateImpl(bool dissociate_from_pool);
+
+  // Remove an idle session from the pool, preferring the least loaded and
+  // healthy channels. Requires `num_idle_sessions_ > 0`.
+  std::unique_ptr<Session> TakeIdleSession();  // EXCLUSIVE_LOCKS_REQUIRED(mu_)
+
+  // The health of each channel, in the same order as `channels_`. The cached
+  // classification is refreshed if it is older than a second.
+  std::vector<bool> const& ChannelHealth();  // EXCLUSIVE_LOCKS_REQUIRED(mu_)
+  void RefreshChannelHealth();               // EXCLUSIVE_LOCKS_REQUIRED(mu_)
 
   // Release session back to the pool.
   void Release(std::unique_ptr<Session> session);
@@ -152,14 +172,15 @@ class SessionPool : public std::enable_shared_from_this<SessionPool> {
 
   Status HandleBatchCreateSessionsDone(
       std::shared_ptr<Channel> const& channel,
-      StatusOr<google::spanner::v1::BatchCreateSessionsResponse> response);
-
-  void UpdateNextChannelForCreateSessions();  // EXCLUSIVE_LOCKS_REQUIRED(mu_)
+      StatusOr<google::spanner::v1::BatchCreateSessionsResponse> response,
+      MetricsClock::time_point start);
 
   void ScheduleBackgroundWork(std::chrono::seconds relative_time);
   void DoBackgroundWork();
   void MaintainPoolSize();
   void RefreshExpiringSessions();
+  void RetireUnhealthySessions();
+  void ReportMetrics();
 
   Database const db_;
   SessionPoolOptions const options_;
@@ -168,20 +189,44 @@ class SessionPool : public std::enable_shared_from_this<SessionPool> {
   std::unique_ptr<BackoffPolicy const> backoff_policy_prototype_;
   std::shared_ptr<Session::Clock> clock_;
   int const max_pool_size_;
-  std::mt19937 random_generator_;
 
   std::mutex mu_;
   std::condition_variable cond_;
-  std::vector<std::unique_ptr<Session>> sessions_;  // GUARDED_BY(mu_)
-  int total_sessions_ = 0;                          // GUARDED_BY(mu_)
-  int create_calls_in_progress_ = 0;                // GUARDED_BY(mu_)
-  int num_waiting_for_session_ = 0;                 // GUARDED_BY(mu_)
+  // The idle sessions on each channel, in the same order as `channels_`, with
+  // the most recently used at the back.
+  std::vector<std::vector<std::unique_ptr<Session>>>
+      idle_sessions_;                 // GUARDED_BY(mu_)
+  int num_idle_sessions_ = 0;         // GUARDED_BY(mu_)
+  int total_sessions_ = 0;            // GUARDED_BY(mu_)
+  int create_calls_in_progress_ = 0;  // GUARDED_BY(mu_)
+  int num_waiting_for_session_ = 0;   // GUARDED_BY(mu_)
+
+  // The cached result of `ClassifyChannelHealth()` for `channels_`, and the
+  // time it was computed.
+  std::vector<bool> channel_health_;  // GUARDED_BY(mu_)
+  Session::Clock::time_point channel_health_time_ =
+      clock_->Now();  // GUARDED_BY(mu_)
 
-  // Lower bound on all `sessions_[i]->last_use_time()` values.
+  // Lower bound on the `last_use_time()` of all the idle sessions.
   Session::Clock::time_point last_use_time_lower_bound_ =
       clock_->Now();  // GUARDED_BY(mu_)
 
   future<void> current_timer_;
+  Session::Clock::time_point last_metrics_report_ = clock_->Now();
+
+  // Cumulative metrics. These are updated without holding `mu_`.
+  std::atomic<std::uint64_t> allocations_{0};
+  std::atomic<std::uint64_t> allocations_without_idle_session_{0};
+  std::atomic<std::uint64_t> exhausted_allocations_{0};
+  std::atomic<std::uint64_t> batch_create_calls_{0};
+  std::atomic<std::uint64_t> batch_create_failures_{0};
+  std::atomic<std::uint64_t> sessions_created_{0};
+  std::atomic<std::uint64_t> keep_alive_refreshes_{0};
+  std::atomic<std::uint64_t> keep_alive_failures_{0};
+  std::atomic<std::uint64_t> sessions_not_found_{0};
+  std::atomic<std::uint64_t> sessions_retired_{0};
+  LatencyHistogram allocation_latency_;
+  LatencyHistogram batch_create_latency_;
 
   // `channels_` is guaranteed to be non-empty and will not be resized after
   // the constructor runs (so the iterators are guaranteed to always be valid).
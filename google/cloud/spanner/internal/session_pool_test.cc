@@ -63,6 +63,15 @@ MATCHER_P(LabelsAre, labels, "BatchCreateSessionsRequest has expected labels") {
   return labels_type(arg_labels.begin(), arg_labels.end()) == labels;
 }
 
+class MockGrpcReader
+    : public ::grpc::ClientReaderInterface<spanner_proto::PartialResultSet> {
+ public:
+  MOCK_METHOD1(Read, bool(spanner_proto::PartialResultSet*));
+  MOCK_METHOD1(NextMessageSize, bool(std::uint32_t*));
+  MOCK_METHOD0(Finish, grpc::Status());
+  MOCK_METHOD0(WaitForInitialMetadata, void());
+};
+
 // Create a response with the given `sessions`
 spanner_proto::BatchCreateSessionsResponse MakeSessionsResponse(
     std::vector<std::string> sessions) {
@@ -102,7 +111,14 @@ TEST(SessionPool, Allocate) {
   auto session = pool->Allocate();
   ASSERT_STATUS_OK(session);
   EXPECT_EQ((*session)->session_name(), "session1");
-  EXPECT_EQ(pool->GetStub(**session), mock);
+
+  // The pool wraps the stub to track the load on its channel, verify the calls
+  // reach `mock`.
+  auto stub = pool->GetStub(**session);
+  ASSERT_NE(stub, nullptr);
+  EXPECT_CALL(*mock, Rollback(_, _)).WillOnce(Return(Status()));
+  grpc::ClientContext context;
+  EXPECT_STATUS_OK(stub->Rollback(context, spanner_proto::RollbackRequest{}));
 }
 
 TEST(SessionPool, ReleaseBadSession) {
@@ -390,7 +406,209 @@ TEST(SessionPool, GetStubForStublessSession) {
   auto pool = MakeSessionPool(db, {mock}, {}, threads.cq());
   // ensure we get a stub even if we didn't allocate from the pool.
   auto session = MakeDissociatedSessionHolder("session_id");
-  EXPECT_EQ(pool->GetStub(*session), mock);
+  auto stub = pool->GetStub(*session);
+  ASSERT_NE(stub, nullptr);
+  EXPECT_CALL(*mock, Rollback(_, _)).WillOnce(Return(Status()));
+  grpc::ClientContext context;
+  EXPECT_STATUS_OK(stub->Rollback(context, spanner_proto::RollbackRequest{}));
+}
+
+TEST(SessionPool, GetStubForStublessSessionPrefersIdleChannel) {
+  auto mock1 = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto mock2 = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto db = Database("project", "instance", "database");
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads threads;
+  auto pool = MakeSessionPool(db, {mock1, mock2}, {}, threads.cq());
+
+  // Keep a streaming RPC in flight on the first stub returned.
+  auto session = MakeDissociatedSessionHolder("session_id");
+  auto busy = pool->GetStub(*session);
+  EXPECT_CALL(*mock1, ExecuteStreamingSql(_, _))
+      .WillRepeatedly([](grpc::ClientContext&,
+                         spanner_proto::ExecuteSqlRequest const&) {
+        return std::unique_ptr<
+            grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>(
+            absl::make_unique<MockGrpcReader>());
+      });
+  EXPECT_CALL(*mock2, ExecuteStreamingSql(_, _))
+      .WillRepeatedly([](grpc::ClientContext&,
+                         spanner_proto::ExecuteSqlRequest const&) {
+        return std::unique_ptr<
+            grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>(
+            absl::make_unique<MockGrpcReader>());
+      });
+  grpc::ClientContext context;
+  auto stream =
+      busy->ExecuteStreamingSql(context, spanner_proto::ExecuteSqlRequest{});
+
+  // The other channel is preferred while the stream is in flight.
+  for (int i = 0; i != 3; ++i) EXPECT_NE(pool->GetStub(*session), busy);
+  stream.reset();
+}
+
+TEST(SessionPool, AllocatePrefersIdleChannel) {
+  auto mock1 = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto mock2 = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto db = Database("project", "instance", "database");
+  EXPECT_CALL(*mock1, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"c1s1"}))));
+  EXPECT_CALL(*mock2, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"c2s1"}))));
+  EXPECT_CALL(*mock1, ExecuteStreamingSql(_, _))
+      .WillOnce([](grpc::ClientContext&,
+                   spanner_proto::ExecuteSqlRequest const&) {
+        return std::unique_ptr<
+            grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>(
+            absl::make_unique<MockGrpcReader>());
+      });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads threads;
+  auto pool = MakeSessionPool(db, {mock1, mock2}, {}, threads.cq());
+  auto s1 = pool->Allocate();
+  ASSERT_STATUS_OK(s1);
+  auto s2 = pool->Allocate();
+  ASSERT_STATUS_OK(s2);
+  auto& c1 = (*s1)->session_name() == "c1s1" ? *s1 : *s2;
+  auto& c2 = (*s1)->session_name() == "c1s1" ? *s2 : *s1;
+  ASSERT_EQ("c2s1", c2->session_name());
+
+  // Start an RPC on the first channel, and release its session last, so it is
+  // the most recently used.
+  grpc::ClientContext context;
+  auto stream = pool->GetStub(*c1)->ExecuteStreamingSql(
+      context, spanner_proto::ExecuteSqlRequest{});
+  c2.reset();
+  c1.reset();
+
+  auto session = pool->Allocate();
+  ASSERT_STATUS_OK(session);
+  EXPECT_EQ("c2s1", (*session)->session_name());
+  session->reset();
+
+  // Without the RPC in flight, the most recently used session is preferred.
+  stream.reset();
+  session = pool->Allocate();
+  ASSERT_STATUS_OK(session);
+  EXPECT_EQ("c2s1", (*session)->session_name());
+}
+
+TEST(SessionPool, RetireSessionsOnUnhealthyChannel) {
+  auto mock1 = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto mock2 = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*mock1, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"c1s1", "c1s2"}))));
+  EXPECT_CALL(*mock2, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"c2s1", "c2s2"}))));
+  EXPECT_CALL(*mock1, Rollback(_, _)).WillRepeatedly(Return(Status()));
+  EXPECT_CALL(*mock2, Rollback(_, _))
+      .WillRepeatedly(Return(Status(StatusCode::kUnavailable, "try-again")));
+
+  // See the comments in MockAsyncResponseReader about their memory management.
+  using DeleteReader =
+      StrictMock<MockAsyncResponseReader<google::protobuf::Empty>>;
+  using CreateReader = StrictMock<
+      MockAsyncResponseReader<spanner_proto::BatchCreateSessionsResponse>>;
+  std::vector<std::unique_ptr<DeleteReader>> delete_readers;
+  std::vector<std::unique_ptr<CreateReader>> create_readers;
+
+  auto db = Database("project", "instance", "database");
+  SessionPoolOptions options;
+  options.set_min_sessions(4);
+  auto impl = std::make_shared<MockCompletionQueue>();
+  auto clock = std::make_shared<FakeSteadyClock>();
+  auto pool = MakeSessionPool(db, {mock1, mock2}, options,
+                              CompletionQueue(impl), clock);
+
+  // Make the second channel unhealthy.
+  std::vector<SessionHolder> sessions;
+  for (int i = 0; i != 4; ++i) {
+    auto session = pool->Allocate();
+    ASSERT_STATUS_OK(session);
+    sessions.push_back(*std::move(session));
+  }
+  for (auto& session : sessions) {
+    for (int i = 0; i != 20; ++i) {
+      grpc::ClientContext context;
+      (void)pool->GetStub(*session)->Rollback(context,
+                                              spanner_proto::RollbackRequest{});
+    }
+  }
+  sessions.clear();
+
+  // The pool classifies the channels at most once per second.
+  clock->AdvanceTime(std::chrono::seconds(1));
+  auto metrics = pool->Metrics();
+  ASSERT_EQ(2, metrics.channels.size());
+  EXPECT_TRUE(metrics.channels[0].healthy);
+  EXPECT_FALSE(metrics.channels[1].healthy);
+  EXPECT_EQ(2, metrics.channels[1].idle_sessions);
+
+  // Idle sessions on the unhealthy channel are preferred last.
+  {
+    auto s1 = pool->Allocate();
+    ASSERT_STATUS_OK(s1);
+    EXPECT_EQ("c1", (*s1)->session_name().substr(0, 2));
+  }
+
+  // The background work deletes some of the sessions on the unhealthy
+  // channel, and replaces them on the healthy channel.
+  EXPECT_CALL(*mock2, AsyncDeleteSession(_, _, _))
+      .WillRepeatedly([&delete_readers](
+                          grpc::ClientContext&,
+                          spanner_proto::DeleteSessionRequest const& request,
+                          grpc::CompletionQueue*) {
+        EXPECT_THAT(request.name(), HasSubstr("c2s"));
+        auto reader = absl::make_unique<DeleteReader>();
+        EXPECT_CALL(*reader, Finish(_, _, _))
+            .WillOnce([](google::protobuf::Empty*, grpc::Status* status,
+                         void*) { *status = grpc::Status::OK; });
+        delete_readers.push_back(std::move(reader));
+        return std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+            google::protobuf::Empty>>(delete_readers.back().get());
+      });
+  int created = 0;
+  EXPECT_CALL(*mock1, AsyncBatchCreateSessions(_, _, _))
+      .WillRepeatedly(
+          [&created, &create_readers](
+              grpc::ClientContext&,
+                     spanner_proto::BatchCreateSessionsRequest const& request,
+                     grpc::CompletionQueue*) {
+            std::vector<std::string> names;
+            for (int i = 0; i != request.session_count(); ++i) {
+              names.push_back("c1s" + std::to_string(3 + created++));
+            }
+            auto reader = absl::make_unique<CreateReader>();
+            EXPECT_CALL(*reader, Finish(_, _, _))
+                .WillOnce([names](
+                              spanner_proto::BatchCreateSessionsResponse* r,
+                              grpc::Status* status, void*) {
+                  *r = MakeSessionsResponse(names);
+                  *status = grpc::Status::OK;
+                });
+            create_readers.push_back(std::move(reader));
+            return std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+                spanner_proto::BatchCreateSessionsResponse>>(
+                create_readers.back().get());
+          });
+
+  impl->SimulateCompletion(true);  // Runs the background work.
+  metrics = pool->Metrics();
+  EXPECT_EQ(1, metrics.sessions_retired);
+  EXPECT_EQ(3, metrics.total_sessions);
+  EXPECT_EQ(1, metrics.channels[1].sessions);
+  EXPECT_EQ(1, created);
+  // The asynchronous RPCs started by the pool count as load on their channel.
+  EXPECT_EQ(1, metrics.channels[0].in_flight_rpcs);
+  EXPECT_EQ(1, metrics.channels[1].in_flight_rpcs);
+
+  // Complete the pending operations, and let the background work drain the
+  // unhealthy channel.
+  for (int i = 0; i != 4; ++i) impl->SimulateCompletion(true);
+  metrics = pool->Metrics();
+  EXPECT_EQ(2, metrics.sessions_retired);
+  EXPECT_EQ(0, metrics.channels[1].sessions);
+  EXPECT_EQ(2 + created, metrics.channels[0].sessions);
+  EXPECT_LE(1, created);
 }
 
 TEST(SessionPool, SessionRefresh) {
@@ -453,6 +671,8 @@ TEST(SessionPool, SessionRefresh) {
   // a call to RefreshExpiringSessions(). This should refresh "s2" and
   // satisfy the AsyncExecuteSql() and Finish() expectations.
   impl->SimulateCompletion(true);
+  EXPECT_EQ(1, pool->Metrics().keep_alive_refreshes);
+  EXPECT_EQ(0, pool->Metrics().keep_alive_failures);
 
   // Simulate completion again, making another RefreshExpiringSessions()
   // call, which should do nothing.  If anything goes wrong with this
@@ -460,6 +680,96 @@ TEST(SessionPool, SessionRefresh) {
   impl->SimulateCompletion(true);
 }
 
+TEST(SessionPool, Metrics) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*mock, BatchCreateSessions(_, SessionCountIs(1)))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"s1"}))))
+      .WillOnce(Return(ByMove(Status(StatusCode::kInternal, "failure"))))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"s2"}))));
+
+  auto db = Database("project", "instance", "database");
+  SessionPoolOptions options;
+  options.set_max_sessions_per_channel(2).set_action_on_exhaustion(
+      ActionOnExhaustion::kFail);
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads threads;
+  auto pool = MakeSessionPool(db, {mock}, options, threads.cq());
+
+  auto metrics = pool->Metrics();
+  EXPECT_EQ(0, metrics.total_sessions);
+  EXPECT_EQ(2, metrics.max_sessions);
+  ASSERT_EQ(1, metrics.channels.size());
+  EXPECT_EQ(0, metrics.allocations);
+
+  auto s1 = pool->Allocate();
+  ASSERT_STATUS_OK(s1);
+  auto s2 = pool->Allocate();  // The first attempt to create "s2" fails.
+  EXPECT_EQ(StatusCode::kInternal, s2.status().code());
+  auto s3 = pool->Allocate();
+  ASSERT_STATUS_OK(s3);
+  EXPECT_EQ(StatusCode::kResourceExhausted, pool->Allocate().status().code());
+  (*s3)->set_bad();
+  s3->reset();  // Drops the bad session from the pool.
+
+  metrics = pool->Metrics();
+  EXPECT_EQ(1, metrics.total_sessions);
+  EXPECT_EQ(0, metrics.idle_sessions);
+  EXPECT_EQ(0, metrics.waiting_for_session);
+  ASSERT_EQ(1, metrics.channels.size());
+  EXPECT_EQ(1, metrics.channels[0].sessions);
+  EXPECT_EQ(0, metrics.channels[0].idle_sessions);
+  EXPECT_EQ(4, metrics.allocations);
+  EXPECT_EQ(4, metrics.allocations_without_idle_session);
+  EXPECT_EQ(1, metrics.exhausted_allocations);
+  EXPECT_EQ(4, metrics.allocation_latency.count);
+  EXPECT_EQ(3, metrics.batch_create_calls);
+  EXPECT_EQ(1, metrics.batch_create_failures);
+  EXPECT_EQ(2, metrics.sessions_created);
+  EXPECT_EQ(3, metrics.batch_create_latency.count);
+  EXPECT_EQ(1, metrics.sessions_not_found);
+
+  s1->reset();  // Returns the session to the pool.
+  metrics = pool->Metrics();
+  EXPECT_EQ(1, metrics.idle_sessions);
+  EXPECT_EQ(1, metrics.channels[0].idle_sessions);
+}
+
+TEST(SessionPool, MetricsReport) {
+  auto mock = std::make_shared<StrictMock<spanner_testing::MockSpannerStub>>();
+  EXPECT_CALL(*mock, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"s1"}))));
+
+  std::vector<SessionPoolMetrics> reports;
+  auto db = Database("project", "instance", "database");
+  SessionPoolOptions options;
+  options.set_metrics_interval(std::chrono::seconds(30))
+      .set_metrics_callback([&reports](SessionPoolMetrics const& metrics) {
+        reports.push_back(metrics);
+      });
+  auto impl = std::make_shared<MockCompletionQueue>();
+  auto clock = std::make_shared<FakeSteadyClock>();
+  auto pool =
+      MakeSessionPool(db, {mock}, options, CompletionQueue(impl), clock);
+  {
+    auto session = pool->Allocate();
+    ASSERT_STATUS_OK(session);
+  }
+
+  // The interval has not elapsed, so there is no report.
+  impl->SimulateCompletion(true);
+  EXPECT_TRUE(reports.empty());
+
+  clock->AdvanceTime(std::chrono::seconds(30));
+  impl->SimulateCompletion(true);
+  ASSERT_EQ(1, reports.size());
+  EXPECT_EQ(1, reports[0].total_sessions);
+  EXPECT_EQ(1, reports[0].idle_sessions);
+  EXPECT_EQ(1, reports[0].allocations);
+  EXPECT_EQ(1, reports[0].batch_create_calls);
+
+  impl->SimulateCompletion(true);
+  EXPECT_EQ(1, reports.size());
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace SPANNER_CLIENT_NS
@@ -57,6 +57,7 @@ class MockConnection : public spanner::Connection {
                StatusOr<spanner::BatchDmlResult>(ExecuteBatchDmlParams));
   MOCK_METHOD1(Commit, StatusOr<spanner::CommitResult>(CommitParams));
   MOCK_METHOD1(Rollback, Status(RollbackParams));
+  MOCK_METHOD0(GetSessionPoolMetrics, spanner::SessionPoolMetrics());
 };
 
 /**
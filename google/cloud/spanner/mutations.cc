@@ -30,6 +30,12 @@ void PrintTo(Mutation const& m, std::ostream* os) {
   *os << "Mutation={" << m.m_.DebugString() << "}";
 }
 
+namespace internal {
+Mutation MakeMutation(google::spanner::v1::Mutation m) {
+  return Mutation(std::move(m));
+}
+}  // namespace internal
+
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
 }  // namespace cloud
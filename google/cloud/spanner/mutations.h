@@ -15,10 +15,14 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_MUTATIONS_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_MUTATIONS_H
 
+#include "google/cloud/spanner/internal/tuple_utils.h"
 #include "google/cloud/spanner/keys.h"
 #include "google/cloud/spanner/value.h"
 #include "google/cloud/spanner/version.h"
 #include <google/spanner/v1/mutation.pb.h>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 
 namespace google {
@@ -26,10 +30,13 @@ namespace cloud {
 namespace spanner {
 inline namespace SPANNER_CLIENT_NS {
 
+class Mutation;
+
 namespace internal {
 template <typename Op>
 class WriteMutationBuilder;
 class DeleteMutationBuilder;
+Mutation MakeMutation(google::spanner::v1::Mutation m);
 }  // namespace internal
 
 /**
@@ -84,6 +91,7 @@ class Mutation {
   template <typename Op>
   friend class internal::WriteMutationBuilder;
   friend class internal::DeleteMutationBuilder;
+  friend Mutation internal::MakeMutation(google::spanner::v1::Mutation);
   explicit Mutation(google::spanner::v1::Mutation m) : m_(std::move(m)) {}
 
   google::spanner::v1::Mutation m_;
@@ -127,9 +135,14 @@ class WriteMutationBuilder {
     return std::move(AddRow(std::move(values)));
   }
 
+  // Encodes each of the `values` directly into the mutation, without creating
+  // a `Value` for it first.
   template <typename... Ts>
   WriteMutationBuilder& EmplaceRow(Ts&&... values) & {
-    return AddRow({Value(std::forward<Ts>(values))...});
+    auto& lv = *Op::mutable_field(m_.proto()).add_values();
+    lv.mutable_values()->Reserve(static_cast<int>(sizeof...(Ts)));
+    AddValues(lv, std::forward<Ts>(values)...);
+    return *this;
   }
 
   template <typename... Ts>
@@ -137,7 +150,51 @@ class WriteMutationBuilder {
     return std::move(EmplaceRow(std::forward<Ts>(values)...));
   }
 
+  /**
+   * Adds one row for each `std::tuple` in @p rows, as if each was passed to
+   * `EmplaceRow()`. The elements are moved out of @p rows when it is an
+   * rvalue.
+   */
+  template <typename Rows>
+  WriteMutationBuilder& AddRows(Rows&& rows) & {
+    using Row = typename std::decay<decltype(*std::begin(rows))>::type;
+    static_assert(internal::IsTuple<Row>::value,
+                  "AddRows() requires a range of std::tuple<...>");
+    auto& field = Op::mutable_field(m_.proto());
+    for (auto&& row : rows) {
+      auto& lv = *field.add_values();
+      lv.mutable_values()->Reserve(
+          static_cast<int>(internal::TupleSize<Row>::value));
+      using RowRef = typename std::conditional<
+          std::is_lvalue_reference<Rows>::value, Row const&, Row&&>::type;
+      internal::ForEach(static_cast<RowRef>(row), AddValue{}, lv);
+    }
+    return *this;
+  }
+
+  template <typename Rows>
+  WriteMutationBuilder&& AddRows(Rows&& rows) && {
+    return std::move(AddRows(std::forward<Rows>(rows)));
+  }
+
  private:
+  // A functor to be used with internal::ForEach to encode the elements of a
+  // tuple.
+  struct AddValue {
+    template <typename T>
+    void operator()(T&& t, google::protobuf::ListValue& lv) const {
+      *lv.add_values() = internal::MakeValueProto(std::forward<T>(t));
+    }
+  };
+
+  static void AddValues(google::protobuf::ListValue&) {}
+  template <typename T, typename... Ts>
+  static void AddValues(google::protobuf::ListValue& lv, T&& value,
+                        Ts&&... values) {
+    *lv.add_values() = internal::MakeValueProto(std::forward<T>(value));
+    AddValues(lv, std::forward<Ts>(values)...);
+  }
+
   Mutation m_;
 };
 
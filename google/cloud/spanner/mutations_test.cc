@@ -401,6 +401,64 @@ TEST(MutationsTest, FluentReplaceBuilder) {
   EXPECT_EQ(data, actual.replace().values(1).values(0).string_value());
 }
 
+TEST(MutationsTest, EmplaceRowMatchesAddRow) {
+  using Row = std::tuple<std::int64_t, std::string, absl::optional<double>,
+                         std::vector<Bytes>, Timestamp>;
+  std::vector<Row> rows = {
+      Row{1, "one", 1.5, {Bytes("a"), Bytes("b")}, Timestamp()},
+      Row{2, "two", absl::optional<double>(), {}, Timestamp()},
+  };
+
+  auto builder = InsertMutationBuilder("table-name", {"a", "b", "c", "d", "e"});
+  for (auto const& r : rows) {
+    builder.AddRow({Value(std::get<0>(r)), Value(std::get<1>(r)),
+                    Value(std::get<2>(r)), Value(std::get<3>(r)),
+                    Value(std::get<4>(r))});
+  }
+  auto const expected = builder.Build();
+
+  builder = InsertMutationBuilder("table-name", {"a", "b", "c", "d", "e"});
+  for (auto const& r : rows) {
+    builder.EmplaceRow(std::get<0>(r), std::get<1>(r), std::get<2>(r),
+                       std::get<3>(r), std::get<4>(r));
+  }
+  EXPECT_EQ(expected, builder.Build());
+
+  // `Value` arguments are accepted too.
+  builder = InsertMutationBuilder("table-name", {"a", "b", "c", "d", "e"});
+  for (auto const& r : rows) {
+    builder.EmplaceRow(std::get<0>(r), Value(std::get<1>(r)), std::get<2>(r),
+                       std::get<3>(r), std::get<4>(r));
+  }
+  EXPECT_EQ(expected, builder.Build());
+
+  EXPECT_EQ(expected,
+            InsertMutationBuilder("table-name", {"a", "b", "c", "d", "e"})
+                .AddRows(rows)
+                .Build());
+  EXPECT_EQ(2, rows.size());
+  EXPECT_EQ("one", std::get<1>(rows[0]));
+}
+
+TEST(MutationsTest, AddRowsMovesFromRvalue) {
+  std::string const data(128, 'x');
+  std::vector<std::tuple<std::string, std::int64_t>> rows;
+  rows.emplace_back(data, 1);
+  rows.emplace_back(data, 2);
+
+  Mutation m = UpdateMutationBuilder("table-name", {"col_a", "col_b"})
+                   .AddRows(std::move(rows))
+                   .EmplaceRow(data, 3)
+                   .Build();
+  auto actual = std::move(m).as_proto();
+  ASSERT_EQ(3, actual.update().values().size());
+  for (auto const& row : actual.update().values()) {
+    ASSERT_EQ(2, row.values().size());
+    EXPECT_EQ(data, row.values(0).string_value());
+  }
+  EXPECT_EQ("2", actual.update().values(1).values(1).string_value());
+}
+
 TEST(MutationsTest, FluentDeleteBuilder) {
   static_assert(
       std::is_rvalue_reference<decltype(
@@ -0,0 +1,329 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/parallel_executor.h"
+#include "google/cloud/spanner/value.h"
+#include "absl/memory/memory.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+namespace {
+
+using PartitionReader = std::function<RowStream(std::size_t)>;
+
+/**
+ * Runs a set of partitions on a pool of threads, delivering each row to a
+ * `RowCallback`.
+ *
+ * The first error (from a partition or the callback) cancels the execution.
+ * `on_done` is called, exactly once, when the last thread finishes.
+ */
+class Execution {
+ public:
+  Execution(std::size_t partition_count, PartitionReader reader,
+            ParallelExecutorOptions const& options,
+            RetryPolicy const& retry_policy,
+            BackoffPolicy const& backoff_policy,
+            ParallelExecutor::RowCallback callback,
+            std::function<void(Status)> on_done)
+      : partition_count_(partition_count),
+        reader_(std::move(reader)),
+        options_(options),
+        retry_policy_(retry_policy.clone()),
+        backoff_policy_(backoff_policy.clone()),
+        callback_(std::move(callback)),
+        on_done_(std::move(on_done)) {}
+
+  ~Execution() {
+    Cancel();
+    Join();
+  }
+
+  void Start() {
+    auto const n = std::min<std::size_t>(
+        partition_count_,
+        static_cast<std::size_t>(std::max(options_.max_concurrency, 1)));
+    running_ = static_cast<int>(n);
+    if (n == 0) {
+      on_done_(Status());
+      return;
+    }
+    for (std::size_t i = 0; i != n; ++i) {
+      threads_.emplace_back([this] { WorkerLoop(); });
+    }
+  }
+
+  void Cancel() { cancelled_.store(true); }
+
+  void Join() {
+    for (auto& t : threads_) t.join();
+    threads_.clear();
+  }
+
+  Status status() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return status_;
+  }
+
+ private:
+  void WorkerLoop() {
+    for (auto i = next_.fetch_add(1); i < partition_count_ && !cancelled_;
+         i = next_.fetch_add(1)) {
+      auto stats = RunPartition(i);
+      if (options_.partition_stats_callback) {
+        options_.partition_stats_callback(stats);
+      }
+      if (!stats.status.ok()) SetError(std::move(stats.status));
+    }
+    Status status;
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      if (--running_ != 0) return;
+      status = status_;
+    }
+    on_done_(std::move(status));
+  }
+
+  PartitionStats RunPartition(std::size_t index) {
+    PartitionStats stats;
+    stats.index = index;
+    auto const start = std::chrono::steady_clock::now();
+    auto retry_policy = retry_policy_->clone();
+    auto backoff_policy = backoff_policy_->clone();
+    for (;;) {
+      ++stats.attempts;
+      stats.status = ReadPartition(index, stats);
+      // A partition can only be restarted if none of its rows were delivered.
+      if (stats.status.ok() || cancelled_ || stats.rows != 0 ||
+          !retry_policy->OnFailure(stats.status)) {
+        break;
+      }
+      std::this_thread::sleep_for(backoff_policy->OnCompletion());
+    }
+    stats.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    return stats;
+  }
+
+  Status ReadPartition(std::size_t index, PartitionStats& stats) {
+    auto rows = reader_(index);
+    for (auto& row : rows) {
+      if (!row) return std::move(row).status();
+      if (cancelled_) return Status(StatusCode::kCancelled, "cancelled");
+      std::int64_t bytes = 0;
+      for (auto const& v : row->values()) {
+        bytes += static_cast<std::int64_t>(internal::EncodedSize(v));
+      }
+      auto status = callback_(index, *std::move(row));
+      if (!status.ok()) {
+        // Errors from the callback are never retried.
+        SetError(status);
+        return status;
+      }
+      ++stats.rows;
+      stats.bytes += bytes;
+    }
+    return Status();
+  }
+
+  void SetError(Status status) {
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      if (status_.ok()) status_ = std::move(status);
+    }
+    Cancel();
+  }
+
+  std::size_t const partition_count_;
+  PartitionReader const reader_;
+  ParallelExecutorOptions const options_;
+  std::unique_ptr<RetryPolicy> const retry_policy_;
+  std::unique_ptr<BackoffPolicy> const backoff_policy_;
+  ParallelExecutor::RowCallback const callback_;
+  std::function<void(Status)> const on_done_;
+
+  std::atomic<std::size_t> next_{0};
+  std::atomic<bool> cancelled_{false};
+  std::vector<std::thread> threads_;
+  std::mutex mu_;
+  int running_ = 0;  // GUARDED_BY(mu_)
+  Status status_;    // GUARDED_BY(mu_)
+};
+
+/**
+ * The source for the `RowStream` returned by `ParallelExecutor::Stream()`.
+ *
+ * The partitions push their rows into a bounded queue, blocking while it is
+ * full, and `NextRow()` pops them.
+ */
+class ParallelResultSource : public internal::ResultSourceInterface {
+ public:
+  ParallelResultSource(std::size_t partition_count, PartitionReader reader,
+                       ParallelExecutorOptions const& options,
+                       RetryPolicy const& retry_policy,
+                       BackoffPolicy const& backoff_policy)
+      : max_queued_rows_(std::max<std::size_t>(options.max_queued_rows, 1)),
+        execution_(
+            partition_count, std::move(reader), options, retry_policy,
+            backoff_policy,
+            [this](std::size_t, Row row) { return Push(std::move(row)); },
+            [this](Status status) { OnDone(std::move(status)); }) {
+    execution_.Start();
+  }
+
+  ~ParallelResultSource() override {
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      cancelled_ = true;
+    }
+    not_full_.notify_all();
+    execution_.Cancel();
+    execution_.Join();
+  }
+
+  StatusOr<Row> NextRow() override {
+    std::unique_lock<std::mutex> lk(mu_);
+    not_empty_.wait(lk, [this] { return !queue_.empty() || done_; });
+    if (!status_.ok()) return status_;
+    if (queue_.empty()) return Row();
+    auto row = std::move(queue_.front());
+    queue_.pop_front();
+    lk.unlock();
+    not_full_.notify_one();
+    return row;
+  }
+
+  absl::optional<google::spanner::v1::ResultSetMetadata> Metadata() override {
+    return {};
+  }
+
+  absl::optional<google::spanner::v1::ResultSetStats> Stats() const override {
+    return {};
+  }
+
+ private:
+  Status Push(Row row) {
+    std::unique_lock<std::mutex> lk(mu_);
+    not_full_.wait(
+        lk, [this] { return queue_.size() < max_queued_rows_ || cancelled_; });
+    if (cancelled_) return Status(StatusCode::kCancelled, "cancelled");
+    queue_.push_back(std::move(row));
+    lk.unlock();
+    not_empty_.notify_one();
+    return Status();
+  }
+
+  void OnDone(Status status) {
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      done_ = true;
+      status_ = std::move(status);
+    }
+    not_empty_.notify_all();
+  }
+
+  std::size_t const max_queued_rows_;
+  std::mutex mu_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::deque<Row> queue_;  // GUARDED_BY(mu_)
+  bool cancelled_ = false;  // GUARDED_BY(mu_)
+  bool done_ = false;       // GUARDED_BY(mu_)
+  Status status_;           // GUARDED_BY(mu_)
+  // Declared last, so it is destroyed (and its threads joined) before any of
+  // the members used by the threads.
+  Execution execution_;
+};
+
+PartitionReader MakeReader(Client client,
+                           std::vector<QueryPartition> partitions) {
+  return [client, partitions](std::size_t i) mutable {
+    return client.ExecuteQuery(partitions[i]);
+  };
+}
+
+PartitionReader MakeReader(Client client,
+                           std::vector<ReadPartition> partitions) {
+  return [client, partitions](std::size_t i) mutable {
+    return client.Read(partitions[i]);
+  };
+}
+
+Status RunPartitions(std::size_t partition_count, PartitionReader reader,
+                     ParallelExecutorOptions const& options,
+                     RetryPolicy const& retry_policy,
+                     BackoffPolicy const& backoff_policy,
+                     ParallelExecutor::RowCallback callback) {
+  Execution execution(partition_count, std::move(reader), options,
+                      retry_policy, backoff_policy, std::move(callback),
+                      [](Status const&) {});
+  execution.Start();
+  execution.Join();
+  return execution.status();
+}
+
+}  // namespace
+
+ParallelExecutor::ParallelExecutor(
+    Client client, ParallelExecutorOptions options,
+    std::unique_ptr<RetryPolicy> retry_policy,
+    std::unique_ptr<BackoffPolicy> backoff_policy)
+    : client_(std::move(client)),
+      options_(std::move(options)),
+      retry_policy_prototype_(std::move(retry_policy)),
+      backoff_policy_prototype_(std::move(backoff_policy)) {}
+
+Status ParallelExecutor::Run(std::vector<QueryPartition> partitions,
+                             RowCallback callback) {
+  auto const count = partitions.size();
+  return RunPartitions(count, MakeReader(client_, std::move(partitions)),
+                       options_, *retry_policy_prototype_,
+                       *backoff_policy_prototype_, std::move(callback));
+}
+
+Status ParallelExecutor::Run(std::vector<ReadPartition> partitions,
+                             RowCallback callback) {
+  auto const count = partitions.size();
+  return RunPartitions(count, MakeReader(client_, std::move(partitions)),
+                       options_, *retry_policy_prototype_,
+                       *backoff_policy_prototype_, std::move(callback));
+}
+
+RowStream ParallelExecutor::Stream(std::vector<QueryPartition> partitions) {
+  auto const count = partitions.size();
+  return RowStream(absl::make_unique<ParallelResultSource>(
+      count, MakeReader(client_, std::move(partitions)), options_,
+      *retry_policy_prototype_, *backoff_policy_prototype_));
+}
+
+RowStream ParallelExecutor::Stream(std::vector<ReadPartition> partitions) {
+  auto const count = partitions.size();
+  return RowStream(absl::make_unique<ParallelResultSource>(
+      count, MakeReader(client_, std::move(partitions)), options_,
+      *retry_policy_prototype_, *backoff_policy_prototype_));
+}
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,173 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_PARALLEL_EXECUTOR_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_PARALLEL_EXECUTOR_H
+
+#include "google/cloud/spanner/backoff_policy.h"
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/spanner/query_partition.h"
+#include "google/cloud/spanner/read_partition.h"
+#include "google/cloud/spanner/results.h"
+#include "google/cloud/spanner/retry_policy.h"
+#include "google/cloud/spanner/row.h"
+#include "google/cloud/spanner/version.h"
+#include "google/cloud/status.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+/**
+ * The outcome of running a single partition with `ParallelExecutor`.
+ */
+struct PartitionStats {
+  /// The position of the partition in the vector given to `ParallelExecutor`.
+  std::size_t index = 0;
+
+  /// The number of rows delivered from the partition.
+  std::int64_t rows = 0;
+
+  /// The (encoded) size of the values delivered from the partition.
+  std::int64_t bytes = 0;
+
+  /// The number of times the partition was started, including retries.
+  int attempts = 0;
+
+  /// The time spent running the partition, including any retry backoff.
+  std::chrono::microseconds elapsed{0};
+
+  /// The final status of the partition.
+  Status status;
+
+  double RowsPerSecond() const { return PerSecond(rows); }
+  double BytesPerSecond() const { return PerSecond(bytes); }
+
+ private:
+  double PerSecond(std::int64_t n) const {
+    if (elapsed.count() == 0) return 0.0;
+    return static_cast<double>(n) * 1.0E6 /
+           static_cast<double>(elapsed.count());
+  }
+};
+
+/// Options for `ParallelExecutor`.
+struct ParallelExecutorOptions {
+  /// The maximum number of partitions that run concurrently.
+  int max_concurrency = 4;
+
+  /**
+   * The maximum number of rows held by the `RowStream` returned from
+   * `ParallelExecutor::Stream()`. When the queue is full the partitions stop
+   * reading until the caller consumes some rows.
+   */
+  std::size_t max_queued_rows = 1024;
+
+  /**
+   * Called as each partition finishes, successfully or not. It may be called
+   * concurrently from different threads.
+   */
+  std::function<void(PartitionStats const&)> partition_stats_callback;
+};
+
+/**
+ * Runs the partitions returned by `Client::PartitionQuery()` or
+ * `Client::PartitionRead()` concurrently, and merges their rows.
+ *
+ * Each partition runs on its own thread, with at most
+ * `ParallelExecutorOptions::max_concurrency` partitions running at once. The
+ * partitions share the `Client`, and thus its session pool and channels.
+ *
+ * A partition that fails before delivering any rows is retried on its own,
+ * according to the retry and backoff policies. A partition that fails after
+ * delivering some rows is not retried (the underlying stream is already
+ * resumed by the `Connection` where that is possible), and its error stops
+ * the other partitions.
+ *
+ * @par Example
+ * @code
+ * namespace spanner = ::google::cloud::spanner;
+ * auto partitions = client.PartitionQuery(txn, sql);
+ * if (!partitions) throw std::runtime_error(partitions.status().message());
+ * spanner::ParallelExecutor executor(client);
+ * auto status = executor.Run(
+ *     *std::move(partitions), [](std::size_t, spanner::Row row) {
+ *       Export(std::move(row));
+ *       return google::cloud::Status();
+ *     });
+ * @endcode
+ */
+class ParallelExecutor {
+ public:
+  /**
+   * Receives the rows of each partition, in order. The rows of different
+   * partitions are delivered concurrently, from different threads.
+   *
+   * Returning an error stops the execution, and `Run()` returns that error.
+   */
+  using RowCallback = std::function<Status(std::size_t partition, Row row)>;
+
+  explicit ParallelExecutor(
+      Client client, ParallelExecutorOptions options = {},
+      std::unique_ptr<RetryPolicy> retry_policy =
+          LimitedErrorCountRetryPolicy(3).clone(),
+      std::unique_ptr<BackoffPolicy> backoff_policy =
+          ExponentialBackoffPolicy(std::chrono::milliseconds(100),
+                                   std::chrono::seconds(10), 2.0)
+              .clone());
+
+  /**
+   * Runs @p partitions and delivers their rows to @p callback, returning once
+   * all the partitions have finished.
+   *
+   * @return the first error from a partition or from @p callback.
+   */
+  Status Run(std::vector<QueryPartition> partitions, RowCallback callback);
+
+  /// @copydoc Run(std::vector<QueryPartition>, RowCallback)
+  Status Run(std::vector<ReadPartition> partitions, RowCallback callback);
+
+  /**
+   * Starts running @p partitions and returns a stream of their merged rows.
+   *
+   * The rows of each partition appear in order, but interleaved with the
+   * rows from other partitions. At most
+   * `ParallelExecutorOptions::max_queued_rows` rows are buffered. Destroying
+   * the stream stops any partitions that are still running.
+   */
+  RowStream Stream(std::vector<QueryPartition> partitions);
+
+  /// @copydoc Stream(std::vector<QueryPartition>)
+  RowStream Stream(std::vector<ReadPartition> partitions);
+
+ private:
+  Client client_;
+  ParallelExecutorOptions options_;
+  std::shared_ptr<RetryPolicy const> retry_policy_prototype_;
+  std::shared_ptr<BackoffPolicy const> backoff_policy_prototype_;
+};
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_PARALLEL_EXECUTOR_H
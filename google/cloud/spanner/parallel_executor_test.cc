@@ -0,0 +1,321 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/parallel_executor.h"
+#include "google/cloud/spanner/mocks/mock_spanner_connection.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace {
+
+using ::google::cloud::spanner_mocks::MockConnection;
+using ::testing::_;
+using ::testing::Invoke;
+
+// A source returning a fixed sequence of rows, optionally followed by an
+// error.
+class FakeSource : public internal::ResultSourceInterface {
+ public:
+  explicit FakeSource(std::vector<Row> rows, Status status = {})
+      : rows_(std::move(rows)), status_(std::move(status)) {}
+
+  StatusOr<Row> NextRow() override {
+    if (next_ == rows_.size()) {
+      if (!status_.ok()) return status_;
+      return Row();
+    }
+    return rows_[next_++];
+  }
+  absl::optional<google::spanner::v1::ResultSetMetadata> Metadata() override {
+    return {};
+  }
+  absl::optional<google::spanner::v1::ResultSetStats> Stats() const override {
+    return {};
+  }
+
+ private:
+  std::vector<Row> rows_;
+  Status status_;
+  std::size_t next_ = 0;
+};
+
+RowStream MakeRows(std::int64_t first, std::int64_t count,
+                   Status status = {}) {
+  std::vector<Row> rows;
+  for (std::int64_t i = 0; i != count; ++i) {
+    rows.push_back(MakeTestRow(first + i));
+  }
+  return RowStream(
+      absl::make_unique<FakeSource>(std::move(rows), std::move(status)));
+}
+
+std::vector<QueryPartition> MakeQueryPartitions(int count) {
+  std::vector<QueryPartition> partitions;
+  for (int i = 0; i != count; ++i) {
+    partitions.push_back(internal::MakeQueryPartition(
+        "txn", "session", "p" + std::to_string(i), SqlStatement("SELECT 1")));
+  }
+  return partitions;
+}
+
+// Partition "pN" returns the rows 100*N, ..., 100*N + 9.
+RowStream PartitionRows(absl::optional<std::string> const& token) {
+  auto const n = std::stoi(token->substr(1));
+  return MakeRows(100 * n, 10);
+}
+
+std::unique_ptr<BackoffPolicy> NoBackoff() {
+  return ExponentialBackoffPolicy(std::chrono::microseconds(1),
+                                  std::chrono::microseconds(1), 2.0)
+      .clone();
+}
+
+TEST(ParallelExecutorTest, RunQueryPartitions) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, ExecuteQuery(_))
+      .Times(5)
+      .WillRepeatedly(Invoke([](Connection::SqlParams const& p) {
+        return PartitionRows(p.partition_token);
+      }));
+
+  std::mutex mu;
+  std::map<std::size_t, std::vector<std::int64_t>> rows;
+  std::vector<PartitionStats> stats;
+  ParallelExecutorOptions options;
+  options.max_concurrency = 2;
+  options.partition_stats_callback = [&](PartitionStats const& s) {
+    std::lock_guard<std::mutex> lk(mu);
+    stats.push_back(s);
+  };
+  ParallelExecutor executor(Client(conn), options);
+  auto status = executor.Run(MakeQueryPartitions(5),
+                             [&](std::size_t partition, Row row) {
+                               auto v = row.get<std::int64_t>(0);
+                               if (!v) return v.status();
+                               std::lock_guard<std::mutex> lk(mu);
+                               rows[partition].push_back(*v);
+                               return Status();
+                             });
+  ASSERT_STATUS_OK(status);
+
+  ASSERT_EQ(5, rows.size());
+  for (auto const& kv : rows) {
+    std::vector<std::int64_t> expected;
+    auto const first = static_cast<std::int64_t>(100 * kv.first);
+    for (std::int64_t i = 0; i != 10; ++i) expected.push_back(first + i);
+    EXPECT_EQ(expected, kv.second);
+  }
+  ASSERT_EQ(5, stats.size());
+  for (auto const& s : stats) {
+    EXPECT_STATUS_OK(s.status);
+    EXPECT_EQ(10, s.rows);
+    EXPECT_LT(0, s.bytes);
+    EXPECT_EQ(1, s.attempts);
+  }
+}
+
+TEST(ParallelExecutorTest, RunReadPartitions) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, Read(_))
+      .Times(3)
+      .WillRepeatedly(Invoke([](Connection::ReadParams const& p) {
+        return PartitionRows(p.partition_token);
+      }));
+
+  std::vector<ReadPartition> partitions;
+  for (int i = 0; i != 3; ++i) {
+    partitions.push_back(internal::MakeReadPartition(
+        "txn", "session", "p" + std::to_string(i), "table", KeySet::All(),
+        {"col"}));
+  }
+  std::mutex mu;
+  std::int64_t sum = 0;
+  ParallelExecutor executor{Client(conn)};
+  auto status =
+      executor.Run(std::move(partitions), [&](std::size_t, Row row) {
+        std::lock_guard<std::mutex> lk(mu);
+        sum += row.get<std::int64_t>(0).value();
+        return Status();
+      });
+  ASSERT_STATUS_OK(status);
+  // 10 * (0 + 100 + 200) + 3 * (0 + 1 + ... + 9)
+  EXPECT_EQ(3135, sum);
+}
+
+TEST(ParallelExecutorTest, RetryPartitionWithoutRows) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, ExecuteQuery(_))
+      .WillOnce(Invoke([](Connection::SqlParams const&) {
+        return MakeRows(0, 0, Status(StatusCode::kUnavailable, "try-again"));
+      }))
+      .WillOnce(Invoke([](Connection::SqlParams const& p) {
+        return PartitionRows(p.partition_token);
+      }));
+
+  std::vector<PartitionStats> stats;
+  ParallelExecutorOptions options;
+  options.partition_stats_callback = [&](PartitionStats const& s) {
+    stats.push_back(s);
+  };
+  ParallelExecutor executor(Client(conn), options,
+                            LimitedErrorCountRetryPolicy(2).clone(),
+                            NoBackoff());
+  int count = 0;
+  auto status = executor.Run(MakeQueryPartitions(1), [&](std::size_t, Row) {
+    ++count;
+    return Status();
+  });
+  ASSERT_STATUS_OK(status);
+  EXPECT_EQ(10, count);
+  ASSERT_EQ(1, stats.size());
+  EXPECT_EQ(2, stats[0].attempts);
+  EXPECT_EQ(10, stats[0].rows);
+}
+
+TEST(ParallelExecutorTest, NoRetryAfterRows) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, ExecuteQuery(_))
+      .WillOnce(Invoke([](Connection::SqlParams const&) {
+        return MakeRows(0, 3, Status(StatusCode::kUnavailable, "try-again"));
+      }));
+
+  ParallelExecutor executor(Client(conn), {},
+                            LimitedErrorCountRetryPolicy(2).clone(),
+                            NoBackoff());
+  int count = 0;
+  auto status = executor.Run(MakeQueryPartitions(1), [&](std::size_t, Row) {
+    ++count;
+    return Status();
+  });
+  EXPECT_EQ(StatusCode::kUnavailable, status.code());
+  EXPECT_EQ(3, count);
+}
+
+TEST(ParallelExecutorTest, CallbackError) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, ExecuteQuery(_))
+      .WillOnce(Invoke([](Connection::SqlParams const& p) {
+        return PartitionRows(p.partition_token);
+      }));
+
+  ParallelExecutorOptions options;
+  options.max_concurrency = 1;
+  ParallelExecutor executor(Client(conn), options);
+  auto status = executor.Run(MakeQueryPartitions(3), [](std::size_t, Row) {
+    return Status(StatusCode::kUnavailable, "callback");
+  });
+  EXPECT_EQ(StatusCode::kUnavailable, status.code());
+  EXPECT_EQ("callback", status.message());
+}
+
+TEST(ParallelExecutorTest, StreamQueryPartitions) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, ExecuteQuery(_))
+      .Times(4)
+      .WillRepeatedly(Invoke([](Connection::SqlParams const& p) {
+        return PartitionRows(p.partition_token);
+      }));
+
+  ParallelExecutorOptions options;
+  options.max_concurrency = 3;
+  options.max_queued_rows = 2;
+  ParallelExecutor executor(Client(conn), options);
+  auto rows = executor.Stream(MakeQueryPartitions(4));
+  std::map<std::int64_t, std::vector<std::int64_t>> actual;
+  for (auto& row : StreamOf<std::tuple<std::int64_t>>(rows)) {
+    ASSERT_STATUS_OK(row);
+    auto v = std::get<0>(*row);
+    actual[v / 100].push_back(v);
+  }
+  ASSERT_EQ(4, actual.size());
+  for (auto const& kv : actual) {
+    EXPECT_EQ(10, kv.second.size());
+    EXPECT_TRUE(std::is_sorted(kv.second.begin(), kv.second.end()));
+  }
+}
+
+TEST(ParallelExecutorTest, StreamError) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, ExecuteQuery(_))
+      .WillOnce(Invoke([](Connection::SqlParams const&) {
+        return MakeRows(0, 1, Status(StatusCode::kPermissionDenied, "uh-oh"));
+      }));
+
+  ParallelExecutor executor{Client(conn)};
+  auto rows = executor.Stream(MakeQueryPartitions(1));
+  Status status;
+  for (auto& row : rows) {
+    if (!row) {
+      status = std::move(row).status();
+      break;
+    }
+  }
+  EXPECT_EQ(StatusCode::kPermissionDenied, status.code());
+}
+
+TEST(ParallelExecutorTest, StreamDestroyedEarly) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, ExecuteQuery(_))
+      .WillRepeatedly(Invoke([](Connection::SqlParams const& p) {
+        return PartitionRows(p.partition_token);
+      }));
+
+  ParallelExecutorOptions options;
+  options.max_queued_rows = 1;
+  ParallelExecutor executor(Client(conn), options);
+  auto rows = executor.Stream(MakeQueryPartitions(8));
+  auto it = rows.begin();
+  ASSERT_NE(it, rows.end());
+  EXPECT_STATUS_OK(*it);
+  // Destroying `rows` must stop the partitions blocked on the full queue.
+}
+
+TEST(ParallelExecutorTest, NoPartitions) {
+  auto conn = std::make_shared<MockConnection>();
+  ParallelExecutor executor{Client(conn)};
+  EXPECT_STATUS_OK(executor.Run(std::vector<QueryPartition>{},
+                                [](std::size_t, Row) { return Status(); }));
+  auto rows = executor.Stream(std::vector<ReadPartition>{});
+  EXPECT_EQ(rows.begin(), rows.end());
+}
+
+TEST(ParallelExecutorTest, PartitionStatsRates) {
+  PartitionStats stats;
+  EXPECT_EQ(0.0, stats.RowsPerSecond());
+  stats.rows = 10;
+  stats.bytes = 1000;
+  stats.elapsed = std::chrono::milliseconds(500);
+  EXPECT_DOUBLE_EQ(20.0, stats.RowsPerSecond());
+  EXPECT_DOUBLE_EQ(2000.0, stats.BytesPerSecond());
+}
+
+}  // namespace
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,50 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/prepared_statement.h"
+#include "google/cloud/internal/throw_delegate.h"
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+std::shared_ptr<PreparedSqlStatement const> MakePreparedSqlStatement(
+    std::string sql, std::vector<std::string> param_names,
+    std::vector<google::spanner::v1::Type> param_types) {
+  auto prepared = std::make_shared<PreparedSqlStatement>();
+  prepared->sql = std::move(sql);
+  for (std::size_t i = 0; i != param_names.size(); ++i) {
+    auto const& name = param_names[i];
+    if (name.empty()) {
+      google::cloud::internal::ThrowInvalidArgument(
+          "PreparedStatement parameter names must not be empty");
+    }
+    auto inserted =
+        prepared->param_types.insert({name, std::move(param_types[i])});
+    if (!inserted.second) {
+      google::cloud::internal::ThrowInvalidArgument(
+          "PreparedStatement parameter names must be unique: " + name);
+    }
+  }
+  prepared->param_names = std::move(param_names);
+  return prepared;
+}
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,115 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_PREPARED_STATEMENT_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_PREPARED_STATEMENT_H
+
+#include "google/cloud/spanner/sql_statement.h"
+#include "google/cloud/spanner/value.h"
+#include "google/cloud/spanner/version.h"
+#include <array>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+// Internal implementation details that callers should not use.
+namespace internal {
+/**
+ * Creates the shared state of a `PreparedStatement`.
+ *
+ * @throw std::invalid_argument if a parameter name is empty or repeated.
+ */
+std::shared_ptr<PreparedSqlStatement const> MakePreparedSqlStatement(
+    std::string sql, std::vector<std::string> param_names,
+    std::vector<google::spanner::v1::Type> param_types);
+}  // namespace internal
+
+/**
+ * A SQL statement whose parameter names and types are fixed in advance.
+ *
+ * Applications that run the same statements many times can prepare them once,
+ * and then `Bind()` the values for each execution. The parameter types are
+ * encoded when the statement is prepared, and the SQL text and types are
+ * shared by all the bindings, so each execution only needs to encode the
+ * values. Compared to a `SqlStatement` with a `SqlStatement::ParamType`, this
+ * avoids building a hash map of `Value` objects, and their types, per call.
+ *
+ * The types `Ts...` are the C++ types of the parameters, in the same order as
+ * their names. Use `absl::optional<T>` for parameters that may be null.
+ *
+ * @par Example
+ * @code
+ * namespace spanner = ::google::cloud::spanner;
+ * spanner::PreparedStatement<std::int64_t, std::string> const update(
+ *     "UPDATE Singers SET FirstName = @name WHERE SingerId = @id",
+ *     {"id", "name"});
+ * auto result = client.ExecuteDml(txn, update.Bind(42, "Elwood"));
+ * @endcode
+ *
+ * @note `PreparedStatement` objects are cheap to copy, and are safe to use
+ *     concurrently from multiple threads.
+ */
+template <typename... Ts>
+class PreparedStatement {
+ public:
+  /// The names of the parameters, in the same order as `Ts...`.
+  using ParamNames = std::array<std::string, sizeof...(Ts)>;
+
+  /**
+   * Prepares the @p sql statement, with the given parameter names.
+   *
+   * @throw std::invalid_argument if a parameter name is empty or repeated.
+   */
+  PreparedStatement(std::string sql, ParamNames param_names)
+      : prepared_(internal::MakePreparedSqlStatement(
+            std::move(sql),
+            std::vector<std::string>(
+                std::make_move_iterator(param_names.begin()),
+                std::make_move_iterator(param_names.end())),
+            {internal::MakeTypeProto<Ts>()...})) {}
+
+  /// Returns the SQL statement.
+  std::string const& sql() const { return prepared_->sql; }
+
+  /// Returns the names of all the parameters, in order.
+  std::vector<std::string> const& ParameterNames() const {
+    return prepared_->param_names;
+  }
+
+  /// Returns a `SqlStatement` with the given parameter @p values.
+  SqlStatement Bind(Ts... values) const {
+    std::vector<google::protobuf::Value> protos;
+    protos.reserve(sizeof...(Ts));
+    (void)std::initializer_list<int>{
+        (protos.push_back(internal::MakeValueProto(std::move(values))), 0)...};
+    return internal::MakeSqlStatement(prepared_, std::move(protos));
+  }
+
+ private:
+  std::shared_ptr<internal::PreparedSqlStatement const> prepared_;
+};
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_PREPARED_STATEMENT_H
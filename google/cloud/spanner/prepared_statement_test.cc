@@ -0,0 +1,147 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/prepared_statement.h"
+#include "google/cloud/spanner/testing/matchers.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "absl/types/optional.h"
+#include <gmock/gmock.h>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace {
+
+using ::google::cloud::spanner_testing::IsProtoEqual;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+TEST(PreparedStatementTest, Accessors) {
+  PreparedStatement<std::int64_t, std::string> const stmt(
+      "UPDATE Singers SET FirstName = @name WHERE SingerId = @id",
+      {"id", "name"});
+  EXPECT_EQ("UPDATE Singers SET FirstName = @name WHERE SingerId = @id",
+            stmt.sql());
+  EXPECT_THAT(stmt.ParameterNames(), ElementsAre("id", "name"));
+}
+
+TEST(PreparedStatementTest, BindMatchesSqlStatement) {
+  PreparedStatement<std::int64_t, std::string, std::vector<double>,
+                    absl::optional<bool>> const stmt(
+      "SELECT * FROM T WHERE a = @a AND b = @b AND c = @c AND d = @d",
+      {"a", "b", "c", "d"});
+  auto const bound = stmt.Bind(42, "foo", {1.5, 2.5}, absl::nullopt);
+  SqlStatement const expected(
+      "SELECT * FROM T WHERE a = @a AND b = @b AND c = @c AND d = @d",
+      {{"a", Value(42)},
+       {"b", Value("foo")},
+       {"c", Value(std::vector<double>{1.5, 2.5})},
+       {"d", MakeNullValue<bool>()}});
+
+  EXPECT_THAT(internal::ToProto(bound),
+              IsProtoEqual(internal::ToProto(expected)));
+  EXPECT_EQ(expected, bound);
+  EXPECT_EQ(expected.sql(), bound.sql());
+  EXPECT_EQ(expected.params(), bound.params());
+  EXPECT_THAT(bound.ParameterNames(), ElementsAre("a", "b", "c", "d"));
+
+  auto param = bound.GetParameter("b");
+  ASSERT_STATUS_OK(param);
+  EXPECT_EQ(Value("foo"), *param);
+  EXPECT_EQ(StatusCode::kNotFound, bound.GetParameter("e").status().code());
+}
+
+TEST(PreparedStatementTest, BindingsAreIndependent) {
+  PreparedStatement<std::int64_t> const stmt(
+      "SELECT * FROM T WHERE a = @a", {"a"});
+  auto const b1 = stmt.Bind(1);
+  auto const b2 = stmt.Bind(2);
+  EXPECT_NE(b1, b2);
+  EXPECT_EQ(SqlStatement("SELECT * FROM T WHERE a = @a", {{"a", Value(1)}}),
+            b1);
+  EXPECT_EQ(SqlStatement("SELECT * FROM T WHERE a = @a", {{"a", Value(2)}}),
+            b2);
+
+  // Copies of a binding own their encoded values.
+  auto copy = b1;
+  EXPECT_EQ(b1.params(), copy.params());
+  EXPECT_THAT(internal::ToProto(std::move(copy)),
+              IsProtoEqual(internal::ToProto(b1)));
+}
+
+TEST(PreparedStatementTest, ConcurrentReaders) {
+  PreparedStatement<std::int64_t, std::string> const stmt(
+      "SELECT * FROM T WHERE a = @a AND b = @b", {"a", "b"});
+  auto const bound = stmt.Bind(42, "foo");
+  SqlStatement::ParamType const expected{{"a", Value(42)},
+                                         {"b", Value("foo")}};
+
+  // The parameters of a shared statement can be read from many threads.
+  std::vector<std::thread> readers;
+  for (int i = 0; i != 4; ++i) {
+    readers.emplace_back([&bound, &expected] {
+      for (int j = 0; j != 100; ++j) {
+        EXPECT_EQ(expected, bound.params());
+        EXPECT_EQ(Value(42), bound.GetParameter("a").value());
+      }
+    });
+  }
+  for (auto& t : readers) t.join();
+}
+
+TEST(PreparedStatementTest, NoParameters) {
+  PreparedStatement<> const stmt("SELECT 1", {});
+  auto const bound = stmt.Bind();
+  EXPECT_EQ(SqlStatement("SELECT 1"), bound);
+  EXPECT_TRUE(bound.params().empty());
+  EXPECT_THAT(internal::ToProto(bound),
+              IsProtoEqual(internal::ToProto(SqlStatement("SELECT 1"))));
+}
+
+TEST(PreparedStatementTest, OStreamOperator) {
+  PreparedStatement<std::string> const stmt(
+      "SELECT * FROM T WHERE a = @a", {"a"});
+  std::ostringstream bound;
+  bound << stmt.Bind("foo");
+  std::ostringstream expected;
+  expected << SqlStatement("SELECT * FROM T WHERE a = @a",
+                           {{"a", Value("foo")}});
+  EXPECT_EQ(expected.str(), bound.str());
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+TEST(PreparedStatementTest, InvalidNames) {
+  using Stmt = PreparedStatement<std::int64_t, std::int64_t>;
+  try {
+    Stmt("SELECT @a", {"a", "a"});
+    FAIL() << "expected an exception for repeated names";
+  } catch (std::invalid_argument const& ex) {
+    EXPECT_THAT(ex.what(), HasSubstr("unique: a"));
+  }
+  EXPECT_THROW(Stmt("SELECT @a", {"a", ""}), std::invalid_argument);
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
+}  // namespace
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,35 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/read_cache_options.h"
+#include <ostream>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+std::ostream& operator<<(std::ostream& os, ReadCacheMetrics const& metrics) {
+  return os << "entries=" << metrics.entries << " hits=" << metrics.hits
+            << " coalesced=" << metrics.coalesced
+            << " misses=" << metrics.misses
+            << " stale_misses=" << metrics.stale_misses
+            << " uncacheable=" << metrics.uncacheable
+            << " evictions=" << metrics.evictions;
+}
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,129 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_READ_CACHE_OPTIONS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_READ_CACHE_OPTIONS_H
+
+#include "google/cloud/spanner/version.h"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+/**
+ * Controls the client-side cache for bounded-staleness reads.
+ *
+ * When enabled, `Client::Read()` calls that use a single-use transaction
+ * with a bounded staleness (`Transaction::SingleUseOptions` constructed from
+ * a `max_staleness` or a `min_read_timestamp`) are served from a cache, as
+ * long as the cached result was read at a timestamp within the caller's
+ * bound. The entries are keyed on the table, the index, the `KeySet`, the
+ * columns and the row limit, and the least recently used entries are evicted
+ * when the cache is full. Concurrent identical reads that miss the cache
+ * share a single RPC.
+ *
+ * Cached reads receive all their rows (up to `max_rows_per_entry`) before
+ * the call returns, rather than streaming them. All other reads, and queries,
+ * are not affected.
+ *
+ * The cache is disabled by default.
+ */
+class ReadCacheOptions {
+ public:
+  /// The maximum number of cached results. Zero (the default) disables the
+  /// cache.
+  ReadCacheOptions& set_max_entries(std::size_t v) {
+    max_entries_ = v;
+    return *this;
+  }
+  std::size_t max_entries() const { return max_entries_; }
+
+  /// The number of independently locked shards. Values < 1 are treated as 1.
+  ReadCacheOptions& set_num_shards(int v) {
+    num_shards_ = v;
+    return *this;
+  }
+  int num_shards() const { return num_shards_; }
+
+  /// Results with more rows than this are streamed to the caller, and not
+  /// cached.
+  ReadCacheOptions& set_max_rows_per_entry(std::size_t v) {
+    max_rows_per_entry_ = v;
+    return *this;
+  }
+  std::size_t max_rows_per_entry() const { return max_rows_per_entry_; }
+
+  friend bool operator==(ReadCacheOptions const& a, ReadCacheOptions const& b) {
+    return a.max_entries_ == b.max_entries_ &&
+           a.num_shards_ == b.num_shards_ &&
+           a.max_rows_per_entry_ == b.max_rows_per_entry_;
+  }
+
+  friend bool operator!=(ReadCacheOptions const& a, ReadCacheOptions const& b) {
+    return !(a == b);
+  }
+
+ private:
+  std::size_t max_entries_ = 0;
+  int num_shards_ = 16;
+  std::size_t max_rows_per_entry_ = 1000;
+};
+
+/**
+ * A snapshot of the counters of the read cache.
+ *
+ * Every cacheable read counts as one of `hits`, `coalesced` or `misses`.
+ */
+struct ReadCacheMetrics {
+  /// The number of reads served from a cached result.
+  std::uint64_t hits = 0;
+
+  /// The number of reads that waited for an identical read already in flight,
+  /// and were served by its result.
+  std::uint64_t coalesced = 0;
+
+  /// The number of reads sent to the service.
+  std::uint64_t misses = 0;
+
+  /// The misses where the cached result was older than the staleness bound.
+  std::uint64_t stale_misses = 0;
+
+  /// The results not cached because they were too large, or failed.
+  std::uint64_t uncacheable = 0;
+
+  /// The number of entries evicted to make room for new ones.
+  std::uint64_t evictions = 0;
+
+  /// The current number of cached results.
+  std::size_t entries = 0;
+};
+
+/**
+ * Outputs a human-readable summary of @p metrics.
+ *
+ * @warning This is intended for debugging and human consumption only, not
+ *     machine consumption, as the output format may change without notice.
+ */
+std::ostream& operator<<(std::ostream& os, ReadCacheMetrics const& metrics);
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_READ_CACHE_OPTIONS_H
@@ -67,10 +67,20 @@ absl::optional<spanner::ExecutionPlan> GetExecutionPlan(
 }
 }  // namespace
 
+namespace internal {
+Status ResultSourceInterface::SetColumnSink(std::string const&, ColumnSink) {
+  return Status(StatusCode::kUnimplemented, "column sinks are not supported");
+}
+}  // namespace internal
+
 absl::optional<Timestamp> RowStream::ReadTimestamp() const {
   return GetReadTimestamp(source_);
 }
 
+Status RowStream::SetColumnSink(std::string const& name, ColumnSink sink) {
+  return source_->SetColumnSink(name, std::move(sink));
+}
+
 absl::optional<Timestamp> ProfileQueryResult::ReadTimestamp() const {
   return GetReadTimestamp(source_);
 }
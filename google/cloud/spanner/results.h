@@ -21,9 +21,12 @@
 #include "google/cloud/optional.h"
 #include "absl/types/optional.h"
 #include <google/spanner/v1/spanner.pb.h>
+#include <functional>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <unordered_map>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -41,6 +44,16 @@ inline namespace SPANNER_CLIENT_NS {
  */
 using ExecutionPlan = ::google::spanner::v1::QueryPlan;
 
+/**
+ * Receives the value of a STRING or BYTES column in pieces, as the pieces
+ * arrive from the service. See `RowStream::SetColumnSink()`.
+ *
+ * The pieces of each (non-NULL) value are delivered in order, with @p last
+ * set to `true` exactly once, on the final (and possibly empty) piece of each
+ * value. BYTES values are delivered as decoded octets.
+ */
+using ColumnSink = std::function<void(std::string piece, bool last)>;
+
 namespace internal {
 class ResultSourceInterface {
  public:
@@ -49,9 +62,121 @@ class ResultSourceInterface {
   virtual StatusOr<Row> NextRow() = 0;
   virtual absl::optional<google::spanner::v1::ResultSetMetadata> Metadata() = 0;
   virtual absl::optional<google::spanner::v1::ResultSetStats> Stats() const = 0;
+
+  // Sources that hold the `Value` protos of each row may return them directly
+  // via `NextRowProtos()`, skipping the `Row` built by `NextRow()`. The types
+  // of those protos are given by `Metadata()->row_type()`.
+  virtual bool SupportsRowProtos() const { return false; }
+  // Moves the `Value` protos of the next row into `values`. Returns OK Status
+  // with empty `values` to indicate end-of-stream.
+  virtual Status NextRowProtos(std::vector<google::protobuf::Value>& values) {
+    values.clear();
+    return Status(StatusCode::kUnimplemented, "NextRowProtos()");
+  }
+
+  // Delivers the values of the column @p name to @p sink instead of storing
+  // them in the rows. See `RowStream::SetColumnSink()`.
+  virtual Status SetColumnSink(std::string const& name, ColumnSink sink);
+};
+
+/**
+ * Decodes the rows of a `ResultSourceInterface` directly into `Tuple` objects.
+ *
+ * The column types are checked against the result set metadata once, when
+ * the first row arrives. After that each `google::protobuf::Value` is
+ * converted straight into the matching tuple element, without creating the
+ * `Value` (and its `Type` proto) or `Row` objects used by `RowStream`.
+ *
+ * Sources that do not support `NextRowProtos()` fall back to `NextRow()`.
+ */
+template <typename Tuple>
+class TupleDecoder {
+ public:
+  explicit TupleDecoder(ResultSourceInterface& source) : source_(source) {}
+
+  // Returns an empty optional to indicate end-of-stream.
+  StatusOr<absl::optional<Tuple>> Next() {
+    if (!source_.SupportsRowProtos()) return NextFromRow();
+    if (!metadata_) {
+      metadata_ = source_.Metadata();
+      if (!metadata_) metadata_.emplace();
+    }
+    auto const& fields = metadata_->row_type().fields();
+
+    auto status = source_.NextRowProtos(values_);
+    if (!status.ok()) return status;
+    if (values_.empty()) return absl::optional<Tuple>{};
+    if (!types_checked_) {
+      if (fields.size() != std::tuple_size<Tuple>::value) {
+        auto const msg = "Tuple has the wrong number of elements";
+        return Status(StatusCode::kInvalidArgument, msg);
+      }
+      bool ok = true;
+      Tuple tup;
+      ForEach(tup, CheckType{ok, 0}, fields);
+      if (!ok) return Status(StatusCode::kUnknown, "wrong type");
+      types_checked_ = true;
+    }
+
+    Tuple tup;
+    ForEach(tup, DecodeValue{status, 0}, fields, values_);
+    if (!status.ok()) return status;
+    return absl::optional<Tuple>(std::move(tup));
+  }
+
+ private:
+  using Fields = google::protobuf::RepeatedPtrField<
+      google::spanner::v1::StructType::Field>;
+
+  // A functor to be used with internal::ForEach to check that each column
+  // type matches the corresponding tuple element.
+  struct CheckType {
+    bool& ok;
+    int i;
+    template <typename T>
+    void operator()(T const&, Fields const& fields) {
+      ok = ok && TypeProtoIs<T>(fields.Get(i).type());
+      ++i;
+    }
+  };
+
+  // A functor to be used with internal::ForEach to decode each column into
+  // the corresponding tuple element.
+  struct DecodeValue {
+    Status& status;
+    int i;
+    template <typename T>
+    void operator()(T& t, Fields const& fields,
+                    std::vector<google::protobuf::Value>& values) {
+      auto v = GetValueFromProto<T>(fields.Get(i).type(), std::move(values[i]));
+      ++i;
+      if (!v) {
+        status = std::move(v).status();
+      } else {
+        t = *std::move(v);
+      }
+    }
+  };
+
+  StatusOr<absl::optional<Tuple>> NextFromRow() {
+    auto row = source_.NextRow();
+    if (!row) return std::move(row).status();
+    if (row->size() == 0) return absl::optional<Tuple>{};
+    auto tup = std::move(*row).template get<Tuple>();
+    if (!tup) return std::move(tup).status();
+    return absl::optional<Tuple>(*std::move(tup));
+  }
+
+  ResultSourceInterface& source_;
+  absl::optional<google::spanner::v1::ResultSetMetadata> metadata_;
+  std::vector<google::protobuf::Value> values_;
+  bool types_checked_ = false;
 };
 }  // namespace internal
 
+template <typename Tuple>
+TupleStream<Tuple> StreamOf(RowStream& range);
+
 /**
  * Represents the stream of `Rows` returned from `spanner::Client::Read()` or
  * `spanner::Client::ExecuteQuery()`.
@@ -93,10 +218,52 @@ class RowStream {
    */
   absl::optional<Timestamp> ReadTimestamp() const;
 
+  /**
+   * Delivers the values of the STRING or BYTES column @p name to @p sink as
+   * they arrive, instead of storing them in the returned rows.
+   *
+   * This allows very large values to be processed without holding them (and,
+   * for BYTES, their base64 encoding) in memory. Each value is delivered to
+   * the @p sink before the `Row` containing it is returned. That `Row` holds
+   * an empty value for the column instead, unless the value is NULL.
+   *
+   * Call this before iterating over the rows. Values that have already been
+   * received but not yet returned are delivered immediately.
+   *
+   * @return an error if there is no such STRING or BYTES column, or if the
+   *     stream does not support column sinks.
+   */
+  Status SetColumnSink(std::string const& name, ColumnSink sink);
+
  private:
+  template <typename T>
+  friend TupleStream<T> StreamOf(RowStream& range);
+
   std::unique_ptr<internal::ResultSourceInterface> source_;
 };
 
+/**
+ * A factory that creates a `TupleStream<Tuple>` by wrapping the given
+ * `RowStream`.
+ *
+ * This overload is chosen over the generic `StreamOf()` for a `RowStream`. It
+ * decodes each row of the result set directly into a `Tuple`, checking the
+ * column types only once per stream, rather than building a `Row` of `Value`
+ * objects and converting that. The results are otherwise the same.
+ *
+ * @note ownership of the @p range is not transferred, so it must outlive the
+ *     returned `TupleStream`.
+ */
+template <typename Tuple>
+TupleStream<Tuple> StreamOf(RowStream& range) {
+  static_assert(internal::IsTuple<Tuple>::value,
+                "StreamOf<T> requires a std::tuple parameter");
+  auto decoder =
+      std::make_shared<internal::TupleDecoder<Tuple>>(*range.source_);
+  return TupleStream<Tuple>(TupleStreamIterator<Tuple>(
+      [decoder]() mutable { return decoder->Next(); }));
+}
+
 /**
  * Represents the result of a data modifying operation using
  * `spanner::Client::ExecuteDml()`.
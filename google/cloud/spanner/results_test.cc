@@ -23,6 +23,8 @@
 #include <chrono>
 #include <iostream>
 #include <string>
+#include <tuple>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -117,6 +119,38 @@ TEST(RowStream, IterateError) {
   EXPECT_EQ(num_rows, 2);
 }
 
+TEST(RowStream, StreamOfFallsBackToNextRow) {
+  auto mock_source = absl::make_unique<MockResultSetSource>();
+  EXPECT_CALL(*mock_source, NextRow())
+      .WillOnce(Return(MakeTestRow(5, true)))
+      .WillOnce(Return(MakeTestRow(10, false)))
+      .WillOnce(Return(Row()));
+
+  RowStream rows(std::move(mock_source));
+  using RowType = std::tuple<std::int64_t, bool>;
+  std::vector<RowType> actual;
+  for (auto& row : StreamOf<RowType>(rows)) {
+    ASSERT_STATUS_OK(row);
+    actual.push_back(*std::move(row));
+  }
+  EXPECT_THAT(actual, ::testing::ElementsAre(RowType{5, true},
+                                              RowType{10, false}));
+}
+
+TEST(RowStream, StreamOfWrongSize) {
+  auto mock_source = absl::make_unique<MockResultSetSource>();
+  EXPECT_CALL(*mock_source, NextRow()).WillOnce(Return(MakeTestRow(5)));
+
+  RowStream rows(std::move(mock_source));
+  int num_rows = 0;
+  for (auto const& row : StreamOf<std::tuple<std::int64_t, bool>>(rows)) {
+    EXPECT_FALSE(row.ok());
+    EXPECT_EQ(row.status().code(), StatusCode::kInvalidArgument);
+    ++num_rows;
+  }
+  EXPECT_EQ(num_rows, 1);
+}
+
 TEST(RowStream, TimestampNoTransaction) {
   auto mock_source = absl::make_unique<MockResultSetSource>();
   spanner_proto::ResultSetMetadata no_transaction;
@@ -16,8 +16,6 @@
 #include "google/cloud/log.h"
 #include "google/cloud/status.h"
 #include "google/cloud/status_or.h"
-#include <algorithm>
-#include <iterator>
 #include <utility>
 
 namespace google {
@@ -26,26 +24,42 @@ namespace spanner {
 inline namespace SPANNER_CLIENT_NS {
 
 namespace internal {
+
+ColumnIndex::ColumnIndex(std::vector<std::string> names)
+    : names_(std::move(names)) {
+  positions_.reserve(names_.size());
+  for (std::size_t i = 0; i != names_.size(); ++i) {
+    positions_.emplace(names_[i], i);  // Keeps the first of any duplicates.
+  }
+}
+
+std::size_t ColumnIndex::Find(std::string const& name) const {
+  auto it = positions_.find(name);
+  return it == positions_.end() ? names_.size() : it->second;
+}
+
 Row MakeRow(std::vector<Value> values,
-            std::shared_ptr<const std::vector<std::string>> columns) {
+            std::shared_ptr<const ColumnIndex> columns) {
   return Row(std::move(values), std::move(columns));
 }
 }  // namespace internal
 
 Row MakeTestRow(std::vector<std::pair<std::string, Value>> pairs) {
   auto values = std::vector<Value>{};
-  auto columns = std::make_shared<std::vector<std::string>>();
+  auto names = std::vector<std::string>{};
   for (auto& p : pairs) {
     values.emplace_back(std::move(p.second));
-    columns->emplace_back(std::move(p.first));
+    names.emplace_back(std::move(p.first));
   }
-  return internal::MakeRow(std::move(values), std::move(columns));
+  return internal::MakeRow(
+      std::move(values),
+      std::make_shared<internal::ColumnIndex>(std::move(names)));
 }
 
-Row::Row() : Row({}, std::make_shared<std::vector<std::string>>()) {}
+Row::Row() : Row({}, std::make_shared<internal::ColumnIndex>()) {}
 
 Row::Row(std::vector<Value> values,
-         std::shared_ptr<const std::vector<std::string>> columns)
+         std::shared_ptr<const internal::ColumnIndex> columns)
     : values_(std::move(values)), columns_(std::move(columns)) {
   if (values_.size() != columns_->size()) {
     GCP_LOG(FATAL) << "Row's value and column sizes do not match: "
@@ -61,13 +75,25 @@ StatusOr<Value> Row::get(std::size_t pos) const {
 
 // NOLINTNEXTLINE(readability-identifier-naming)
 StatusOr<Value> Row::get(std::string const& name) const {
-  auto it = std::find(columns_->begin(), columns_->end(), name);
-  if (it != columns_->end()) return get(std::distance(columns_->begin(), it));
+  auto pos = columns_->Find(name);
+  if (pos != columns_->size()) return get(pos);
   return Status(StatusCode::kInvalidArgument, "column name not found");
 }
 
+// NOLINTNEXTLINE(readability-identifier-naming)
+StatusOr<Value> Row::get(ColumnRef const& column) const {
+  if (column.columns_ == columns_) return get(column.pos_);
+  return get(column.name_);
+}
+
+ColumnRef Row::column_ref(std::string name) const {
+  auto pos = columns_->Find(name);
+  if (pos == columns_->size()) return ColumnRef(std::move(name));
+  return ColumnRef(std::move(name), columns_, pos);
+}
+
 bool operator==(Row const& a, Row const& b) {
-  return a.values_ == b.values_ && *a.columns_ == *b.columns_;
+  return a.values_ == b.values_ && a.columns_->names() == b.columns_->names();
 }
 
 //
@@ -20,12 +20,14 @@
 #include "google/cloud/spanner/version.h"
 #include "google/cloud/status.h"
 #include "google/cloud/status_or.h"
+#include "absl/types/optional.h"
 #include <functional>
 #include <iterator>
 #include <memory>
 #include <string>
 #include <tuple>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -35,11 +37,73 @@ namespace spanner {
 inline namespace SPANNER_CLIENT_NS {
 
 class Row;
+class RowStream;
 namespace internal {
-Row MakeRow(std::vector<Value>,
-            std::shared_ptr<const std::vector<std::string>>);
+
+/**
+ * The column names of a result set, and an index from each name to its
+ * position.
+ *
+ * This is built once per result set and shared by all its `Row` objects, so
+ * that looking up a column by name does not need to compare strings.
+ */
+class ColumnIndex {
+ public:
+  ColumnIndex() = default;
+  explicit ColumnIndex(std::vector<std::string> names);
+
+  std::vector<std::string> const& names() const { return names_; }
+  std::size_t size() const { return names_.size(); }
+
+  /// Returns the position of the first column named @p name, or `size()`.
+  std::size_t Find(std::string const& name) const;
+
+ private:
+  std::vector<std::string> names_;
+  std::unordered_map<std::string, std::size_t> positions_;
+};
+
+Row MakeRow(std::vector<Value>, std::shared_ptr<const ColumnIndex>);
 }  // namespace internal
 
+/**
+ * A reference to a column of a `Row`, for repeated lookups by name.
+ *
+ * A `ColumnRef` obtained from `Row::column_ref()` remembers the position of
+ * the column, so using it with any other `Row` from the same result set
+ * (e.g., the same `RowStream`) does not need to look up the name at all.
+ * With other `Row` objects it falls back to looking up the column name.
+ *
+ * @par Example
+ *
+ * @code
+ * absl::optional<ColumnRef> last_name;
+ * for (auto& row : client.ExecuteQuery(...)) {
+ *   if (!row) return row.status();
+ *   if (!last_name) last_name = row->column_ref("LastName");
+ *   StatusOr<std::string> x = row->get<std::string>(*last_name);
+ * }
+ * @endcode
+ */
+class ColumnRef {
+ public:
+  /// Constructs a reference to the column named @p name.
+  explicit ColumnRef(std::string name) : name_(std::move(name)) {}
+
+  /// Returns the name of the referenced column.
+  std::string const& name() const { return name_; }
+
+ private:
+  friend class Row;
+  ColumnRef(std::string name, std::shared_ptr<const internal::ColumnIndex> c,
+            std::size_t pos)
+      : name_(std::move(name)), columns_(std::move(c)), pos_(pos) {}
+
+  std::string name_;
+  std::shared_ptr<const internal::ColumnIndex> columns_;  // may be nullptr
+  std::size_t pos_ = 0;  // the position of `name_` in `columns_`
+};
+
 /**
  * A `Row` is a sequence of columns each with a name and an associated `Value`.
  *
@@ -92,7 +156,7 @@ class Row {
   std::size_t size() const { return columns_->size(); }
 
   /// Returns the column names for the row.
-  std::vector<std::string> const& columns() const { return *columns_; }
+  std::vector<std::string> const& columns() const { return columns_->names(); }
 
   /// Returns the `Value` objects in the given row.
   std::vector<Value> const& values() const& { return values_; }
@@ -106,11 +170,22 @@ class Row {
   /// Returns the `Value` in the column with @p name
   StatusOr<Value> get(std::string const& name) const;
 
+  /// Returns the `Value` in the column referenced by @p column.
+  StatusOr<Value> get(ColumnRef const& column) const;
+
+  /**
+   * Returns a `ColumnRef` for the column with @p name, which can be used to
+   * access that column efficiently in this and any other `Row` from the same
+   * result set.
+   */
+  ColumnRef column_ref(std::string name) const;
+
   /**
    * Returns the native C++ value at the given position or column name.
    *
    * @tparam T the native C++ type, e.g., std::int64_t or std::string
-   * @tparam Arg a deduced parameter convertible to a std::size_t or std::string
+   * @tparam Arg a deduced parameter convertible to a std::size_t, std::string,
+   *     or `ColumnRef`
    */
   template <typename T, typename Arg>
   StatusOr<T> get(Arg&& arg) const {
@@ -167,7 +242,7 @@ class Row {
 
  private:
   friend Row internal::MakeRow(std::vector<Value>,
-                               std::shared_ptr<const std::vector<std::string>>);
+                               std::shared_ptr<const internal::ColumnIndex>);
   struct ExtractValue {
     Status& status;
     template <typename T, typename It>
@@ -188,10 +263,10 @@ class Row {
    * @note columns.size() must equal values.size()
    */
   Row(std::vector<Value> values,
-      std::shared_ptr<const std::vector<std::string>> columns);
+      std::shared_ptr<const internal::ColumnIndex> columns);
 
   std::vector<Value> values_;
-  std::shared_ptr<const std::vector<std::string>> columns_;
+  std::shared_ptr<const internal::ColumnIndex> columns_;
 };
 
 /**
@@ -219,12 +294,14 @@ Row MakeTestRow(std::vector<std::pair<std::string, Value>> pairs);
  */
 template <typename... Ts>
 Row MakeTestRow(Ts&&... ts) {
-  auto columns = std::make_shared<std::vector<std::string>>();
+  std::vector<std::string> names;
   for (std::size_t i = 0; i < sizeof...(ts); ++i) {
-    columns->emplace_back(std::to_string(i));
+    names.emplace_back(std::to_string(i));
   }
   std::vector<Value> v{Value(std::forward<Ts>(ts))...};
-  return internal::MakeRow(std::move(v), std::move(columns));
+  return internal::MakeRow(
+      std::move(v),
+      std::make_shared<internal::ColumnIndex>(std::move(names)));
 }
 
 /**
@@ -319,6 +396,13 @@ class TupleStreamIterator {
   using const_reference = value_type const&;
   ///@}
 
+  /**
+   * A function that returns a sequence of `StatusOr<Tuple>` objects decoded
+   * directly from a result set. Returning an empty `absl::optional` indicates
+   * that there are no more rows to be returned.
+   */
+  using Source = std::function<StatusOr<absl::optional<Tuple>>()>;
+
   /// Default constructs an "end" iterator.
   TupleStreamIterator() = default;
 
@@ -328,6 +412,15 @@ class TupleStreamIterator {
     ParseTuple();
   }
 
+  /**
+   * Creates an iterator that consumes tuples from the given @p source, which
+   * must not be `nullptr`.
+   */
+  explicit TupleStreamIterator(Source source)
+      : source_(std::make_shared<Source>(std::move(source))) {
+    ParseTuple();
+  }
+
   reference operator*() { return tup_; }
   pointer operator->() { return &tup_; }
 
@@ -337,9 +430,10 @@ class TupleStreamIterator {
   TupleStreamIterator& operator++() {
     if (!tup_) {
       it_ = end_;
+      source_ = nullptr;
       return *this;
     }
-    ++it_;
+    if (!source_) ++it_;
     ParseTuple();
     return *this;
   }
@@ -352,6 +446,9 @@ class TupleStreamIterator {
 
   friend bool operator==(TupleStreamIterator const& a,
                          TupleStreamIterator const& b) {
+    if (a.AtEnd() || b.AtEnd()) return a.AtEnd() == b.AtEnd();
+    // Copies of an iterator decoding from a result set share its source.
+    if (a.source_ || b.source_) return a.source_ == b.source_;
     return a.it_ == b.it_;
   }
 
@@ -361,7 +458,20 @@ class TupleStreamIterator {
   }
 
  private:
+  bool AtEnd() const { return !source_ && it_ == end_; }
+
   void ParseTuple() {
+    if (source_) {
+      auto next = (*source_)();
+      if (!next) {
+        tup_ = std::move(next).status();
+      } else if (!next->has_value()) {
+        source_ = nullptr;  // No more tuples to consume; become "end"
+      } else {
+        tup_ = **std::move(next);
+      }
+      return;
+    }
     if (it_ == end_) return;
     tup_ = *it_ ? std::move(*it_)->template get<Tuple>() : it_->status();
   }
@@ -369,6 +479,8 @@ class TupleStreamIterator {
   value_type tup_;
   RowStreamIterator it_;
   RowStreamIterator end_;
+  // nullptr unless decoding directly from a result set
+  std::shared_ptr<Source> source_;
 };
 
 /**
@@ -411,11 +523,15 @@ class TupleStream {
  private:
   template <typename T, typename RowRange>
   friend TupleStream<T> StreamOf(RowRange&& range);
+  template <typename T>
+  friend TupleStream<T> StreamOf(RowStream& range);
 
   template <typename It>
   explicit TupleStream(It&& start, It&& end)
       : begin_(std::forward<It>(start), std::forward<It>(end)) {}
 
+  explicit TupleStream(iterator begin) : begin_(std::move(begin)) {}
+
   iterator begin_;
   iterator end_;
 };
@@ -14,6 +14,10 @@
 
 #include "google/cloud/spanner/row.h"
 #include <benchmark/benchmark.h>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -58,6 +62,101 @@ void BM_RowGetByColumnName(benchmark::State& state) {
 }
 BENCHMARK(BM_RowGetByColumnName);
 
+void BM_RowGetByColumnRef(benchmark::State& state) {
+  Row row = MakeTestRow({
+      {"a", Value(1)},       //
+      {"b", Value("blah")},  //
+      {"c", Value(true)}     //
+  });
+  auto const a = row.column_ref("a");
+  auto const b = row.column_ref("b");
+  auto const c = row.column_ref("c");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(row.get(a));
+    benchmark::DoNotOptimize(row.get(b));
+    benchmark::DoNotOptimize(row.get(c));
+  }
+}
+BENCHMARK(BM_RowGetByColumnRef);
+
+// Access the last columns of a wide row by name, where a linear scan of the
+// column names would be most expensive.
+Row MakeWideRow() {
+  std::vector<std::pair<std::string, Value>> pairs;
+  for (int i = 0; i != 200; ++i) {
+    pairs.emplace_back("column_" + std::to_string(i), Value(i));
+  }
+  return MakeTestRow(std::move(pairs));
+}
+
+void BM_WideRowGetByColumnName(benchmark::State& state) {
+  Row row = MakeWideRow();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(row.get("column_197"));
+    benchmark::DoNotOptimize(row.get("column_198"));
+    benchmark::DoNotOptimize(row.get("column_199"));
+  }
+}
+BENCHMARK(BM_WideRowGetByColumnName);
+
+void BM_WideRowGetByColumnRef(benchmark::State& state) {
+  Row row = MakeWideRow();
+  auto const a = row.column_ref("column_197");
+  auto const b = row.column_ref("column_198");
+  auto const c = row.column_ref("column_199");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(row.get(a));
+    benchmark::DoNotOptimize(row.get(b));
+    benchmark::DoNotOptimize(row.get(c));
+  }
+}
+BENCHMARK(BM_WideRowGetByColumnRef);
+
+// The following benchmarks measure the per-cell cost of decoding the scalar
+// types that Spanner sends as strings.
+
+void BM_RowGetInt64(benchmark::State& state) {
+  Row row = MakeTestRow(std::int64_t{1234567890123456789});
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(row.get<std::int64_t>(0));
+  }
+}
+BENCHMARK(BM_RowGetInt64);
+
+void BM_RowGetBytes(benchmark::State& state) {
+  Row row = MakeTestRow(Bytes(std::string(64, 'x')));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(row.get<Bytes>(0)->get<std::string>());
+  }
+}
+BENCHMARK(BM_RowGetBytes);
+
+void BM_RowGetTimestamp(benchmark::State& state) {
+  Row row = MakeTestRow(
+      MakeTimestamp(absl::FromUnixNanos(1561135942123456789)).value());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(row.get<Timestamp>(0));
+  }
+}
+BENCHMARK(BM_RowGetTimestamp);
+
+void BM_RowGetNumeric(benchmark::State& state) {
+  Row row = MakeTestRow(MakeNumeric("12345678901234567890.123456789").value());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(row.get<Numeric>(0));
+  }
+}
+BENCHMARK(BM_RowGetNumeric);
+
+void BM_ValueFromTimestamp(benchmark::State& state) {
+  auto const ts =
+      MakeTimestamp(absl::FromUnixNanos(1561135942123456789)).value();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Value(ts));
+  }
+}
+BENCHMARK(BM_ValueFromTimestamp);
+
 }  // namespace
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
@@ -15,8 +15,11 @@
 #include "google/cloud/spanner/row.h"
 #include "google/cloud/testing_util/assert_ok.h"
 #include <gmock/gmock.h>
+#include <memory>
+#include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -122,6 +125,43 @@ TEST(Row, GetByColumnName) {
   EXPECT_EQ(Value(true), *row.get("c"));
 }
 
+TEST(Row, GetByDuplicateColumnName) {
+  Row row = MakeTestRow({
+      {"a", Value(1)},  //
+      {"b", Value(2)},  //
+      {"a", Value(3)}   //
+  });
+  EXPECT_EQ(Value(1), *row.get("a"));
+  EXPECT_EQ(Value(1), *row.get(row.column_ref("a")));
+}
+
+TEST(Row, GetByColumnRef) {
+  auto columns = std::make_shared<internal::ColumnIndex>(
+      std::vector<std::string>{"a", "b", "c"});
+  Row row1 = internal::MakeRow({Value(1), Value("blah"), Value(true)}, columns);
+  Row row2 = internal::MakeRow({Value(2), Value("foo"), Value(false)}, columns);
+
+  auto const b = row1.column_ref("b");
+  EXPECT_EQ("b", b.name());
+  EXPECT_EQ(Value("blah"), *row1.get(b));
+  EXPECT_EQ(Value("foo"), *row2.get(b));
+  EXPECT_EQ("foo", *row2.get<std::string>(b));
+  EXPECT_FALSE(row2.get<std::int64_t>(b).ok());
+
+  // A reference from a row with different columns falls back to the name.
+  Row other = MakeTestRow({{"b", Value(42)}});
+  EXPECT_EQ(Value(42), *other.get(b));
+  EXPECT_EQ(Value("foo"), *row2.get(other.column_ref("b")));
+
+  // So does a reference that was not obtained from a row.
+  EXPECT_EQ(Value(true), *row1.get(ColumnRef("c")));
+
+  auto const missing = row1.column_ref("not a column name");
+  EXPECT_FALSE(row1.get(missing).ok());
+  EXPECT_FALSE(row2.get(missing).ok());
+  EXPECT_FALSE(row2.get(ColumnRef("not a column name")).ok());
+}
+
 TEST(Row, TemplatedGetByPosition) {
   Row row = MakeTestRow(1, "blah", true);
 
@@ -360,6 +400,39 @@ TEST(TupleStreamIterator, Basics) {
   EXPECT_EQ(it, end);
 }
 
+TEST(TupleStreamIterator, SourceEquality) {
+  using RowType = std::tuple<std::int64_t>;
+  using TupleIterator = TupleStreamIterator<RowType>;
+
+  auto make_source = [] {
+    auto count = std::make_shared<std::int64_t>(0);
+    return [count]() -> StatusOr<absl::optional<RowType>> {
+      if (*count == 2) return absl::optional<RowType>{};
+      return absl::optional<RowType>(RowType{++*count});
+    };
+  };
+
+  auto end = TupleIterator();
+  auto a = TupleIterator(make_source());
+  auto b = TupleIterator(make_source());
+  auto const copy = a;
+  EXPECT_EQ(a, copy);
+  EXPECT_NE(a, b);
+  EXPECT_NE(a, end);
+
+  // Iterators decoding from a source never equal those wrapping rows.
+  std::vector<Row> rows;
+  rows.emplace_back(MakeTestRow({{"num", Value(1)}}));
+  auto c = TupleIterator(RowStreamIterator(MakeRowStreamIteratorSource(rows)),
+                         RowStreamIterator());
+  EXPECT_NE(a, c);
+
+  ++a;
+  EXPECT_NE(a, end);
+  ++a;
+  EXPECT_EQ(a, end);
+}
+
 TEST(TupleStreamIterator, Empty) {
   using RowType = std::tuple<std::int64_t, std::string, bool>;
   using TupleIterator = TupleStreamIterator<RowType>;
@@ -0,0 +1,78 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/session_pool_metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+std::chrono::microseconds LatencyDistribution::Mean() const {
+  if (count == 0) return std::chrono::microseconds(0);
+  return total / static_cast<std::chrono::microseconds::rep>(count);
+}
+
+std::chrono::microseconds LatencyDistribution::Percentile(
+    double percentile) const {
+  if (count == 0) return std::chrono::microseconds(0);
+  percentile = (std::min)((std::max)(percentile, 0.0), 100.0);
+  auto const rank = static_cast<std::uint64_t>(
+      std::ceil(percentile / 100.0 * static_cast<double>(count)));
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i != bucket_limits.size(); ++i) {
+    seen += bucket_counts[i];
+    if (seen >= rank && seen != 0) return (std::min)(bucket_limits[i], max);
+  }
+  return max;
+}
+
+std::ostream& operator<<(std::ostream& os, LatencyDistribution const& d) {
+  return os << "count=" << d.count << " mean=" << d.Mean().count()
+            << "us p50=" << d.Percentile(50).count()
+            << "us p99=" << d.Percentile(99).count()
+            << "us max=" << d.max.count() << "us";
+}
+
+std::ostream& operator<<(std::ostream& os, SessionPoolMetrics const& metrics) {
+  os << "sessions=" << metrics.total_sessions
+     << " idle=" << metrics.idle_sessions << " max=" << metrics.max_sessions
+     << " waiting=" << metrics.waiting_for_session << " channels=[";
+  char const* sep = "";
+  for (auto const& c : metrics.channels) {
+    os << sep << c.sessions - c.idle_sessions << "/" << c.sessions;
+    if (!c.healthy) os << "!";
+    sep = " ";
+  }
+  return os << "] allocations=" << metrics.allocations
+            << " without_idle=" << metrics.allocations_without_idle_session
+            << " exhausted=" << metrics.exhausted_allocations
+            << " allocation_latency={" << metrics.allocation_latency << "}"
+            << " batch_create_calls=" << metrics.batch_create_calls
+            << " batch_create_failures=" << metrics.batch_create_failures
+            << " sessions_created=" << metrics.sessions_created
+            << " batch_create_latency={" << metrics.batch_create_latency
+            << "} keep_alive_refreshes=" << metrics.keep_alive_refreshes
+            << " keep_alive_failures=" << metrics.keep_alive_failures
+            << " sessions_not_found=" << metrics.sessions_not_found
+            << " sessions_retired=" << metrics.sessions_retired;
+}
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
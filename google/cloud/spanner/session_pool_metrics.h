@@ -0,0 +1,154 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_SESSION_POOL_METRICS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_SESSION_POOL_METRICS_H
+
+#include "google/cloud/spanner/version.h"
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+/**
+ * A summary of the latencies of some operation.
+ *
+ * The latencies are counted in buckets with exponentially growing limits, so
+ * the percentiles are approximate.
+ */
+struct LatencyDistribution {
+  /// The number of operations.
+  std::uint64_t count = 0;
+
+  /// The sum of the latencies of all the operations.
+  std::chrono::microseconds total{0};
+
+  /// The largest latency.
+  std::chrono::microseconds max{0};
+
+  /**
+   * The (exclusive) upper limits of the buckets.
+   *
+   * The last bucket, which has no upper limit, is not included.
+   */
+  std::vector<std::chrono::microseconds> bucket_limits;
+
+  /// The number of operations in each bucket, `bucket_limits.size() + 1`.
+  std::vector<std::uint64_t> bucket_counts;
+
+  /// The mean latency, or zero if there are no operations.
+  std::chrono::microseconds Mean() const;
+
+  /**
+   * The approximate latency at the given @p percentile (in `[0, 100]`).
+   *
+   * Returns the upper limit of the bucket containing the percentile, or `max`
+   * if that is smaller.
+   */
+  std::chrono::microseconds Percentile(double percentile) const;
+};
+
+/// Outputs the count, mean, p50, p99 and max of @p d.
+std::ostream& operator<<(std::ostream& os, LatencyDistribution const& d);
+
+/**
+ * A snapshot of the state and activity of the session pool of a `Client`.
+ *
+ * The counters and latencies are cumulative since the pool was created, use
+ * the difference between two snapshots to compute rates.
+ *
+ * @see `SessionPoolOptions::set_metrics_interval()` to receive these
+ *     snapshots periodically.
+ */
+struct SessionPoolMetrics {
+  /// The number of sessions associated with a single gRPC channel.
+  struct ChannelSessions {
+    int sessions = 0;
+    int idle_sessions = 0;
+    /// The number of RPCs in flight on the channel.
+    int in_flight_rpcs = 0;
+    /// False if the channel is slow or failing, compared to the others.
+    bool healthy = true;
+    /// The latency of the RPCs on the channel.
+    LatencyDistribution rpc_latency;
+  };
+
+  /// The sessions and the load on each channel. The in-use session count is
+  /// the difference between `sessions` and `idle_sessions`.
+  std::vector<ChannelSessions> channels;
+
+  /// The current number of sessions in the pool, in use or idle.
+  int total_sessions = 0;
+
+  /// The current number of idle sessions.
+  int idle_sessions = 0;
+
+  /// The maximum number of sessions in the pool.
+  int max_sessions = 0;
+
+  /// The number of callers currently waiting for a session.
+  int waiting_for_session = 0;
+
+  /// The number of calls to allocate a session.
+  std::uint64_t allocations = 0;
+
+  /// The number of allocations that did not find an idle session.
+  std::uint64_t allocations_without_idle_session = 0;
+
+  /// The number of allocations that failed because the pool was exhausted.
+  std::uint64_t exhausted_allocations = 0;
+
+  /// The time spent allocating sessions, including any waiting.
+  LatencyDistribution allocation_latency;
+
+  /// The number of `BatchCreateSessions` calls, and of failed calls.
+  std::uint64_t batch_create_calls = 0;
+  std::uint64_t batch_create_failures = 0;
+
+  /// The number of sessions created by `BatchCreateSessions`.
+  std::uint64_t sessions_created = 0;
+
+  /// The latency of the `BatchCreateSessions` calls, including retries.
+  LatencyDistribution batch_create_latency;
+
+  /// The number of keep-alive requests sent, and of failed requests.
+  std::uint64_t keep_alive_refreshes = 0;
+  std::uint64_t keep_alive_failures = 0;
+
+  /// The number of sessions dropped from the pool because they were not found.
+  std::uint64_t sessions_not_found = 0;
+
+  /// The number of idle sessions deleted because their channel was unhealthy.
+  std::uint64_t sessions_retired = 0;
+};
+
+/**
+ * Outputs a human-readable summary of @p metrics.
+ *
+ * @warning This is intended for debugging and human consumption only, not
+ *     machine consumption, as the output format may change without notice.
+ */
+std::ostream& operator<<(std::ostream& os, SessionPoolMetrics const& metrics);
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_SESSION_POOL_METRICS_H
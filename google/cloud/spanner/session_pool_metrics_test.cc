@@ -0,0 +1,96 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/session_pool_metrics.h"
+#include <gmock/gmock.h>
+#include <sstream>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace {
+
+using ::testing::HasSubstr;
+using us = std::chrono::microseconds;
+
+LatencyDistribution MakeDistribution() {
+  LatencyDistribution d;
+  d.bucket_limits = {us(10), us(100), us(1000)};
+  d.bucket_counts = {50, 40, 9, 1};
+  d.count = 100;
+  d.total = us(5000);
+  d.max = us(2500);
+  return d;
+}
+
+TEST(LatencyDistribution, Empty) {
+  LatencyDistribution d;
+  EXPECT_EQ(us(0), d.Mean());
+  EXPECT_EQ(us(0), d.Percentile(50));
+}
+
+TEST(LatencyDistribution, Mean) {
+  EXPECT_EQ(us(50), MakeDistribution().Mean());
+}
+
+TEST(LatencyDistribution, Percentile) {
+  auto d = MakeDistribution();
+  EXPECT_EQ(us(10), d.Percentile(0));
+  EXPECT_EQ(us(10), d.Percentile(50));
+  EXPECT_EQ(us(100), d.Percentile(51));
+  EXPECT_EQ(us(100), d.Percentile(90));
+  EXPECT_EQ(us(1000), d.Percentile(99));
+  EXPECT_EQ(us(2500), d.Percentile(99.5));
+  EXPECT_EQ(us(2500), d.Percentile(100));
+  EXPECT_EQ(us(2500), d.Percentile(200));
+
+  // The percentiles never exceed the maximum.
+  d.max = us(70);
+  EXPECT_EQ(us(70), d.Percentile(90));
+}
+
+TEST(SessionPoolMetrics, OStream) {
+  SessionPoolMetrics metrics;
+  metrics.channels.resize(2);
+  metrics.channels[0].sessions = 3;
+  metrics.channels[0].idle_sessions = 1;
+  metrics.channels[1].sessions = 2;
+  metrics.channels[1].idle_sessions = 2;
+  metrics.channels[1].healthy = false;
+  metrics.total_sessions = 5;
+  metrics.idle_sessions = 3;
+  metrics.max_sessions = 200;
+  metrics.allocations = 42;
+  metrics.sessions_not_found = 7;
+  metrics.sessions_retired = 3;
+  metrics.allocation_latency = MakeDistribution();
+
+  std::ostringstream os;
+  os << metrics;
+  auto const str = os.str();
+  EXPECT_THAT(str, HasSubstr("sessions=5 idle=3 max=200"));
+  EXPECT_THAT(str, HasSubstr("channels=[2/3 0/2!]"));
+  EXPECT_THAT(str, HasSubstr("allocations=42"));
+  EXPECT_THAT(str, HasSubstr("sessions_not_found=7"));
+  EXPECT_THAT(str, HasSubstr("sessions_retired=3"));
+  EXPECT_THAT(str, HasSubstr("allocation_latency={count=100 mean=50us "
+                             "p50=10us p99=1000us max=2500us}"));
+}
+
+}  // namespace
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -15,9 +15,11 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_SESSION_POOL_OPTIONS_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_SESSION_POOL_OPTIONS_H
 
+#include "google/cloud/spanner/session_pool_metrics.h"
 #include "google/cloud/spanner/version.h"
 #include <algorithm>
 #include <chrono>
+#include <functional>
 #include <map>
 #include <string>
 
@@ -146,6 +148,38 @@ class SessionPoolOptions {
   /// Return the labels used when creating sessions within the pool.
   std::map<std::string, std::string> const& labels() const { return labels_; }
 
+  /**
+   * Set the interval at which the pool reports its `SessionPoolMetrics`.
+   *
+   * The metrics are reported by the pool's background maintenance, which
+   * runs every few seconds, so the actual interval is rounded up to that
+   * period. Values <= 0 disable the reports, which is the default.
+   */
+  SessionPoolOptions& set_metrics_interval(std::chrono::seconds interval) {
+    metrics_interval_ = interval;
+    return *this;
+  }
+
+  /// Return the interval at which the pool reports its metrics.
+  std::chrono::seconds metrics_interval() const { return metrics_interval_; }
+
+  /// The type of the callbacks receiving the pool metrics.
+  using MetricsCallback = std::function<void(SessionPoolMetrics const&)>;
+
+  /**
+   * Set the function receiving the periodic `SessionPoolMetrics` reports.
+   *
+   * If no callback is set the metrics are logged, using `GCP_LOG(INFO)`. The
+   * callback runs in a background thread, and should not block.
+   */
+  SessionPoolOptions& set_metrics_callback(MetricsCallback callback) {
+    metrics_callback_ = std::move(callback);
+    return *this;
+  }
+
+  /// Return the function receiving the periodic metrics reports.
+  MetricsCallback const& metrics_callback() const { return metrics_callback_; }
+
  private:
   int min_sessions_ = 0;
   int max_sessions_per_channel_ = 100;
@@ -153,6 +187,8 @@ class SessionPoolOptions {
   ActionOnExhaustion action_on_exhaustion_ = ActionOnExhaustion::kBlock;
   std::chrono::seconds keep_alive_interval_ = std::chrono::minutes(55);
   std::map<std::string, std::string> labels_;
+  std::chrono::seconds metrics_interval_ = std::chrono::seconds(0);
+  MetricsCallback metrics_callback_;
 };
 
 }  // namespace SPANNER_CLIENT_NS
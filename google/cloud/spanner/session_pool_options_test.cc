@@ -51,6 +51,20 @@ TEST(SessionPoolOptionsTest, MaxMinSessionsConflict) {
   EXPECT_EQ(2, options.max_sessions_per_channel());
 }
 
+TEST(SessionPoolOptionsTest, Metrics) {
+  SessionPoolOptions options;
+  EXPECT_EQ(std::chrono::seconds(0), options.metrics_interval());
+  EXPECT_FALSE(options.metrics_callback());
+
+  int calls = 0;
+  options.set_metrics_interval(std::chrono::minutes(1))
+      .set_metrics_callback([&calls](SessionPoolMetrics const&) { ++calls; });
+  EXPECT_EQ(std::chrono::minutes(1), options.metrics_interval());
+  ASSERT_TRUE(options.metrics_callback());
+  options.metrics_callback()(SessionPoolMetrics{});
+  EXPECT_EQ(1, calls);
+}
+
 }  // namespace
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
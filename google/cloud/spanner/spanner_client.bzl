@@ -21,6 +21,7 @@ spanner_client_hdrs = [
     "backup.h",
     "batch_dml_result.h",
     "bytes.h",
+    "bulk_writer.h",
     "client.h",
     "client_options.h",
     "commit_result.h",
@@ -31,12 +32,14 @@ spanner_client_hdrs = [
     "database_admin_client.h",
     "database_admin_connection.h",
     "date.h",
+    "dml_batcher.h",
     "iam_updater.h",
     "instance.h",
     "instance_admin_client.h",
     "instance_admin_connection.h",
     "internal/api_client_header.h",
     "internal/channel.h",
+    "internal/channel_load.h",
     "internal/clock.h",
     "internal/compiler_info.h",
     "internal/connection_impl.h",
@@ -46,6 +49,8 @@ spanner_client_hdrs = [
     "internal/instance_admin_logging.h",
     "internal/instance_admin_metadata.h",
     "internal/instance_admin_stub.h",
+    "internal/latency_histogram.h",
+    "internal/load_tracking_spanner_stub.h",
     "internal/log_wrapper.h",
     "internal/logging_result_set_reader.h",
     "internal/logging_spanner_stub.h",
@@ -55,26 +60,32 @@ spanner_client_hdrs = [
     "internal/partial_result_set_resume.h",
     "internal/partial_result_set_source.h",
     "internal/polling_loop.h",
+    "internal/read_cache.h",
     "internal/retry_loop.h",
     "internal/session.h",
     "internal/session_pool.h",
     "internal/spanner_stub.h",
+    "internal/status_only_result_set_source.h",
     "internal/status_utils.h",
     "internal/transaction_impl.h",
     "internal/tuple_utils.h",
     "keys.h",
     "mutations.h",
     "numeric.h",
+    "parallel_executor.h",
     "partition_options.h",
     "partitioned_dml_result.h",
     "polling_policy.h",
+    "prepared_statement.h",
     "query_options.h",
     "query_partition.h",
+    "read_cache_options.h",
     "read_options.h",
     "read_partition.h",
     "results.h",
     "retry_policy.h",
     "row.h",
+    "session_pool_metrics.h",
     "session_pool_options.h",
     "sql_statement.h",
     "timestamp.h",
@@ -89,15 +100,18 @@ spanner_client_hdrs = [
 spanner_client_srcs = [
     "backup.cc",
     "bytes.cc",
+    "bulk_writer.cc",
     "client.cc",
     "connection_options.cc",
     "database.cc",
     "database_admin_client.cc",
     "database_admin_connection.cc",
+    "dml_batcher.cc",
     "instance.cc",
     "instance_admin_client.cc",
     "instance_admin_connection.cc",
     "internal/api_client_header.cc",
+    "internal/channel_load.cc",
     "internal/compiler_info.cc",
     "internal/connection_impl.cc",
     "internal/database_admin_logging.cc",
@@ -106,6 +120,8 @@ spanner_client_srcs = [
     "internal/instance_admin_logging.cc",
     "internal/instance_admin_metadata.cc",
     "internal/instance_admin_stub.cc",
+    "internal/latency_histogram.cc",
+    "internal/load_tracking_spanner_stub.cc",
     "internal/log_wrapper.cc",
     "internal/logging_result_set_reader.cc",
     "internal/logging_spanner_stub.cc",
@@ -113,6 +129,7 @@ spanner_client_srcs = [
     "internal/metadata_spanner_stub.cc",
     "internal/partial_result_set_resume.cc",
     "internal/partial_result_set_source.cc",
+    "internal/read_cache.cc",
     "internal/retry_loop.cc",
     "internal/session.cc",
     "internal/session_pool.cc",
@@ -122,11 +139,15 @@ spanner_client_srcs = [
     "keys.cc",
     "mutations.cc",
     "numeric.cc",
+    "parallel_executor.cc",
     "partition_options.cc",
+    "prepared_statement.cc",
     "query_partition.cc",
+    "read_cache_options.cc",
     "read_partition.cc",
     "results.cc",
     "row.cc",
+    "session_pool_metrics.cc",
     "sql_statement.cc",
     "timestamp.cc",
     "transaction.cc",
@@ -19,6 +19,7 @@
 spanner_client_unit_tests = [
     "backup_test.cc",
     "bytes_test.cc",
+    "bulk_writer_test.cc",
     "client_options_test.cc",
     "client_test.cc",
     "connection_options_test.cc",
@@ -26,10 +27,12 @@ spanner_client_unit_tests = [
     "database_admin_client_test.cc",
     "database_admin_connection_test.cc",
     "database_test.cc",
+    "dml_batcher_test.cc",
     "instance_admin_client_test.cc",
     "instance_admin_connection_test.cc",
     "instance_test.cc",
     "internal/api_client_header_test.cc",
+    "internal/channel_load_test.cc",
     "internal/clock_test.cc",
     "internal/compiler_info_test.cc",
     "internal/connection_impl_test.cc",
@@ -37,6 +40,8 @@ spanner_client_unit_tests = [
     "internal/database_admin_metadata_test.cc",
     "internal/instance_admin_logging_test.cc",
     "internal/instance_admin_metadata_test.cc",
+    "internal/latency_histogram_test.cc",
+    "internal/load_tracking_spanner_stub_test.cc",
     "internal/log_wrapper_test.cc",
     "internal/logging_result_set_reader_test.cc",
     "internal/logging_spanner_stub_test.cc",
@@ -45,6 +50,7 @@ spanner_client_unit_tests = [
     "internal/partial_result_set_resume_test.cc",
     "internal/partial_result_set_source_test.cc",
     "internal/polling_loop_test.cc",
+    "internal/read_cache_test.cc",
     "internal/retry_loop_test.cc",
     "internal/session_pool_test.cc",
     "internal/spanner_stub_test.cc",
@@ -54,7 +60,9 @@ spanner_client_unit_tests = [
     "keys_test.cc",
     "mutations_test.cc",
     "numeric_test.cc",
+    "parallel_executor_test.cc",
     "partition_options_test.cc",
+    "prepared_statement_test.cc",
     "query_options_test.cc",
     "query_partition_test.cc",
     "read_options_test.cc",
@@ -62,6 +70,7 @@ spanner_client_unit_tests = [
     "results_test.cc",
     "retry_policy_test.cc",
     "row_test.cc",
+    "session_pool_metrics_test.cc",
     "session_pool_options_test.cc",
     "spanner_version_test.cc",
     "sql_statement_test.cc",
@@ -14,6 +14,8 @@
 
 #include "google/cloud/spanner/sql_statement.h"
 #include <algorithm>
+#include <iterator>
+#include <mutex>
 
 namespace google {
 namespace cloud {
@@ -21,8 +23,27 @@ namespace spanner {
 inline namespace SPANNER_CLIENT_NS {
 
 namespace internal {
+struct DecodedSqlParams {
+  std::once_flag once;
+  SqlStatement::ParamType params;
+};
+
 SqlStatementProto ToProto(SqlStatement s) {
   SqlStatementProto statement_proto;
+  if (s.prepared_) {
+    // The types were encoded when the statement was prepared, and the values
+    // when it was bound, so they are only copied (or moved) into the request.
+    auto const& prepared = *s.prepared_;
+    statement_proto.set_sql(prepared.sql);
+    if (!s.prepared_values_.empty()) {
+      auto& values = *statement_proto.mutable_params()->mutable_fields();
+      for (std::size_t i = 0; i != s.prepared_values_.size(); ++i) {
+        values[prepared.param_names[i]] = std::move(s.prepared_values_[i]);
+      }
+      *statement_proto.mutable_param_types() = prepared.param_types;
+    }
+    return statement_proto;
+  }
   statement_proto.set_sql(std::move(s.statement_));
   if (!s.params_.empty()) {
     auto& values = *statement_proto.mutable_params()->mutable_fields();
@@ -35,9 +56,37 @@ SqlStatementProto ToProto(SqlStatement s) {
   }
   return statement_proto;
 }
+
+SqlStatement MakeSqlStatement(
+    std::shared_ptr<PreparedSqlStatement const> prepared,
+    std::vector<google::protobuf::Value> values) {
+  SqlStatement statement;
+  statement.prepared_ = std::move(prepared);
+  statement.prepared_values_ = std::move(values);
+  statement.decoded_params_ = std::make_shared<DecodedSqlParams>();
+  return statement;
+}
 }  // namespace internal
 
+SqlStatement::ParamType const& SqlStatement::params() const {
+  if (!prepared_) return params_;
+  // The values of a bound statement never change, so they are decoded once,
+  // and shared by all its copies. `std::call_once()` makes this safe when
+  // `SqlStatement` objects are shared between threads.
+  auto& decoded = *decoded_params_;
+  std::call_once(decoded.once, [this, &decoded] {
+    for (std::size_t i = 0; i != prepared_values_.size(); ++i) {
+      auto const& name = prepared_->param_names[i];
+      decoded.params.emplace(
+          name, internal::FromProto(prepared_->param_types.at(name),
+                                    prepared_values_[i]));
+    }
+  });
+  return decoded.params;
+}
+
 std::vector<std::string> SqlStatement::ParameterNames() const {
+  if (prepared_) return prepared_->param_names;
   std::vector<std::string> keys;
   keys.reserve(params_.size());
   for (auto const& p : params_) {
@@ -48,16 +97,26 @@ std::vector<std::string> SqlStatement::ParameterNames() const {
 
 google::cloud::StatusOr<Value> SqlStatement::GetParameter(
     std::string const& parameter_name) const {
-  auto iter = params_.find(parameter_name);
-  if (iter != params_.end()) {
-    return iter->second;
+  if (prepared_) {
+    auto const& names = prepared_->param_names;
+    auto n = std::find(names.begin(), names.end(), parameter_name);
+    auto const i = static_cast<std::size_t>(std::distance(names.begin(), n));
+    if (i < prepared_values_.size()) {
+      return internal::FromProto(prepared_->param_types.at(parameter_name),
+                                 prepared_values_[i]);
+    }
+  } else {
+    auto iter = params_.find(parameter_name);
+    if (iter != params_.end()) {
+      return iter->second;
+    }
   }
   return Status(StatusCode::kNotFound, "No such parameter: " + parameter_name);
 }
 
 std::ostream& operator<<(std::ostream& os, SqlStatement const& stmt) {
-  os << stmt.statement_;
-  for (auto const& param : stmt.params_) {
+  os << stmt.sql();
+  for (auto const& param : stmt.params()) {
     os << "\n[param]: {" << param.first << "=" << param.second << "}";
   }
   return os;
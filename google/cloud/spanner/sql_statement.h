@@ -19,8 +19,10 @@
 #include "google/cloud/spanner/version.h"
 #include "google/cloud/status_or.h"
 #include <google/spanner/v1/spanner.pb.h>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -36,6 +38,27 @@ namespace internal {
 using SqlStatementProto =
     google::spanner::v1::ExecuteBatchDmlRequest::Statement;
 SqlStatementProto ToProto(SqlStatement s);
+
+/**
+ * The parts of a `PreparedStatement` that are shared by all its bindings.
+ *
+ * The parameter types are encoded once, when the statement is prepared, and
+ * copied into each request. The values of each binding are stored in the same
+ * order as `param_names`.
+ */
+struct PreparedSqlStatement {
+  std::string sql;
+  std::vector<std::string> param_names;
+  google::protobuf::Map<std::string, google::spanner::v1::Type> param_types;
+};
+
+/// The decoded parameters of a bound statement, shared by its copies.
+struct DecodedSqlParams;
+
+/// Creates a `SqlStatement` binding @p values to the @p prepared statement.
+SqlStatement MakeSqlStatement(
+    std::shared_ptr<PreparedSqlStatement const> prepared,
+    std::vector<google::protobuf::Value> values);
 }  // namespace internal
 
 /**
@@ -76,13 +99,18 @@ class SqlStatement {
    * Returns the SQL statement.
    * No parameter substitution is performed in the statement string.
    */
-  std::string const& sql() const { return statement_; }
+  std::string const& sql() const {
+    return prepared_ ? prepared_->sql : statement_;
+  }
 
   /**
    * Returns the collection of parameters.
    * @return If no parameters were specified, the container will be empty.
+   *
+   * @note For statements created by `PreparedStatement::Bind()` the
+   *     parameters are decoded the first time this function is called.
    */
-  ParamType const& params() const { return params_; }
+  ParamType const& params() const;
 
   /**
    * Returns the names of all the parameters.
@@ -98,7 +126,7 @@ class SqlStatement {
       std::string const& parameter_name) const;
 
   friend bool operator==(SqlStatement const& a, SqlStatement const& b) {
-    return a.statement_ == b.statement_ && a.params_ == b.params_;
+    return a.sql() == b.sql() && a.params() == b.params();
   }
   friend bool operator!=(SqlStatement const& a, SqlStatement const& b) {
     return !(a == b);
@@ -114,9 +142,16 @@ class SqlStatement {
 
  private:
   friend internal::SqlStatementProto internal::ToProto(SqlStatement s);
+  friend SqlStatement internal::MakeSqlStatement(
+      std::shared_ptr<internal::PreparedSqlStatement const>,
+      std::vector<google::protobuf::Value>);
 
   std::string statement_;
+  // Unused when `prepared_` is set; the values are in `prepared_values_`.
   ParamType params_;
+  std::shared_ptr<internal::PreparedSqlStatement const> prepared_;
+  std::vector<google::protobuf::Value> prepared_values_;
+  std::shared_ptr<internal::DecodedSqlParams> decoded_params_;
 };
 
 }  // namespace SPANNER_CLIENT_NS
@@ -40,6 +40,89 @@ Status NegativeOverflow(std::string const& type) {
   return OutOfRange(type + " negative overflow");
 }
 
+// Days since 1970-01-01 of the given proleptic Gregorian date. See
+// http://howardhinnant.github.io/date_algorithms.html#days_from_civil
+std::int64_t DaysFromCivil(std::int64_t y, unsigned m, unsigned d) {
+  y -= m <= 2;
+  std::int64_t const era = (y >= 0 ? y : y - 399) / 400;
+  auto const yoe = static_cast<unsigned>(y - era * 400);
+  unsigned const doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+  unsigned const doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + static_cast<std::int64_t>(doe) - 719468;
+}
+
+// The inverse of `DaysFromCivil()`. See
+// http://howardhinnant.github.io/date_algorithms.html#civil_from_days
+void CivilFromDays(std::int64_t z, std::int64_t& y, unsigned& m, unsigned& d) {
+  z += 719468;
+  std::int64_t const era = (z >= 0 ? z : z - 146096) / 146097;
+  auto const doe = static_cast<unsigned>(z - era * 146097);
+  unsigned const yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  unsigned const doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  unsigned const mp = (5 * doy + 2) / 153;
+  d = doy - (153 * mp + 2) / 5 + 1;
+  m = mp < 10 ? mp + 3 : mp - 9;
+  y = static_cast<std::int64_t>(yoe) + era * 400 + (m <= 2);
+}
+
+// Consumes exactly `n` decimal digits from `p`.
+bool ParseDigits(char const*& p, int n, unsigned& value) {
+  value = 0;
+  for (char const* e = p + n; p != e; ++p) {
+    auto const digit = static_cast<unsigned>(*p - '0');
+    if (digit > 9) return false;
+    value = value * 10 + digit;
+  }
+  return true;
+}
+
+// Writes `value` as exactly `n` decimal digits, ending at `p`.
+void FormatDigits(char* p, int n, unsigned value) {
+  while (n-- != 0) {
+    *--p = static_cast<char>('0' + value % 10);
+    value /= 10;
+  }
+}
+
+// Parses the fixed "YYYY-MM-DDTHH:MM:SS[.F{1,9}]Z" format that Spanner uses
+// for TIMESTAMP values. Returns false for anything else (including leap
+// seconds and UTC offsets), which callers should then handle with the more
+// general `absl::ParseTime()`.
+bool ParseCanonicalRFC3339(std::string const& s, absl::Time& t) {
+  auto constexpr kMinSize = sizeof("YYYY-MM-DDTHH:MM:SSZ") - 1;
+  if (s.size() < kMinSize || s.size() > kMinSize + 10) return false;
+  char const* p = s.data();
+  unsigned year, month, day, hour, minute, second;
+  if (!ParseDigits(p, 4, year) || *p++ != '-') return false;
+  if (!ParseDigits(p, 2, month) || *p++ != '-') return false;
+  if (!ParseDigits(p, 2, day) || *p++ != 'T') return false;
+  if (!ParseDigits(p, 2, hour) || *p++ != ':') return false;
+  if (!ParseDigits(p, 2, minute) || *p++ != ':') return false;
+  if (!ParseDigits(p, 2, second)) return false;
+  unsigned nanos = 0;
+  if (*p == '.') {
+    int const n = static_cast<int>(s.size() - kMinSize) - 1;
+    ++p;
+    if (n == 0 || !ParseDigits(p, n, nanos)) return false;
+    for (int i = n; i != 9; ++i) nanos *= 10;
+  }
+  if (p != s.data() + s.size() - 1 || *p != 'Z') return false;
+
+  static constexpr unsigned kDaysInMonth[] = {31, 29, 31, 30, 31, 30,
+                                              31, 31, 30, 31, 30, 31};
+  if (month < 1 || month > 12 || day < 1 || day > kDaysInMonth[month - 1]) {
+    return false;
+  }
+  bool const leap = year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+  if (month == 2 && day == 29 && !leap) return false;
+  if (hour > 23 || minute > 59 || second > 59) return false;
+
+  auto const days = DaysFromCivil(year, month, day);
+  auto const seconds = days * 86400 + hour * 3600 + minute * 60 + second;
+  t = absl::FromUnixSeconds(seconds) + absl::Nanoseconds(nanos);
+  return true;
+}
+
 }  // namespace
 
 StatusOr<std::int64_t> Timestamp::ToRatio(std::int64_t min, std::int64_t max,
@@ -73,21 +156,57 @@ std::ostream& operator<<(std::ostream& os, Timestamp ts) {
 namespace internal {
 
 // Timestamp objects are always formatted in UTC, and we always format them
-// with a trailing 'Z'. However, we're a bit more liberal in the UTC offsets we
-// accept, thus the use of '%Ez' in kParseSpec.
-auto constexpr kFormatSpec = "%E4Y-%m-%dT%H:%M:%E*SZ";
+// with a trailing 'Z' (i.e., as "%E4Y-%m-%dT%H:%M:%E*SZ"). However, we're a bit
+// more liberal in the UTC offsets we accept, thus the use of '%Ez' in
+// kParseSpec.
 auto constexpr kParseSpec = "%Y-%m-%dT%H:%M:%E*S%Ez";
 
 StatusOr<Timestamp> TimestampFromRFC3339(std::string const& s) {
   absl::Time t;
+  if (ParseCanonicalRFC3339(s, t)) return MakeTimestamp(t);
   std::string err;
   if (absl::ParseTime(kParseSpec, s, &t, &err)) return MakeTimestamp(t);
   return InvalidArgument(s + ": " + err);
 }
 
+// Equivalent to formatting with `absl::FormatTime()`, but without the
+// time-zone lookup and format-string interpretation. This relies on the
+// `Timestamp` range, which limits the year to [1, 9999].
 std::string TimestampToRFC3339(Timestamp ts) {
   auto const t = ts.get<absl::Time>().value();  // Cannot fail.
-  return absl::FormatTime(kFormatSpec, t, absl::UTCTimeZone());
+  auto const seconds = absl::ToUnixSeconds(t);  // Rounds toward the past.
+  auto const nanos = static_cast<unsigned>(
+      (t - absl::FromUnixSeconds(seconds)) / absl::Nanoseconds(1));
+  auto days = seconds / 86400;
+  auto sod = seconds % 86400;
+  if (sod < 0) {
+    sod += 86400;
+    --days;
+  }
+  std::int64_t year;
+  unsigned month, day;
+  CivilFromDays(days, year, month, day);
+
+  char buf[sizeof("YYYY-MM-DDTHH:MM:SS.FFFFFFFFFZ")];
+  char* p = buf;
+  FormatDigits(p += 4, 4, static_cast<unsigned>(year));
+  *p++ = '-';
+  FormatDigits(p += 2, 2, month);
+  *p++ = '-';
+  FormatDigits(p += 2, 2, day);
+  *p++ = 'T';
+  FormatDigits(p += 2, 2, static_cast<unsigned>(sod / 3600));
+  *p++ = ':';
+  FormatDigits(p += 2, 2, static_cast<unsigned>(sod / 60 % 60));
+  *p++ = ':';
+  FormatDigits(p += 2, 2, static_cast<unsigned>(sod % 60));
+  if (nanos != 0) {
+    *p++ = '.';
+    FormatDigits(p += 9, 9, nanos);
+    while (*(p - 1) == '0') --p;  // Like %E*S, trims trailing zeros.
+  }
+  *p++ = 'Z';
+  return std::string(buf, p);
 }
 
 StatusOr<Timestamp> TimestampFromProto(protobuf::Timestamp const& proto) {
@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <limits>
 #include <sstream>
+#include <string>
 
 namespace google {
 namespace cloud {
@@ -231,6 +232,41 @@ TEST(Timestamp, FromRFC3339Failure) {
   EXPECT_FALSE(internal::TimestampFromRFC3339("2019-06-21T16:52:22-24:60"));
 }
 
+TEST(Timestamp, RFC3339MatchesAbsl) {
+  // The RFC3339 conversions use a fast path for the canonical format. Verify
+  // that it agrees with `absl::FormatTime()` and `absl::ParseTime()` across
+  // the whole `Timestamp` range.
+  auto constexpr kFormatSpec = "%E4Y-%m-%dT%H:%M:%E*SZ";
+  std::int64_t const min_seconds = -62135596800;
+  std::int64_t const max_seconds = 253402300799;
+  std::int64_t const step = 86400 * 29 + 3600 * 5 + 60 * 7 + 11;
+  std::int32_t nanos = 0;
+  for (auto seconds = min_seconds; seconds <= max_seconds; seconds += step) {
+    auto const t = absl::FromUnixSeconds(seconds) + absl::Nanoseconds(nanos);
+    auto const ts = MakeTimestamp(t).value();
+    auto const expected = absl::FormatTime(kFormatSpec, t, absl::UTCTimeZone());
+    auto const actual = internal::TimestampToRFC3339(ts);
+    ASSERT_EQ(expected, actual);
+    ASSERT_EQ(ts, internal::TimestampFromRFC3339(actual).value()) << actual;
+    nanos = (nanos * 7 + 123457) % 1000000000;
+  }
+
+  for (auto const* s :
+       {"2019-02-29T00:00:00Z", "2020-02-30T00:00:00Z", "2019-06-31T00:00:00Z",
+        "2019-00-01T00:00:00Z", "2019-13-01T00:00:00Z", "2019-06-00T00:00:00Z",
+        "2019-06-21T24:00:00Z", "2019-06-21T16:60:00Z",
+        "2019-06-21T16:52:22.1234567890Z"}) {
+    absl::Time t;
+    std::string err;
+    auto const expected =
+        absl::ParseTime("%Y-%m-%dT%H:%M:%E*S%Ez", s, &t, &err);
+    EXPECT_EQ(expected, internal::TimestampFromRFC3339(s).ok()) << s;
+  }
+  EXPECT_EQ(
+      internal::TimestampFromProto(MakeProtoTimestamp(1582934400, 0)).value(),
+      internal::TimestampFromRFC3339("2020-02-29T00:00:00Z").value());
+}
+
 TEST(Timestamp, FromRFC3339Limit) {
   // Verify Spanner range requirements.
   EXPECT_EQ(
@@ -21,6 +21,7 @@
 #include <cstdlib>
 #include <iomanip>
 #include <ios>
+#include <limits>
 #include <sstream>
 #include <string>
 
@@ -181,6 +182,38 @@ std::ostream& StreamHelper(std::ostream& os, google::protobuf::Value const& v,
   return os;
 }
 
+// Parses the canonical `-?[0-9]+` representation of an INT64. Returns false,
+// leaving `out` unspecified, for anything else (including overflow), which
+// callers should then handle with the more general (and much slower)
+// `std::strtoll()`.
+bool ParseCanonicalInt64(std::string const& s, std::int64_t& out) {
+  char const* p = s.data();
+  char const* const e = p + s.size();
+  bool const negative = p != e && *p == '-';
+  if (negative) ++p;
+  // 19 decimal digits always fit in a std::uint64_t, so only the magnitude
+  // of a 19-digit value needs checking against the std::int64_t limits.
+  if (p == e || e - p > 19) return false;
+  std::uint64_t magnitude = 0;
+  for (; p != e; ++p) {
+    auto const digit = static_cast<unsigned>(*p - '0');
+    if (digit > 9) return false;
+    magnitude = magnitude * 10 + digit;
+  }
+  auto const max = static_cast<std::uint64_t>(
+      (std::numeric_limits<std::int64_t>::max)());
+  if (negative) {
+    if (magnitude > max + 1) return false;
+    // Avoids the undefined behavior of negating the minimum value.
+    out = magnitude == max + 1 ? (std::numeric_limits<std::int64_t>::min)()
+                               : -static_cast<std::int64_t>(magnitude);
+    return true;
+  }
+  if (magnitude > max) return false;
+  out = static_cast<std::int64_t>(magnitude);
+  return true;
+}
+
 }  // namespace
 
 namespace internal {
@@ -193,6 +226,8 @@ std::pair<google::spanner::v1::Type, google::protobuf::Value> ToProto(Value v) {
   return std::make_pair(std::move(v.type_), std::move(v.value_));
 }
 
+std::size_t EncodedSize(Value const& v) { return v.value_.ByteSizeLong(); }
+
 }  // namespace internal
 
 bool operator==(Value const& a, Value const& b) {
@@ -408,6 +443,8 @@ StatusOr<std::int64_t> Value::GetValue(std::int64_t,
     return Status(StatusCode::kUnknown, "missing INT64");
   }
   auto const& s = pv.string_value();
+  std::int64_t canonical;
+  if (ParseCanonicalInt64(s, canonical)) return canonical;
   char* end = nullptr;
   errno = 0;
   std::int64_t x = {std::strtoll(s.c_str(), &end, 10)};
@@ -468,6 +505,14 @@ StatusOr<Bytes> Value::GetValue(Bytes const&, google::protobuf::Value const& pv,
   return *decoded;
 }
 
+StatusOr<Bytes> Value::GetValue(Bytes const&, google::protobuf::Value&& pv,
+                                google::spanner::v1::Type const&) {
+  if (pv.kind_case() != google::protobuf::Value::kStringValue) {
+    return Status(StatusCode::kUnknown, "missing BYTES");
+  }
+  return internal::BytesFromBase64(std::move(*pv.mutable_string_value()));
+}
+
 StatusOr<Numeric> Value::GetValue(Numeric const&,
                                   google::protobuf::Value const& pv,
                                   google::spanner::v1::Type const&) {
@@ -479,6 +524,14 @@ StatusOr<Numeric> Value::GetValue(Numeric const&,
   return *decoded;
 }
 
+StatusOr<Numeric> Value::GetValue(Numeric const&, google::protobuf::Value&& pv,
+                                  google::spanner::v1::Type const&) {
+  if (pv.kind_case() != google::protobuf::Value::kStringValue) {
+    return Status(StatusCode::kUnknown, "missing NUMERIC");
+  }
+  return MakeNumeric(std::move(*pv.mutable_string_value()));
+}
+
 StatusOr<Timestamp> Value::GetValue(Timestamp,
                                     google::protobuf::Value const& pv,
                                     google::spanner::v1::Type const&) {
@@ -46,6 +46,16 @@ class Value;  // Defined later in this file.
 namespace internal {
 Value FromProto(google::spanner::v1::Type t, google::protobuf::Value v);
 std::pair<google::spanner::v1::Type, google::protobuf::Value> ToProto(Value v);
+std::size_t EncodedSize(Value const& v);
+template <typename T>
+google::protobuf::Value MakeValueProto(T&& v);
+template <typename T>
+google::spanner::v1::Type MakeTypeProto();
+template <typename T>
+bool TypeProtoIs(google::spanner::v1::Type const& t);
+template <typename T>
+StatusOr<T> GetValueFromProto(google::spanner::v1::Type const& t,
+                              google::protobuf::Value v);
 }  // namespace internal
 
 /**
@@ -294,11 +304,7 @@ class Value {
   StatusOr<T> get() const& {
     if (!TypeProtoIs(T{}, type_))
       return Status(StatusCode::kUnknown, "wrong type");
-    if (value_.kind_case() == google::protobuf::Value::kNullValue) {
-      if (IsOptional<T>::value) return T{};
-      return Status(StatusCode::kUnknown, "null value");
-    }
-    return GetValue(T{}, value_, type_);
+    return GetNullableValue<T>(value_, type_);
   }
 
   /// @copydoc get()
@@ -306,12 +312,7 @@ class Value {
   StatusOr<T> get() && {
     if (!TypeProtoIs(T{}, type_))
       return Status(StatusCode::kUnknown, "wrong type");
-    if (value_.kind_case() == google::protobuf::Value::kNullValue) {
-      if (IsOptional<T>::value) return T{};
-      return Status(StatusCode::kUnknown, "null value");
-    }
-    auto tag = T{};  // Works around an odd msvc issue
-    return GetValue(std::move(tag), std::move(value_), type_);
+    return GetNullableValue<T>(std::move(value_), type_);
   }
 
   /**
@@ -470,6 +471,9 @@ class Value {
   static google::protobuf::Value MakeValueProto(absl::CivilDay d);
   static google::protobuf::Value MakeValueProto(int i);
   static google::protobuf::Value MakeValueProto(char const* s);
+  static google::protobuf::Value MakeValueProto(Value v) {
+    return std::move(v.value_);
+  }
   template <typename T>
   static google::protobuf::Value MakeValueProto(absl::optional<T> opt) {
     if (opt.has_value()) return MakeValueProto(*std::move(opt));
@@ -479,8 +483,11 @@ class Value {
   }
   template <typename T>
   static google::protobuf::Value MakeValueProto(std::vector<T> vec) {
+    static_assert(!IsVector<typename std::decay<T>::type>::value,
+                  "vector of vector not allowed. See value.h documentation.");
     google::protobuf::Value v;
     auto& list = *v.mutable_list_value();
+    list.mutable_values()->Reserve(static_cast<int>(vec.size()));
     for (auto&& e : vec) {
       *list.add_values() = MakeValueProto(std::move(e));
     }
@@ -509,6 +516,19 @@ class Value {
     }
   };
 
+  // Extracts a `T` from a `Value` protobuf whose type has already been checked
+  // against `T`. A "null" is only accepted when `T` is an `absl::optional`.
+  template <typename T, typename V>
+  static StatusOr<T> GetNullableValue(V&& pv,
+                                      google::spanner::v1::Type const& pt) {
+    if (pv.kind_case() == google::protobuf::Value::kNullValue) {
+      if (IsOptional<T>::value) return T{};
+      return Status(StatusCode::kUnknown, "null value");
+    }
+    auto tag = T{};  // Works around an odd msvc issue
+    return GetValue(std::move(tag), std::forward<V>(pv), pt);
+  }
+
   // Tag-dispatch overloads to extract a C++ value from a `Value` protobuf. The
   // first argument type is the tag, its value is ignored.
   static StatusOr<bool> GetValue(bool, google::protobuf::Value const&,
@@ -526,9 +546,13 @@ class Value {
                                         google::spanner::v1::Type const&);
   static StatusOr<Bytes> GetValue(Bytes const&, google::protobuf::Value const&,
                                   google::spanner::v1::Type const&);
+  static StatusOr<Bytes> GetValue(Bytes const&, google::protobuf::Value&&,
+                                  google::spanner::v1::Type const&);
   static StatusOr<Numeric> GetValue(Numeric const&,
                                     google::protobuf::Value const&,
                                     google::spanner::v1::Type const&);
+  static StatusOr<Numeric> GetValue(Numeric const&, google::protobuf::Value&&,
+                                    google::spanner::v1::Type const&);
   static StatusOr<Timestamp> GetValue(Timestamp, google::protobuf::Value const&,
                                       google::spanner::v1::Type const&);
   static StatusOr<CommitTimestamp> GetValue(CommitTimestamp,
@@ -543,7 +567,10 @@ class Value {
     if (pv.kind_case() == google::protobuf::Value::kNullValue) {
       return absl::optional<T>{};
     }
-    auto value = GetValue(T{}, std::forward<V>(pv), pt);
+    // A (non-constant) tag object, so that `T{}` is never a null pointer
+    // constant competing with the `std::string const&` overloads.
+    T tag{};
+    auto value = GetValue(tag, std::forward<V>(pv), pt);
     if (!value) return std::move(value).status();
     return absl::optional<T>{*std::move(value)};
   }
@@ -554,10 +581,11 @@ class Value {
       return Status(StatusCode::kUnknown, "missing ARRAY");
     }
     std::vector<T> v;
+    T tag{};  // see the `absl::optional<T>` overload
     for (int i = 0; i < pv.list_value().values().size(); ++i) {
       auto&& e = GetProtoListValueElement(std::forward<V>(pv), i);
       using ET = decltype(e);
-      auto value = GetValue(T{}, std::forward<ET>(e), pt.array_element_type());
+      auto value = GetValue(tag, std::forward<ET>(e), pt.array_element_type());
       if (!value) return std::move(value).status();
       v.push_back(*std::move(value));
     }
@@ -589,7 +617,8 @@ class Value {
     void operator()(T& t) {
       auto&& e = GetProtoListValueElement(std::forward<V>(pv), i);
       using ET = decltype(e);
-      auto value = GetValue(T{}, std::forward<ET>(e), type);
+      T tag{};  // see the `absl::optional<T>` overload
+      auto value = GetValue(tag, std::forward<ET>(e), type);
       ++i;
       if (!value) {
         status = std::move(value).status();
@@ -602,7 +631,8 @@ class Value {
       p.first = type.struct_type().fields(i).name();
       auto&& e = GetProtoListValueElement(std::forward<V>(pv), i);
       using ET = decltype(e);
-      auto value = GetValue(T{}, std::forward<ET>(e), type);
+      T tag{};  // see the `absl::optional<T>` overload
+      auto value = GetValue(tag, std::forward<ET>(e), type);
       ++i;
       if (!value) {
         status = std::move(value).status();
@@ -643,6 +673,16 @@ class Value {
                                    google::protobuf::Value);
   friend std::pair<google::spanner::v1::Type, google::protobuf::Value>
       internal::ToProto(Value);
+  friend std::size_t internal::EncodedSize(Value const&);
+  template <typename T>
+  friend google::protobuf::Value internal::MakeValueProto(T&&);
+  template <typename T>
+  friend google::spanner::v1::Type internal::MakeTypeProto();
+  template <typename T>
+  friend bool internal::TypeProtoIs(google::spanner::v1::Type const&);
+  template <typename T>
+  friend StatusOr<T> internal::GetValueFromProto(
+      google::spanner::v1::Type const&, google::protobuf::Value);
 
   google::spanner::v1::Type type_;
   google::protobuf::Value value_;
@@ -660,6 +700,46 @@ Value MakeNullValue() {
   return Value(absl::optional<T>{});
 }
 
+namespace internal {
+
+/**
+ * Encodes @p v directly as a `google::protobuf::Value`, without creating a
+ * `Value` (and its `Type`) first.
+ *
+ * This is equivalent to `ToProto(Value(v)).second`, and accepts the same types
+ * as the `Value` constructors, as well as `Value` itself.
+ */
+template <typename T>
+google::protobuf::Value MakeValueProto(T&& v) {
+  return Value::MakeValueProto(std::forward<T>(v));
+}
+
+/// Returns the Spanner type of the values of C++ type `T`.
+template <typename T>
+google::spanner::v1::Type MakeTypeProto() {
+  return Value::MakeTypeProto(T{});
+}
+
+/// Returns true if the C++ type `T` can hold values of the Spanner type @p t.
+template <typename T>
+bool TypeProtoIs(google::spanner::v1::Type const& t) {
+  return Value::TypeProtoIs(T{}, t);
+}
+
+/**
+ * Extracts a `T` directly from the given protos, without creating a `Value`.
+ *
+ * This is equivalent to `FromProto(t, v).get<T>()`, except that the caller
+ * must have verified `TypeProtoIs<T>(t)` beforehand.
+ */
+template <typename T>
+StatusOr<T> GetValueFromProto(google::spanner::v1::Type const& t,
+                              google::protobuf::Value v) {
+  return Value::GetNullableValue<T>(std::move(v), t);
+}
+
+}  // namespace internal
+
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
 }  // namespace cloud
@@ -25,6 +25,7 @@
 #include <string>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace google {
@@ -909,6 +910,32 @@ TEST(Value, GetBadInt) {
   EXPECT_FALSE(v.get<std::int64_t>().ok());
 }
 
+TEST(Value, GetInt64) {
+  Value v(42);
+  for (auto const& test : std::vector<std::pair<char const*, std::int64_t>>{
+           {"0", 0},
+           {"-0", 0},
+           {"007", 7},
+           {"-42", -42},
+           {"+42", 42},
+           {" 42", 42},
+           {"00000000000000000000042", 42},
+           {"9223372036854775807", std::numeric_limits<std::int64_t>::max()},
+           {"-9223372036854775808", std::numeric_limits<std::int64_t>::min()},
+       }) {
+    SetProtoKind(v, test.first);
+    auto actual = v.get<std::int64_t>();
+    ASSERT_STATUS_OK(actual) << test.first;
+    EXPECT_EQ(test.second, *actual) << test.first;
+  }
+
+  for (auto const* bad : {"-", "--1", "1-", "9223372036854775808",
+                          "-9223372036854775809", "99999999999999999999"}) {
+    SetProtoKind(v, bad);
+    EXPECT_FALSE(v.get<std::int64_t>().ok()) << bad;
+  }
+}
+
 TEST(Value, GetBadTimestamp) {
   Value v(Timestamp{});
   ClearProtoKind(v);
@@ -36,6 +36,13 @@ class MockCompletionQueue
     return std::unique_ptr<grpc::Alarm>();
   }
 
+  void RunAsync(
+      std::unique_ptr<google::cloud::internal::RunAsyncBase> f) override {
+    // Keep the functions as pending operations, so tests control when they
+    // run via `SimulateCompletion()`.
+    RunAsyncViaAlarm(std::move(f));
+  }
+
   using CompletionQueueImpl::empty;
   using CompletionQueueImpl::SimulateCompletion;
   using CompletionQueueImpl::size;